@@ -1,5 +1,7 @@
 <?php
 
+require_once __DIR__ . '/src/Ksfraser/Database/ConfigCache.php';
+
 /**
  * Database Configuration Manager
  * 
@@ -11,12 +13,28 @@ class DatabaseConfig
     private static $config = null;
     private static $configFile = null;
     
+    /**
+     * Shared connections per system: ['pdo' => PDO, 'pid' => int, 'checked' => int]
+     */
+    private static $connections = [];
+    
+    /**
+     * PID that first loaded this class's connections (before any fork)
+     */
+    private static $originPid = null;
+    
+    /**
+     * Connections inherited across fork, kept so they are not closed
+     */
+    private static $inherited = [];
+    
     /**
      * Load configuration from file
      */
     public static function load($configFile = null)
     {
-        if (self::$config !== null && $configFile === self::$configFile) {
+        // load() with no argument reuses whatever was loaded (the default file)
+        if (self::$config !== null && ($configFile === null || $configFile === self::$configFile)) {
             return self::$config;
         }
         
@@ -43,20 +61,16 @@ class DatabaseConfig
             throw new Exception('Database configuration file not found. Please create db_config.yml from db_config.example.yml');
         }
         
-        $extension = pathinfo($configFile, PATHINFO_EXTENSION);
-        
-        switch (strtolower($extension)) {
-            case 'yml':
-            case 'yaml':
-                self::$config = self::loadYaml($configFile);
-                break;
-            case 'ini':
-                self::$config = self::loadIni($configFile);
-                break;
-            default:
-                throw new Exception('Unsupported configuration file format. Use .yml, .yaml, or .ini');
+        $extension = strtolower(pathinfo($configFile, PATHINFO_EXTENSION));
+        if (!in_array($extension, ['yml', 'yaml', 'ini'])) {
+            throw new Exception('Unsupported configuration file format. Use .yml, .yaml, or .ini');
         }
         
+        // Parsed once per file change, then served compiled from opcache
+        self::$config = \Ksfraser\Database\ConfigCache::load($configFile, function ($file) use ($extension) {
+            return $extension === 'ini' ? self::loadIni($file) : self::loadYaml($file);
+        });
+        
         self::$configFile = $configFile;
         return self::$config;
     }
@@ -188,6 +202,37 @@ class DatabaseConfig
         ];
     }
     
+    /**
+     * Get shared cache configuration (symbol registry, ...)
+     */
+    public static function getCacheConfig()
+    {
+        $config = self::load();
+        $cache = $config['cache'] ?? [];
+        
+        return [
+            'backend' => $cache['backend'] ?? 'memory',
+            'ttl' => (int)($cache['ttl'] ?? 300),
+            'version_check_interval' => (int)($cache['version_check_interval'] ?? 1),
+            'redis' => $cache['redis'] ?? []
+        ];
+    }
+    
+    /**
+     * Get stock data storage configuration (per-symbol tables or shared partitioned tables)
+     */
+    public static function getStorageConfig()
+    {
+        $config = self::load();
+        $storage = $config['storage'] ?? [];
+        
+        return [
+            'backend' => $storage['backend'] ?? 'per_symbol',
+            'partition_start_year' => (int)($storage['partition_start_year'] ?? 2000),
+            'compressed' => (bool)($storage['compressed'] ?? true)
+        ];
+    }
+    
     /**
      * Get logging configuration
      */
@@ -201,6 +246,23 @@ class DatabaseConfig
         ];
     }
     
+    /**
+     * Get connection pooling settings
+     *
+     * persistent reuses connections across requests in the same PHP worker;
+     * health_check_interval is how long a shared connection may sit idle
+     * before it is pinged (0 = never).
+     */
+    public static function getConnectionConfig()
+    {
+        $config = self::load();
+        
+        return [
+            'persistent' => filter_var($config['database']['persistent'] ?? false, FILTER_VALIDATE_BOOLEAN),
+            'health_check_interval' => (int)($config['database']['health_check_interval'] ?? 60)
+        ];
+    }
+    
     /**
      * Create PDO connection for micro-cap system
      */
@@ -208,21 +270,7 @@ class DatabaseConfig
     {
         $config = self::getMicroCapConfig();
         
-        $dsn = sprintf(
-            'mysql:host=%s;port=%d;dbname=%s;charset=%s',
-            $config['host'],
-            $config['port'],
-            $config['dbname'],
-            $config['charset']
-        );
-        
-        $options = [
-            PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION,
-            PDO::ATTR_DEFAULT_FETCH_MODE => PDO::FETCH_ASSOC,
-            PDO::ATTR_EMULATE_PREPARES => false,
-        ];
-        
-        return new PDO($dsn, $config['username'], $config['password'], $options);
+        return self::connect($config, $config['dbname']);
     }
     
     /**
@@ -232,11 +280,113 @@ class DatabaseConfig
     {
         $config = self::getLegacyConfig();
         
+        return self::connect($config, $config['database']);
+    }
+    
+    /**
+     * Shared legacy connection for this process
+     *
+     * Prefer this over createLegacyConnection() for anything that does not
+     * need its own session: every caller in the process shares one socket.
+     */
+    public static function getLegacyConnection()
+    {
+        return self::getSharedConnection('legacy');
+    }
+    
+    /**
+     * Shared micro-cap connection for this process
+     */
+    public static function getMicroCapConnection()
+    {
+        return self::getSharedConnection('micro_cap');
+    }
+    
+    /**
+     * Drop shared connections (the next call reconnects)
+     *
+     * Connections inherited from a parent process are parked rather than
+     * closed, for the same reason as in getSharedConnection().
+     */
+    public static function resetConnections()
+    {
+        $pid = getmypid();
+        foreach (self::$connections as $shared) {
+            if ($shared['pid'] !== $pid) {
+                self::$inherited[] = $shared['pdo'];
+            }
+        }
+        self::$connections = [];
+    }
+    
+    /**
+     * One connection per system and process
+     *
+     * A forked child never reuses the parent's socket: the inherited handle
+     * is parked (closing it would end the parent's session) and a new,
+     * non-persistent connection is opened. A connection idle longer than
+     * health_check_interval is pinged and reopened if the server dropped it.
+     */
+    private static function getSharedConnection($system)
+    {
+        $pid = getmypid();
+        $now = time();
+        $shared = self::$connections[$system] ?? null;
+        
+        if ($shared !== null) {
+            if ($shared['pid'] !== $pid) {
+                self::$inherited[] = $shared['pdo'];
+            } elseif (self::isHealthy($shared, $now)) {
+                self::$connections[$system]['checked'] = $now;
+                return $shared['pdo'];
+            }
+        }
+        
+        $config = $system === 'micro_cap' ? self::getMicroCapConfig() : self::getLegacyConfig();
+        $database = $system === 'micro_cap' ? $config['dbname'] : $config['database'];
+        
+        if (self::$originPid === null) {
+            self::$originPid = $pid;
+        }
+        // Persistent handles live in a per-process list the child inherited
+        $allowPersistent = self::$originPid === $pid;
+        
+        self::$connections[$system] = [
+            'pdo' => self::connect($config, $database, $allowPersistent),
+            'pid' => $pid,
+            'checked' => $now
+        ];
+        return self::$connections[$system]['pdo'];
+    }
+    
+    /**
+     * Ping a shared connection that has been idle past the check interval
+     */
+    private static function isHealthy(array $shared, $now)
+    {
+        $interval = self::getConnectionConfig()['health_check_interval'];
+        if ($interval <= 0 || $now - $shared['checked'] < $interval) {
+            return true;
+        }
+        
+        try {
+            $shared['pdo']->query('SELECT 1');
+            return true;
+        } catch (PDOException $e) {
+            return false;
+        }
+    }
+    
+    /**
+     * Open a PDO connection
+     */
+    private static function connect(array $config, $database, $allowPersistent = true)
+    {
         $dsn = sprintf(
             'mysql:host=%s;port=%d;dbname=%s;charset=%s',
             $config['host'],
             $config['port'],
-            $config['database'],
+            $database,
             $config['charset']
         );
         
@@ -244,6 +394,7 @@ class DatabaseConfig
             PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION,
             PDO::ATTR_DEFAULT_FETCH_MODE => PDO::FETCH_ASSOC,
             PDO::ATTR_EMULATE_PREPARES => false,
+            PDO::ATTR_PERSISTENT => $allowPersistent && self::getConnectionConfig()['persistent'],
         ];
         
         return new PDO($dsn, $config['username'], $config['password'], $options);
@@ -8,52 +8,171 @@
 class DatabaseJobBackend
 {
     private $pdo;
+    private $logger;
+    private $sharedConnection;
     
-    public function __construct()
+    /**
+     * Statuses a job may be claimed from
+     */
+    const CLAIMABLE_STATUSES = ['PENDING', 'pending'];
+    
+    public function __construct($config = [], $logger = null, $pdo = null)
     {
-        $this->pdo = DatabaseConfig::createLegacyConnection();
+        $this->logger = $logger;
+        $this->sharedConnection = $pdo === null;
+        $this->pdo = $pdo ?: DatabaseConfig::getLegacyConnection();
         $this->initializeTables();
     }
     
+    /**
+     * Switch to this process's own connection (call in a forked child, so
+     * it does not interleave queries on the parent's socket)
+     */
+    public function reconnect()
+    {
+        if ($this->sharedConnection) {
+            $this->pdo = DatabaseConfig::getLegacyConnection();
+        }
+    }
+    
+    /**
+     * Columns the job queue adds to the existing ta_analysis_jobs table
+     */
+    const JOB_COLUMNS = [
+        'job_type' => "VARCHAR(50) DEFAULT 'technical_analysis'",
+        'priority' => 'INT DEFAULT 5',
+        'worker_id' => 'VARCHAR(255) NULL',
+        'retry_count' => 'INT DEFAULT 0',
+        'max_retries' => 'INT DEFAULT 3',
+        'scheduled_at' => 'TIMESTAMP NULL',
+        'started_at' => 'TIMESTAMP NULL',
+        'completed_at' => 'TIMESTAMP NULL',
+        'result_data' => 'JSON NULL',
+        'error_details' => 'TEXT NULL',
+        'claimed_at' => 'TIMESTAMP NULL'
+    ];
+    
+    /**
+     * Indexes on ta_analysis_jobs; idx_job_claim serves claimJobs()
+     */
+    const JOB_INDEXES = [
+        'idx_job_status_priority' => 'status, priority',
+        'idx_worker_id' => 'worker_id',
+        'idx_job_type' => 'job_type',
+        'idx_job_claim' => 'status, scheduled_at, priority, created_at'
+    ];
+    
+    /**
+     * MySQL duplicate column / duplicate key name, raised when another
+     * worker added the same column or index concurrently
+     */
+    const DUPLICATE_SCHEMA_ERRORS = [1060, 1061];
+    
     /**
      * Initialize database tables for job processing
+     *
+     * Works on MySQL 8, MariaDB and SQLite: missing columns and indexes are
+     * found through information_schema (PRAGMA on SQLite) and added one at a
+     * time, since ADD COLUMN / ADD INDEX IF NOT EXISTS is MariaDB-only.
      */
     private function initializeTables()
     {
         // Job workers table
-        $this->pdo->exec("
-            CREATE TABLE IF NOT EXISTS job_workers (
-                worker_id VARCHAR(255) PRIMARY KEY,
-                name VARCHAR(255) NOT NULL,
-                hostname VARCHAR(255) NOT NULL,
-                pid INT NOT NULL,
-                max_concurrent_jobs INT DEFAULT 3,
-                supported_job_types JSON,
-                capabilities JSON,
-                status ENUM('starting', 'running', 'stopping', 'stopped') DEFAULT 'starting',
-                started_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-                last_heartbeat TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-            )
-        ");
+        if ($this->isSqlite()) {
+            $this->pdo->exec("
+                CREATE TABLE IF NOT EXISTS job_workers (
+                    worker_id VARCHAR(255) PRIMARY KEY,
+                    name VARCHAR(255) NOT NULL,
+                    hostname VARCHAR(255) NOT NULL,
+                    pid INT NOT NULL,
+                    max_concurrent_jobs INT DEFAULT 3,
+                    supported_job_types TEXT,
+                    capabilities TEXT,
+                    status VARCHAR(20) DEFAULT 'starting',
+                    started_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                    last_heartbeat TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+                )
+            ");
+        } else {
+            $this->pdo->exec("
+                CREATE TABLE IF NOT EXISTS job_workers (
+                    worker_id VARCHAR(255) PRIMARY KEY,
+                    name VARCHAR(255) NOT NULL,
+                    hostname VARCHAR(255) NOT NULL,
+                    pid INT NOT NULL,
+                    max_concurrent_jobs INT DEFAULT 3,
+                    supported_job_types JSON,
+                    capabilities JSON,
+                    status ENUM('starting', 'running', 'stopping', 'stopped') DEFAULT 'starting',
+                    started_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                    last_heartbeat TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+                    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+                )
+            ");
+        }
         
         // Job queue table (extend existing ta_analysis_jobs)
-        $this->pdo->exec("
-            ALTER TABLE ta_analysis_jobs 
-            ADD COLUMN IF NOT EXISTS job_type VARCHAR(50) DEFAULT 'technical_analysis',
-            ADD COLUMN IF NOT EXISTS priority INT DEFAULT 5,
-            ADD COLUMN IF NOT EXISTS worker_id VARCHAR(255) NULL,
-            ADD COLUMN IF NOT EXISTS retry_count INT DEFAULT 0,
-            ADD COLUMN IF NOT EXISTS max_retries INT DEFAULT 3,
-            ADD COLUMN IF NOT EXISTS scheduled_at TIMESTAMP NULL,
-            ADD COLUMN IF NOT EXISTS started_at TIMESTAMP NULL,
-            ADD COLUMN IF NOT EXISTS completed_at TIMESTAMP NULL,
-            ADD COLUMN IF NOT EXISTS result_data JSON NULL,
-            ADD COLUMN IF NOT EXISTS error_details TEXT NULL,
-            ADD INDEX idx_job_status_priority (status, priority),
-            ADD INDEX idx_worker_id (worker_id),
-            ADD INDEX idx_job_type (job_type)
-        ");
+        $columns = $this->existingColumns('ta_analysis_jobs');
+        foreach (self::JOB_COLUMNS as $column => $definition) {
+            if (!in_array($column, $columns, true)) {
+                $this->execSchemaChange("ALTER TABLE ta_analysis_jobs ADD COLUMN {$column} {$definition}");
+            }
+        }
+        
+        $indexes = $this->existingIndexes('ta_analysis_jobs');
+        foreach (self::JOB_INDEXES as $index => $indexColumns) {
+            if (!in_array($index, $indexes, true)) {
+                $this->execSchemaChange("CREATE INDEX {$index} ON ta_analysis_jobs ({$indexColumns})");
+            }
+        }
+    }
+    
+    /**
+     * Column names of a table
+     */
+    private function existingColumns($table)
+    {
+        if ($this->isSqlite()) {
+            return array_column($this->pdo->query("PRAGMA table_info({$table})")->fetchAll(PDO::FETCH_ASSOC), 'name');
+        }
+        
+        $stmt = $this->pdo->prepare("SELECT COLUMN_NAME FROM information_schema.COLUMNS
+                                     WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?");
+        $stmt->execute([$table]);
+        return $stmt->fetchAll(PDO::FETCH_COLUMN);
+    }
+    
+    /**
+     * Index names of a table
+     */
+    private function existingIndexes($table)
+    {
+        if ($this->isSqlite()) {
+            return array_column($this->pdo->query("PRAGMA index_list({$table})")->fetchAll(PDO::FETCH_ASSOC), 'name');
+        }
+        
+        $stmt = $this->pdo->prepare("SELECT DISTINCT INDEX_NAME FROM information_schema.STATISTICS
+                                     WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?");
+        $stmt->execute([$table]);
+        return $stmt->fetchAll(PDO::FETCH_COLUMN);
+    }
+    
+    /**
+     * Run one ALTER/CREATE INDEX, ignoring a column or index that a
+     * concurrent worker added since existingColumns()/existingIndexes() ran
+     */
+    private function execSchemaChange($sql)
+    {
+        try {
+            $this->pdo->exec($sql);
+        } catch (PDOException $e) {
+            $duplicate = in_array((int)($e->errorInfo[1] ?? 0), self::DUPLICATE_SCHEMA_ERRORS, true)
+                || ($this->isSqlite() && preg_match('/duplicate column|already exists/i', $e->getMessage()));
+            if (!$duplicate) {
+                throw $e;
+            }
+        }
     }
     
     /**
@@ -112,45 +231,159 @@ class DatabaseJobBackend
     
     /**
      * Get available jobs for worker
+     *
+     * Jobs are claimed atomically (see claimJobs()), so no two workers
+     * receive the same job.
+     */
+    public function getAvailableJobs($limit, $supportedTypes = [], $capabilities = [], $workerId = null)
+    {
+        return $this->claimJobs($workerId, $limit, $supportedTypes);
+    }
+    
+    /**
+     * Atomically claim up to $limit runnable jobs for a worker
+     *
+     * MySQL 8 / MariaDB 10.6 lock the candidate rows with
+     * SELECT ... FOR UPDATE SKIP LOCKED, so concurrent workers skip rows
+     * another transaction is claiming instead of blocking on them. SQLite has
+     * no row locks; BEGIN IMMEDIATE takes the write lock up front, which
+     * serializes claimers. Either way the candidates are stamped with
+     * status 'claimed', worker_id and claimed_at in the same transaction, in
+     * one UPDATE. The candidate scan uses idx_job_claim.
+     *
+     * @return array Claimed job rows
      */
-    public function getAvailableJobs($limit, $supportedTypes = [], $capabilities = [])
+    public function claimJobs($workerId, $limit, $supportedTypes = [])
     {
+        $limit = (int)$limit;
+        if ($limit <= 0) {
+            return [];
+        }
+        
+        $sqlite = $this->isSqlite();
+        
+        $statusPlaceholders = implode(',', array_fill(0, count(self::CLAIMABLE_STATUSES), '?'));
         $sql = "SELECT * FROM ta_analysis_jobs 
-                WHERE status IN ('PENDING', 'pending') 
+                WHERE status IN ({$statusPlaceholders}) 
                 AND (scheduled_at IS NULL OR scheduled_at <= CURRENT_TIMESTAMP)
                 AND retry_count < max_retries";
-        
-        $params = [];
+        $params = self::CLAIMABLE_STATUSES;
         
         // Filter by supported job types
         if (!empty($supportedTypes)) {
             $placeholders = str_repeat('?,', count($supportedTypes) - 1) . '?';
             $sql .= " AND job_type IN ({$placeholders})";
-            $params = array_merge($params, $supportedTypes);
+            $params = array_merge($params, array_values($supportedTypes));
         }
         
-        $sql .= " ORDER BY priority DESC, created_at ASC LIMIT ?";
-        $params[] = $limit;
+        $sql .= " ORDER BY priority DESC, created_at ASC LIMIT {$limit}";
+        if (!$sqlite) {
+            $sql .= " FOR UPDATE SKIP LOCKED";
+        }
         
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute($params);
+        if ($sqlite) {
+            $this->pdo->exec('BEGIN IMMEDIATE');
+        } else {
+            $this->pdo->beginTransaction();
+        }
         
-        $jobs = $stmt->fetchAll(PDO::FETCH_ASSOC);
+        try {
+            $stmt = $this->pdo->prepare($sql);
+            $stmt->execute($params);
+            $jobs = $stmt->fetchAll(PDO::FETCH_ASSOC);
+            
+            if (!empty($jobs)) {
+                $ids = array_column($jobs, 'id');
+                $idPlaceholders = implode(',', array_fill(0, count($ids), '?'));
+                $update = $this->pdo->prepare(
+                    "UPDATE ta_analysis_jobs 
+                     SET status = 'claimed', worker_id = ?, claimed_at = CURRENT_TIMESTAMP 
+                     WHERE id IN ({$idPlaceholders})"
+                );
+                $update->execute(array_merge([$workerId], $ids));
+            }
+            
+            if ($sqlite) {
+                $this->pdo->exec('COMMIT');
+            } else {
+                $this->pdo->commit();
+            }
+        } catch (Exception $e) {
+            if ($sqlite) {
+                $this->pdo->exec('ROLLBACK');
+            } elseif ($this->pdo->inTransaction()) {
+                $this->pdo->rollBack();
+            }
+            throw $e;
+        }
         
-        // Mark jobs as claimed by this request
-        foreach ($jobs as $job) {
-            $this->updateJobStatus($job['id'], 'claimed', null);
+        $claimedAt = date('Y-m-d H:i:s');
+        foreach ($jobs as &$job) {
+            $job['status'] = 'claimed';
+            $job['worker_id'] = $workerId;
+            $job['claimed_at'] = $claimedAt;
         }
+        unset($job);
         
         return $jobs;
     }
     
+    /**
+     * Claim and start the next job (StandaloneWorker interface)
+     */
+    public function getNextJob($workerId, $jobTypes = [])
+    {
+        $jobs = $this->claimJobs($workerId, 1, $jobTypes);
+        
+        if (empty($jobs)) {
+            return null;
+        }
+        
+        $this->updateJobStatus($jobs[0]['id'], 'running', $workerId);
+        $jobs[0]['status'] = 'running';
+        
+        return $jobs[0];
+    }
+    
+    /**
+     * Mark a job completed (StandaloneWorker interface)
+     */
+    public function completeJob($jobId, $workerId, $result)
+    {
+        return $this->updateJobStatus($jobId, 'completed', $workerId, null, $result);
+    }
+    
+    /**
+     * Mark a job failed, returning it to the queue while retries remain (StandaloneWorker interface)
+     */
+    public function failJob($jobId, $workerId, $error, $retry = true)
+    {
+        $this->updateJobStatus($jobId, 'failed', $workerId, $error);
+        
+        if ($retry) {
+            $sql = "UPDATE ta_analysis_jobs SET status = 'pending', worker_id = NULL, claimed_at = NULL 
+                    WHERE id = ? AND retry_count < max_retries";
+            $stmt = $this->pdo->prepare($sql);
+            $stmt->execute([$jobId]);
+        }
+        
+        return true;
+    }
+    
+    /**
+     * Whether the connection is SQLite (no SKIP LOCKED, no MySQL DDL)
+     */
+    private function isSqlite()
+    {
+        return $this->pdo->getAttribute(PDO::ATTR_DRIVER_NAME) === 'sqlite';
+    }
+    
     /**
      * Update job status
      */
     public function updateJobStatus($jobId, $status, $workerId = null, $errorMessage = null, $resultData = null)
     {
-        $updates = ['status' => $status];
+        $updates = ['status = :status'];
         $params = ['id' => $jobId, 'status' => $status];
         
         if ($workerId !== null) {
@@ -177,7 +410,7 @@ class DatabaseJobBackend
             $params['result_data'] = json_encode($resultData);
         }
         
-        $updateClause = is_array($updates) ? implode(', ', $updates) : $updates;
+        $updateClause = implode(', ', $updates);
         $sql = "UPDATE ta_analysis_jobs SET {$updateClause} WHERE id = :id";
         
         $stmt = $this->pdo->prepare($sql);
@@ -260,6 +493,17 @@ class DatabaseJobBackend
         return $stmt->execute([$daysOld]);
     }
     
+    /**
+     * Delete every job of a type, whatever its status (benchmark cleanup)
+     */
+    public function deleteJobsByType($jobType)
+    {
+        $stmt = $this->pdo->prepare("DELETE FROM ta_analysis_jobs WHERE job_type = ?");
+        $stmt->execute([$jobType]);
+        
+        return $stmt->rowCount();
+    }
+    
     /**
      * Get stale workers (no heartbeat for X minutes)
      */
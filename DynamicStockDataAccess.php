@@ -1,6 +1,9 @@
 
 <?php
 require_once __DIR__ . '/src/IStockDataAccess.php';
+require_once __DIR__ . '/src/BulkUpsertWriter.php';
+require_once __DIR__ . '/src/Ksfraser/Database/StatementCache.php';
+require_once __DIR__ . '/src/Metrics.php';
 
 /**
  * Dynamic Stock Data Access Layer
@@ -12,15 +15,72 @@ require_once 'DatabaseConfig.php';
 
 class DynamicStockDataAccess implements IStockDataAccess
 {
+    /**
+     * Maximum number of per-symbol tables combined into one UNION ALL query
+     */
+    const MULTI_SYMBOL_CHUNK_SIZE = 50;
+    
     private $pdo;
     private $tableManager;
     private $logger;
+    private $statements;
+    
+    // Query shapes for getMultiSymbolData / streamMultiSymbolData
+    private $multiSymbolQueries = [
+        'historical_prices' => ['table_type' => 'historical_prices', 'order' => 'date DESC', 'latest' => false],
+        'technical_indicators' => ['table_type' => 'technical_indicators', 'order' => 'date DESC, indicator_name', 'latest' => false],
+        'candlestick_patterns' => ['table_type' => 'candlestick_patterns', 'order' => 'date DESC', 'latest' => false],
+        'latest_prices' => ['table_type' => 'historical_prices', 'order' => 'date DESC', 'latest' => true]
+    ];
     
     public function __construct()
     {
-        $this->pdo = DatabaseConfig::createLegacyConnection();
+        $this->pdo = DatabaseConfig::getLegacyConnection();
         $this->tableManager = new StockTableManager();
         $this->logger = new JobLogger('logs/stock_data_access.log');
+        $this->statements = new \Ksfraser\Database\StatementCache();
+    }
+    
+    /**
+     * Prepared statement cache counters (hits, misses, evictions, hit_rate)
+     */
+    public function getStatementCacheStats()
+    {
+        return $this->statements->getStats();
+    }
+    
+    /**
+     * Prepare through the statement cache: per-symbol SQL repeats for every
+     * call on the same symbol, so the server parses each shape once
+     */
+    private function prepareCached($sql)
+    {
+        return $this->statements->get($sql, function ($sql) {
+            return $this->pdo->prepare($sql);
+        });
+    }
+    
+    /**
+     * Run a database call inside a stock_data_query span labelled with the operation
+     */
+    private function timed($operation, callable $call)
+    {
+        return Metrics::time('stock_data_query', $call, ['operation' => $operation]);
+    }
+    
+    private function executeTimed($operation, $stmt, array $params)
+    {
+        return $this->timed($operation, function () use ($stmt, $params) {
+            return $stmt->execute($params);
+        });
+    }
+    
+    private function fetchAllTimed($operation, $stmt, array $params)
+    {
+        return $this->timed($operation, function () use ($stmt, $params) {
+            $stmt->execute($params);
+            return $stmt->fetchAll(PDO::FETCH_ASSOC);
+        });
     }
     
     /**
@@ -28,6 +88,12 @@ class DynamicStockDataAccess implements IStockDataAccess
      */
     public function insertPriceData($symbol, $priceData)
     {
+        if (is_array($priceData[0] ?? null)) {
+            // Bulk insert
+            return $this->bulkInsertPriceData($symbol, $priceData)['rows'];
+        }
+        
+        // Single insert
         $symbol = strtoupper(trim($symbol));
         
         // Ensure tables exist for this symbol
@@ -49,36 +115,64 @@ class DynamicStockDataAccess implements IStockDataAccess
                 volume = VALUES(volume),
                 updated_at = CURRENT_TIMESTAMP";
         
-        $stmt = $this->pdo->prepare($sql);
+        $stmt = $this->prepareCached($sql);
+        return $this->executePriceInsert($stmt, $symbol, $priceData);
+    }
+    
+    /**
+     * Bulk upsert historical price rows using multi-row statements
+     * committed in chunks. Returns per-chunk counts.
+     */
+    public function bulkInsertPriceData($symbol, $priceRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
         
-        if (is_array($priceData[0] ?? null)) {
-            // Bulk insert
-            $inserted = 0;
-            foreach ($priceData as $data) {
-                if ($this->executePriceInsert($stmt, $symbol, $data)) {
-                    $inserted++;
-                }
-            }
-            return $inserted;
-        } else {
-            // Single insert
-            return $this->executePriceInsert($stmt, $symbol, $priceData);
+        if (!$this->tableManager->tablesExistForSymbol($symbol)) {
+            $this->tableManager->registerSymbol($symbol);
         }
+        
+        $writer = new BulkUpsertWriter(
+            $this->pdo,
+            $this->tableManager->getTableName($symbol, 'historical_prices'),
+            ['symbol', 'date', 'open', 'high', 'low', 'close', 'adj_close', 'volume'],
+            [
+                'open = VALUES(open)',
+                'high = VALUES(high)',
+                'low = VALUES(low)',
+                'close = VALUES(close)',
+                'adj_close = VALUES(adj_close)',
+                'volume = VALUES(volume)',
+                'updated_at = CURRENT_TIMESTAMP'
+            ],
+            $chunkSize ?? BulkUpsertWriter::DEFAULT_CHUNK_SIZE,
+            $this->logger
+        );
+        
+        return $this->timed('bulk_insert_prices', function () use ($writer, $symbol, $priceRows) {
+            return $writer->write($this->mapRows($priceRows, function ($data) use ($symbol) {
+                return $this->priceRowValues($symbol, $data);
+            }));
+        });
+    }
+    
+    private function priceRowValues($symbol, $data)
+    {
+        return [
+            $symbol,
+            $data['date'],
+            $data['open'],
+            $data['high'],
+            $data['low'],
+            $data['close'],
+            $data['adj_close'] ?? $data['close'],
+            $data['volume'] ?? 0
+        ];
     }
     
     private function executePriceInsert($stmt, $symbol, $data)
     {
         try {
-            return $stmt->execute([
-                $symbol,
-                $data['date'],
-                $data['open'],
-                $data['high'],
-                $data['low'],
-                $data['close'],
-                $data['adj_close'] ?? $data['close'],
-                $data['volume'] ?? 0
-            ]);
+            return $this->executeTimed('insert_price', $stmt, $this->priceRowValues($symbol, $data));
         } catch (Exception $e) {
             $this->logger->error("Failed to insert price data for {$symbol}: " . $e->getMessage());
             return false;
@@ -118,10 +212,8 @@ class DynamicStockDataAccess implements IStockDataAccess
             $params[] = $limit;
         }
         
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute($params);
-        
-        return $stmt->fetchAll(PDO::FETCH_ASSOC);
+        $stmt = $this->prepareCached($sql);
+        return $this->fetchAllTimed('select_prices', $stmt, $params);
     }
     
     /**
@@ -129,6 +221,11 @@ class DynamicStockDataAccess implements IStockDataAccess
      */
     public function insertTechnicalIndicator($symbol, $indicatorData)
     {
+        if (is_array($indicatorData[0] ?? null)) {
+            // Bulk insert
+            return $this->bulkInsertTechnicalIndicators($symbol, $indicatorData)['rows'];
+        }
+        
         $symbol = strtoupper(trim($symbol));
         
         if (!$this->tableManager->tablesExistForSymbol($symbol)) {
@@ -144,33 +241,57 @@ class DynamicStockDataAccess implements IStockDataAccess
                 value = VALUES(value),
                 calculation_date = CURRENT_TIMESTAMP";
         
-        $stmt = $this->pdo->prepare($sql);
+        $stmt = $this->prepareCached($sql);
+        return $this->executeIndicatorInsert($stmt, $symbol, $indicatorData);
+    }
+    
+    /**
+     * Bulk upsert technical indicator rows using multi-row statements
+     * committed in chunks. Returns per-chunk counts.
+     */
+    public function bulkInsertTechnicalIndicators($symbol, $indicatorRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
         
-        if (is_array($indicatorData[0] ?? null)) {
-            // Bulk insert
-            $inserted = 0;
-            foreach ($indicatorData as $data) {
-                if ($this->executeIndicatorInsert($stmt, $symbol, $data)) {
-                    $inserted++;
-                }
-            }
-            return $inserted;
-        } else {
-            return $this->executeIndicatorInsert($stmt, $symbol, $indicatorData);
+        if (!$this->tableManager->tablesExistForSymbol($symbol)) {
+            $this->tableManager->registerSymbol($symbol);
         }
+        
+        $writer = new BulkUpsertWriter(
+            $this->pdo,
+            $this->tableManager->getTableName($symbol, 'technical_indicators'),
+            ['symbol', 'date', 'indicator_name', 'value', 'period', 'timeframe'],
+            [
+                'value = VALUES(value)',
+                'calculation_date = CURRENT_TIMESTAMP'
+            ],
+            $chunkSize ?? BulkUpsertWriter::DEFAULT_CHUNK_SIZE,
+            $this->logger
+        );
+        
+        return $this->timed('bulk_insert_indicators', function () use ($writer, $symbol, $indicatorRows) {
+            return $writer->write($this->mapRows($indicatorRows, function ($data) use ($symbol) {
+                return $this->indicatorRowValues($symbol, $data);
+            }));
+        });
+    }
+    
+    private function indicatorRowValues($symbol, $data)
+    {
+        return [
+            $symbol,
+            $data['date'],
+            $data['indicator_name'],
+            $data['value'],
+            $data['period'] ?? null,
+            $data['timeframe'] ?? 'daily'
+        ];
     }
     
     private function executeIndicatorInsert($stmt, $symbol, $data)
     {
         try {
-            return $stmt->execute([
-                $symbol,
-                $data['date'],
-                $data['indicator_name'],
-                $data['value'],
-                $data['period'] ?? null,
-                $data['timeframe'] ?? 'daily'
-            ]);
+            return $this->executeTimed('insert_indicator', $stmt, $this->indicatorRowValues($symbol, $data));
         } catch (Exception $e) {
             $this->logger->error("Failed to insert indicator data for {$symbol}: " . $e->getMessage());
             return false;
@@ -210,10 +331,8 @@ class DynamicStockDataAccess implements IStockDataAccess
         
         $sql .= " ORDER BY date DESC, indicator_name";
         
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute($params);
-        
-        return $stmt->fetchAll(PDO::FETCH_ASSOC);
+        $stmt = $this->prepareCached($sql);
+        return $this->fetchAllTimed('select_indicators', $stmt, $params);
     }
     
     /**
@@ -221,6 +340,10 @@ class DynamicStockDataAccess implements IStockDataAccess
      */
     public function insertCandlestickPattern($symbol, $patternData)
     {
+        if (is_array($patternData[0] ?? null)) {
+            return $this->bulkInsertCandlestickPatterns($symbol, $patternData)['rows'];
+        }
+        
         $symbol = strtoupper(trim($symbol));
         
         if (!$this->tableManager->tablesExistForSymbol($symbol)) {
@@ -237,32 +360,58 @@ class DynamicStockDataAccess implements IStockDataAccess
                 signal = VALUES(signal),
                 detection_date = CURRENT_TIMESTAMP";
         
-        $stmt = $this->pdo->prepare($sql);
+        $stmt = $this->prepareCached($sql);
+        return $this->executePatternInsert($stmt, $symbol, $patternData);
+    }
+    
+    /**
+     * Bulk upsert candlestick pattern rows using multi-row statements
+     * committed in chunks. Returns per-chunk counts.
+     */
+    public function bulkInsertCandlestickPatterns($symbol, $patternRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
         
-        if (is_array($patternData[0] ?? null)) {
-            $inserted = 0;
-            foreach ($patternData as $data) {
-                if ($this->executePatternInsert($stmt, $symbol, $data)) {
-                    $inserted++;
-                }
-            }
-            return $inserted;
-        } else {
-            return $this->executePatternInsert($stmt, $symbol, $patternData);
+        if (!$this->tableManager->tablesExistForSymbol($symbol)) {
+            $this->tableManager->registerSymbol($symbol);
         }
+        
+        $writer = new BulkUpsertWriter(
+            $this->pdo,
+            $this->tableManager->getTableName($symbol, 'candlestick_patterns'),
+            ['symbol', 'date', 'pattern_name', 'strength', 'signal', 'timeframe'],
+            [
+                'strength = VALUES(strength)',
+                'signal = VALUES(signal)',
+                'detection_date = CURRENT_TIMESTAMP'
+            ],
+            $chunkSize ?? BulkUpsertWriter::DEFAULT_CHUNK_SIZE,
+            $this->logger
+        );
+        
+        return $this->timed('bulk_insert_patterns', function () use ($writer, $symbol, $patternRows) {
+            return $writer->write($this->mapRows($patternRows, function ($data) use ($symbol) {
+                return $this->patternRowValues($symbol, $data);
+            }));
+        });
+    }
+    
+    private function patternRowValues($symbol, $data)
+    {
+        return [
+            $symbol,
+            $data['date'],
+            $data['pattern_name'],
+            $data['strength'] ?? 50,
+            $data['signal'] ?? 'NEUTRAL',
+            $data['timeframe'] ?? 'daily'
+        ];
     }
     
     private function executePatternInsert($stmt, $symbol, $data)
     {
         try {
-            return $stmt->execute([
-                $symbol,
-                $data['date'],
-                $data['pattern_name'],
-                $data['strength'] ?? 50,
-                $data['signal'] ?? 'NEUTRAL',
-                $data['timeframe'] ?? 'daily'
-            ]);
+            return $this->executeTimed('insert_pattern', $stmt, $this->patternRowValues($symbol, $data));
         } catch (Exception $e) {
             $this->logger->error("Failed to insert pattern data for {$symbol}: " . $e->getMessage());
             return false;
@@ -302,10 +451,8 @@ class DynamicStockDataAccess implements IStockDataAccess
         
         $sql .= " ORDER BY date DESC";
         
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute($params);
-        
-        return $stmt->fetchAll(PDO::FETCH_ASSOC);
+        $stmt = $this->prepareCached($sql);
+        return $this->fetchAllTimed('select_patterns', $stmt, $params);
     }
     
     /**
@@ -322,10 +469,12 @@ class DynamicStockDataAccess implements IStockDataAccess
         $tableName = $this->tableManager->getTableName($symbol, 'historical_prices');
         
         $sql = "SELECT * FROM {$tableName} WHERE symbol = ? ORDER BY date DESC LIMIT 1";
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$symbol]);
+        $stmt = $this->prepareCached($sql);
+        $this->executeTimed('select_latest_price', $stmt, [$symbol]);
         
-        return $stmt->fetch(PDO::FETCH_ASSOC);
+        $row = $stmt->fetch(PDO::FETCH_ASSOC);
+        $stmt->closeCursor();
+        return $row;
     }
     
     /**
@@ -347,10 +496,8 @@ class DynamicStockDataAccess implements IStockDataAccess
                 ORDER BY date DESC 
                 LIMIT ?";
         
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$symbol, $days]);
-        
-        $data = $stmt->fetchAll(PDO::FETCH_ASSOC);
+        $stmt = $this->prepareCached($sql);
+        $data = $this->fetchAllTimed('select_prices_for_analysis', $stmt, [$symbol, $days]);
         
         // Return in chronological order for calculations
         return array_reverse($data);
@@ -361,34 +508,103 @@ class DynamicStockDataAccess implements IStockDataAccess
      */
     public function getMultiSymbolData($symbols, $dataType = 'historical_prices', $startDate = null, $endDate = null)
     {
+        if (!isset($this->multiSymbolQueries[$dataType])) {
+            $this->logger->warning("Unknown data type requested: {$dataType}");
+            return [];
+        }
+        
+        $empty = $dataType === 'latest_prices' ? null : [];
         $results = [];
         
         foreach ($symbols as $symbol) {
-            $symbol = strtoupper(trim($symbol));
+            $results[strtoupper(trim($symbol))] = $empty;
+        }
+        
+        foreach ($this->streamMultiSymbolData(array_keys($results), $dataType, $startDate, $endDate) as $symbol => $data) {
+            $results[$symbol] = $data;
+        }
+        
+        return $results;
+    }
+    
+    /**
+     * Stream cross-symbol data grouped by symbol.
+     *
+     * Table names for all symbols are resolved with one registry query, then
+     * the per-symbol tables are read with chunked UNION ALL queries instead
+     * of one round trip per symbol. Yields symbol => rows (or symbol => row
+     * for latest_prices); symbols without tables or rows are not yielded.
+     */
+    public function streamMultiSymbolData($symbols, $dataType = 'historical_prices', $startDate = null, $endDate = null)
+    {
+        if (!isset($this->multiSymbolQueries[$dataType])) {
+            $this->logger->warning("Unknown data type requested: {$dataType}");
+            return;
+        }
+        
+        $query = $this->multiSymbolQueries[$dataType];
+        $available = $this->tableManager->getSymbolsWithTables($symbols);
+        
+        foreach (array_chunk($available, self::MULTI_SYMBOL_CHUNK_SIZE) as $chunk) {
+            list($sql, $params) = $this->buildMultiSymbolQuery($chunk, $query, $startDate, $endDate);
+            
+            $stmt = $this->pdo->prepare($sql);
+            $this->executeTimed('select_multi_symbol', $stmt, $params);
+            
+            $currentSymbol = null;
+            $rows = [];
             
-            switch ($dataType) {
-                case 'historical_prices':
-                    $results[$symbol] = $this->getPriceData($symbol, $startDate, $endDate);
-                    break;
-                    
-                case 'technical_indicators':
-                    $results[$symbol] = $this->getTechnicalIndicators($symbol, null, $startDate, $endDate);
-                    break;
-                    
-                case 'candlestick_patterns':
-                    $results[$symbol] = $this->getCandlestickPatterns($symbol, null, $startDate, $endDate);
-                    break;
-                    
-                case 'latest_prices':
-                    $results[$symbol] = $this->getLatestPrice($symbol);
-                    break;
-                    
-                default:
-                    $this->logger->warning("Unknown data type requested: {$dataType}");
+            while ($row = $stmt->fetch(PDO::FETCH_ASSOC)) {
+                if ($row['symbol'] !== $currentSymbol) {
+                    if ($currentSymbol !== null) {
+                        yield $currentSymbol => $query['latest'] ? $rows[0] : $rows;
+                    }
+                    $currentSymbol = $row['symbol'];
+                    $rows = [];
+                }
+                $rows[] = $row;
+            }
+            
+            if ($currentSymbol !== null) {
+                yield $currentSymbol => $query['latest'] ? $rows[0] : $rows;
             }
         }
+    }
+    
+    /**
+     * Build one UNION ALL query across the per-symbol tables of a chunk
+     */
+    private function buildMultiSymbolQuery($symbols, $query, $startDate, $endDate)
+    {
+        $selects = [];
+        $params = [];
         
-        return $results;
+        foreach ($symbols as $symbol) {
+            $tableName = $this->tableManager->getTableName($symbol, $query['table_type']);
+            
+            $select = "SELECT * FROM {$tableName} WHERE symbol = ?";
+            $params[] = $symbol;
+            
+            if ($query['latest']) {
+                $select .= " ORDER BY date DESC LIMIT 1";
+            } else {
+                if ($startDate) {
+                    $select .= " AND date >= ?";
+                    $params[] = $startDate;
+                }
+                
+                if ($endDate) {
+                    $select .= " AND date <= ?";
+                    $params[] = $endDate;
+                }
+            }
+            
+            $selects[] = "({$select})";
+        }
+        
+        $sql = implode(" UNION ALL ", $selects) . " ORDER BY symbol, {$query['order']}";
+        
+        return [$sql, $params];
     }
     
     /**
@@ -420,9 +636,7 @@ class DynamicStockDataAccess implements IStockDataAccess
                 
                 $sql = "SELECT * FROM {$tableName} WHERE symbol = ? ORDER BY date";
                 $stmt = $this->pdo->prepare($sql);
-                $stmt->execute([$symbol]);
-                
-                $exportData[$tableType] = $stmt->fetchAll(PDO::FETCH_ASSOC);
+                $exportData[$tableType] = $this->fetchAllTimed('export', $stmt, [$symbol]);
                 
             } catch (Exception $e) {
                 $this->logger->error("Failed to export {$tableType} for {$symbol}: " . $e->getMessage());
@@ -498,7 +712,7 @@ class DynamicStockDataAccess implements IStockDataAccess
         $inserted = 0;
         foreach ($data as $row) {
             try {
-                if ($stmt->execute(array_values($row))) {
+                if ($this->executeTimed('import', $stmt, array_values($row))) {
                     $inserted++;
                 }
             } catch (Exception $e) {
@@ -509,6 +723,16 @@ class DynamicStockDataAccess implements IStockDataAccess
         return $inserted;
     }
     
+    /**
+     * Lazily map associative rows to positional values for BulkUpsertWriter
+     */
+    private function mapRows($rows, callable $mapper)
+    {
+        foreach ($rows as $row) {
+            yield $mapper($row);
+        }
+    }
+    
     /**
      * Clean up old data for a symbol
      */
@@ -531,7 +755,7 @@ class DynamicStockDataAccess implements IStockDataAccess
                 
                 $sql = "DELETE FROM {$tableName} WHERE symbol = ? AND date < ?";
                 $stmt = $this->pdo->prepare($sql);
-                $stmt->execute([$symbol, $cutoffDate]);
+                $this->executeTimed('cleanup', $stmt, [$symbol, $cutoffDate]);
                 
                 $cleanupResults[$tableType] = $stmt->rowCount();
                 
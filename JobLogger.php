@@ -3,21 +3,47 @@
 /**
  * Simple Job Logger
  * Provides logging functionality for job processors
+ *
+ * Entries are buffered in memory and appended in one write once
+ * buffer_size entries are pending, flush_interval seconds have passed, an
+ * ERROR is logged, flush() is called, or the process exits. Buffers
+ * inherited across pcntl_fork() are dropped in the child, so entries are
+ * never written twice.
  */
 class JobLogger
 {
     private $logFile;
     private $dateFormat = 'Y-m-d H:i:s';
+    private $bufferSize;
+    private $flushInterval;
+    private $buffer = [];
+    private $bufferPid;
+    private $lastFlush;
     
-    public function __construct($logFile)
+    /**
+     * @param string $logFile
+     * @param array $config ['buffer_size' => int (1 = write-through), 'flush_interval' => seconds]
+     */
+    public function __construct($logFile, $config = [])
     {
         $this->logFile = $logFile;
+        $this->bufferSize = max(1, (int)($config['buffer_size'] ?? 100));
+        $this->flushInterval = (float)($config['flush_interval'] ?? 1);
+        $this->bufferPid = getmypid();
+        $this->lastFlush = microtime(true);
         
         // Ensure log directory exists
         $logDir = dirname($logFile);
         if (!is_dir($logDir)) {
             mkdir($logDir, 0755, true);
         }
+        
+        register_shutdown_function([$this, 'flush']);
+    }
+    
+    public function __destruct()
+    {
+        $this->flush();
     }
     
     /**
@@ -53,15 +79,55 @@ class JobLogger
     }
     
     /**
-     * Write log entry to file
+     * Buffer a log entry, writing the buffer out when it is due
      */
     private function writeLog($level, $message)
     {
         $timestamp = date($this->dateFormat);
         $pid = getmypid();
-        $logEntry = "[{$timestamp}] [{$level}] [PID:{$pid}] {$message}" . PHP_EOL;
         
-        file_put_contents($this->logFile, $logEntry, FILE_APPEND | LOCK_EX);
+        if ($pid !== $this->bufferPid) {
+            $this->resetInheritedBuffer($pid);
+        }
+        
+        $this->buffer[] = "[{$timestamp}] [{$level}] [PID:{$pid}] {$message}" . PHP_EOL;
+        
+        if (count($this->buffer) >= $this->bufferSize
+            || $level === 'ERROR'
+            || microtime(true) - $this->lastFlush >= $this->flushInterval) {
+            $this->flush();
+        }
+    }
+    
+    /**
+     * Append all buffered entries to the log file in one write
+     */
+    public function flush()
+    {
+        $pid = getmypid();
+        if ($pid !== $this->bufferPid) {
+            $this->resetInheritedBuffer($pid);
+            return;
+        }
+        
+        $this->lastFlush = microtime(true);
+        if (empty($this->buffer)) {
+            return;
+        }
+        
+        $entries = implode('', $this->buffer);
+        $this->buffer = [];
+        file_put_contents($this->logFile, $entries, FILE_APPEND | LOCK_EX);
+    }
+    
+    /**
+     * Forked child: the buffer belongs to the parent, which will write it
+     */
+    private function resetInheritedBuffer($pid)
+    {
+        $this->buffer = [];
+        $this->bufferPid = $pid;
+        $this->lastFlush = microtime(true);
     }
     
     /**
@@ -69,6 +135,8 @@ class JobLogger
      */
     public function getRecentEntries($lines = 100)
     {
+        $this->flush();
+        
         if (!file_exists($this->logFile)) {
             return [];
         }
@@ -97,6 +165,8 @@ class JobLogger
      */
     public function clear()
     {
+        $this->buffer = [];
+        
         if (file_exists($this->logFile)) {
             file_put_contents($this->logFile, '');
         }
@@ -107,6 +177,8 @@ class JobLogger
      */
     public function rotate($maxSize = 10485760) // 10MB default
     {
+        $this->flush();
+        
         if (!file_exists($this->logFile)) {
             return;
         }
@@ -8,6 +8,7 @@
  */
 
 require_once __DIR__ . '/DatabaseConfig.php';
+require_once __DIR__ . '/JobLogger.php';
 
 class JobProcessor
 {
@@ -228,7 +229,7 @@ class JobProcessor
         $supportedTypes = $this->config['worker']['supported_job_types'] ?? [];
         $capabilities = $this->config['worker']['capabilities'] ?? [];
         
-        $newJobs = $this->backend->getAvailableJobs($availableSlots, $supportedTypes, $capabilities);
+        $newJobs = $this->backend->getAvailableJobs($availableSlots, $supportedTypes, $capabilities, $this->workerId);
         
         foreach ($newJobs as $job) {
             $this->startJob($job);
@@ -399,42 +400,3 @@ class JobProcessor
         $this->logger->info("Worker shutdown complete");
     }
 }
-
-/**
- * Simple logger for job processor
- */
-class JobLogger
-{
-    private $logFile;
-    private $level;
-    
-    public function __construct($logFile, $config = [])
-    {
-        $this->logFile = $logFile;
-        $this->level = $config['level'] ?? 'INFO';
-    }
-    
-    public function info($message)
-    {
-        $this->log('INFO', $message);
-    }
-    
-    public function warning($message)
-    {
-        $this->log('WARNING', $message);
-    }
-    
-    public function error($message)
-    {
-        $this->log('ERROR', $message);
-    }
-    
-    private function log($level, $message)
-    {
-        $timestamp = date('Y-m-d H:i:s');
-        $pid = getmypid();
-        $logLine = "[{$timestamp}] [{$level}] [PID:{$pid}] {$message}\n";
-        
-        file_put_contents($this->logFile, $logLine, FILE_APPEND | LOCK_EX);
-    }
-}
@@ -1,5 +1,10 @@
 <?php
 
+require_once __DIR__ . '/src/IncrementalIndicatorEngine.php';
+require_once __DIR__ . '/src/IndicatorStateStore.php';
+require_once __DIR__ . '/src/JobShardCoordinator.php';
+require_once __DIR__ . '/src/JobProgressReporter.php';
+
 /**
  * Abstract Job Processor
  * Base class for all job processors
@@ -9,15 +14,19 @@ abstract class AbstractJobProcessor
     protected $logger;
     protected $pdo;
     protected $stockDataAccess;
+    protected $jobBackend;
+    protected $progressReporter;
     
     public function __construct()
     {
-        $this->pdo = DatabaseConfig::createLegacyConnection();
+        $this->pdo = DatabaseConfig::getLegacyConnection();
         $this->logger = new JobLogger('logs/job_processor.log');
         
-        // Include dynamic data access
-        require_once __DIR__ . '/DynamicStockDataAccess.php';
-        $this->stockDataAccess = new DynamicStockDataAccess();
+        // Configured stock data backend (per-symbol or partitioned tables)
+        require_once __DIR__ . '/src/StockDataAccessFactory.php';
+        $this->stockDataAccess = StockDataAccessFactory::create();
+        
+        $this->progressReporter = new JobProgressReporter([$this, 'publishProgress']);
     }
     
     /**
@@ -25,10 +34,173 @@ abstract class AbstractJobProcessor
      */
     abstract public function execute($jobData);
     
+    /**
+     * Give the processor access to the worker's job backend, so it can
+     * enqueue child jobs and publish progress
+     *
+     * $progressOptions are JobProgressReporter throttle settings
+     * (min_interval_ms, min_delta).
+     */
+    public function setJobBackend($backend, array $progressOptions = [])
+    {
+        $this->jobBackend = $backend;
+        $this->progressReporter = new JobProgressReporter([$this, 'publishProgress'], $progressOptions);
+    }
+    
+    /**
+     * ta_analysis_jobs row a job reports progress and status to
+     *
+     * Database backend jobs are rows themselves. Jobs queued on Redis,
+     * RabbitMQ or MQTT have a backend id (job_...) and carry the id of their
+     * ta_analysis_jobs row as tracking_id.
+     */
+    public static function progressJobId(array $jobData)
+    {
+        return $jobData['tracking_id'] ?? $jobData['id'];
+    }
+    
+    /**
+     * Enqueue a job through the configured backend
+     *
+     * Redis/RabbitMQ/MQTT backends expose addJob(); the job also gets a
+     * ta_analysis_jobs row (its tracking_id) so the monitor can follow it.
+     * DatabaseJobBackend exposes createJob(). Returns the new job id, or null
+     * without a backend.
+     */
+    protected function enqueueJob($jobType, array $parameters, $priority = 'normal')
+    {
+        if (!$this->jobBackend) {
+            return null;
+        }
+        
+        if (method_exists($this->jobBackend, 'addJob')) {
+            return $this->jobBackend->addJob([
+                'job_type' => $jobType,
+                'priority' => $priority,
+                'parameters' => json_encode($parameters),
+                'tracking_id' => self::createTrackingRow($this->pdo, $jobType, $priority, $parameters)
+            ]);
+        }
+        
+        return $this->jobBackend->createJob([
+            'job_type' => $jobType,
+            'priority' => self::numericPriority($priority),
+            'parameters' => $parameters
+        ]);
+    }
+    
+    /**
+     * ta_analysis_jobs priority (1-10) for a high/normal/low queue priority
+     */
+    public static function numericPriority($priority)
+    {
+        return $priority === 'high' ? 8 : ($priority === 'low' ? 2 : 5);
+    }
+    
+    /**
+     * Insert the pending ta_analysis_jobs row of a job queued on a broker
+     * backend and return its id
+     */
+    public static function createTrackingRow(PDO $pdo, $jobType, $priority, array $parameters)
+    {
+        $stmt = $pdo->prepare("INSERT INTO ta_analysis_jobs (job_type, status, priority, parameters, created_at)
+                               VALUES (?, 'pending', ?, ?, CURRENT_TIMESTAMP)");
+        $stmt->execute([$jobType, self::numericPriority($priority), json_encode($parameters)]);
+        return (int)$pdo->lastInsertId();
+    }
+    
+    /**
+     * Mirror a broker job's status onto its ta_analysis_jobs row
+     *
+     * Rows of database backend jobs are updated by the backend itself, so
+     * only jobs carrying a tracking_id are written.
+     */
+    public function trackStatus(array $jobData, $status, $workerId = null)
+    {
+        if (!isset($jobData['tracking_id'])) {
+            return;
+        }
+        
+        $sql = "UPDATE ta_analysis_jobs SET status = :status";
+        $params = ['id' => $jobData['tracking_id'], 'status' => $status];
+        
+        if ($status === 'running') {
+            $sql .= ", worker_id = :worker_id, started_at = CURRENT_TIMESTAMP";
+            $params['worker_id'] = $workerId;
+        } elseif ($status === 'completed') {
+            $sql .= ", completed_at = CURRENT_TIMESTAMP, progress = 100";
+        }
+        
+        // Bookkeeping only: a failed write must not fail the job itself
+        try {
+            $stmt = $this->pdo->prepare($sql . " WHERE id = :id");
+            $stmt->execute($params);
+        } catch (Exception $e) {
+            $this->logger->warning("Status update for job {$jobData['tracking_id']} failed: " . $e->getMessage());
+        }
+    }
+    
     /**
      * Update job progress
+     *
+     * $jobId is progressJobId() of the job. Updates are coalesced and
+     * throttled; call flushProgress() once the job ends so the last state is
+     * not left pending.
      */
     protected function updateProgress($jobId, $progress, $message = null)
+    {
+        $this->progressReporter->report($jobId, $progress, $message);
+    }
+    
+    /**
+     * Publish any progress still held back by the throttle
+     *
+     * Pass the job once it has ended: its final state is then in
+     * ta_analysis_jobs, and the live copy on the backend channel (retained
+     * MQTT message, Redis fields) is cleared so the broker doesn't keep one
+     * per job ever run.
+     */
+    public function flushProgress($jobData = null)
+    {
+        $this->progressReporter->flush();
+        
+        if ($jobData && $this->jobBackend && method_exists($this->jobBackend, 'clearProgress')) {
+            $jobId = self::progressJobId($jobData);
+            try {
+                $this->jobBackend->clearProgress($jobId);
+            } catch (Exception $e) {
+                $this->logger->warning("Progress clear for job {$jobId} failed: " . $e->getMessage());
+            }
+        }
+    }
+    
+    /**
+     * JobProgressReporter publisher
+     *
+     * Live updates go through the backend's own channel (Redis hash, MQTT
+     * topic) when it has one. The final update of a job, and every update on
+     * backends without a channel, is persisted to ta_analysis_jobs.
+     */
+    public function publishProgress($jobId, $progress, $message, $final)
+    {
+        if ($this->jobBackend && method_exists($this->jobBackend, 'publishProgress')) {
+            try {
+                $this->jobBackend->publishProgress($jobId, $progress, $message);
+                if (!$final) {
+                    return;
+                }
+            } catch (Exception $e) {
+                $this->logger->warning("Progress publish for job {$jobId} failed: " . $e->getMessage());
+            }
+        }
+        
+        $this->writeProgressToDatabase($jobId, $progress, $message);
+    }
+    
+    /**
+     * Write job progress to ta_analysis_jobs
+     */
+    protected function writeProgressToDatabase($jobId, $progress, $message = null)
     {
         $sql = "UPDATE ta_analysis_jobs SET progress = :progress";
         $params = ['job_id' => $jobId, 'progress' => $progress];
@@ -51,20 +223,41 @@ abstract class AbstractJobProcessor
  */
 class TechnicalAnalysisJobProcessor extends AbstractJobProcessor
 {
+    /**
+     * Default number of stocks per child job when fanning out
+     */
+    const DEFAULT_SHARD_SIZE = 50;
+    
+    protected $indicatorStateStore;
+    protected $shardCoordinator;
+    
+    public function __construct()
+    {
+        parent::__construct();
+        $this->indicatorStateStore = new IndicatorStateStore($this->pdo);
+        $this->shardCoordinator = new JobShardCoordinator($this->pdo);
+    }
+    
     public function execute($jobData)
     {
-        $jobId = $jobData['id'];
+        $jobId = self::progressJobId($jobData);
         $parameters = json_decode($jobData['parameters'] ?? '{}', true);
         $stockId = $parameters['stockId'] ?? null;
+        $fullRecalc = !empty($parameters['full_recalc']);
         
         $this->logger->info("Starting technical analysis job {$jobId} for stock {$stockId}");
         
         try {
             // Get stock data
-            if ($stockId) {
-                $result = $this->analyzeStock($stockId, $jobId);
+            if (isset($parameters['shard_id'])) {
+                // Child of a fanned-out run: progress and result go to the shard
+                return $this->runShard($parameters['shard_id'], $fullRecalc);
+            } elseif ($stockId) {
+                $result = $this->analyzeStock($stockId, $jobId, $fullRecalc);
+            } elseif ($this->jobBackend && ($parameters['parallel'] ?? true)) {
+                $result = $this->fanOutAllStocks($jobId, $parameters, $fullRecalc);
             } else {
-                $result = $this->analyzeAllStocks($jobId);
+                $result = $this->analyzeAllStocks($jobId, $fullRecalc);
             }
             
             $this->updateProgress($jobId, 100, 'Analysis completed');
@@ -84,8 +277,13 @@ class TechnicalAnalysisJobProcessor extends AbstractJobProcessor
     
     /**
      * Analyze a single stock
+     *
+     * Resumes the incremental indicator engine from its persisted state, so
+     * only bars newer than the last run are computed and written. Without
+     * state (first run, config change or full_recalc) the engine is primed
+     * from the last 200 bars.
      */
-    private function analyzeStock($stockId, $jobId)
+    private function analyzeStock($stockId, $jobId, $fullRecalc = false)
     {
         require_once __DIR__ . '/Stock-Analysis-Extension/Legacy/vendor/autoload.php';
 
@@ -97,169 +295,228 @@ class TechnicalAnalysisJobProcessor extends AbstractJobProcessor
         }
 
         $symbol = $stock['stocksymbol'];
-        $this->updateProgress($jobId, 10, "Analyzing {$symbol}");
-
-        // Get historical price data using dynamic table system
-        $priceData = $this->stockDataAccess->getPriceDataForAnalysis($symbol, 200);
-
-        if (empty($priceData)) {
-            throw new Exception("No price data available for {$symbol}");
-        }
+        $this->reportStockProgress($jobId, 10, "Analyzing {$symbol}");
 
-        $indicatorsCalculated = 0;
-        $patternsDetected = 0;
+        $savedState = $fullRecalc ? null : $this->indicatorStateStore->load($symbol);
+        $engine = new IncrementalIndicatorEngine($savedState ?? []);
+        $lastDate = $engine->getLastDate();
 
-        // Calculate RSI
-        $this->updateProgress($jobId, 20, "Calculating RSI for {$symbol}");
-        $rsiValues = $this->calculateRSI($priceData);
-        $indicatorsCalculated += $this->saveIndicators($symbol, 'RSI', $rsiValues);
+        if ($lastDate === null) {
+            // Get historical price data using dynamic table system
+            $priceData = $this->stockDataAccess->getPriceDataForAnalysis($symbol, 200);
 
-        // Calculate MACD
-        $this->updateProgress($jobId, 40, "Calculating MACD for {$symbol}");
-        $macdValues = $this->calculateMACD($priceData);
-        $indicatorsCalculated += $this->saveIndicators($symbol, 'MACD', $macdValues);
+            if (empty($priceData)) {
+                throw new Exception("No price data available for {$symbol}");
+            }
+        } else {
+            // Resume: only bars newer than the last processed one
+            $priceData = array_values(array_filter(
+                array_reverse($this->stockDataAccess->getPriceData($symbol, $lastDate)),
+                function ($bar) use ($lastDate) {
+                    return strcmp($bar['date'], $lastDate) > 0;
+                }
+            ));
+        }
 
-        // Calculate Moving Averages
-        $this->updateProgress($jobId, 60, "Calculating Moving Averages for {$symbol}");
-        $smaValues = $this->calculateSMA($priceData, 20);
-        $indicatorsCalculated += $this->saveIndicators($symbol, 'SMA_20', $smaValues);
+        // Calculate RSI, MACD, moving averages, Bollinger Bands and ATR in one pass
+        $this->reportStockProgress($jobId, 30, "Calculating indicators for {$symbol}");
+        $indicatorValues = $engine->appendAll($priceData);
+        $indicatorsCalculated = $this->saveIndicators($symbol, $engine, $indicatorValues);
 
         // Detect Candlestick Patterns
-        $this->updateProgress($jobId, 80, "Detecting Candlestick Patterns for {$symbol}");
+        $this->reportStockProgress($jobId, 70, "Detecting Candlestick Patterns for {$symbol}");
         $patterns = $this->detectCandlestickPatterns($priceData);
         $patternsDetected = $this->savePatterns($symbol, $patterns);
 
+        $this->indicatorStateStore->save($symbol, $engine->getState());
+
         return [
             'processed_stocks' => 1,
             'indicators_calculated' => $indicatorsCalculated,
             'patterns_detected' => $patternsDetected
         ];
-    }    /**
-     * Analyze all active stocks
+    }
+    
+    /**
+     * Per-stock progress; skipped when the stock is part of a larger run
      */
-    private function analyzeAllStocks($jobId)
+    private function reportStockProgress($jobId, $progress, $message)
     {
-        $stockModel = new \Ksfraser\StockInfo\StockInfo($this->pdo);
-        $stocks = $stockModel->getActiveStocks();
-        
-        $totalStocks = count($stocks);
-        $processedStocks = 0;
-        $totalIndicators = 0;
-        $totalPatterns = 0;
-        
-        foreach ($stocks as $index => $stock) {
-            try {
-                $result = $this->analyzeStock($stock->idstockinfo, $jobId);
-                $totalIndicators += $result['indicators_calculated'];
-                $totalPatterns += $result['patterns_detected'];
-                $processedStocks++;
-                
-                $progress = (($index + 1) / $totalStocks) * 90; // Leave 10% for completion
-                $this->updateProgress($jobId, $progress, "Processed {$processedStocks}/{$totalStocks} stocks");
-                
-            } catch (Exception $e) {
-                $this->logger->warning("Failed to analyze stock {$stock->stocksymbol}: " . $e->getMessage());
-            }
+        if ($jobId !== null) {
+            $this->updateProgress($jobId, $progress, $message);
         }
-        
-        return [
-            'processed_stocks' => $processedStocks,
-            'indicators_calculated' => $totalIndicators,
-            'patterns_detected' => $totalPatterns
-        ];
     }
     
     /**
-     * Get historical price data for a stock
-     * This is a placeholder - you would implement actual data fetching
+     * Analyze all active stocks across the worker fleet (map/reduce)
+     *
+     * Splits the universe into shards, enqueues one child technical_analysis
+     * job per shard, then waits for the shards to finish while rolling their
+     * progress up into this job. While waiting, the parent runs any shard no
+     * worker has picked up yet, so a run completes even if every worker slot
+     * is busy with parents.
      */
-    /**
-     * Calculate RSI (Relative Strength Index)
-     * Simplified implementation - you would use TA-Lib for production
-     */
-    private function calculateRSI($priceData, $period = 14)
+    private function fanOutAllStocks($jobId, $parameters, $fullRecalc = false)
     {
-        $rsiValues = [];
+        require_once __DIR__ . '/Stock-Analysis-Extension/Legacy/vendor/autoload.php';
         
-        if (count($priceData) < $period + 1) {
-            return $rsiValues;
+        $stockModel = new \Ksfraser\StockInfo\StockInfo($this->pdo);
+        $stockIds = [];
+        foreach ($stockModel->getActiveStocks() as $stock) {
+            $stockIds[] = $stock->idstockinfo;
         }
         
-        // Calculate price changes
-        $gains = [];
-        $losses = [];
+        $shardSize = (int)($parameters['shard_size'] ?? self::DEFAULT_SHARD_SIZE);
+        $shardTimeout = (int)($parameters['shard_timeout'] ?? 600);
+        $pollInterval = (int)($parameters['poll_interval'] ?? 2);
+        $workerId = gethostname() . '_' . getmypid();
         
-        for ($i = 1; $i < count($priceData); $i++) {
-            $change = $priceData[$i]['close'] - $priceData[$i-1]['close'];
-            $gains[] = $change > 0 ? $change : 0;
-            $losses[] = $change < 0 ? abs($change) : 0;
+        if (count($stockIds) <= $shardSize) {
+            return $this->analyzeAllStocks($jobId, $fullRecalc);
         }
         
-        // Calculate initial averages
-        $avgGain = array_sum(array_slice($gains, 0, $period)) / $period;
-        $avgLoss = array_sum(array_slice($losses, 0, $period)) / $period;
+        $shardIds = $this->shardCoordinator->createShards($jobId, $stockIds, $shardSize);
+        foreach ($shardIds as $shardId) {
+            $childJobId = $this->enqueueJob('technical_analysis', [
+                'shard_id' => $shardId,
+                'parent_job_id' => $jobId,
+                'full_recalc' => $fullRecalc
+            ]);
+            if ($childJobId !== null) {
+                $this->shardCoordinator->setChildJobId($shardId, $childJobId);
+            }
+        }
         
-        for ($i = $period; $i < count($priceData); $i++) {
-            if ($avgLoss != 0) {
-                $rs = $avgGain / $avgLoss;
-                $rsi = 100 - (100 / (1 + $rs));
-            } else {
-                $rsi = 100;
+        $this->logger->info("Job {$jobId} fanned out " . count($stockIds) . " stocks into " . count($shardIds) . " shards");
+        
+        $lastReported = -1;
+        while (true) {
+            $summary = $this->shardCoordinator->getSummary($jobId);
+            
+            // Roll up child progress, at most once per whole percent
+            $progress = floor($summary['progress'] * 0.9); // Leave 10% for completion
+            if ($progress > $lastReported) {
+                $this->updateProgress($jobId, $progress, "Shards {$summary['completed']}/{$summary['total']} completed");
+                $lastReported = $progress;
             }
             
-            $rsiValues[] = [
-                'date' => $priceData[$i]['date'],
-                'value' => round($rsi, 2)
-            ];
+            if ($summary['pending'] + $summary['running'] === 0) {
+                break;
+            }
+            
+            $this->shardCoordinator->releaseStaleShards($jobId, $shardTimeout);
             
-            // Update averages for next iteration
-            if ($i < count($gains)) {
-                $avgGain = (($avgGain * ($period - 1)) + $gains[$i]) / $period;
-                $avgLoss = (($avgLoss * ($period - 1)) + $losses[$i]) / $period;
+            $shard = $this->shardCoordinator->claimNextShard($jobId, $workerId);
+            if ($shard) {
+                $this->executeShard($shard, $fullRecalc);
+            } else {
+                sleep($pollInterval);
             }
         }
         
-        return $rsiValues;
+        if ($summary['failed'] > 0) {
+            $this->logger->warning("Job {$jobId}: {$summary['failed']} shards failed: " . implode('; ', $summary['errors']));
+        }
+        
+        return [
+            'processed_stocks' => $summary['result']['processed_stocks'] ?? 0,
+            'indicators_calculated' => $summary['result']['indicators_calculated'] ?? 0,
+            'patterns_detected' => $summary['result']['patterns_detected'] ?? 0
+        ];
     }
     
     /**
-     * Calculate MACD (Moving Average Convergence Divergence)
+     * Run a shard delivered as a child job
      */
-    private function calculateMACD($priceData, $fastPeriod = 12, $slowPeriod = 26, $signalPeriod = 9)
+    private function runShard($shardId, $fullRecalc = false)
     {
-        // Simplified MACD calculation
-        $macdValues = [];
+        $shard = $this->shardCoordinator->claimShard($shardId, gethostname() . '_' . getmypid());
         
-        if (count($priceData) < $slowPeriod) {
-            return $macdValues;
+        if (!$shard) {
+            // Already taken by the parent or another worker
+            return ['success' => true, 'skipped' => true, 'shard_id' => $shardId];
         }
         
-        // This is a simplified implementation
-        // In production, use TA-Lib: trader_macd()
-        
-        return $macdValues;
+        return array_merge(['success' => true, 'shard_id' => $shardId], $this->executeShard($shard, $fullRecalc));
     }
     
     /**
-     * Calculate Simple Moving Average
+     * Analyze the stocks of a claimed shard and record the result on it
      */
-    private function calculateSMA($priceData, $period)
+    private function executeShard($shard, $fullRecalc = false)
     {
-        $smaValues = [];
+        $totals = [
+            'processed_stocks' => 0,
+            'failed_stocks' => 0,
+            'indicators_calculated' => 0,
+            'patterns_detected' => 0
+        ];
+        $stockIds = $shard['items'];
+        $count = count($stockIds);
         
-        for ($i = $period - 1; $i < count($priceData); $i++) {
-            $sum = 0;
-            for ($j = 0; $j < $period; $j++) {
-                $sum += $priceData[$i - $j]['close'];
+        try {
+            foreach ($stockIds as $index => $stockId) {
+                try {
+                    $result = $this->analyzeStock($stockId, null, $fullRecalc);
+                    $totals['processed_stocks']++;
+                    $totals['indicators_calculated'] += $result['indicators_calculated'];
+                    $totals['patterns_detected'] += $result['patterns_detected'];
+                } catch (Exception $e) {
+                    $totals['failed_stocks']++;
+                    $this->logger->warning("Shard {$shard['id']}: failed to analyze stock {$stockId}: " . $e->getMessage());
+                }
+                
+                if (!$this->shardCoordinator->updateShardProgress($shard['id'], $shard['claimed_by'], (($index + 1) / $count) * 100)) {
+                    // Released as stale and claimed by another worker, which redoes it
+                    $this->logger->warning("Shard {$shard['id']}: claim lost after " . ($index + 1) . "/{$count} stocks, abandoning");
+                    return array_merge($totals, ['lost_claim' => true]);
+                }
             }
             
-            $smaValues[] = [
-                'date' => $priceData[$i]['date'],
-                'value' => round($sum / $period, 2)
-            ];
+            if (!$this->shardCoordinator->completeShard($shard['id'], $shard['claimed_by'], $totals)) {
+                $this->logger->warning("Shard {$shard['id']}: claim lost before completion, result discarded");
+            }
+        } catch (Exception $e) {
+            $this->shardCoordinator->failShard($shard['id'], $shard['claimed_by'], $e->getMessage());
+            throw $e;
         }
         
-        return $smaValues;
+        return $totals;
+    }
+    
+    /**
+     * Analyze all active stocks
+     */
+    private function analyzeAllStocks($jobId, $fullRecalc = false)
+    {
+        $stockModel = new \Ksfraser\StockInfo\StockInfo($this->pdo);
+        $stocks = $stockModel->getActiveStocks();
+        
+        $totalStocks = count($stocks);
+        $processedStocks = 0;
+        $totalIndicators = 0;
+        $totalPatterns = 0;
+        
+        foreach ($stocks as $index => $stock) {
+            try {
+                $result = $this->analyzeStock($stock->idstockinfo, null, $fullRecalc);
+                $totalIndicators += $result['indicators_calculated'];
+                $totalPatterns += $result['patterns_detected'];
+                $processedStocks++;
+                
+                $progress = (($index + 1) / $totalStocks) * 90; // Leave 10% for completion
+                $this->updateProgress($jobId, $progress, "Processed {$processedStocks}/{$totalStocks} stocks");
+                
+            } catch (Exception $e) {
+                $this->logger->warning("Failed to analyze stock {$stock->stocksymbol}: " . $e->getMessage());
+            }
+        }
+        
+        return [
+            'processed_stocks' => $processedStocks,
+            'indicators_calculated' => $totalIndicators,
+            'patterns_detected' => $totalPatterns
+        ];
     }
     
     /**
@@ -291,29 +548,32 @@ class TechnicalAnalysisJobProcessor extends AbstractJobProcessor
         return $patterns;
     }
     
-    /**
-     * Save calculated indicators to database
-     */
     /**
      * Save calculated indicators to database using dynamic table system
      */
-    private function saveIndicators($symbol, $indicatorType, $values)
+    private function saveIndicators($symbol, IncrementalIndicatorEngine $engine, $indicatorValues)
     {
-        $saved = 0;
-        
-        foreach ($values as $date => $value) {
-            if ($value !== null) {
-                $this->stockDataAccess->insertTechnicalIndicator($symbol, [
-                    'indicator_type' => $indicatorType,
-                    'date' => $date,
-                    'value' => $value,
-                    'created_at' => date('Y-m-d H:i:s')
-                ]);
-                $saved++;
+        $rows = [];
+        $names = $engine->getIndicatorNames();
+        
+        foreach ($indicatorValues as $bar) {
+            foreach ($names as $name) {
+                if ($bar[$name] !== null) {
+                    $rows[] = [
+                        'date' => $bar['date'],
+                        'indicator_name' => $name,
+                        'value' => round($bar[$name], 6),
+                        'period' => $engine->getIndicatorPeriod($name)
+                    ];
+                }
             }
         }
         
-        return $saved;
+        if (empty($rows)) {
+            return 0;
+        }
+        
+        return $this->stockDataAccess->bulkInsertTechnicalIndicators($symbol, $rows)['rows'];
     }
 
     /**
@@ -321,19 +581,22 @@ class TechnicalAnalysisJobProcessor extends AbstractJobProcessor
      */
     private function savePatterns($symbol, $patterns)
     {
-        $saved = 0;
-        
-        foreach ($patterns as $date => $pattern) {
-            $this->stockDataAccess->insertCandlestickPattern($symbol, [
-                'pattern_type' => $pattern['type'],
-                'date' => $date,
-                'confidence' => $pattern['confidence'],
-                'created_at' => date('Y-m-d H:i:s')
-            ]);
-            $saved++;
+        $rows = [];
+        
+        foreach ($patterns as $pattern) {
+            $rows[] = [
+                'date' => $pattern['date'],
+                'pattern_name' => $pattern['pattern'],
+                'strength' => $pattern['strength'] ?? 50,
+                'signal' => $pattern['signal'] ?? 'NEUTRAL'
+            ];
+        }
+        
+        if (empty($rows)) {
+            return 0;
         }
         
-        return $saved;
+        return $this->stockDataAccess->bulkInsertCandlestickPatterns($symbol, $rows)['rows'];
     }
 }
 
@@ -345,7 +608,7 @@ class PriceUpdateJobProcessor extends AbstractJobProcessor
 {
     public function execute($jobData)
     {
-        $jobId = $jobData['id'];
+        $jobId = self::progressJobId($jobData);
         $parameters = json_decode($jobData['parameters'] ?? '{}', true);
         
         $this->logger->info("Starting price update job {$jobId}");
@@ -370,7 +633,7 @@ class DataImportJobProcessor extends AbstractJobProcessor
 {
     public function execute($jobData)
     {
-        $jobId = $jobData['id'];
+        $jobId = self::progressJobId($jobData);
         $parameters = json_decode($jobData['parameters'] ?? '{}', true);
         
         $this->logger->info("Starting data import job {$jobId}");
@@ -395,7 +658,7 @@ class PortfolioAnalysisJobProcessor extends AbstractJobProcessor
 {
     public function execute($jobData)
     {
-        $jobId = $jobData['id'];
+        $jobId = self::progressJobId($jobData);
         $parameters = json_decode($jobData['parameters'] ?? '{}', true);
         
         $this->logger->info("Starting portfolio analysis job {$jobId}");
@@ -12,6 +12,9 @@ class MQTTJobBackend
     private $isConnected = false;
     private $subscribedTopics = [];
     private $messageQueue = [];
+    private $jobSubscriptions = [];
+    private $inheritedClients = [];
+    private $liveProgress = [];
     
     public function __construct($config, $logger)
     {
@@ -90,6 +93,28 @@ class MQTTJobBackend
         }
     }
     
+    /**
+     * Connect with a new client (and client id), e.g. in a forked child that
+     * must not share the parent's socket
+     *
+     * The broker drops an existing session when a second connection uses
+     * the same client id, so the child cannot reuse the parent's. The
+     * inherited client is kept, not disconnected, so the parent's
+     * connection and subscriptions stay intact.
+     */
+    public function reconnect()
+    {
+        $this->inheritedClients[] = $this->client;
+        $this->isConnected = false;
+        $this->subscribedTopics = [];
+        $this->jobSubscriptions = [];
+        $this->messageQueue = [];
+        $this->liveProgress = [];
+        
+        $this->initializeClient();
+        $this->connect();
+    }
+    
     /**
      * MQTT connection callback
      */
@@ -237,6 +262,99 @@ class MQTTJobBackend
         return $job;
     }
     
+    /**
+     * Wait for the next job delivered by subscription
+     *
+     * Subscribes once to the worker's assignment topic and, through a shared
+     * subscription ($share/<group>/...), to the queue topics of its job types,
+     * so the broker hands each queued job to one worker. onMessage() buffers
+     * deliveries, and this method runs the network loop until one arrives or
+     * $timeout seconds pass. Direct assignments come first, then queued jobs
+     * by priority.
+     */
+    public function waitForJob($workerId, $jobTypes = [], $timeout = 5)
+    {
+        $this->subscribeToJobs($workerId, $jobTypes);
+        
+        $deadline = microtime(true) + max(1, (int)$timeout);
+        
+        while (true) {
+            $job = $this->takeDeliveredJob($workerId);
+            if ($job) {
+                $job['status'] = 'running';
+                $job['worker_id'] = $workerId;
+                $job['started_at'] = time();
+                return $job;
+            }
+            
+            $remaining = (int)(($deadline - microtime(true)) * 1000);
+            if ($remaining <= 0 || !$this->isConnected) {
+                return null;
+            }
+            
+            $this->client->loop($remaining);
+        }
+    }
+    
+    /**
+     * Subscribe to the assignment and shared queue topics for a worker
+     */
+    private function subscribeToJobs($workerId, $jobTypes)
+    {
+        $group = $this->config['mqtt']['shared_group'] ?? 'workers';
+        $topics = ["jobs/assign/{$workerId}" => 1];
+        
+        foreach (['high', 'normal', 'low'] as $priority) {
+            foreach ($jobTypes as $jobType) {
+                $topics["\$share/{$group}/jobs/queue/{$priority}/{$jobType}"] = ($priority === 'high') ? 2 : 1;
+            }
+        }
+        
+        foreach ($topics as $topic => $qos) {
+            if (isset($this->jobSubscriptions[$topic])) {
+                continue;
+            }
+            
+            $this->client->subscribe($topic, $qos);
+            $this->jobSubscriptions[$topic] = true;
+            $this->logger->info("Subscribed to MQTT topic: {$topic}");
+        }
+    }
+    
+    /**
+     * Take the best buffered job delivery off the message queue
+     */
+    private function takeDeliveredJob($workerId)
+    {
+        $job = $this->checkForJobAssignment($workerId);
+        if ($job) {
+            return $job;
+        }
+        
+        foreach (['high', 'normal', 'low'] as $priority) {
+            $prefix = "jobs/queue/{$priority}/";
+            
+            foreach ($this->messageQueue as $index => $message) {
+                if (strpos($message['topic'], $prefix) !== 0) {
+                    continue;
+                }
+                
+                unset($this->messageQueue[$index]);
+                $this->messageQueue = array_values($this->messageQueue);
+                
+                $jobData = json_decode($message['payload'], true);
+                if ($jobData && isset($jobData['id'])) {
+                    return $jobData;
+                }
+                
+                // Malformed payload: it has been dropped, keep looking
+                return $this->takeDeliveredJob($workerId);
+            }
+        }
+        
+        return null;
+    }
+    
     /**
      * Check message queue for job assignments
      */
@@ -335,6 +453,84 @@ class MQTTJobBackend
         }
     }
     
+    /**
+     * Publish live progress as a retained message on jobs/progress/{jobId}
+     *
+     * QoS 0 is enough: every update supersedes the previous one, and the
+     * retained copy is what late subscribers (monitor_api.php) read.
+     */
+    public function publishProgress($jobId, $progress, $message = null)
+    {
+        $topic = "jobs/progress/{$jobId}";
+        $payload = json_encode([
+            'job_id' => $jobId,
+            'progress' => $progress,
+            'status_message' => $message,
+            'progress_at' => time()
+        ]);
+
+        $this->client->publish($topic, $payload, 0, true); // QoS 0, retained
+
+        return true;
+    }
+
+    /**
+     * Clear a job's retained progress message once the job has ended
+     *
+     * An empty retained payload deletes the broker's retained copy.
+     */
+    public function clearProgress($jobId)
+    {
+        $this->client->publish("jobs/progress/{$jobId}", '', 0, true);
+        unset($this->liveProgress[(string)$jobId]);
+
+        return true;
+    }
+
+    /**
+     * Read retained progress messages for the given jobs
+     *
+     * Subscribes to jobs/progress/+ and loops briefly so the broker can
+     * deliver the retained messages. Progress messages are taken off the
+     * message queue into the latest state per job; an empty payload (the
+     * job ended, see clearProgress()) drops the job.
+     */
+    public function getProgress(array $jobIds, $waitMs = 250)
+    {
+        if (empty($jobIds)) {
+            return [];
+        }
+
+        if (!in_array('jobs/progress/+', $this->subscribedTopics)) {
+            $this->client->subscribe('jobs/progress/+', 0);
+            $this->subscribedTopics[] = 'jobs/progress/+';
+        }
+        $this->client->loop($waitMs);
+
+        foreach ($this->messageQueue as $index => $message) {
+            if (strpos($message['topic'], 'jobs/progress/') !== 0) {
+                continue;
+            }
+            unset($this->messageQueue[$index]);
+
+            $jobId = substr($message['topic'], strlen('jobs/progress/'));
+            $data = json_decode($message['payload'], true);
+            if (!$data) {
+                unset($this->liveProgress[$jobId]);
+                continue;
+            }
+
+            $this->liveProgress[$jobId] = [
+                'progress' => (float)$data['progress'],
+                'status_message' => $data['status_message'] ?? null,
+                'progress_at' => (int)($data['progress_at'] ?? 0)
+            ];
+        }
+        $this->messageQueue = array_values($this->messageQueue);
+
+        return array_intersect_key($this->liveProgress, array_flip(array_map('strval', $jobIds)));
+    }
+
     /**
      * Get queue statistics
      */
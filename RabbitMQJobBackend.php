@@ -12,6 +12,10 @@ class RabbitMQJobBackend
     private $config;
     private $exchanges = [];
     private $queues = [];
+    private $consumerTags = [];
+    private $deliveries = [];
+    private $unacked = [];
+    private $inherited = [];
     
     public function __construct($config, $logger)
     {
@@ -46,6 +50,24 @@ class RabbitMQJobBackend
         $this->logger->info("Connected to RabbitMQ at {$host}:{$port}");
     }
     
+    /**
+     * Open a new connection and channel, e.g. in a forked child that must
+     * not share the parent's socket
+     *
+     * The inherited connection is kept, not closed: closing it would send
+     * Connection.Close on the parent's socket. The parent's consumers,
+     * buffered deliveries and unacked messages stay with the parent.
+     */
+    public function reconnect()
+    {
+        $this->inherited[] = [$this->connection, $this->channel];
+        $this->consumerTags = [];
+        $this->deliveries = [];
+        $this->unacked = [];
+        
+        $this->connect();
+    }
+    
     /**
      * Setup exchanges and queues
      */
@@ -167,6 +189,111 @@ class RabbitMQJobBackend
         return null;
     }
     
+    /**
+     * Wait for the next job pushed by the broker
+     *
+     * On first use this registers a basic_consume consumer (manual ack) on
+     * every priority/type queue, with basic_qos limiting unacknowledged
+     * deliveries to the prefetch count (default: the worker's
+     * max_concurrent_jobs). The broker pushes deliveries, and the highest
+     * priority buffered one is returned. A job stays unacknowledged until
+     * ackJob(), so the broker redelivers it if the worker dies.
+     */
+    public function waitForJob($workerId, $jobTypes = [], $timeout = 5)
+    {
+        if (empty($this->consumerTags)) {
+            $this->startConsuming($jobTypes);
+        }
+        
+        if (array_sum(array_map('count', $this->deliveries)) === 0) {
+            try {
+                $this->channel->wait(null, false, max(1, (int)$timeout));
+            } catch (\PhpAmqpLib\Exception\AMQPTimeoutException $e) {
+                return null;
+            }
+        }
+        
+        foreach (['high', 'normal', 'low'] as $priority) {
+            if (empty($this->deliveries[$priority])) {
+                continue;
+            }
+            
+            $msg = array_shift($this->deliveries[$priority]);
+            $jobData = json_decode($msg->getBody(), true);
+            
+            if (!$jobData || !isset($jobData['id'])) {
+                $msg->getChannel()->basic_reject($msg->getDeliveryTag(), false);
+                $this->logger->warning("Rejected malformed job message");
+                continue;
+            }
+            
+            $jobData['status'] = 'running';
+            $jobData['worker_id'] = $workerId;
+            $jobData['started_at'] = time();
+            
+            $this->unacked[$jobData['id']] = $msg;
+            
+            return $jobData;
+        }
+        
+        return null;
+    }
+    
+    /**
+     * Acknowledge a job delivered by waitForJob()
+     *
+     * Must be called from the process that owns the channel. A failed job is
+     * requeued once by the broker; a second failure drops it.
+     */
+    public function ackJob($jobId, $workerId, $success = true)
+    {
+        if (!isset($this->unacked[$jobId])) {
+            return;
+        }
+        
+        $msg = $this->unacked[$jobId];
+        unset($this->unacked[$jobId]);
+        
+        if ($success) {
+            $msg->getChannel()->basic_ack($msg->getDeliveryTag());
+        } else {
+            $msg->getChannel()->basic_reject($msg->getDeliveryTag(), !$msg->get('redelivered'));
+        }
+    }
+    
+    /**
+     * Register push consumers for the given job types
+     */
+    private function startConsuming($jobTypes)
+    {
+        $prefetch = (int)($this->config['rabbitmq']['prefetch'] ?? $this->config['worker']['max_concurrent_jobs'] ?? 1);
+        $this->channel->basic_qos(null, max(1, $prefetch), null);
+        
+        foreach (['high', 'normal', 'low'] as $priority) {
+            $this->deliveries[$priority] = [];
+            
+            foreach ($jobTypes as $jobType) {
+                $queueName = "jobs.{$priority}.{$jobType}";
+                $this->channel->queue_declare($queueName, false, true, false, false);
+                $this->channel->queue_bind($queueName, 'jobs', $queueName);
+                
+                $this->consumerTags[] = $this->channel->basic_consume(
+                    $queueName,
+                    '',
+                    false,
+                    false, // Manual ack
+                    false,
+                    false,
+                    function ($msg) use ($priority) {
+                        $this->deliveries[$priority][] = $msg;
+                    }
+                );
+            }
+        }
+        
+        $this->logger->info("Consuming " . count($this->consumerTags) . " job queues with prefetch {$prefetch}");
+    }
+    
     /**
      * Add job to queue
      */
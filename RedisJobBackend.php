@@ -9,6 +9,47 @@ class RedisJobBackend
     private $redis;
     private $logger;
     private $config;
+    private $inFlight = [];
+    
+    /**
+     * Atomically move the first job found (in KEYS[3..] order) from its
+     * queue onto the worker's processing list (KEYS[1]) and bump the
+     * worker's current_jobs (KEYS[2])
+     *
+     * Returns 0 without claiming when the worker hash has expired: HINCRBY
+     * would otherwise recreate it without a TTL, and recoverProcessingJobs()
+     * already treats the worker as dead.
+     */
+    const CLAIM_SCRIPT = <<<'LUA'
+if redis.call('EXISTS', KEYS[2]) == 0 then
+    return 0
+end
+for i = 3, #KEYS do
+    local job = redis.call('LPOP', KEYS[i])
+    if job then
+        redis.call('RPUSH', KEYS[1], job)
+        redis.call('HINCRBY', KEYS[2], 'current_jobs', 1)
+        return job
+    end
+end
+return false
+LUA;
+    
+    /**
+     * Add ARGV[1] to the current_jobs of worker hash KEYS[1], never below
+     * zero, and only while the hash exists (so it keeps its TTL)
+     */
+    const CURRENT_JOBS_SCRIPT = <<<'LUA'
+if redis.call('EXISTS', KEYS[1]) == 0 then
+    return false
+end
+local jobs = redis.call('HINCRBY', KEYS[1], 'current_jobs', ARGV[1])
+if jobs < 0 then
+    redis.call('HSET', KEYS[1], 'current_jobs', 0)
+    jobs = 0
+end
+return jobs
+LUA;
     
     public function __construct($config, $logger)
     {
@@ -133,7 +174,7 @@ class RedisJobBackend
                         $job['started_at'] = time();
                         
                         $this->redis->hSet("job:{$job['id']}", 'data', json_encode($job));
-                        $this->redis->hSet($workerKey, 'current_jobs', $currentJobs + 1);
+                        $this->adjustCurrentJobs($workerId, 1);
                         
                         return $job;
                     }
@@ -144,6 +185,152 @@ class RedisJobBackend
         return null;
     }
     
+    /**
+     * Wait for the next job, blocking until one arrives or $timeout seconds pass
+     *
+     * Unlike getNextJob() this does not poll: a single atomic script sweeps
+     * every priority/type queue, and when they are all empty the worker
+     * blocks in BLPOP across them (high priority keys first). Each claimed job
+     * is kept on the worker's processing list until ackJob(), so
+     * recoverProcessingJobs() can re-queue the jobs of a dead worker.
+     */
+    public function waitForJob($workerId, $jobTypes = [], $timeout = 5)
+    {
+        $processingKey = $this->getProcessingKey($workerId);
+        $workerKey = "workers:{$workerId}";
+        $queueKeys = $this->getQueueKeys($jobTypes);
+        
+        if (empty($queueKeys)) {
+            return null;
+        }
+        
+        $raw = $this->redis->eval(self::CLAIM_SCRIPT, array_merge([$processingKey, $workerKey], $queueKeys), count($queueKeys) + 2);
+        
+        if ($raw === 0) {
+            $this->logger->warning("Worker {$workerId} is not registered (heartbeat expired); not claiming jobs");
+            return null;
+        }
+        
+        if (!$raw) {
+            $popped = $this->redis->blPop($queueKeys, max(1, (int)$timeout));
+            if (empty($popped)) {
+                return null;
+            }
+            
+            // Only the blocking wake-up path is not a single atomic move; record it straight away
+            $raw = $popped[1];
+            $this->redis->rPush($processingKey, $raw);
+            $this->adjustCurrentJobs($workerId, 1);
+        }
+        
+        $job = json_decode($raw, true);
+        if (!$job) {
+            $this->redis->lRem($processingKey, $raw, 1);
+            $this->logger->warning("Discarded malformed job payload from queue");
+            return null;
+        }
+        
+        $job['status'] = 'running';
+        $job['worker_id'] = $workerId;
+        $job['started_at'] = time();
+        
+        $this->redis->hSet("job:{$job['id']}", 'data', json_encode($job));
+        $this->inFlight[$job['id']] = $raw;
+        
+        return $job;
+    }
+    
+    /**
+     * Remove a finished job from the worker's processing list
+     *
+     * Called by the worker process once the job's outcome has been recorded
+     * (completeJob()/failJob()) or the job's process has exited.
+     */
+    public function ackJob($jobId, $workerId, $success = true)
+    {
+        $processingKey = $this->getProcessingKey($workerId);
+        $raw = $this->inFlight[$jobId] ?? null;
+        
+        if ($raw === null) {
+            foreach ($this->redis->lRange($processingKey, 0, -1) as $item) {
+                $job = json_decode($item, true);
+                if ($job && ($job['id'] ?? null) === $jobId) {
+                    $raw = $item;
+                    break;
+                }
+            }
+        }
+        
+        if ($raw !== null) {
+            $this->redis->lRem($processingKey, $raw, 1);
+        }
+        
+        unset($this->inFlight[$jobId]);
+    }
+    
+    /**
+     * Re-queue the jobs left on the processing lists of expired workers
+     *
+     * Jobs go back to the head of their queue so they run next.
+     */
+    public function recoverProcessingJobs()
+    {
+        $recovered = 0;
+        
+        foreach ($this->redis->sMembers('active_workers') as $workerId) {
+            if ($this->redis->exists("workers:{$workerId}")) {
+                continue;
+            }
+            
+            $processingKey = $this->getProcessingKey($workerId);
+            while (($raw = $this->redis->lPop($processingKey)) !== false) {
+                $job = json_decode($raw, true);
+                if (!$job) {
+                    continue;
+                }
+                
+                $queueKey = "jobs:" . ($job['priority'] ?? 'normal') . ":" . ($job['job_type'] ?? 'default');
+                $this->redis->lPush($queueKey, $raw);
+                $recovered++;
+                
+                $this->logger->warning("Recovered job {$job['id']} from expired worker {$workerId}");
+            }
+        }
+        
+        return $recovered;
+    }
+    
+    /**
+     * Reopen the connection, e.g. in a forked child that must not share the parent's socket
+     */
+    public function reconnect()
+    {
+        $this->redis = new Redis();
+        $this->connect();
+    }
+    
+    /**
+     * Processing list holding the jobs a worker has claimed
+     */
+    private function getProcessingKey($workerId)
+    {
+        return "jobs:processing:{$workerId}";
+    }
+    
+    /**
+     * Queue keys for the given job types, highest priority first
+     */
+    private function getQueueKeys($jobTypes)
+    {
+        $keys = [];
+        foreach (['high', 'normal', 'low'] as $priority) {
+            foreach ($jobTypes as $jobType) {
+                $keys[] = "jobs:{$priority}:{$jobType}";
+            }
+        }
+        return $keys;
+    }
+    
     /**
      * Add job to queue
      */
@@ -190,9 +377,7 @@ class RedisJobBackend
             $this->redis->expire($jobKey, 86400); // Keep for 24 hours
             
             // Update worker current jobs count
-            $workerKey = "workers:{$workerId}";
-            $currentJobs = (int)$this->redis->hGet($workerKey, 'current_jobs');
-            $this->redis->hSet($workerKey, 'current_jobs', max(0, $currentJobs - 1));
+            $this->adjustCurrentJobs($workerId, -1);
             
             $this->logger->info("Completed job {$jobId}");
         }
@@ -234,12 +419,76 @@ class RedisJobBackend
             $this->redis->hSet($jobKey, 'data', json_encode($job));
             
             // Update worker current jobs count
-            $workerKey = "workers:{$workerId}";
-            $currentJobs = (int)$this->redis->hGet($workerKey, 'current_jobs');
-            $this->redis->hSet($workerKey, 'current_jobs', max(0, $currentJobs - 1));
+            $this->adjustCurrentJobs($workerId, -1);
         }
     }
+
+    /**
+     * Change a worker's current_jobs count without recreating an expired worker hash
+     */
+    private function adjustCurrentJobs($workerId, $delta)
+    {
+        return $this->redis->eval(self::CURRENT_JOBS_SCRIPT, ["workers:{$workerId}", (int)$delta], 1);
+    }
     
+    /**
+     * Publish live progress into the job hash, next to its data field
+     */
+    public function publishProgress($jobId, $progress, $message = null)
+    {
+        $fields = ['progress' => $progress, 'progress_at' => time()];
+        if ($message !== null) {
+            $fields['status_message'] = $message;
+        }
+
+        $this->redis->hMSet("job:{$jobId}", $fields);
+
+        return true;
+    }
+
+    /**
+     * Drop a job's live progress fields once the job has ended
+     */
+    public function clearProgress($jobId)
+    {
+        $this->redis->hDel("job:{$jobId}", 'progress', 'status_message', 'progress_at');
+
+        return true;
+    }
+
+    /**
+     * Read live progress for several jobs in one round trip
+     *
+     * Returns [jobId => ['progress', 'status_message', 'progress_at']] for
+     * jobs that have published progress.
+     */
+    public function getProgress(array $jobIds)
+    {
+        if (empty($jobIds)) {
+            return [];
+        }
+
+        $pipe = $this->redis->multi(Redis::PIPELINE);
+        foreach ($jobIds as $jobId) {
+            $pipe->hMGet("job:{$jobId}", ['progress', 'status_message', 'progress_at']);
+        }
+        $replies = $pipe->exec();
+
+        $progress = [];
+        foreach (array_values($jobIds) as $i => $jobId) {
+            $reply = $replies[$i] ?? false;
+            if (is_array($reply) && $reply['progress'] !== false && $reply['progress'] !== null) {
+                $progress[$jobId] = [
+                    'progress' => (float)$reply['progress'],
+                    'status_message' => $reply['status_message'] === false ? null : $reply['status_message'],
+                    'progress_at' => (int)$reply['progress_at']
+                ];
+            }
+        }
+
+        return $progress;
+    }
+
     /**
      * Get queue statistics
      */
@@ -271,6 +520,9 @@ class RedisJobBackend
      */
     public function cleanupExpiredWorkers()
     {
+        // Hand back whatever expired workers had claimed before forgetting them
+        $this->recoverProcessingJobs();
+        
         $activeWorkers = $this->redis->sMembers('active_workers');
         $cleanedUp = 0;
         
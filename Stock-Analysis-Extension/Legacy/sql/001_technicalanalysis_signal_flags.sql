@@ -0,0 +1,28 @@
+-- Precomputed screener signals for technicalanalysis.
+-- signal_flags is a bitmap (see TechnicalAnalysis::SIGNAL_* constants),
+-- maintained by TechnicalAnalysis::upsertAnalysis. The (date, signal_flags,
+-- stocksymbol) index lets any combination of signals for a day be answered
+-- from the index alone.
+ALTER TABLE technicalanalysis
+    ADD COLUMN signal_flags INT UNSIGNED NOT NULL DEFAULT 0,
+    ADD COLUMN volume_ratio DECIMAL(12,4) NULL,
+    ADD COLUMN price_to_middle_ratio DECIMAL(12,6) NULL,
+    ADD INDEX idx_ta_date_flags (date, signal_flags, stocksymbol);
+
+-- Backfill existing rows (same thresholds as the PHP defaults)
+UPDATE technicalanalysis ta
+LEFT JOIN stockprices sp ON sp.symbol = ta.stocksymbol AND sp.date = ta.date
+SET ta.volume_ratio = sp.volume / NULLIF(ta.volume_sma, 0),
+    ta.price_to_middle_ratio = ABS(sp.day_close - ta.bollinger_middle) / NULLIF(ta.bollinger_middle, 0);
+
+UPDATE technicalanalysis SET signal_flags =
+      (COALESCE(golden_cross, 0) = 1)
+    | ((COALESCE(death_cross, 0) = 1) << 1)
+    | ((COALESCE(rsi > 70, 0)) << 2)
+    | ((COALESCE(rsi < 30, 0)) << 3)
+    | ((COALESCE(macd > macd_signal AND macd_histogram > 0, 0)) << 4)
+    | ((COALESCE(price_to_middle_ratio <= 0.02, 0)) << 5)
+    | ((COALESCE(volume_ratio >= 2, 0)) << 6)
+    | ((COALESCE(price_above_sma20, 0) = 1) << 7)
+    | ((COALESCE(price_above_sma50, 0) = 1) << 8)
+    | ((COALESCE(price_above_sma200, 0) = 1) << 9);
@@ -19,11 +19,17 @@ use Ksfraser\StockInfo\DatabaseFactory;
  */
 class UnifiedAnalyzer
 {
+    /**
+     * Stale unified_scores rows recomputed per refresh batch
+     */
+    private const REFRESH_BATCH_SIZE = 200;
+
     private MotleyFoolAnalyzer $motleyFoolAnalyzer;
     private BuffettAnalyzer $buffettAnalyzer;
     private IPlaceAnalyzer $iPlaceAnalyzer;
     private EvaluationAnalyzer $evaluationAnalyzer;
     private \PDO $db;
+    private UnifiedScoreStore $scoreStore;
 
     public function __construct()
     {
@@ -32,6 +38,7 @@ class UnifiedAnalyzer
         $this->iPlaceAnalyzer = new IPlaceAnalyzer();
         $this->evaluationAnalyzer = new EvaluationAnalyzer();
         $this->db = DatabaseFactory::getInstance()->getConnection();
+        $this->scoreStore = new UnifiedScoreStore($this->db);
     }
 
     /**
@@ -295,43 +302,51 @@ class UnifiedAnalyzer
 
     /**
      * Get top stocks using unified scoring
+     * 
+     * Reads the materialized unified_scores table. At most one batch of stale
+     * rows (flagged by the methodology table triggers) is recomputed inline,
+     * so a request never pays for the whole universe; the rest is served as
+     * last materialized until refreshScores() catches up.
      */
     public function getTopUnifiedStocks(int $limit = 20): array
     {
-        // Get stocks that have data in multiple methodologies
-        $sql = "SELECT DISTINCT s.idstockinfo, s.symbol, s.name, s.sector
-                FROM stockinfo s
-                WHERE EXISTS (SELECT 1 FROM motleyfool mf WHERE mf.idstockinfo = s.idstockinfo)
-                OR EXISTS (SELECT 1 FROM tenets t WHERE t.idstockinfo = s.idstockinfo)
-                OR EXISTS (SELECT 1 FROM iplace_calc ic WHERE ic.idstockinfo = s.idstockinfo)
-                OR EXISTS (SELECT 1 FROM evalbusiness eb WHERE eb.idstockinfo = s.idstockinfo)
-                ORDER BY s.symbol
-                LIMIT 100"; // Get larger sample to score
-                
-        $stmt = $this->db->prepare($sql);
-        $stmt->execute();
-        $stocks = $stmt->fetchAll(\PDO::FETCH_ASSOC);
-        
+        $this->scoreStore->refreshStale([$this, 'calculateUnifiedScore'], self::REFRESH_BATCH_SIZE);
+
         $results = [];
-        foreach ($stocks as $stock) {
-            $unifiedScore = $this->calculateUnifiedScore($stock['idstockinfo']);
-            if ($unifiedScore['unified_score'] > 0) {
-                $results[] = [
-                    'stock_info' => $stock,
-                    'unified_score' => $unifiedScore['unified_score'],
-                    'grade' => $unifiedScore['grade'],
-                    'confidence' => $unifiedScore['confidence_level'],
-                    'methodologies_count' => count($unifiedScore['individual_scores'])
-                ];
-            }
+        foreach ($this->scoreStore->getTop($limit) as $row) {
+            $results[] = [
+                'stock_info' => [
+                    'idstockinfo' => $row['idstockinfo'],
+                    'symbol' => $row['symbol'],
+                    'name' => $row['name'],
+                    'sector' => $row['sector']
+                ],
+                'unified_score' => (float)$row['unified_score'],
+                'grade' => $row['grade'],
+                'confidence' => $row['confidence_level'],
+                'methodologies_count' => (int)$row['methodologies_count']
+            ];
         }
         
-        // Sort by unified score
-        usort($results, function($a, $b) {
-            return $b['unified_score'] <=> $a['unified_score'];
-        });
-        
-        return array_slice($results, 0, $limit);
+        return $results;
+    }
+
+    /**
+     * Recompute every stale unified score; run from a job or cron, not a page request
+     *
+     * @return int Rows refreshed
+     */
+    public function refreshScores(): int
+    {
+        return $this->scoreStore->refreshAll([$this, 'calculateUnifiedScore'], self::REFRESH_BATCH_SIZE);
+    }
+
+    /**
+     * Materialized unified score store
+     */
+    public function getScoreStore(): UnifiedScoreStore
+    {
+        return $this->scoreStore;
     }
 
     /**
@@ -0,0 +1,229 @@
+<?php
+
+namespace Ksfraser\Analysis;
+
+/**
+ * Materialized Unified Scores
+ *
+ * Keeps one pre-computed unified score row per stock in `unified_scores`, so
+ * top-N lists are a single indexed ORDER BY ... LIMIT query instead of a full
+ * per-stock methodology fan-out:
+ * - Triggers on the methodology tables mark a stock stale (and bump its version)
+ *   whenever its Motley Fool, Buffett, IPlace or evaluation data changes
+ * - refreshStale() recomputes a bounded batch of stale rows; refreshAll() works
+ *   through all of them and is meant for jobs and cron, not page requests
+ * - A refresh only clears the stale flag if the version it read is still current,
+ *   so a change that lands mid-refresh is picked up next time
+ */
+class UnifiedScoreStore
+{
+    /**
+     * Methodology tables whose changes invalidate a stock's unified score
+     */
+    public const SOURCE_TABLES = [
+        'motleyfool', 'tenets', 'iplace_calc',
+        'evalbusiness', 'evalfinancial', 'evalmanagement', 'evalmarket'
+    ];
+
+    private \PDO $db;
+    private bool $tableEnsured = false;
+
+    public function __construct(\PDO $db)
+    {
+        $this->db = $db;
+    }
+
+    /**
+     * Create the table and invalidation triggers, and queue every scored stock
+     *
+     * Safe to re-run; requires the TRIGGER privilege.
+     */
+    public function install(): void
+    {
+        $this->ensureTable();
+
+        foreach (self::SOURCE_TABLES as $table) {
+            foreach (['INSERT' => 'NEW', 'UPDATE' => 'NEW', 'DELETE' => 'OLD'] as $event => $row) {
+                $trigger = "trg_{$table}_" . strtolower($event) . "_unified";
+                $this->db->exec("DROP TRIGGER IF EXISTS {$trigger}");
+                $this->db->exec("CREATE TRIGGER {$trigger} AFTER {$event} ON {$table} FOR EACH ROW
+                    INSERT INTO unified_scores (idstockinfo, is_stale, version)
+                    VALUES ({$row}.idstockinfo, 1, 1)
+                    ON DUPLICATE KEY UPDATE is_stale = 1, version = version + 1");
+            }
+        }
+
+        $this->queueAll();
+    }
+
+    /**
+     * Mark one stock stale (for writers running without the triggers)
+     */
+    public function markStale(int $stockId): void
+    {
+        $this->ensureTable();
+
+        $sql = "INSERT INTO unified_scores (idstockinfo, is_stale, version)
+                VALUES (:stockId, 1, 1)
+                ON DUPLICATE KEY UPDATE is_stale = 1, version = version + 1";
+        $stmt = $this->db->prepare($sql);
+        $stmt->bindParam(':stockId', $stockId, \PDO::PARAM_INT);
+        $stmt->execute();
+    }
+
+    /**
+     * Queue every stock that has data in any methodology table
+     */
+    public function queueAll(): int
+    {
+        $this->ensureTable();
+
+        $exists = [];
+        foreach (self::SOURCE_TABLES as $table) {
+            $exists[] = "EXISTS (SELECT 1 FROM {$table} x WHERE x.idstockinfo = s.idstockinfo)";
+        }
+
+        $sql = "INSERT INTO unified_scores (idstockinfo, is_stale, version)
+                SELECT s.idstockinfo, 1, 1 FROM stockinfo s
+                WHERE " . implode("\n                OR ", $exists) . "
+                ON DUPLICATE KEY UPDATE is_stale = 1, version = unified_scores.version + 1";
+
+        return $this->db->exec($sql);
+    }
+
+    /**
+     * Recompute up to $limit stale rows
+     *
+     * @param callable $scorer function (int $stockId): array, e.g. UnifiedAnalyzer::calculateUnifiedScore
+     * @return int Rows refreshed
+     */
+    public function refreshStale(callable $scorer, int $limit = 200): int
+    {
+        return $this->refreshBatch($scorer, $limit, 0)['refreshed'];
+    }
+
+    /**
+     * Recompute every stale row, in batches
+     *
+     * Each pass walks the stale rows in idstockinfo order. Rows that lose the
+     * version race stay stale and are retried by the next pass, up to
+     * $maxPasses; anything still contended after that waits for the next run.
+     */
+    public function refreshAll(callable $scorer, int $batchSize = 500, int $maxPasses = 3): int
+    {
+        $total = 0;
+        for ($pass = 0; $pass < $maxPasses; $pass++) {
+            $afterId = 0;
+            $seen = 0;
+            do {
+                $batch = $this->refreshBatch($scorer, $batchSize, $afterId);
+                $total += $batch['refreshed'];
+                $seen += $batch['fetched'];
+                $afterId = $batch['last_id'];
+            } while ($batch['fetched'] > 0);
+
+            if ($seen === 0) {
+                break;
+            }
+        }
+
+        return $total;
+    }
+
+    /**
+     * Top stocks by materialized unified score
+     */
+    public function getTop(int $limit = 20): array
+    {
+        $this->ensureTable();
+
+        $sql = "SELECT u.idstockinfo, s.symbol, s.name, s.sector,
+                       u.unified_score, u.grade, u.confidence_level, u.methodologies_count
+                FROM unified_scores u
+                JOIN stockinfo s ON s.idstockinfo = u.idstockinfo
+                WHERE u.unified_score > 0
+                ORDER BY u.unified_score DESC
+                LIMIT :limit";
+
+        $stmt = $this->db->prepare($sql);
+        $stmt->bindParam(':limit', $limit, \PDO::PARAM_INT);
+        $stmt->execute();
+
+        return $stmt->fetchAll(\PDO::FETCH_ASSOC);
+    }
+
+    /**
+     * Recompute up to $limit stale rows with idstockinfo above $afterId
+     *
+     * @return array ['fetched' => int, 'refreshed' => int, 'last_id' => int]
+     */
+    private function refreshBatch(callable $scorer, int $limit, int $afterId): array
+    {
+        $this->ensureTable();
+
+        $stmt = $this->db->prepare("SELECT idstockinfo, version FROM unified_scores
+            WHERE is_stale = 1 AND idstockinfo > :afterId
+            ORDER BY idstockinfo
+            LIMIT :limit");
+        $stmt->bindValue(':afterId', $afterId, \PDO::PARAM_INT);
+        $stmt->bindValue(':limit', $limit, \PDO::PARAM_INT);
+        $stmt->execute();
+        $stale = $stmt->fetchAll(\PDO::FETCH_ASSOC);
+
+        $update = $this->db->prepare("UPDATE unified_scores
+            SET unified_score = :score, grade = :grade, confidence_level = :confidence,
+                methodologies_count = :methodologies, individual_scores = :individual,
+                is_stale = 0, computed_at = CURRENT_TIMESTAMP
+            WHERE idstockinfo = :stockId AND version = :version");
+
+        $refreshed = 0;
+        $lastId = $afterId;
+        foreach ($stale as $row) {
+            $lastId = (int)$row['idstockinfo'];
+            $score = $scorer((int)$row['idstockinfo']);
+            $update->execute([
+                ':score' => $score['unified_score'],
+                ':grade' => $score['grade'],
+                ':confidence' => $score['confidence_level'],
+                ':methodologies' => count($score['individual_scores']),
+                ':individual' => json_encode($score['individual_scores']),
+                ':stockId' => (int)$row['idstockinfo'],
+                ':version' => (int)$row['version']
+            ]);
+            $refreshed += $update->rowCount();
+        }
+
+        return ['fetched' => count($stale), 'refreshed' => $refreshed, 'last_id' => $lastId];
+    }
+
+    /**
+     * Create the table on first use, queueing all stocks when it starts out empty
+     */
+    private function ensureTable(): void
+    {
+        if ($this->tableEnsured) {
+            return;
+        }
+        $this->tableEnsured = true;
+
+        $this->db->exec("
+            CREATE TABLE IF NOT EXISTS unified_scores (
+                idstockinfo INT NOT NULL PRIMARY KEY,
+                unified_score DECIMAL(4,1) NULL,
+                grade VARCHAR(2) NULL,
+                confidence_level VARCHAR(20) NULL,
+                methodologies_count TINYINT NOT NULL DEFAULT 0,
+                individual_scores JSON NULL,
+                is_stale TINYINT(1) NOT NULL DEFAULT 1,
+                version INT UNSIGNED NOT NULL DEFAULT 1,
+                computed_at TIMESTAMP NULL,
+                INDEX idx_unified_score (unified_score),
+                INDEX idx_stale (is_stale)
+            ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci
+        ");
+
+        if ($this->db->query("SELECT 1 FROM unified_scores LIMIT 1")->fetchColumn() === false) {
+            $this->queueAll();
+        }
+    }
+}
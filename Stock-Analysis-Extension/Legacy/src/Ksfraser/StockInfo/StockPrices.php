@@ -195,6 +195,9 @@ class StockPrices extends BaseModel
 
     /**
      * Insert or update price data
+     *
+     * Also refreshes the price-dependent signal flags of any technical
+     * analysis row already stored for the same symbol and date.
      */
     public function upsertPrice($data)
     {
@@ -214,7 +217,7 @@ class StockPrices extends BaseModel
                 idstockinfo = VALUES(idstockinfo)";
 
         $stmt = $this->pdo->prepare($sql);
-        return $stmt->execute([
+        $saved = $stmt->execute([
             $data['symbol'],
             $data['date'],
             $data['previous_close'] ?? null,
@@ -228,6 +231,17 @@ class StockPrices extends BaseModel
             $data['volume'] ?? null,
             $data['idstockinfo'] ?? 0
         ]);
+
+        if ($saved) {
+            (new TechnicalAnalysis($this->pdo))->refreshPriceSignals(
+                $data['symbol'],
+                $data['date'],
+                $data['day_close'] ?? null,
+                $data['volume'] ?? null
+            );
+        }
+
+        return $saved;
     }
 
     /**
@@ -10,9 +10,59 @@ namespace Ksfraser\StockInfo;
  * - Technical indicators
  * - Chart patterns
  * - Trading signals
+ *
+ * Screener conditions are precomputed by upsertAnalysis into the
+ * signal_flags bitmap (sql/001_technicalanalysis_signal_flags.sql), so a
+ * screen for any combination of signals on a day is one lookup on the
+ * (date, signal_flags, stocksymbol) index.
+ *
+ * The bollinger_squeeze and volume_breakout flags also depend on the day's
+ * close and volume, which StockPrices::upsertPrice feeds back through
+ * refreshPriceSignals when prices arrive after the analysis row.
  */
 class TechnicalAnalysis extends BaseModel
 {
+    const SIGNAL_GOLDEN_CROSS = 1;
+    const SIGNAL_DEATH_CROSS = 2;
+    const SIGNAL_OVERBOUGHT = 4;
+    const SIGNAL_OVERSOLD = 8;
+    const SIGNAL_MACD_BUY = 16;
+    const SIGNAL_BOLLINGER_SQUEEZE = 32;
+    const SIGNAL_VOLUME_BREAKOUT = 64;
+    const SIGNAL_ABOVE_SMA20 = 128;
+    const SIGNAL_ABOVE_SMA50 = 256;
+    const SIGNAL_ABOVE_SMA200 = 512;
+
+    /** Thresholds the flags are computed with */
+    const RSI_OVERBOUGHT = 70;
+    const RSI_OVERSOLD = 30;
+    const SQUEEZE_TOLERANCE = 0.02;
+    const VOLUME_BREAKOUT_MULTIPLIER = 2;
+
+    /** Names accepted by screen() */
+    const SIGNALS = [
+        'golden_cross' => self::SIGNAL_GOLDEN_CROSS,
+        'death_cross' => self::SIGNAL_DEATH_CROSS,
+        'overbought' => self::SIGNAL_OVERBOUGHT,
+        'oversold' => self::SIGNAL_OVERSOLD,
+        'macd_buy' => self::SIGNAL_MACD_BUY,
+        'bollinger_squeeze' => self::SIGNAL_BOLLINGER_SQUEEZE,
+        'volume_breakout' => self::SIGNAL_VOLUME_BREAKOUT,
+        'above_sma20' => self::SIGNAL_ABOVE_SMA20,
+        'above_sma50' => self::SIGNAL_ABOVE_SMA50,
+        'above_sma200' => self::SIGNAL_ABOVE_SMA200,
+    ];
+
+    /** Columns screen() may order by */
+    const SCREEN_ORDER_COLUMNS = [
+        'ta.stocksymbol',
+        'ta.rsi',
+        'ta.macd_histogram',
+        'ta.volume_ratio',
+        'ta.price_to_middle_ratio',
+        's.currentprice',
+    ];
+
     protected $table = 'technicalanalysis';
     protected $primaryKey = 'id';
     
@@ -37,7 +87,10 @@ class TechnicalAnalysis extends BaseModel
         'price_above_sma200',
         'golden_cross',
         'death_cross',
-        'analysis_date'
+        'analysis_date',
+        'signal_flags',
+        'volume_ratio',
+        'price_to_middle_ratio'
     ];
 
     /**
@@ -90,19 +143,7 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getGoldenCrossStocks($date = null)
     {
-        $date = $date ?: date('Y-m-d');
-        
-        $sql = "SELECT ta.*, s.corporatename, s.currentprice
-                FROM {$this->table} ta
-                JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
-                WHERE ta.golden_cross = 1 
-                AND ta.date = ?
-                AND s.active = 1
-                ORDER BY ta.stocksymbol";
-        
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$date]);
-        return $stmt->fetchAll(\PDO::FETCH_OBJ);
+        return $this->screen(self::SIGNAL_GOLDEN_CROSS, $date);
     }
 
     /**
@@ -110,19 +151,7 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getDeathCrossStocks($date = null)
     {
-        $date = $date ?: date('Y-m-d');
-        
-        $sql = "SELECT ta.*, s.corporatename, s.currentprice
-                FROM {$this->table} ta
-                JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
-                WHERE ta.death_cross = 1 
-                AND ta.date = ?
-                AND s.active = 1
-                ORDER BY ta.stocksymbol";
-        
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$date]);
-        return $stmt->fetchAll(\PDO::FETCH_OBJ);
+        return $this->screen(self::SIGNAL_DEATH_CROSS, $date);
     }
 
     /**
@@ -130,6 +159,10 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getOverboughtStocks($rsiThreshold = 70, $date = null)
     {
+        if ($rsiThreshold == self::RSI_OVERBOUGHT) {
+            return $this->screen(self::SIGNAL_OVERBOUGHT, $date, 0, 'ta.rsi DESC');
+        }
+
         $date = $date ?: date('Y-m-d');
         
         $sql = "SELECT ta.*, s.corporatename, s.currentprice
@@ -150,6 +183,10 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getOversoldStocks($rsiThreshold = 30, $date = null)
     {
+        if ($rsiThreshold == self::RSI_OVERSOLD) {
+            return $this->screen(self::SIGNAL_OVERSOLD, $date, 0, 'ta.rsi ASC');
+        }
+
         $date = $date ?: date('Y-m-d');
         
         $sql = "SELECT ta.*, s.corporatename, s.currentprice
@@ -170,26 +207,17 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getStocksAboveMovingAverages($movingAverage = 'sma_20', $date = null)
     {
-        $date = $date ?: date('Y-m-d');
-        $validMAs = ['sma_20', 'sma_50', 'sma_200'];
+        $flags = [
+            'sma_20' => self::SIGNAL_ABOVE_SMA20,
+            'sma_50' => self::SIGNAL_ABOVE_SMA50,
+            'sma_200' => self::SIGNAL_ABOVE_SMA200,
+        ];
         
-        if (!in_array($movingAverage, $validMAs)) {
+        if (!isset($flags[$movingAverage])) {
             throw new \InvalidArgumentException("Invalid moving average: {$movingAverage}");
         }
 
-        $priceAboveColumn = 'price_above_' . $movingAverage;
-        
-        $sql = "SELECT ta.*, s.corporatename, s.currentprice
-                FROM {$this->table} ta
-                JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
-                WHERE ta.{$priceAboveColumn} = 1 
-                AND ta.date = ?
-                AND s.active = 1
-                ORDER BY ta.stocksymbol";
-        
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$date]);
-        return $stmt->fetchAll(\PDO::FETCH_OBJ);
+        return $this->screen($flags[$movingAverage], $date);
     }
 
     /**
@@ -197,27 +225,21 @@ class TechnicalAnalysis extends BaseModel
      */
     public function getMACDBuySignals($date = null)
     {
-        $date = $date ?: date('Y-m-d');
-        
-        $sql = "SELECT ta.*, s.corporatename, s.currentprice
-                FROM {$this->table} ta
-                JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
-                WHERE ta.macd > ta.macd_signal 
-                AND ta.macd_histogram > 0
-                AND ta.date = ?
-                AND s.active = 1
-                ORDER BY ta.macd_histogram DESC";
-        
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$date]);
-        return $stmt->fetchAll(\PDO::FETCH_OBJ);
+        return $this->screen(self::SIGNAL_MACD_BUY, $date, 0, 'ta.macd_histogram DESC');
     }
 
     /**
      * Get Bollinger Band squeeze (price near middle band)
+     *
+     * With the default tolerance this uses the close recorded at analysis
+     * time; other tolerances compare against the live current price.
      */
     public function getBollingerBandSqueeze($tolerance = 0.02, $date = null)
     {
+        if ($tolerance == self::SQUEEZE_TOLERANCE) {
+            return $this->screen(self::SIGNAL_BOLLINGER_SQUEEZE, $date, 0, 'ta.price_to_middle_ratio ASC');
+        }
+
         $date = $date ?: date('Y-m-d');
         
         $sql = "SELECT ta.*, s.corporatename, s.currentprice,
@@ -240,6 +262,22 @@ class TechnicalAnalysis extends BaseModel
     public function getVolumeBreakouts($volumeMultiplier = 2, $date = null)
     {
         $date = $date ?: date('Y-m-d');
+
+        if ($volumeMultiplier == self::VOLUME_BREAKOUT_MULTIPLIER) {
+            $flag = self::SIGNAL_VOLUME_BREAKOUT;
+            $sql = "SELECT ta.*, s.corporatename, s.currentprice, sp.volume as current_volume
+                    FROM {$this->table} ta
+                    JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
+                    LEFT JOIN stockprices sp ON ta.stocksymbol = sp.symbol AND sp.date = ta.date
+                    WHERE ta.date = ?
+                    AND (ta.signal_flags & ?) = ?
+                    AND s.active = 1
+                    ORDER BY ta.volume_ratio DESC";
+
+            $stmt = $this->pdo->prepare($sql);
+            $stmt->execute([$date, $flag, $flag]);
+            return $stmt->fetchAll(\PDO::FETCH_OBJ);
+        }
         
         $sql = "SELECT ta.*, s.corporatename, s.currentprice, sp.volume as current_volume,
                 (sp.volume / ta.volume_sma) as volume_ratio
@@ -256,6 +294,166 @@ class TechnicalAnalysis extends BaseModel
         return $stmt->fetchAll(\PDO::FETCH_OBJ);
     }
 
+    /**
+     * Stocks matching every signal in $require and none in $exclude on a date
+     *
+     * e.g. screen(['oversold', 'above_sma200', 'volume_breakout']) answers
+     * "oversold AND above SMA 200 AND volume breakout" in one query on the
+     * (date, signal_flags) index.
+     *
+     * @param array|int $require Signal names (see SIGNALS) or a SIGNAL_* bitmask
+     * @param string|null $date Defaults to today
+     * @param array|int $exclude Signals that must not be set
+     * @param string $orderBy A SCREEN_ORDER_COLUMNS column, optionally followed by ASC or DESC
+     */
+    public function screen($require, $date = null, $exclude = 0, $orderBy = 'ta.stocksymbol')
+    {
+        $date = $date ?: date('Y-m-d');
+        $requireMask = $this->signalMask($require);
+        $excludeMask = $this->signalMask($exclude);
+        $orderBy = $this->screenOrder($orderBy);
+
+        $sql = "SELECT ta.*, s.corporatename, s.currentprice
+                FROM {$this->table} ta
+                JOIN stockinfo s ON ta.stocksymbol = s.stocksymbol
+                WHERE ta.date = ?
+                AND (ta.signal_flags & ?) = ?
+                AND (ta.signal_flags & ?) = 0
+                AND s.active = 1
+                ORDER BY {$orderBy}";
+
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$date, $requireMask, $requireMask, $excludeMask]);
+        return $stmt->fetchAll(\PDO::FETCH_OBJ);
+    }
+
+    /**
+     * Bitmask for signal names or an existing mask
+     */
+    public function signalMask($signals)
+    {
+        if (is_int($signals)) {
+            return $signals;
+        }
+
+        $mask = 0;
+        foreach ((array)$signals as $signal) {
+            if (!isset(self::SIGNALS[$signal])) {
+                throw new \InvalidArgumentException("Unknown signal: {$signal}");
+            }
+            $mask |= self::SIGNALS[$signal];
+        }
+        return $mask;
+    }
+
+    /**
+     * Validate an ORDER BY for screen() against SCREEN_ORDER_COLUMNS
+     */
+    private function screenOrder($orderBy)
+    {
+        $parts = preg_split('/\s+/', trim($orderBy));
+        $column = $parts[0];
+        $direction = strtoupper($parts[1] ?? 'ASC');
+
+        if (count($parts) > 2 || !in_array($column, self::SCREEN_ORDER_COLUMNS, true)
+            || !in_array($direction, ['ASC', 'DESC'], true)) {
+            throw new \InvalidArgumentException("Invalid screen order: {$orderBy}");
+        }
+
+        return "{$column} {$direction}";
+    }
+
+    /**
+     * Compute signal_flags and the ratios behind them for an analysis row
+     *
+     * $data may carry the day's close and volume; otherwise they are read
+     * from stockprices for the same symbol and date. Without either, the
+     * squeeze and breakout flags stay clear until refreshPriceSignals runs.
+     *
+     * @return array ['signal_flags' => int, 'volume_ratio' => ?float, 'price_to_middle_ratio' => ?float]
+     */
+    public function computeSignals(array $data)
+    {
+        $close = $data['close'] ?? $data['day_close'] ?? null;
+        $volume = $data['volume'] ?? null;
+
+        if ($close === null || $volume === null) {
+            $stmt = $this->pdo->prepare("SELECT day_close, volume FROM stockprices WHERE symbol = ? AND date = ?");
+            $stmt->execute([$data['stocksymbol'], $data['date']]);
+            $price = $stmt->fetch(\PDO::FETCH_ASSOC);
+            if ($price) {
+                $close = $close ?? $price['day_close'];
+                $volume = $volume ?? $price['volume'];
+            }
+        }
+
+        $volumeRatio = ($volume !== null && !empty($data['volume_sma'])) ? $volume / $data['volume_sma'] : null;
+        $middle = $data['bollinger_middle'] ?? null;
+        $middleRatio = ($close !== null && !empty($middle)) ? abs($close - $middle) / $middle : null;
+        $rsi = $data['rsi'] ?? null;
+        $macd = $data['macd'] ?? null;
+        $macdSignal = $data['macd_signal'] ?? null;
+        $histogram = $data['macd_histogram'] ?? null;
+
+        $conditions = [
+            self::SIGNAL_GOLDEN_CROSS => !empty($data['golden_cross']),
+            self::SIGNAL_DEATH_CROSS => !empty($data['death_cross']),
+            self::SIGNAL_OVERBOUGHT => $rsi !== null && $rsi > self::RSI_OVERBOUGHT,
+            self::SIGNAL_OVERSOLD => $rsi !== null && $rsi < self::RSI_OVERSOLD,
+            self::SIGNAL_MACD_BUY => $macd !== null && $macdSignal !== null && $histogram !== null
+                && $macd > $macdSignal && $histogram > 0,
+            self::SIGNAL_BOLLINGER_SQUEEZE => $middleRatio !== null && $middleRatio <= self::SQUEEZE_TOLERANCE,
+            self::SIGNAL_VOLUME_BREAKOUT => $volumeRatio !== null && $volumeRatio >= self::VOLUME_BREAKOUT_MULTIPLIER,
+            self::SIGNAL_ABOVE_SMA20 => !empty($data['price_above_sma20']),
+            self::SIGNAL_ABOVE_SMA50 => !empty($data['price_above_sma50']),
+            self::SIGNAL_ABOVE_SMA200 => !empty($data['price_above_sma200']),
+        ];
+
+        $flags = 0;
+        foreach ($conditions as $flag => $set) {
+            if ($set) {
+                $flags |= $flag;
+            }
+        }
+
+        return [
+            'signal_flags' => $flags,
+            'volume_ratio' => $volumeRatio,
+            'price_to_middle_ratio' => $middleRatio
+        ];
+    }
+
+    /**
+     * Recompute the price-dependent flags of an existing analysis row
+     *
+     * Called by StockPrices::upsertPrice so rows analysed before the day's
+     * prices were stored pick up bollinger_squeeze and volume_breakout.
+     *
+     * @return bool True when an analysis row for the symbol and date exists
+     */
+    public function refreshPriceSignals($stockSymbol, $date, $close, $volume)
+    {
+        $stmt = $this->pdo->prepare("SELECT * FROM {$this->table} WHERE stocksymbol = ? AND date = ?");
+        $stmt->execute([$stockSymbol, $date]);
+        $row = $stmt->fetch(\PDO::FETCH_ASSOC);
+        if (!$row) {
+            return false;
+        }
+
+        $signals = $this->computeSignals(array_merge($row, ['close' => $close, 'volume' => $volume]));
+
+        $stmt = $this->pdo->prepare("UPDATE {$this->table}
+                SET signal_flags = ?, volume_ratio = ?, price_to_middle_ratio = ?
+                WHERE stocksymbol = ? AND date = ?");
+        return $stmt->execute([
+            $signals['signal_flags'],
+            $signals['volume_ratio'],
+            $signals['price_to_middle_ratio'],
+            $stockSymbol,
+            $date
+        ]);
+    }
+
     /**
      * Get technical strength score
      */
@@ -307,11 +505,14 @@ class TechnicalAnalysis extends BaseModel
      */
     public function upsertAnalysis($data)
     {
+        $signals = $this->computeSignals($data);
+
         $sql = "INSERT INTO {$this->table} 
                 (stocksymbol, date, sma_20, sma_50, sma_200, ema_12, ema_26, macd, macd_signal, macd_histogram, 
                  rsi, bollinger_upper, bollinger_middle, bollinger_lower, volume_sma, price_above_sma20, 
-                 price_above_sma50, price_above_sma200, golden_cross, death_cross, analysis_date)
-                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+                 price_above_sma50, price_above_sma200, golden_cross, death_cross, analysis_date,
+                 signal_flags, volume_ratio, price_to_middle_ratio)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
                 ON DUPLICATE KEY UPDATE
                 sma_20 = VALUES(sma_20), sma_50 = VALUES(sma_50), sma_200 = VALUES(sma_200),
                 ema_12 = VALUES(ema_12), ema_26 = VALUES(ema_26), macd = VALUES(macd),
@@ -321,7 +522,8 @@ class TechnicalAnalysis extends BaseModel
                 volume_sma = VALUES(volume_sma), price_above_sma20 = VALUES(price_above_sma20),
                 price_above_sma50 = VALUES(price_above_sma50), price_above_sma200 = VALUES(price_above_sma200),
                 golden_cross = VALUES(golden_cross), death_cross = VALUES(death_cross),
-                analysis_date = VALUES(analysis_date)";
+                analysis_date = VALUES(analysis_date), signal_flags = VALUES(signal_flags),
+                volume_ratio = VALUES(volume_ratio), price_to_middle_ratio = VALUES(price_to_middle_ratio)";
 
         $stmt = $this->pdo->prepare($sql);
         return $stmt->execute([
@@ -345,7 +547,10 @@ class TechnicalAnalysis extends BaseModel
             $data['price_above_sma200'] ?? 0,
             $data['golden_cross'] ?? 0,
             $data['death_cross'] ?? 0,
-            $data['analysis_date'] ?? date('Y-m-d H:i:s')
+            $data['analysis_date'] ?? date('Y-m-d H:i:s'),
+            $signals['signal_flags'],
+            $signals['volume_ratio'],
+            $signals['price_to_middle_ratio']
         ]);
     }
 }
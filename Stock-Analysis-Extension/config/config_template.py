@@ -44,6 +44,8 @@ ANALYSIS_CONFIG = {
     'min_market_cap': 1000000000,  # $1B minimum market cap for "normal" stocks
     'max_pe_ratio': 50,
     'min_dividend_yield': 0.0,
+    'max_symbols_to_analyze': None,  # Cap on the recommendation universe (None = all)
+    'feature_cache_size': 64,  # Symbols whose indicator frames StockAnalyzer keeps memoized
     'sectors_to_analyze': [
         'Technology', 'Healthcare', 'Financial Services', 
         'Consumer Cyclical', 'Industrials', 'Communication Services',
@@ -61,6 +63,29 @@ RISK_CONFIG = {
     'max_sector_exposure': 0.25  # 25% max per sector
 }
 
+# Market data fetch pipeline
+FETCH_CONFIG = {
+    'max_workers': 8,  # Concurrent symbol fetches
+    'max_retries': 2,  # Retries per provider before failing over
+    'backoff_base': 0.5,  # Seconds; doubled per retry, with full jitter
+    'backoff_max': 8.0,
+    'rate_limits': {  # Sustained requests/second and burst per provider
+        'yahoo': {'rate': 2.0, 'burst': 5},
+        'alpha_vantage': {'rate': 5 / 60.0, 'burst': 1},
+        'finnhub': {'rate': 1.0, 'burst': 5}
+    }
+}
+
+# Recommendation Screening Configuration
+SCREENING_CONFIG = {
+    'parallel': True,  # Analyze on a process pool (False = in-process)
+    'max_workers': None,  # Analysis processes (None = CPU count)
+    'candidate_multiplier': 3,  # Top-K kept = max_recommendations x this, before risk filters
+    'min_market_cap': None,  # Optional hard pre-filter floors (None = off)
+    'max_pe_ratio': None,
+    'min_avg_volume': None
+}
+
 # Scoring Weights (should sum to 1.0)
 SCORING_WEIGHTS = {
     'fundamental': 0.40,
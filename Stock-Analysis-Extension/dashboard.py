@@ -15,6 +15,8 @@ from pathlib import Path
 
 # Add modules to path
 sys.path.append(str(Path(__file__).parent / "modules"))
+# Repository root, so the analyzers record runtime_metrics (they fall back to no-ops without it)
+sys.path.append(str(Path(__file__).parent.parent))
 
 from main import StockAnalysisApp
 
@@ -13,6 +13,8 @@ from typing import Dict, List, Any, Optional
 
 # Add the modules directory to the path
 sys.path.append(str(Path(__file__).parent / "modules"))
+# Repository root, so the analyzers record runtime_metrics (they fall back to no-ops without it)
+sys.path.append(str(Path(__file__).parent.parent))
 
 # Import modules
 from modules.database_manager import DatabaseManager
@@ -57,7 +59,9 @@ class StockAnalysisApp:
                     'API_KEYS': config_module.API_KEYS,
                     'ANALYSIS_CONFIG': config_module.ANALYSIS_CONFIG,
                     'RISK_CONFIG': config_module.RISK_CONFIG,
-                    'SCORING_WEIGHTS': config_module.SCORING_WEIGHTS
+                    'SCORING_WEIGHTS': config_module.SCORING_WEIGHTS,
+                    'FETCH_CONFIG': getattr(config_module, 'FETCH_CONFIG', {}),
+                    'SCREENING_CONFIG': getattr(config_module, 'SCREENING_CONFIG', {})
                 }
             else:
                 # Use default configuration
@@ -0,0 +1,138 @@
+"""
+Feature Frame for Stock Analysis Extension
+Lazily computed, memoized indicator columns shared by the StockAnalyzer sub-analyses
+"""
+
+from collections import OrderedDict
+from typing import Any, Dict, Hashable, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+import ta
+
+
+class FeatureFrame:
+    """
+    One symbol's price history plus its derived features
+
+    Features are computed on first access and memoized, so each indicator
+    is derived at most once however many sub-analyses read it. The price
+    frame is sorted by date only when it is not already in order, and it is
+    never copied defensively. Treat it, and every returned Series, as read-only.
+    """
+
+    def __init__(self, price_df: pd.DataFrame):
+        if 'date' in price_df.columns and not price_df['date'].is_monotonic_increasing:
+            price_df = price_df.sort_values('date').reset_index(drop=True)
+
+        self.df = price_df
+        self._features: Dict[str, Any] = {}
+
+    def __len__(self) -> int:
+        return len(self.df)
+
+    def has(self, column: str) -> bool:
+        """Whether the underlying price data has a raw column"""
+        return column in self.df.columns
+
+    def __getitem__(self, name: str) -> Any:
+        """A raw price column or a named feature, computed once"""
+        if name not in self._features:
+            compute = getattr(self, f"_compute_{name}", None)
+            self._features[name] = compute() if compute else self.df[name]
+        return self._features[name]
+
+    def last(self, name: str, offset: int = 1) -> Any:
+        """Value of a column `offset` bars from the end (1 = latest)"""
+        return self[name].iloc[-offset]
+
+    # Price-derived series
+
+    def _compute_returns(self) -> pd.Series:
+        return self['close'].pct_change()
+
+    def _compute_sma_20(self) -> pd.Series:
+        return ta.trend.sma_indicator(self['close'], window=20)
+
+    def _compute_sma_50(self) -> pd.Series:
+        return ta.trend.sma_indicator(self['close'], window=50)
+
+    def _compute_rsi(self) -> pd.Series:
+        return ta.momentum.rsi(self['close'], window=14)
+
+    def _compute_macd(self) -> pd.Series:
+        return ta.trend.macd_diff(self['close'])
+
+    def _compute_bb_upper(self) -> pd.Series:
+        return ta.volatility.bollinger_hband(self['close'])
+
+    def _compute_bb_lower(self) -> pd.Series:
+        return ta.volatility.bollinger_lband(self['close'])
+
+    # Scalar statistics
+
+    def _compute_volatility_annual(self) -> float:
+        """Annualized volatility of daily returns over the whole history (fraction)"""
+        return float(self['returns'].dropna().std() * np.sqrt(252))
+
+    def _compute_volatility_30d(self) -> float:
+        """Annualized volatility of the last 30 daily returns (fraction)"""
+        return float(self['returns'].tail(30).std() * np.sqrt(252))
+
+
+class FeatureFrameCache:
+    """
+    Small LRU of FeatureFrames keyed on a symbol and the shape of its data
+
+    The key includes the bar count, the first and last dates, and the last
+    close and volume. Re-analyzing unchanged data (e.g. repeated dashboard
+    clicks) reuses the features already computed, while a new bar or a
+    different period produces a fresh frame.
+    """
+
+    def __init__(self, max_items: int = 64):
+        self.max_items = max_items
+        self._frames: "OrderedDict[Hashable, FeatureFrame]" = OrderedDict()
+        self.stats = {'hits': 0, 'misses': 0}
+
+    @staticmethod
+    def key(symbol: str, price_df: pd.DataFrame) -> Optional[Tuple]:
+        """Cache key for a price frame, or None when the frame has no usable last bar"""
+        if price_df.empty or 'close' not in price_df.columns:
+            return None
+
+        if 'date' in price_df.columns:
+            dates = price_df['date']
+            first, last = dates.min(), dates.max()
+            last_bar = price_df.loc[dates.idxmax()]
+        else:
+            first = last = None
+            last_bar = price_df.iloc[-1]
+
+        return (
+            symbol,
+            len(price_df),
+            str(first),
+            str(last),
+            float(last_bar['close']),
+            float(last_bar['volume']) if 'volume' in price_df.columns else None
+        )
+
+    def get(self, symbol: str, price_df: pd.DataFrame) -> FeatureFrame:
+        """The memoized FeatureFrame for this data, building it on a miss"""
+        key = self.key(symbol, price_df)
+        if key is None:
+            return FeatureFrame(price_df)
+
+        frame = self._frames.get(key)
+        if frame is not None:
+            self._frames.move_to_end(key)
+            self.stats['hits'] += 1
+            return frame
+
+        self.stats['misses'] += 1
+        frame = FeatureFrame(price_df)
+        self._frames[key] = frame
+        while len(self._frames) > self.max_items:
+            self._frames.popitem(last=False)
+        return frame
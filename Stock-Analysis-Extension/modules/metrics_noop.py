@@ -0,0 +1,36 @@
+"""
+No-op stand-in for the repository's runtime_metrics module.
+
+Used when the extension runs without the repository root on sys.path;
+only the calls the analyzer and fetcher make are provided.
+"""
+
+from typing import Any
+
+
+class _NoopSpan:
+    __slots__ = ()
+
+    def label(self, **labels: Any) -> "_NoopSpan":
+        return self
+
+    def __enter__(self) -> "_NoopSpan":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> bool:
+        return False
+
+
+_NOOP_SPAN = _NoopSpan()
+
+
+def span(name: str, **labels: Any) -> _NoopSpan:
+    return _NOOP_SPAN
+
+
+def increment(name: str, value: float = 1, **labels: Any) -> None:
+    pass
+
+
+def observe(name: str, seconds: float, **labels: Any) -> None:
+    pass
@@ -11,6 +11,7 @@ import logging
 from .database_manager import DatabaseManager
 from .stock_data_fetcher import StockDataFetcher
 from .stock_analyzer import StockAnalyzer
+from .screening_engine import ScreeningEngine
 from .front_accounting import FrontAccountingIntegrator
 
 class PortfolioManager:
@@ -28,6 +29,7 @@ class PortfolioManager:
         self.db_manager = DatabaseManager(config['DATABASE_CONFIG'])
         self.data_fetcher = StockDataFetcher(config)
         self.analyzer = StockAnalyzer(config)
+        self.screening_engine = ScreeningEngine(config, self.analyzer)
         self.fa_integrator = FrontAccountingIntegrator(config)
         
         # Risk management settings
@@ -90,19 +92,21 @@ class PortfolioManager:
             
         return results
     
-    def analyze_portfolio_stock(self, symbol: str) -> Dict[str, Any]:
+    def analyze_portfolio_stock(self, symbol: str, stock_data: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
         """
         Analyze a stock for potential portfolio inclusion
         
         Args:
             symbol: Stock symbol to analyze
+            stock_data: Already fetched data for the symbol (fetched here if omitted)
             
         Returns:
             Dictionary containing analysis results
         """
         try:
             # Fetch stock data
-            stock_data = self.data_fetcher.get_stock_data(symbol, period='1y', include_fundamentals=True)
+            if stock_data is None:
+                stock_data = self.data_fetcher.get_stock_data(symbol, period='1y', include_fundamentals=True)
             
             if stock_data['price_data'].empty:
                 return {
@@ -113,20 +117,7 @@ class PortfolioManager:
             
             # Perform analysis
             analysis = self.analyzer.analyze_stock(stock_data)
-            
-            # Store analysis results in database
-            if analysis['error'] is None:
-                self.db_manager.update_analysis_results(symbol, analysis)
-                
-                # Store fundamental data
-                if stock_data['fundamentals']:
-                    self._store_fundamental_data(symbol, stock_data['fundamentals'])
-                
-                # Store price data (last 30 days to avoid overwhelming database)
-                recent_prices = stock_data['price_data'].tail(30).copy()
-                if not recent_prices.empty:
-                    recent_prices['symbol'] = symbol
-                    self.db_manager.insert_stock_data(recent_prices, 'stock_prices')
+            self._store_analysis(stock_data, analysis)
             
             return {
                 'symbol': symbol,
@@ -143,6 +134,30 @@ class PortfolioManager:
                 'analysis': None
             }
     
+    def _store_analysis(self, stock_data: Dict[str, Any], analysis: Dict[str, Any]):
+        """
+        Store a successful analysis with its fundamentals and recent prices
+        
+        Args:
+            stock_data: Data the analysis ran on
+            analysis: Result of StockAnalyzer.analyze_stock
+        """
+        if analysis['error'] is not None:
+            return
+        
+        symbol = analysis['symbol']
+        self.db_manager.update_analysis_results(symbol, analysis)
+        
+        # Store fundamental data
+        if stock_data['fundamentals']:
+            self._store_fundamental_data(symbol, stock_data['fundamentals'])
+        
+        # Store price data (last 30 days to avoid overwhelming database)
+        recent_prices = stock_data['price_data'].tail(30).copy()
+        if not recent_prices.empty:
+            recent_prices['symbol'] = symbol
+            self.db_manager.insert_stock_data(recent_prices, 'stock_prices')
+    
     def get_portfolio_recommendations(self, max_recommendations: int = 10) -> List[Dict[str, Any]]:
         """
         Get stock recommendations for portfolio
@@ -157,47 +172,40 @@ class PortfolioManager:
             # Get S&P 500 stocks for analysis
             sp500_symbols = self.data_fetcher.get_sp500_list()
             
-            # Limit analysis to avoid overwhelming the system
-            analysis_batch_size = 50
-            symbols_to_analyze = sp500_symbols[:analysis_batch_size]
+            # Optional cap on the universe (default: the full list)
+            max_symbols = self.config.get('ANALYSIS_CONFIG', {}).get('max_symbols_to_analyze')
+            symbols_to_analyze = sp500_symbols[:max_symbols] if max_symbols else sp500_symbols
             
-            recommendations = []
+            self.logger.info(f"Screening {len(symbols_to_analyze)} stocks for recommendations")
             
-            self.logger.info(f"Analyzing {len(symbols_to_analyze)} stocks for recommendations")
+            # Keep extra candidates so the risk filters below still have enough to choose from
+            overfetch = self.config.get('SCREENING_CONFIG', {}).get('candidate_multiplier', 3)
             
-            # Analyze stocks in batches
-            for i in range(0, len(symbols_to_analyze), 10):
-                batch = symbols_to_analyze[i:i+10]
-                
-                for symbol in batch:
-                    try:
-                        result = self.analyze_portfolio_stock(symbol)
-                        
-                        if result['error'] is None and result['analysis']:
-                            analysis = result['analysis']
-                            
-                            # Filter by minimum score
-                            if analysis['overall_score'] >= 65 and analysis['recommendation'] in ['BUY', 'STRONG_BUY']:
-                                recommendations.append({
-                                    'symbol': symbol,
-                                    'score': analysis['overall_score'],
-                                    'recommendation': analysis['recommendation'],
-                                    'target_price': analysis['target_price'],
-                                    'current_price': result['stock_data']['price_data']['close'].iloc[-1],
-                                    'risk_rating': analysis['risk_rating'],
-                                    'confidence': analysis['confidence_level'],
-                                    'fundamental_score': analysis['fundamental_score'],
-                                    'technical_score': analysis['technical_score'],
-                                    'company_name': result['stock_data']['fundamentals'].get('company_name', symbol),
-                                    'sector': result['stock_data']['fundamentals'].get('sector', 'Unknown')
-                                })
-                                
-                    except Exception as e:
-                        self.logger.warning(f"Error analyzing {symbol}: {e}")
-                        continue
+            # Pre-filter on fundamentals, analyze survivors in parallel as their data arrives
+            # from the rate-limited fetch pipeline, and keep the best in a bounded heap
+            candidates = self.screening_engine.screen(
+                self.data_fetcher.stream_fetch_data(symbols_to_analyze, period='1y'),
+                top_k=max_recommendations * overfetch,
+                min_score=65,
+                accept=lambda analysis: analysis['recommendation'] in ['BUY', 'STRONG_BUY'],
+                on_result=self._store_analysis
+            )
             
-            # Sort by score and return top recommendations
-            recommendations.sort(key=lambda x: x['score'], reverse=True)
+            recommendations = []
+            for stock_data, analysis in candidates:
+                recommendations.append({
+                    'symbol': analysis['symbol'],
+                    'score': analysis['overall_score'],
+                    'recommendation': analysis['recommendation'],
+                    'target_price': analysis['target_price'],
+                    'current_price': stock_data['price_data']['close'].iloc[-1],
+                    'risk_rating': analysis['risk_rating'],
+                    'confidence': analysis['confidence_level'],
+                    'fundamental_score': analysis['fundamental_score'],
+                    'technical_score': analysis['technical_score'],
+                    'company_name': stock_data['fundamentals'].get('company_name', analysis['symbol']),
+                    'sector': stock_data['fundamentals'].get('sector', 'Unknown')
+                })
             
             # Apply risk management filters
             filtered_recommendations = self._apply_risk_filters(recommendations)
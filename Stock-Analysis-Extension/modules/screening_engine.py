@@ -0,0 +1,226 @@
+"""
+Screening Engine for Stock Analysis Extension
+Runs StockAnalyzer over a large universe on a process pool
+"""
+
+import heapq
+import itertools
+import logging
+import os
+from concurrent.futures import ProcessPoolExecutor, wait, FIRST_COMPLETED
+from multiprocessing import shared_memory
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+
+from .stock_analyzer import StockAnalyzer
+
+# Per-process analyzer, created once by the pool initializer
+_worker_analyzer: Optional[StockAnalyzer] = None
+
+
+def _init_worker(config: Dict[str, Any]) -> None:
+    global _worker_analyzer
+    _worker_analyzer = StockAnalyzer(config)
+
+
+class SharedPriceFrame:
+    """
+    A price DataFrame packed into one shared-memory block
+
+    Layout: n int64 date values (ns since epoch), followed by one contiguous
+    float64 column per numeric field. Workers attach by name and rebuild the
+    frame from views, so the bars are never pickled.
+    """
+
+    def __init__(self, price_df: pd.DataFrame):
+        numeric = [c for c in price_df.columns if c != 'date' and pd.api.types.is_numeric_dtype(price_df[c])]
+        n = len(price_df)
+
+        self.columns = numeric
+        self.length = n
+        self.has_date = 'date' in price_df.columns
+        self.shm = shared_memory.SharedMemory(create=True, size=max(8, 8 * n * (len(numeric) + 1)))
+
+        dates = np.ndarray((n,), dtype=np.int64, buffer=self.shm.buf)
+        if self.has_date:
+            dates[:] = pd.to_datetime(price_df['date'], utc=True).dt.tz_localize(None).values.astype('datetime64[ns]').astype(np.int64)
+
+        values = np.ndarray((len(numeric), n), dtype=np.float64, buffer=self.shm.buf, offset=8 * n)
+        for i, column in enumerate(numeric):
+            values[i, :] = price_df[column].to_numpy(dtype=np.float64, na_value=np.nan)
+
+    def handle(self) -> Tuple[str, int, List[str], bool]:
+        """What a worker needs to attach: (block name, rows, columns, has_date)"""
+        return self.shm.name, self.length, self.columns, self.has_date
+
+    def release(self) -> None:
+        self.shm.close()
+        self.shm.unlink()
+
+    @staticmethod
+    def attach(handle: Tuple[str, int, List[str], bool]) -> Tuple[pd.DataFrame, shared_memory.SharedMemory]:
+        """Rebuild the frame in a worker; the caller closes the returned block when done"""
+        name, n, columns, has_date = handle
+        shm = shared_memory.SharedMemory(name=name)
+
+        data = {}
+        if has_date:
+            data['date'] = np.ndarray((n,), dtype=np.int64, buffer=shm.buf).view('datetime64[ns]')
+        values = np.ndarray((len(columns), n), dtype=np.float64, buffer=shm.buf, offset=8 * n)
+        for i, column in enumerate(columns):
+            data[column] = values[i]
+
+        # Copy out so nothing references the block once it is closed
+        return pd.DataFrame(data).copy(), shm
+
+
+def _analyze_shared(symbol: str, handle: Tuple[str, int, List[str], bool],
+                    fundamentals: Dict[str, Any]) -> Tuple[str, Dict[str, Any]]:
+    """Process-pool task: analyze one symbol whose bars live in shared memory"""
+    price_df, shm = SharedPriceFrame.attach(handle)
+    try:
+        analysis = _worker_analyzer.analyze_stock({
+            'symbol': symbol,
+            'price_data': price_df,
+            'fundamentals': fundamentals
+        })
+        return symbol, analysis
+    finally:
+        shm.close()
+
+
+class ScreeningEngine:
+    """
+    Three-stage screen: fundamentals pre-filter, parallel full analysis, top-K selection
+
+    The pre-filter rejects a symbol when even perfect technical, momentum
+    and sentiment scores could not lift it to min_score, given its
+    fundamental score (a cheap dict-only computation), plus any
+    SCREENING_CONFIG market-cap/PE/volume floors. Survivors are analyzed in a
+    process pool, with their price frames shipped through shared memory.
+    The best candidates are kept in a bounded heap instead of being
+    collected and sorted.
+    """
+
+    def __init__(self, config: Dict[str, Any], analyzer: Optional[StockAnalyzer] = None):
+        self.config = config
+        self.logger = logging.getLogger(__name__)
+        self.analyzer = analyzer or StockAnalyzer(config)
+
+        screening_config = config.get('SCREENING_CONFIG', {})
+        self.max_workers = screening_config.get('max_workers') or os.cpu_count() or 1
+        self.parallel = screening_config.get('parallel', True)
+
+        # Optional hard pre-filter floors (None = off)
+        self.min_market_cap = screening_config.get('min_market_cap')
+        self.max_pe_ratio = screening_config.get('max_pe_ratio')
+        self.min_volume = screening_config.get('min_avg_volume')
+
+    def prefilter(self, stock_data: Dict[str, Any], min_score: float) -> bool:
+        """Whether a symbol can possibly reach min_score; uses fundamentals and volume only"""
+        price_df = stock_data.get('price_data')
+        if price_df is None or len(price_df) < 50:
+            return False
+
+        fundamentals = stock_data.get('fundamentals') or {}
+
+        market_cap = fundamentals.get('market_cap')
+        if self.min_market_cap and market_cap and market_cap < self.min_market_cap:
+            return False
+
+        pe_ratio = fundamentals.get('pe_ratio')
+        if self.max_pe_ratio and pe_ratio and pe_ratio > self.max_pe_ratio:
+            return False
+
+        if self.min_volume and 'volume' in price_df and price_df['volume'].tail(30).mean() < self.min_volume:
+            return False
+
+        weights = self.analyzer.scoring_weights
+        fundamental_score = self.analyzer.fundamental_score(fundamentals)
+        best_case = weights['fundamental'] * fundamental_score + 100 * (1 - weights['fundamental'])
+        return best_case >= min_score
+
+    def screen(self, stocks: Iterable[Tuple[str, Dict[str, Any]]], top_k: int, min_score: float = 65,
+               accept=None, on_result=None) -> List[Tuple[Dict[str, Any], Dict[str, Any]]]:
+        """
+        Screen (symbol, stock_data) pairs and return the top_k (stock_data, analysis) by overall score
+
+        Args:
+            stocks: Iterable of (symbol, stock_data), e.g. StockDataFetcher.stream_fetch_data()
+            top_k: Number of best results to keep
+            min_score: Minimum overall score
+            accept: Optional predicate(analysis) a result must also satisfy
+            on_result: Optional callback(stock_data, analysis), run in this process for every analyzed symbol
+
+        Returns:
+            Best results, highest score first
+        """
+        heap: List[Tuple[float, int, Dict[str, Any], Dict[str, Any]]] = []
+        counter = itertools.count()
+        analyzed = 0
+
+        for stock_data, analysis in self._analyze_all(self._survivors(stocks, min_score)):
+            analyzed += 1
+            if on_result:
+                try:
+                    on_result(stock_data, analysis)
+                except Exception as e:
+                    self.logger.warning(f"Result handler failed for {analysis.get('symbol')}: {e}")
+            if analysis.get('error') is not None or analysis['overall_score'] < min_score:
+                continue
+            if accept and not accept(analysis):
+                continue
+
+            entry = (analysis['overall_score'], next(counter), stock_data, analysis)
+            if len(heap) < top_k:
+                heapq.heappush(heap, entry)
+            elif entry[0] > heap[0][0]:
+                heapq.heapreplace(heap, entry)
+
+        self.logger.info(f"Screen kept {len(heap)} of {analyzed} analyzed symbols")
+        return [(stock_data, analysis) for _, _, stock_data, analysis in sorted(heap, reverse=True)]
+
+    def _survivors(self, stocks: Iterable[Tuple[str, Dict[str, Any]]], min_score: float) -> Iterator[Tuple[str, Dict[str, Any]]]:
+        for symbol, stock_data in stocks:
+            try:
+                if self.prefilter(stock_data, min_score):
+                    yield symbol, stock_data
+            except Exception as e:
+                self.logger.warning(f"Pre-filter failed for {symbol}: {e}")
+
+    def _analyze_all(self, stocks: Iterator[Tuple[str, Dict[str, Any]]]) -> Iterator[Tuple[Dict[str, Any], Dict[str, Any]]]:
+        """Full analysis of each stock, in a process pool when enabled (results in completion order)"""
+        if not self.parallel or self.max_workers <= 1:
+            for _, stock_data in stocks:
+                yield stock_data, self.analyzer.analyze_stock(stock_data)
+            return
+
+        with ProcessPoolExecutor(max_workers=self.max_workers, initializer=_init_worker,
+                                 initargs=(self.config,)) as pool:
+            in_flight = {}
+
+            def drain(return_when):
+                done, _ = wait(in_flight, return_when=return_when)
+                for future in done:
+                    stock_data, frame = in_flight.pop(future)
+                    frame.release()
+                    try:
+                        _, analysis = future.result()
+                    except Exception as e:
+                        self.logger.warning(f"Analysis failed for {stock_data.get('symbol')}: {e}")
+                        continue
+                    yield stock_data, analysis
+
+            for symbol, stock_data in stocks:
+                frame = SharedPriceFrame(stock_data['price_data'])
+                future = pool.submit(_analyze_shared, symbol, frame.handle(), stock_data.get('fundamentals') or {})
+                in_flight[future] = (stock_data, frame)
+
+                # Bound in-flight work (and live shared-memory blocks)
+                if len(in_flight) >= self.max_workers * 2:
+                    yield from drain(FIRST_COMPLETED)
+
+            while in_flight:
+                yield from drain(FIRST_COMPLETED)
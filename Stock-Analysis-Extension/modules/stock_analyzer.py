@@ -10,7 +10,11 @@ from typing import Dict, List, Tuple, Any, Optional
 import logging
 from sklearn.preprocessing import StandardScaler
 from sklearn.ensemble import RandomForestRegressor
-import ta
+from .feature_frame import FeatureFrame, FeatureFrameCache
+try:
+    import runtime_metrics as metrics
+except ImportError:  # repository root not on sys.path
+    from . import metrics_noop as metrics
 import warnings
 warnings.filterwarnings('ignore')
 
@@ -31,6 +35,9 @@ class StockAnalyzer:
             'sentiment': 0.10
         })
         
+        # Indicator frames memoized per symbol and last bar
+        self.feature_cache = FeatureFrameCache(config.get('ANALYSIS_CONFIG', {}).get('feature_cache_size', 64))
+        
     def analyze_stock(self, stock_data: Dict[str, Any]) -> Dict[str, Any]:
         """
         Perform comprehensive stock analysis
@@ -41,6 +48,23 @@ class StockAnalyzer:
         Returns:
             Dictionary containing analysis results and scores
         """
+        with metrics.span('analyzer_analyze_stock') as span:
+            analysis_result = self._analyze_stock(stock_data)
+            if analysis_result['error']:
+                span.label(outcome='error')
+        return analysis_result
+    
+    def fundamental_score(self, fundamentals: Dict[str, Any]) -> float:
+        """
+        Fundamental score (0-100) on its own, as used in the overall score
+        
+        Needs no price data, so screeners can use it to rule symbols out
+        before running the full analysis.
+        """
+        return self._analyze_fundamentals(fundamentals or {})['score']
+    
+    def _analyze_stock(self, stock_data: Dict[str, Any]) -> Dict[str, Any]:
+        """analyze_stock without the timing span"""
         symbol = stock_data['symbol']
         self.logger.info(f"Starting analysis for {symbol}")
         
@@ -73,11 +97,19 @@ class StockAnalyzer:
                 analysis_result['error'] = "Insufficient price data for analysis"
                 return analysis_result
             
+            # Shared, lazily computed indicators for every sub-analysis
+            with metrics.span('analyzer_step', step='features'):
+                features = self.feature_cache.get(symbol, price_df)
+            
             # Perform individual analyses
-            fundamental_analysis = self._analyze_fundamentals(fundamentals)
-            technical_analysis = self._analyze_technical(price_df)
-            momentum_analysis = self._analyze_momentum(price_df)
-            sentiment_analysis = self._analyze_sentiment(fundamentals, price_df)
+            with metrics.span('analyzer_step', step='fundamental'):
+                fundamental_analysis = self._analyze_fundamentals(fundamentals)
+            with metrics.span('analyzer_step', step='technical'):
+                technical_analysis = self._analyze_technical(features)
+            with metrics.span('analyzer_step', step='momentum'):
+                momentum_analysis = self._analyze_momentum(features)
+            with metrics.span('analyzer_step', step='sentiment'):
+                sentiment_analysis = self._analyze_sentiment(fundamentals, features)
             
             # Extract scores
             analysis_result['fundamental_score'] = fundamental_analysis['score']
@@ -85,32 +117,33 @@ class StockAnalyzer:
             analysis_result['momentum_score'] = momentum_analysis['score']
             analysis_result['sentiment_score'] = sentiment_analysis['score']
             
-            # Calculate overall score
-            overall_score = (
-                self.scoring_weights['fundamental'] * fundamental_analysis['score'] +
-                self.scoring_weights['technical'] * technical_analysis['score'] +
-                self.scoring_weights['momentum'] * momentum_analysis['score'] +
-                self.scoring_weights['sentiment'] * sentiment_analysis['score']
-            )
-            analysis_result['overall_score'] = round(overall_score, 2)
-            
-            # Determine recommendation
-            analysis_result['recommendation'] = self._get_recommendation(overall_score)
-            
-            # Calculate target price
-            analysis_result['target_price'] = self._calculate_target_price(
-                price_df, fundamentals, overall_score
-            )
-            
-            # Assess risk rating
-            analysis_result['risk_rating'] = self._assess_risk(
-                price_df, fundamentals, technical_analysis
-            )
-            
-            # Calculate confidence level
-            analysis_result['confidence_level'] = self._calculate_confidence(
-                fundamental_analysis, technical_analysis, momentum_analysis, sentiment_analysis
-            )
+            with metrics.span('analyzer_step', step='scoring'):
+                # Calculate overall score
+                overall_score = (
+                    self.scoring_weights['fundamental'] * fundamental_analysis['score'] +
+                    self.scoring_weights['technical'] * technical_analysis['score'] +
+                    self.scoring_weights['momentum'] * momentum_analysis['score'] +
+                    self.scoring_weights['sentiment'] * sentiment_analysis['score']
+                )
+                analysis_result['overall_score'] = round(overall_score, 2)
+            
+                # Determine recommendation
+                analysis_result['recommendation'] = self._get_recommendation(overall_score)
+            
+                # Calculate target price
+                analysis_result['target_price'] = self._calculate_target_price(
+                    features, fundamentals, overall_score
+                )
+            
+                # Assess risk rating
+                analysis_result['risk_rating'] = self._assess_risk(
+                    features, fundamentals, technical_analysis
+                )
+            
+                # Calculate confidence level
+                analysis_result['confidence_level'] = self._calculate_confidence(
+                    fundamental_analysis, technical_analysis, momentum_analysis, sentiment_analysis
+                )
             
             # Store detailed analysis
             analysis_result['details'] = {
@@ -118,11 +151,11 @@ class StockAnalyzer:
                 'technical': technical_analysis,
                 'momentum': momentum_analysis,
                 'sentiment': sentiment_analysis,
-                'price_current': float(price_df['close'].iloc[-1]),
-                'price_52w_high': float(price_df['high'].tail(252).max()),
-                'price_52w_low': float(price_df['low'].tail(252).min()),
-                'volume_avg_30d': float(price_df['volume'].tail(30).mean()),
-                'volatility_30d': float(price_df['close'].pct_change().tail(30).std() * np.sqrt(252))
+                'price_current': float(features.last('close')),
+                'price_52w_high': float(features['high'].tail(252).max()),
+                'price_52w_low': float(features['low'].tail(252).min()),
+                'volume_avg_30d': float(features['volume'].tail(30).mean()),
+                'volatility_30d': features['volatility_30d']
             }
             
             self.logger.info(f"Analysis completed for {symbol} - Score: {overall_score:.2f}")
@@ -285,12 +318,12 @@ class StockAnalyzer:
             
         return analysis
     
-    def _analyze_technical(self, price_df: pd.DataFrame) -> Dict[str, Any]:
+    def _analyze_technical(self, features: FeatureFrame) -> Dict[str, Any]:
         """
         Analyze technical indicators
         
         Args:
-            price_df: DataFrame containing price data
+            features: Price data and its memoized indicators
             
         Returns:
             Dictionary containing technical analysis results
@@ -303,22 +336,11 @@ class StockAnalyzer:
         }
         
         try:
-            df = price_df.copy()
-            df = df.sort_values('date').reset_index(drop=True)
-            
-            # Calculate technical indicators
-            df['sma_20'] = ta.trend.sma_indicator(df['close'], window=20)
-            df['sma_50'] = ta.trend.sma_indicator(df['close'], window=50)
-            df['sma_200'] = ta.trend.sma_indicator(df['close'], window=200)
-            
-            df['rsi'] = ta.momentum.rsi(df['close'], window=14)
-            df['macd'] = ta.trend.macd_diff(df['close'])
-            df['bb_upper'] = ta.volatility.bollinger_hband(df['close'])
-            df['bb_lower'] = ta.volatility.bollinger_lband(df['close'])
-            df['atr'] = ta.volatility.average_true_range(df['high'], df['low'], df['close'])
-            
-            # Get latest values
-            latest = df.iloc[-1]
+            # Get latest values (indicators are computed on first access)
+            latest = {
+                name: features.last(name)
+                for name in ('close', 'sma_20', 'sma_50', 'rsi', 'macd', 'bb_upper', 'bb_lower')
+            }
             current_price = latest['close']
             
             # Scoring factors
@@ -355,9 +377,9 @@ class StockAnalyzer:
                 analysis['indicators']['rsi'] = round(rsi, 2)
             
             # MACD Analysis
-            if not pd.isna(latest['macd']) and len(df) > 1:
+            if not pd.isna(latest['macd']) and len(features) > 1:
                 macd_current = latest['macd']
-                macd_prev = df.iloc[-2]['macd'] if not pd.isna(df.iloc[-2]['macd']) else macd_current
+                macd_prev = features.last('macd', 2) if not pd.isna(features.last('macd', 2)) else macd_current
                 
                 if macd_current > 0 and macd_current > macd_prev:
                     score_factors.append(75)
@@ -388,9 +410,9 @@ class StockAnalyzer:
                 analysis['indicators']['bb_position'] = round(bb_position, 3)
             
             # Volume Analysis
-            if 'volume' in df.columns and len(df) >= 20:
-                avg_volume_20 = df['volume'].tail(20).mean()
-                recent_volume = df['volume'].tail(5).mean()
+            if features.has('volume') and len(features) >= 20:
+                avg_volume_20 = features['volume'].tail(20).mean()
+                recent_volume = features['volume'].tail(5).mean()
                 
                 if recent_volume > avg_volume_20 * 1.5:
                     score_factors.append(70)
@@ -402,8 +424,8 @@ class StockAnalyzer:
                     score_factors.append(55)
             
             # Price Trend Analysis
-            if len(df) >= 20:
-                price_20d_ago = df['close'].iloc[-20]
+            if len(features) >= 20:
+                price_20d_ago = features.last('close', 20)
                 price_change_20d = (current_price - price_20d_ago) / price_20d_ago * 100
                 
                 if price_change_20d > 10:
@@ -433,12 +455,12 @@ class StockAnalyzer:
             
         return analysis
     
-    def _analyze_momentum(self, price_df: pd.DataFrame) -> Dict[str, Any]:
+    def _analyze_momentum(self, features: FeatureFrame) -> Dict[str, Any]:
         """
         Analyze price momentum
         
         Args:
-            price_df: DataFrame containing price data
+            features: Price data and its memoized indicators
             
         Returns:
             Dictionary containing momentum analysis results
@@ -450,18 +472,15 @@ class StockAnalyzer:
         }
         
         try:
-            df = price_df.copy()
-            df = df.sort_values('date').reset_index(drop=True)
-            
-            if len(df) < 20:
+            if len(features) < 20:
                 return analysis
             
-            current_price = df['close'].iloc[-1]
+            current_price = features.last('close')
             score_factors = []
             
             # Short-term momentum (5 days)
-            if len(df) >= 5:
-                price_5d = df['close'].iloc[-5]
+            if len(features) >= 5:
+                price_5d = features.last('close', 5)
                 momentum_5d = (current_price - price_5d) / price_5d * 100
                 
                 if momentum_5d > 5:
@@ -482,8 +501,8 @@ class StockAnalyzer:
                 analysis['metrics']['momentum_5d'] = round(momentum_5d, 2)
             
             # Medium-term momentum (20 days)
-            if len(df) >= 20:
-                price_20d = df['close'].iloc[-20]
+            if len(features) >= 20:
+                price_20d = features.last('close', 20)
                 momentum_20d = (current_price - price_20d) / price_20d * 100
                 
                 if momentum_20d > 10:
@@ -504,8 +523,8 @@ class StockAnalyzer:
                 analysis['metrics']['momentum_20d'] = round(momentum_20d, 2)
             
             # Long-term momentum (60 days)
-            if len(df) >= 60:
-                price_60d = df['close'].iloc[-60]
+            if len(features) >= 60:
+                price_60d = features.last('close', 60)
                 momentum_60d = (current_price - price_60d) / price_60d * 100
                 
                 if momentum_60d > 20:
@@ -526,9 +545,8 @@ class StockAnalyzer:
                 analysis['metrics']['momentum_60d'] = round(momentum_60d, 2)
             
             # Volatility analysis
-            if len(df) >= 30:
-                returns = df['close'].pct_change().dropna()
-                volatility = returns.std() * np.sqrt(252) * 100  # Annualized volatility
+            if len(features) >= 30:
+                volatility = features['volatility_annual'] * 100  # Annualized volatility
                 
                 # Lower volatility with positive momentum is better
                 if volatility < 20 and analysis['metrics'].get('momentum_20d', 0) > 0:
@@ -555,13 +573,13 @@ class StockAnalyzer:
             
         return analysis
     
-    def _analyze_sentiment(self, fundamentals: Dict[str, Any], price_df: pd.DataFrame) -> Dict[str, Any]:
+    def _analyze_sentiment(self, fundamentals: Dict[str, Any], features: FeatureFrame) -> Dict[str, Any]:
         """
         Analyze market sentiment indicators
         
         Args:
             fundamentals: Dictionary of fundamental data
-            price_df: DataFrame containing price data
+            features: Price data and its memoized indicators
             
         Returns:
             Dictionary containing sentiment analysis results
@@ -632,8 +650,8 @@ class StockAnalyzer:
                 analysis['factors']['sector_sentiment'] = sector_score
             
             # Price momentum as sentiment proxy
-            if len(price_df) >= 30:
-                recent_returns = price_df['close'].pct_change().tail(30)
+            if len(features) >= 30:
+                recent_returns = features['returns'].tail(30)
                 positive_days = (recent_returns > 0).sum()
                 positive_ratio = positive_days / len(recent_returns)
                 
@@ -651,9 +669,9 @@ class StockAnalyzer:
                 analysis['factors']['performance_sentiment'] = round(positive_ratio * 100, 1)
             
             # Volume sentiment
-            if 'volume' in price_df.columns and len(price_df) >= 20:
-                recent_volume = price_df['volume'].tail(10).mean()
-                avg_volume = price_df['volume'].tail(60).mean()
+            if features.has('volume') and len(features) >= 20:
+                recent_volume = features['volume'].tail(10).mean()
+                avg_volume = features['volume'].tail(60).mean()
                 
                 volume_ratio = recent_volume / avg_volume if avg_volume > 0 else 1
                 
@@ -690,10 +708,10 @@ class StockAnalyzer:
         else:
             return 'STRONG_SELL'
     
-    def _calculate_target_price(self, price_df: pd.DataFrame, fundamentals: Dict[str, Any], overall_score: float) -> Optional[float]:
+    def _calculate_target_price(self, features: FeatureFrame, fundamentals: Dict[str, Any], overall_score: float) -> Optional[float]:
         """Calculate target price based on analysis"""
         try:
-            current_price = float(price_df['close'].iloc[-1])
+            current_price = float(features.last('close'))
             
             # Base adjustment on overall score
             if overall_score >= 80:
@@ -722,15 +740,14 @@ class StockAnalyzer:
             self.logger.warning(f"Error calculating target price: {e}")
             return None
     
-    def _assess_risk(self, price_df: pd.DataFrame, fundamentals: Dict[str, Any], technical_analysis: Dict[str, Any]) -> str:
+    def _assess_risk(self, features: FeatureFrame, fundamentals: Dict[str, Any], technical_analysis: Dict[str, Any]) -> str:
         """Assess risk level"""
         try:
             risk_factors = []
             
             # Volatility risk
-            if len(price_df) >= 30:
-                returns = price_df['close'].pct_change().dropna()
-                volatility = returns.std() * np.sqrt(252)
+            if len(features) >= 30:
+                volatility = features['volatility_annual']
                 
                 if volatility > 0.4:
                     risk_factors.append('HIGH')
@@ -15,6 +15,60 @@ import finnhub
 from alpha_vantage.timeseries import TimeSeries
 from alpha_vantage.fundamentaldata import FundamentalData
 import json
+import random
+import threading
+from concurrent.futures import ThreadPoolExecutor, wait, FIRST_COMPLETED
+
+try:
+    import runtime_metrics as metrics
+except ImportError:  # repository root not on sys.path
+    from . import metrics_noop as metrics
+
+# Default per-provider limits: sustained requests/second and burst size
+DEFAULT_RATE_LIMITS = {
+    'yahoo': {'rate': 2.0, 'burst': 5},
+    'alpha_vantage': {'rate': 5 / 60.0, 'burst': 1},   # Free tier: 5 requests/minute
+    'finnhub': {'rate': 1.0, 'burst': 5}               # Free tier: 60 requests/minute
+}
+
+
+class TokenBucket:
+    """
+    Thread-safe token bucket rate limiter
+    
+    Tokens refill continuously at `rate` per second up to `burst`; acquire()
+    blocks the calling worker until enough tokens are available, so every
+    thread sharing a bucket is held to the provider's limit together. A cost
+    larger than the bucket is taken one bucketful at a time, so it is still
+    charged in full.
+    """
+    
+    def __init__(self, rate: float, burst: float):
+        self.rate = float(rate)
+        self.capacity = float(max(burst, 1))
+        self.tokens = self.capacity
+        self.updated = time.monotonic()
+        self.lock = threading.Lock()
+    
+    def acquire(self, tokens: float = 1.0) -> float:
+        """Take `tokens`, waiting as needed. Returns seconds waited."""
+        remaining = float(tokens)
+        waited = 0.0
+        while remaining > 0:
+            chunk = min(remaining, self.capacity)
+            with self.lock:
+                now = time.monotonic()
+                self.tokens = min(self.capacity, self.tokens + (now - self.updated) * self.rate)
+                self.updated = now
+                if self.tokens >= chunk:
+                    self.tokens -= chunk
+                    remaining -= chunk
+                    continue
+                delay = (chunk - self.tokens) / self.rate
+            time.sleep(delay)
+            waited += delay
+        return waited
+
 
 class StockDataFetcher:
     def __init__(self, config: Dict[str, Any]):
@@ -37,6 +91,20 @@ class StockDataFetcher:
         if config.get('API_KEYS', {}).get('alpha_vantage'):
             self.av_client = TimeSeries(key=config['API_KEYS']['alpha_vantage'])
             self.av_fundamentals = FundamentalData(key=config['API_KEYS']['alpha_vantage'])
+        
+        # Fetch pipeline settings: per-provider token buckets, retries, concurrency
+        fetch_config = config.get('FETCH_CONFIG', {})
+        self.max_retries = fetch_config.get('max_retries', 2)
+        self.backoff_base = fetch_config.get('backoff_base', 0.5)
+        self.backoff_max = fetch_config.get('backoff_max', 8.0)
+        self.max_workers = fetch_config.get('max_workers', 8)
+        
+        rate_limits = dict(DEFAULT_RATE_LIMITS)
+        rate_limits.update(fetch_config.get('rate_limits', {}))
+        self.rate_limiters = {
+            provider: TokenBucket(limits['rate'], limits['burst'])
+            for provider, limits in rate_limits.items()
+        }
     
     def get_stock_data(self, symbol: str, period: str = "1y", include_fundamentals: bool = True) -> Dict[str, Any]:
         """
@@ -60,16 +128,11 @@ class StockDataFetcher:
         }
         
         try:
-            # Primary: Yahoo Finance
-            result = self._fetch_yahoo_data(symbol, period, include_fundamentals)
-            
-            if result['price_data'].empty:
-                # Fallback: Alpha Vantage
-                result = self._fetch_alpha_vantage_data(symbol, period, include_fundamentals)
-                
-            if result['price_data'].empty:
-                # Fallback: Finnhub
-                result = self._fetch_finnhub_data(symbol, period, include_fundamentals)
+            # Yahoo Finance, then Alpha Vantage, then Finnhub (configured providers only)
+            for provider, fetch in self._provider_chain():
+                result = self._fetch_with_retry(provider, fetch, symbol, period, include_fundamentals)
+                if not result['price_data'].empty:
+                    break
                 
         except Exception as e:
             self.logger.error(f"Error fetching data for {symbol}: {e}")
@@ -77,6 +140,52 @@ class StockDataFetcher:
             
         return result
     
+    def _provider_chain(self) -> List[Tuple[str, Any]]:
+        """Providers in failover order, skipping those without credentials"""
+        chain = [('yahoo', self._fetch_yahoo_data)]
+        if self.av_client:
+            chain.append(('alpha_vantage', self._fetch_alpha_vantage_data))
+        if self.finnhub_client:
+            chain.append(('finnhub', self._fetch_finnhub_data))
+        return chain
+    
+    def _request_cost(self, provider: str, include_fundamentals: bool) -> int:
+        """API calls one fetch makes against a provider's limit"""
+        if not include_fundamentals:
+            return 1
+        return 3 if provider == 'finnhub' else 2
+    
+    def _fetch_with_retry(self, provider: str, fetch, symbol: str, period: str,
+                          include_fundamentals: bool) -> Dict[str, Any]:
+        """
+        Call one provider under its rate limit, retrying failures with jittered exponential backoff
+        
+        An empty result without an error (unknown symbol) is not retried.
+        """
+        limiter = self.rate_limiters.get(provider)
+        attempt = 0
+        
+        while True:
+            if limiter:
+                waited = limiter.acquire(self._request_cost(provider, include_fundamentals))
+                metrics.observe('provider_rate_limit_wait_seconds', waited, provider=provider)
+            
+            with metrics.span('price_provider_fetch', provider=provider) as span:
+                result = fetch(symbol, period, include_fundamentals)
+                if not result['price_data'].empty:
+                    span.label(outcome='ok')
+                else:
+                    span.label(outcome='empty' if result['error'] is None else 'error')
+            if result['error'] is None or not result['price_data'].empty or attempt >= self.max_retries:
+                return result
+            
+            # Full jitter keeps retrying workers from synchronizing
+            delay = random.uniform(0, min(self.backoff_max, self.backoff_base * (2 ** attempt)))
+            self.logger.info(f"{provider} failed for {symbol}, retrying in {delay:.2f}s: {result['error']}")
+            time.sleep(delay)
+            metrics.increment('provider_retries_total', provider=provider)
+            attempt += 1
+    
     def _fetch_yahoo_data(self, symbol: str, period: str, include_fundamentals: bool) -> Dict[str, Any]:
         """Fetch data from Yahoo Finance"""
         result = {
@@ -364,7 +473,63 @@ class StockDataFetcher:
                 'PFE', 'INTC', 'ABT', 'TMO', 'COST', 'CVX', 'MRK', 'AVGO', 'XOM'
             ]
     
-    def batch_fetch_data(self, symbols: List[str], period: str = "1y", max_workers: int = 5) -> Dict[str, Dict]:
+    def stream_fetch_data(self, symbols: List[str], period: str = "1y", max_workers: Optional[int] = None,
+                          include_fundamentals: bool = True):
+        """
+        Fetch data for many symbols, yielding (symbol, data) as each completes
+        
+        Work runs on a bounded worker pool, with at most 2 x max_workers
+        symbols in flight, so large universes aren't queued all at once.
+        Throughput is governed by the per-provider token buckets rather than
+        fixed sleeps, and every symbol fails over through the provider chain
+        on its own.
+        
+        Args:
+            symbols: List of stock symbols
+            period: Time period for price data
+            max_workers: Maximum number of concurrent requests (default: FETCH_CONFIG max_workers)
+            include_fundamentals: Whether to fetch fundamental data
+            
+        Yields:
+            (symbol, data) tuples in completion order
+        """
+        max_workers = max_workers or self.max_workers
+        pending_symbols = iter(symbols)
+        
+        with ThreadPoolExecutor(max_workers=max_workers) as executor:
+            in_flight = {}
+            
+            def submit_next() -> bool:
+                symbol = next(pending_symbols, None)
+                if symbol is None:
+                    return False
+                in_flight[executor.submit(self.get_stock_data, symbol, period, include_fundamentals)] = symbol
+                return True
+            
+            for _ in range(max_workers * 2):
+                if not submit_next():
+                    break
+            
+            while in_flight:
+                done, _ = wait(in_flight, return_when=FIRST_COMPLETED)
+                for future in done:
+                    symbol = in_flight.pop(future)
+                    try:
+                        data = future.result()
+                    except Exception as e:
+                        self.logger.error(f"Failed to fetch data for {symbol}: {e}")
+                        data = {
+                            'symbol': symbol,
+                            'price_data': pd.DataFrame(),
+                            'fundamentals': {},
+                            'info': {},
+                            'error': str(e),
+                            'source': 'error'
+                        }
+                    submit_next()
+                    yield symbol, data
+    
+    def batch_fetch_data(self, symbols: List[str], period: str = "1y", max_workers: Optional[int] = None) -> Dict[str, Dict]:
         """
         Fetch data for multiple symbols concurrently
         
@@ -376,37 +541,7 @@ class StockDataFetcher:
         Returns:
             Dictionary with symbol as key and data as value
         """
-        import concurrent.futures
-        
-        results = {}
-        
-        def fetch_single(symbol):
-            return symbol, self.get_stock_data(symbol, period)
-        
-        with concurrent.futures.ThreadPoolExecutor(max_workers=max_workers) as executor:
-            # Submit all tasks
-            futures = {executor.submit(fetch_single, symbol): symbol for symbol in symbols}
-            
-            # Collect results
-            for future in concurrent.futures.as_completed(futures):
-                try:
-                    symbol, data = future.result()
-                    results[symbol] = data
-                    
-                    # Rate limiting
-                    time.sleep(0.1)
-                    
-                except Exception as e:
-                    symbol = futures[future]
-                    self.logger.error(f"Failed to fetch data for {symbol}: {e}")
-                    results[symbol] = {
-                        'symbol': symbol,
-                        'price_data': pd.DataFrame(),
-                        'fundamentals': {},
-                        'info': {},
-                        'error': str(e),
-                        'source': 'error'
-                    }
+        results = dict(self.stream_fetch_data(symbols, period, max_workers))
         
         self.logger.info(f"Batch fetched data for {len(results)} symbols")
         return results
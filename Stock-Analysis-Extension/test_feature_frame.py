@@ -0,0 +1,83 @@
+"""
+Tests for the FeatureFrame cache
+
+A cached FeatureFrame must give exactly the features an uncached one
+computes for the same data, and a changed or new last bar must not be
+served from the cache.
+
+Run from Stock-Analysis-Extension: python -m unittest test_feature_frame
+"""
+
+import unittest
+
+import numpy as np
+import pandas as pd
+
+from modules.feature_frame import FeatureFrame, FeatureFrameCache
+
+FEATURES = sorted(name[len('_compute_'):] for name in dir(FeatureFrame) if name.startswith('_compute_'))
+
+
+def price_frame(bars=120, seed=3):
+    rng = np.random.default_rng(seed)
+    close = 20 * np.exp(np.cumsum(rng.normal(0, 0.02, bars)))
+    return pd.DataFrame({
+        'date': pd.date_range('2024-01-01', periods=bars, freq='B'),
+        'open': close * 0.99,
+        'high': close * 1.01,
+        'low': close * 0.98,
+        'close': close,
+        'volume': rng.integers(10_000, 50_000, bars).astype(float),
+    })
+
+
+class FeatureFrameCacheTest(unittest.TestCase):
+
+    def assertSameFeatures(self, frame, expected):
+        for name in FEATURES:
+            if isinstance(expected[name], pd.Series):
+                pd.testing.assert_series_equal(frame[name], expected[name], obj=name)
+            else:
+                np.testing.assert_equal(frame[name], expected[name], err_msg=name)
+
+    def test_hit_returns_the_uncached_features(self):
+        cache = FeatureFrameCache()
+        df = price_frame()
+
+        first = cache.get('ABC', df)
+        for name in FEATURES:
+            first[name]
+        second = cache.get('ABC', df.copy())
+
+        self.assertIs(second, first)
+        self.assertEqual({'hits': 1, 'misses': 1}, cache.stats)
+        self.assertSameFeatures(second, FeatureFrame(df.copy()))
+
+    def test_revised_last_bar_is_recomputed(self):
+        cache = FeatureFrameCache()
+        df = price_frame()
+        stale = cache.get('ABC', df)
+        stale_rsi = stale['rsi']
+
+        revised = df.copy()
+        revised.loc[revised.index[-1], 'close'] *= 1.05
+        fresh = cache.get('ABC', revised)
+
+        self.assertIsNot(fresh, stale)
+        self.assertEqual(2, cache.stats['misses'])
+        self.assertSameFeatures(fresh, FeatureFrame(revised.copy()))
+        self.assertNotEqual(stale_rsi.iloc[-1], fresh['rsi'].iloc[-1])
+
+    def test_new_bar_is_recomputed(self):
+        cache = FeatureFrameCache()
+        df = price_frame(121)
+        cache.get('ABC', df.iloc[:-1])
+
+        fresh = cache.get('ABC', df)
+
+        self.assertEqual(2, cache.stats['misses'])
+        self.assertSameFeatures(fresh, FeatureFrame(df.copy()))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,55 @@
+"""
+Tests for the fetch pipeline's TokenBucket rate limiter
+
+Runs on a simulated clock: sleeping advances time instead of blocking.
+
+Run from Stock-Analysis-Extension: python -m unittest test_stock_data_fetcher
+"""
+
+import unittest
+from unittest import mock
+
+from modules import stock_data_fetcher
+from modules.stock_data_fetcher import TokenBucket
+
+
+class FakeClock:
+
+    def __init__(self):
+        self.now = 0.0
+
+    def monotonic(self):
+        return self.now
+
+    def sleep(self, seconds):
+        self.now += seconds
+
+
+class TokenBucketTest(unittest.TestCase):
+
+    def setUp(self):
+        self.clock = FakeClock()
+        patcher = mock.patch.object(stock_data_fetcher, 'time', self.clock)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+    def test_cost_above_burst_is_charged_in_full(self):
+        # Alpha Vantage free tier: two calls per fetch when fundamentals are requested
+        bucket = TokenBucket(rate=5 / 60.0, burst=1)
+
+        bucket.acquire(2)
+        bucket.acquire(2)
+
+        self.assertGreaterEqual(self.clock.now, 36.0 - 1e-6)
+
+    def test_burst_is_served_without_waiting(self):
+        bucket = TokenBucket(rate=1.0, burst=5)
+
+        waited = sum(bucket.acquire() for _ in range(5))
+
+        self.assertEqual(waited, 0.0)
+        self.assertAlmostEqual(bucket.acquire(), 1.0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -9,11 +9,14 @@ require_once 'DatabaseConfig.php';
 require_once __DIR__ . '/JobLogger.php';
 
 require_once __DIR__ . '/src/IStockTableManager.php';
+require_once __DIR__ . '/src/SymbolRegistryCache.php';
 
 class StockTableManager implements IStockTableManager
 {
     private $pdo;
     private $logger;
+    private $registryCache;
+    private $tableNameCache = [];
     
     // Table templates for each stock symbol
     private $tableTemplates = [
@@ -169,11 +172,13 @@ class StockTableManager implements IStockTableManager
     
     public function __construct()
     {
-        $this->pdo = DatabaseConfig::createLegacyConnection();
+        $this->pdo = DatabaseConfig::getLegacyConnection();
         $this->logger = new JobLogger('logs/table_manager.log');
         
         // Ensure we have the stock symbol registry table
         $this->createSymbolRegistryTable();
+        
+        $this->registryCache = new SymbolRegistryCache($this->pdo, DatabaseConfig::getCacheConfig(), $this->logger);
     }
     
     /**
@@ -252,6 +257,7 @@ class StockTableManager implements IStockTableManager
             $stmt->execute([$symbol]);
             
             $this->pdo->commit();
+            $this->registryCache->invalidate();
             
             $this->logger->info("Successfully registered symbol: {$symbol}");
             
@@ -303,24 +309,47 @@ class StockTableManager implements IStockTableManager
         }
         
         $symbol = strtoupper(trim($symbol));
-        $sanitizedSymbol = $this->sanitizeSymbolForTableName($symbol);
+        $cacheKey = $symbol . '|' . $tableType;
         
-        return $sanitizedSymbol . $this->tableTemplates[$tableType]['suffix'];
+        if (!isset($this->tableNameCache[$cacheKey])) {
+            $sanitizedSymbol = $this->sanitizeSymbolForTableName($symbol);
+            $this->tableNameCache[$cacheKey] = $sanitizedSymbol . $this->tableTemplates[$tableType]['suffix'];
+        }
+        
+        return $this->tableNameCache[$cacheKey];
     }
     
     /**
-     * Check if tables exist for a symbol
+     * Check if tables exist for a symbol (served from the registry cache)
      */
     public function tablesExistForSymbol($symbol)
     {
-        $symbol = strtoupper(trim($symbol));
+        return $this->registryCache->tablesExist(strtoupper(trim($symbol)));
+    }
+    
+    /**
+     * Resolve which of the given symbols have tables, from the registry cache
+     * and at most one query for symbols it has not seen
+     */
+    public function getSymbolsWithTables(array $symbols)
+    {
+        $symbols = array_values(array_unique(array_map(function ($symbol) {
+            return strtoupper(trim($symbol));
+        }, $symbols)));
         
-        $sql = "SELECT tables_created FROM stock_symbol_registry WHERE symbol = ?";
-        $stmt = $this->pdo->prepare($sql);
-        $stmt->execute([$symbol]);
+        if (empty($symbols)) {
+            return [];
+        }
         
-        $result = $stmt->fetchColumn();
-        return $result === '1' || $result === 1 || $result === true;
+        return $this->registryCache->getSymbolsWithTables($symbols);
+    }
+    
+    /**
+     * Drop the cached registry snapshot (all processes when shared)
+     */
+    public function invalidateRegistryCache()
+    {
+        $this->registryCache->invalidate();
     }
     
     /**
@@ -374,6 +403,7 @@ class StockTableManager implements IStockTableManager
         $sql = "UPDATE stock_symbol_registry SET tables_created = FALSE WHERE symbol = ?";
         $stmt = $this->pdo->prepare($sql);
         $stmt->execute([$symbol]);
+        $this->registryCache->invalidate();
         
         return $droppedTables;
     }
@@ -388,6 +418,7 @@ class StockTableManager implements IStockTableManager
         $sql = "UPDATE stock_symbol_registry SET status = 'INACTIVE' WHERE symbol = ?";
         $stmt = $this->pdo->prepare($sql);
         $result = $stmt->execute([$symbol]);
+        $this->registryCache->invalidate();
         
         if ($result) {
             $this->logger->info("Deactivated symbol: {$symbol}");
@@ -0,0 +1,195 @@
+"""Background batch writer.
+
+Moves slow persistence (database inserts, log files) off the caller's
+thread. Items are queued by ``submit`` and handed to a handler in batches
+on a single daemon thread, so the handler may keep its own connection
+without any locking.
+
+With a ``spool_path``, batches the handler fails on (e.g. the database is
+down) are appended to that file as JSON lines and replayed after the next
+successful write, so nothing is lost while the target is unavailable.
+Pending items are flushed at interpreter exit.
+
+Usage:
+    writer = BackgroundWriter(lambda rows: insert_many(rows), name='llm-log',
+                              spool_path='automation_micro_cap/db_spool.jsonl')
+    writer.submit(row)
+    ...
+    writer.flush()   # wait until everything queued so far is handled
+"""
+
+from __future__ import annotations
+
+import atexit
+import json
+import logging
+import os
+import queue
+import threading
+import time
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Optional, Union
+
+
+class BackgroundWriter:
+    """Queue items and write them in batches on a daemon thread."""
+
+    def __init__(self,
+                 handler: Callable[[List[Any]], None],
+                 name: str = 'background-writer',
+                 max_batch: int = 50,
+                 flush_interval: float = 1.0,
+                 max_queue: int = 10000,
+                 spool_path: Optional[Union[str, Path]] = None,
+                 shutdown_timeout: float = 10.0):
+        """
+        Args:
+            handler: Called on the writer thread with a list of 1..max_batch items.
+                Raising means the batch was not written.
+            name: Thread name, also used in log messages.
+            max_batch: Largest batch handed to the handler.
+            flush_interval: Longest an item waits for more items to batch with.
+            max_queue: Bound on queued items. When full, items are spooled
+                (or dropped without a spool) instead of blocking the caller.
+            spool_path: JSON-lines file for batches that could not be written.
+                Items must then be JSON-serializable (datetimes become strings).
+            shutdown_timeout: Longest the exit-time flush waits.
+        """
+        self.handler = handler
+        self.name = name
+        self.max_batch = max_batch
+        self.flush_interval = flush_interval
+        self.spool_path = Path(spool_path) if spool_path else None
+        self.shutdown_timeout = shutdown_timeout
+        self.logger = logging.getLogger(__name__)
+
+        self._queue: queue.Queue = queue.Queue(maxsize=max_queue)
+        self._thread: Optional[threading.Thread] = None
+        self._lock = threading.Lock()
+        self._spool_lock = threading.Lock()
+        self._closed = False
+        self.stats = {'submitted': 0, 'written': 0, 'failed': 0, 'dropped': 0, 'spooled': 0, 'replayed': 0}
+
+    def submit(self, item: Any) -> bool:
+        """Queue an item without blocking. Returns False if it was not queued."""
+        if self._closed:
+            self.stats['dropped'] += 1
+            return False
+
+        self._ensure_started()
+        try:
+            self._queue.put_nowait(item)
+        except queue.Full:
+            if self.spool_path:
+                self._spool([item])
+            else:
+                self.stats['dropped'] += 1
+                self.logger.warning(f"{self.name}: queue full, dropping item")
+            return False
+
+        self.stats['submitted'] += 1
+        return True
+
+    def flush(self, timeout: Optional[float] = None) -> bool:
+        """Wait until every item submitted so far has been handled.
+
+        Returns False if the timeout expired first.
+        """
+        if self._thread is None:
+            return True
+
+        deadline = None if timeout is None else time.time() + timeout
+        with self._queue.all_tasks_done:
+            while self._queue.unfinished_tasks:
+                remaining = None if deadline is None else deadline - time.time()
+                if remaining is not None and remaining <= 0:
+                    return False
+                self._queue.all_tasks_done.wait(remaining)
+        return True
+
+    def close(self):
+        """Flush (bounded by shutdown_timeout) and stop accepting items."""
+        if self._closed:
+            return
+        if not self.flush(self.shutdown_timeout):
+            self.logger.warning(f"{self.name}: {self._queue.unfinished_tasks} items still pending at shutdown")
+        self._closed = True
+
+    def get_stats(self) -> Dict[str, int]:
+        """Counters plus the number of queued items."""
+        return dict(self.stats, pending=self._queue.qsize())
+
+    def _ensure_started(self):
+        if self._thread is not None:
+            return
+        with self._lock:
+            if self._thread is None:
+                self._thread = threading.Thread(target=self._run, name=self.name, daemon=True)
+                self._thread.start()
+                atexit.register(self.close)
+
+    def _run(self):
+        while True:
+            batch = [self._queue.get()]
+            while len(batch) < self.max_batch:
+                try:
+                    batch.append(self._queue.get(timeout=self.flush_interval))
+                except queue.Empty:
+                    break
+
+            try:
+                self._write(batch)
+            finally:
+                for _ in batch:
+                    self._queue.task_done()
+
+    def _write(self, batch: List[Any]):
+        try:
+            self.handler(batch)
+        except Exception as e:
+            if self.spool_path:
+                self.logger.warning(f"{self.name}: write failed ({e}); spooling {len(batch)} items")
+                self._spool(batch)
+            else:
+                self.stats['failed'] += len(batch)
+                self.logger.error(f"{self.name}: failed to write {len(batch)} items: {e}")
+            return
+
+        self.stats['written'] += len(batch)
+        if self.spool_path and self.spool_path.exists():
+            self._replay_spool()
+
+    def _spool(self, items: List[Any]):
+        try:
+            with self._spool_lock, open(self.spool_path, 'a', encoding='utf-8') as handle:
+                for item in items:
+                    handle.write(json.dumps(item, default=str) + '\n')
+            self.stats['spooled'] += len(items)
+        except OSError as e:
+            self.stats['failed'] += len(items)
+            self.logger.error(f"{self.name}: could not spool {len(items)} items: {e}")
+
+    def _replay_spool(self):
+        """Write spooled items back through the handler; keep whatever still fails."""
+        replaying = self.spool_path.with_name(self.spool_path.name + '.replay')
+        with self._spool_lock:
+            try:
+                os.replace(self.spool_path, replaying)
+            except OSError:
+                return
+
+        with open(replaying, 'r', encoding='utf-8') as handle:
+            items = [json.loads(line) for line in handle if line.strip()]
+        os.unlink(replaying)
+
+        for start in range(0, len(items), self.max_batch):
+            chunk = items[start:start + self.max_batch]
+            try:
+                self.handler(chunk)
+            except Exception as e:
+                self.logger.warning(f"{self.name}: replay stopped ({e}); {len(items) - start} items kept")
+                self._spool(items[start:])
+                return
+            self.stats['replayed'] += len(chunk)
+
+        self.logger.info(f"{self.name}: replayed {len(items)} spooled items")
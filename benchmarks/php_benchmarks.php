@@ -0,0 +1,22 @@
+#!/usr/bin/env php
+<?php
+/**
+ * PHP Benchmarks
+ * Times the indicator pass, per-symbol price storage and queue round trips
+ * and prints the results as JSON. Normally run by run_benchmarks.py, which
+ * writes the price fixture and compares the results against a baseline.
+ *
+ * Usage: php php_benchmarks.php --prices=FILE [--passes=N] [--db] [--read-passes=N]
+ *                               [--backends=database,redis,rabbitmq,mqtt] [--workers=1,4]
+ *                               [--jobs=N] [--queue-db=sqlite|mysql] [--queue-config=FILE]
+ *                               [--work-us=N] [--timeout=SECONDS]
+ */
+
+if (php_sapi_name() !== 'cli') {
+    die("This script must be run from the command line\n");
+}
+
+require_once __DIR__ . '/../src/BenchmarkCliHandler.php';
+
+$handler = new BenchmarkCliHandler();
+exit($handler->run($argv));
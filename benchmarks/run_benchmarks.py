@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+"""
+Benchmark Suite
+
+Repeatable timings for the hot paths, compared against a stored baseline so
+regressions show up before a deploy:
+
+- StockAnalyzer.analyze_stock scans per second (cold and feature-cache warm)
+- TechnicalAnalysisJobProcessor indicators per second over N symbols x M bars
+- DynamicStockDataAccess insert (single vs bulk) and read throughput (--db)
+- job latency and throughput per queue backend under K workers
+
+Every run uses the same seeded random walk as generate_sample_price_data
+(scripts/sample_data.py). The PHP benchmarks run in benchmarks/php_benchmarks.php.
+Results are written as JSON, and any result more than --tolerance worse than
+the baseline fails the run with exit code 1.
+
+Usage:
+    python3 benchmarks/run_benchmarks.py [--symbols N] [--bars M] [--workers 1,4]
+                                         [--backends database,redis] [--db]
+    python3 benchmarks/run_benchmarks.py --save-baseline
+"""
+
+import argparse
+import csv
+import json
+import logging
+import math
+import platform
+import random
+import subprocess
+import sys
+import tempfile
+import time
+from datetime import datetime
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(ROOT))  # runtime_metrics, imported by the analyzer modules
+sys.path.insert(0, str(ROOT / 'scripts'))
+
+from sample_data import PRICE_COLUMNS, sample_price_records  # noqa: E402
+
+logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(levelname)s - %(message)s')
+logger = logging.getLogger(__name__)
+
+BENCHMARK_DIR = Path(__file__).resolve().parent
+DEFAULT_BASELINE = BENCHMARK_DIR / 'baseline.json'
+DEFAULT_OUTPUT = BENCHMARK_DIR / 'results' / 'latest.json'
+
+# Fixed first day so a seed always produces the same fixture
+FIXTURE_START = datetime(2020, 1, 1)
+
+
+def result(value, unit, higher_is_better=True):
+    """One benchmark result, in the shape php_benchmarks.php also emits."""
+    return {'value': round(value, 4), 'unit': unit, 'higher_is_better': higher_is_better}
+
+
+def build_fixture(symbol_count, bars, seed):
+    """symbol -> the last `bars` weekday bars of the sample random walk.
+
+    Symbols start with BENCH, the prefix the data access benchmark is allowed
+    to create and drop tables for.
+    """
+    symbols = [f"BENCH{i:03d}" for i in range(symbol_count)]
+    days = math.ceil(bars * 7 / 5) + 7
+    return {
+        symbol: records[-bars:]
+        for symbol, records in sample_price_records(symbols, days, seed, FIXTURE_START)
+    }
+
+
+def write_fixture_csv(fixture, path):
+    with open(path, 'w', newline='') as handle:
+        writer = csv.writer(handle)
+        writer.writerow(PRICE_COLUMNS)
+        for records in fixture.values():
+            for record in records:
+                writer.writerow([record[0], record[1].isoformat()] + list(record[2:]))
+
+
+def bench_stock_analyzer(fixture, seed, passes):
+    """StockAnalyzer.analyze_stock over every fixture symbol.
+
+    The cold pass uses a fresh analyzer for each pass, so indicators are
+    computed from scratch; the warm pass re-scans unchanged data, which the
+    FeatureFrameCache serves.
+    """
+    sys.path.insert(0, str(ROOT / 'Stock-Analysis-Extension'))
+    import pandas as pd
+    from modules.stock_analyzer import StockAnalyzer
+
+    # One INFO line per scan would dominate the timing
+    logging.getLogger('modules.stock_analyzer').setLevel(logging.WARNING)
+
+    rng = random.Random(seed)
+    stocks = []
+    for symbol, records in fixture.items():
+        stocks.append({
+            'symbol': symbol,
+            'price_data': pd.DataFrame.from_records(records, columns=PRICE_COLUMNS),
+            'fundamentals': {
+                'pe_ratio': rng.uniform(5, 40),
+                'price_to_book': rng.uniform(0.5, 6),
+                'return_on_equity': rng.uniform(-0.1, 0.35),
+                'debt_to_equity': rng.uniform(0, 2.5),
+                'profit_margin': rng.uniform(-0.05, 0.3),
+                'revenue_growth': rng.uniform(-0.1, 0.4),
+                'current_ratio': rng.uniform(0.5, 3),
+                'market_cap': rng.uniform(5e7, 2e9),
+                'analyst_rating': rng.choice(['BUY', 'HOLD', 'SELL']),
+                'sector': rng.choice(['Technology', 'Healthcare', 'Energy', 'Financial Services'])
+            }
+        })
+
+    cold_elapsed = 0.0
+    warm_elapsed = 0.0
+    for _ in range(passes):
+        analyzer = StockAnalyzer({})
+
+        started = time.perf_counter()
+        analyses = [analyzer.analyze_stock(stock) for stock in stocks]
+        cold_elapsed += time.perf_counter() - started
+
+        failed = [a['symbol'] for a in analyses if a['error']]
+        if failed:
+            raise RuntimeError(f"analyze_stock failed for {', '.join(failed)}: {analyses[0]['error']}")
+
+        started = time.perf_counter()
+        for stock in stocks:
+            analyzer.analyze_stock(stock)
+        warm_elapsed += time.perf_counter() - started
+
+    scans = len(stocks) * passes
+    return {
+        'analyzer.scans_per_sec': result(scans / cold_elapsed, 'scans/s'),
+        'analyzer.cached_scans_per_sec': result(scans / warm_elapsed, 'scans/s')
+    }
+
+
+def run_php_benchmarks(args, fixture_csv):
+    """Run php_benchmarks.php and return its parsed JSON document."""
+    command = [
+        args.php, str(BENCHMARK_DIR / 'php_benchmarks.php'),
+        f"--prices={fixture_csv}",
+        f"--passes={args.passes}",
+        f"--backends={args.backends}",
+        f"--workers={args.workers}",
+        f"--jobs={args.jobs}",
+        f"--queue-db={args.queue_db}",
+        f"--work-us={args.work_us}",
+        f"--timeout={args.timeout}"
+    ]
+    if args.db:
+        command.append('--db')
+    if args.queue_config:
+        command.append(f"--queue-config={args.queue_config}")
+
+    completed = subprocess.run(command, cwd=ROOT, capture_output=True, text=True)
+    if completed.returncode != 0:
+        raise RuntimeError(f"php_benchmarks.php exited with {completed.returncode}: {completed.stderr.strip()}")
+    return json.loads(completed.stdout)
+
+
+def compare_to_baseline(results, baseline, tolerance):
+    """Annotate results with their baseline and return the regressions.
+
+    A result regresses when it is more than `tolerance` (a fraction) worse
+    than its baseline, in whichever direction is worse for it.
+    """
+    regressions = []
+    for name, current in results.items():
+        base = baseline.get('results', {}).get(name)
+        if not base or not base.get('value'):
+            continue
+
+        change = (current['value'] - base['value']) / base['value']
+        current['baseline'] = base['value']
+        current['change_pct'] = round(change * 100, 1)
+
+        worse_by = -change if current['higher_is_better'] else change
+        if worse_by > tolerance:
+            regressions.append(name)
+    return regressions
+
+
+def git_revision():
+    try:
+        return subprocess.run(['git', 'rev-parse', '--short', 'HEAD'], cwd=ROOT,
+                              capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def print_summary(results, skipped, regressions):
+    width = max((len(name) for name in results), default=10)
+    for name in sorted(results):
+        current = results[name]
+        line = f"{name:<{width}}  {current['value']:>14,.2f} {current['unit']}"
+        if 'change_pct' in current:
+            line += f"  ({current['change_pct']:+.1f}% vs baseline)"
+        if name in regressions:
+            line += "  REGRESSION"
+        print(line)
+    for name, reason in sorted(skipped.items()):
+        print(f"{name:<{width}}  skipped: {reason}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run the benchmark suite and compare against a baseline')
+    parser.add_argument('--symbols', type=int, default=20, help='Fixture symbols (N)')
+    parser.add_argument('--bars', type=int, default=500, help='Bars per symbol (M)')
+    parser.add_argument('--seed', type=int, default=42, help='Random walk seed')
+    parser.add_argument('--passes', type=int, default=3, help='Repetitions of the analyzer and indicator benchmarks')
+    parser.add_argument('--db', action='store_true',
+                        help='Also benchmark DynamicStockDataAccess against the database in db_config.yml')
+    parser.add_argument('--backends', default='database', help='Queue backends: database,redis,rabbitmq,mqtt')
+    parser.add_argument('--workers', default='1,4', help='Worker counts (K) to run each backend with')
+    parser.add_argument('--jobs', type=int, default=500, help='Jobs per queue benchmark')
+    parser.add_argument('--queue-db', choices=['sqlite', 'mysql'], default='sqlite',
+                        help='Database queue storage: a temporary SQLite file or the legacy MySQL database')
+    parser.add_argument('--queue-config', help='job_processor.yml (needs the yaml extension) or JSON with redis/rabbitmq/mqtt settings')
+    parser.add_argument('--work-us', type=int, default=0, help='Simulated work per job in microseconds')
+    parser.add_argument('--timeout', type=int, default=120, help='Seconds to wait for a queue benchmark to drain')
+    parser.add_argument('--php', default='php', help='PHP CLI binary')
+    parser.add_argument('--skip-php', action='store_true', help='Skip the PHP benchmarks')
+    parser.add_argument('--skip-python', action='store_true', help='Skip the Python benchmarks')
+    parser.add_argument('--output', type=Path, default=DEFAULT_OUTPUT, help='Results file')
+    parser.add_argument('--baseline', type=Path, default=DEFAULT_BASELINE, help='Baseline file')
+    parser.add_argument('--tolerance', type=float, default=0.15,
+                        help='Allowed fraction worse than baseline before failing (default 0.15)')
+    parser.add_argument('--save-baseline', action='store_true', help='Store these results as the new baseline')
+    args = parser.parse_args()
+
+    logger.info(f"Generating fixture: {args.symbols} symbols x {args.bars} bars (seed {args.seed})")
+    fixture = build_fixture(args.symbols, args.bars, args.seed)
+
+    results = {}
+    skipped = {}
+
+    if not args.skip_python:
+        try:
+            results.update(bench_stock_analyzer(fixture, args.seed, args.passes))
+        except ImportError as e:
+            skipped['analyzer'] = f"missing dependency: {e.name}"
+
+    if not args.skip_php:
+        with tempfile.TemporaryDirectory() as tmp:
+            fixture_csv = Path(tmp) / 'prices.csv'
+            write_fixture_csv(fixture, fixture_csv)
+            try:
+                php = run_php_benchmarks(args, fixture_csv)
+                results.update(php['results'])
+                skipped.update(php['skipped'])
+            except (OSError, RuntimeError, ValueError) as e:
+                skipped['php'] = str(e)
+
+    params = {key: getattr(args, key) for key in ('symbols', 'bars', 'seed', 'passes', 'jobs', 'workers', 'work_us')}
+    document = {
+        'meta': {
+            'timestamp': datetime.now().isoformat(timespec='seconds'),
+            'revision': git_revision(),
+            'host': platform.node(),
+            'python': platform.python_version(),
+            'params': params
+        },
+        'results': results,
+        'skipped': skipped
+    }
+
+    regressions = []
+    if args.baseline.exists() and not args.save_baseline:
+        baseline = json.loads(args.baseline.read_text())
+        if baseline.get('meta', {}).get('params') != params:
+            logger.warning("Baseline was recorded with different parameters; comparisons may not be meaningful")
+        regressions = compare_to_baseline(results, baseline, args.tolerance)
+        missing = sorted(set(baseline.get('results', {})) - set(results))
+        if missing:
+            logger.warning(f"Not measured this run (in baseline): {', '.join(missing)}")
+        document['baseline'] = {'revision': baseline.get('meta', {}).get('revision'), 'tolerance': args.tolerance}
+        document['regressions'] = regressions
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text(json.dumps(document, indent=2) + '\n')
+    logger.info(f"Results written to {args.output}")
+
+    if args.save_baseline:
+        args.baseline.write_text(json.dumps(document, indent=2) + '\n')
+        logger.info(f"Baseline saved to {args.baseline}")
+
+    print_summary(results, skipped, regressions)
+
+    if regressions:
+        logger.error(f"{len(regressions)} result(s) regressed more than {args.tolerance:.0%}: {', '.join(regressions)}")
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -46,6 +46,10 @@ from simple_automation import (
 # Import our enhanced trading engine
 from enhanced_trading_script import EnhancedTradingEngine, create_trading_engine
 
+from llm_executor import AsyncLLMExecutor, LLMRequest, LLMResult, LLMUsage
+from llm_cache import LLMResponseCache
+from background_writer import BackgroundWriter
+
 # Database imports
 try:
     import mysql.connector
@@ -82,6 +86,8 @@ class TradingSession:
     starting_equity: float = 0.0
     ending_equity: float = 0.0
     llm_interactions: int = 0
+    llm_tokens_used: int = 0
+    llm_latency: float = 0.0
     errors: List[str] = None
     
     def __post_init__(self):
@@ -128,7 +134,11 @@ class EnhancedAutomationEngine:
                  config_file: Optional[str] = None,
                  max_position_size: float = 0.1,  # Max 10% of portfolio per position
                  risk_tolerance: str = 'moderate',  # 'conservative', 'moderate', 'aggressive'
-                 api_key: Optional[str] = None):  # OpenAI API key for LLM functionality
+                 api_key: Optional[str] = None,  # OpenAI API key for LLM functionality
+                 llm_concurrency: int = 4,
+                 enable_llm_cache: bool = True,
+                 llm_cache_ttl: float = 6 * 3600,
+                 llm_cache_path: Optional[str] = None):
         """
         Initialize the enhanced automation engine.
         
@@ -140,6 +150,10 @@ class EnhancedAutomationEngine:
             max_position_size: Maximum position size as fraction of portfolio
             risk_tolerance: Risk tolerance level
             api_key: OpenAI API key for LLM interactions
+            llm_concurrency: Maximum LLM requests in flight for parallel prompts
+            enable_llm_cache: Reuse responses for prompts built from unchanged inputs
+            llm_cache_ttl: Seconds a cached LLM response stays valid
+            llm_cache_path: SQLite file for the response cache (default: in the automation directory)
         """
         self.market_cap_category = market_cap_category.lower()
         self.enable_database = enable_database and HAS_DB_DEPS
@@ -158,6 +172,10 @@ class EnhancedAutomationEngine:
         self.current_session: Optional[TradingSession] = None
         self.llm_interactions: List[LLMInteraction] = []
         
+        # Parallel LLM calls with per-session token/latency accounting
+        self.llm_usage = LLMUsage()
+        self.llm_executor = AsyncLLMExecutor(api_key, max_concurrency=llm_concurrency, usage=self.llm_usage)
+        
         # Set up data directories
         self.automation_dir = Path(f"automation_{self.market_cap_category}_cap")
         self.automation_dir.mkdir(exist_ok=True)
@@ -165,6 +183,25 @@ class EnhancedAutomationEngine:
         self.sessions_file = self.automation_dir / "trading_sessions.json"
         self.interactions_file = self.automation_dir / "llm_interactions.json"
         
+        # Session and interaction rows are written behind on a background thread
+        # with its own connection; batches that fail while the database is down
+        # are spooled to disk and replayed once writes succeed again
+        self.db_writer = BackgroundWriter(
+            self._write_db_rows,
+            name='automation-db',
+            spool_path=self.automation_dir / "db_spool.jsonl"
+        )
+        self._writer_connection = None
+        
+        # JSON session files are rewritten whole, so they are kept off the trading thread too
+        self.file_writer = BackgroundWriter(self._write_session_files, name='automation-files', max_batch=10)
+        
+        # Responses keyed on prompt type, ticker and quantized inputs
+        self.llm_cache = LLMResponseCache(
+            llm_cache_path or self.automation_dir / "llm_cache.sqlite",
+            ttl_seconds=llm_cache_ttl
+        ) if enable_llm_cache else None
+        
         # Risk management parameters based on market cap category
         self.risk_params = self._get_risk_parameters()
         
@@ -211,6 +248,9 @@ class EnhancedAutomationEngine:
             starting_equity=starting_equity
         )
         
+        self.llm_usage = LLMUsage()
+        self.llm_executor.usage = self.llm_usage
+        
         enhanced_logger.info(f"Started trading session: {session_id}")
         enhanced_logger.info(f"Starting portfolio: {len(portfolio)} positions, ${cash:,.2f} cash, ${starting_equity:,.2f} equity")
         
@@ -230,8 +270,10 @@ class EnhancedAutomationEngine:
         self.current_session.ending_cash = cash
         self.current_session.ending_equity = ending_equity
         self.current_session.total_pnl = ending_equity - self.current_session.starting_equity
+        self.current_session.llm_tokens_used = self.llm_usage.total_tokens
+        self.current_session.llm_latency = self.llm_usage.total_latency
         
-        # Save session data
+        # Save session data (queued; written in the background)
         self._save_session_data()
         
         # Save to database if enabled
@@ -242,53 +284,134 @@ class EnhancedAutomationEngine:
         enhanced_logger.info(f"Session P&L: ${self.current_session.total_pnl:,.2f}")
         enhanced_logger.info(f"Total trades: {self.current_session.total_trades}")
         enhanced_logger.info(f"LLM interactions: {self.current_session.llm_interactions}")
+        enhanced_logger.info(f"LLM usage: {self.llm_usage.to_dict()}")
+        if self.llm_cache:
+            enhanced_logger.info(f"LLM cache: {self.llm_cache.get_stats()}")
         
         self.current_session = None
     
-    def enhanced_ask_gpt(self, prompt: str, prompt_type: str = 'analysis', ticker: Optional[str] = None) -> str:
-        """Enhanced GPT interaction with logging and database storage."""
-        start_time = time.time()
-        interaction_id = f"{datetime.now().strftime('%Y%m%d_%H%M%S_%f')}"
+    def close(self, timeout: float = 10.0):
+        """Flush pending session/interaction writes and release the writer connection."""
+        self.file_writer.flush(timeout)
+        if not self.db_writer.flush(timeout):
+            enhanced_logger.warning(f"Database writes still pending at shutdown: {self.db_writer.get_stats()}")
+        
+        if self._writer_connection is not None:
+            try:
+                self._writer_connection.close()
+            except Exception:
+                pass
+            self._writer_connection = None
+    
+    def enhanced_ask_gpt(self, prompt: str, prompt_type: str = 'analysis', ticker: Optional[str] = None,
+                         cache_inputs: Optional[Any] = None, bypass_cache: bool = False) -> str:
+        """Enhanced GPT interaction with logging and database storage.
+        
+        When cache_inputs (the market data the prompt was built from) is given,
+        a cached response for the same prompt type, ticker and inputs is
+        returned instead of calling the LLM, unless bypass_cache is set.
+        """
+        request = LLMRequest(prompt, prompt_type, ticker, self._cache_key(prompt_type, ticker, cache_inputs))
         
+        cached = self._cached_response(request, bypass_cache)
+        if cached is not None:
+            return cached
+        
+        start_time = time.time()
         try:
             # Use original call_openai_api function - need API key
             if not hasattr(self, 'api_key') or not self.api_key:
                 raise ValueError("API key not configured for LLM interactions")
             response = call_openai_api(prompt, self.api_key)
-            response_time = time.time() - start_time
-            
-            # Create interaction record
-            interaction = LLMInteraction(
-                session_id=self.current_session.session_id if self.current_session else 'no_session',
-                interaction_id=interaction_id,
-                timestamp=datetime.now(),
-                market_cap_category=self.market_cap_category,
-                prompt_type=prompt_type,
-                prompt=prompt,
-                response=response,
-                response_time=response_time,
-                ticker_analyzed=ticker
-            )
-            
-            self.llm_interactions.append(interaction)
-            
-            if self.current_session:
-                self.current_session.llm_interactions += 1
-            
-            # Save to database if enabled
-            if self.trading_engine.db_connected:
-                self._save_interaction_to_database(interaction)
-            
-            enhanced_logger.info(f"LLM interaction completed: {prompt_type} in {response_time:.2f}s")
-            return response
+            result = LLMResult(request=request, response=response, response_time=time.time() - start_time)
             
         except Exception as e:
-            enhanced_logger.error(f"LLM interaction failed: {e}")
+            result = LLMResult(request=request, response=f"Error: {str(e)}",
+                               response_time=time.time() - start_time, error=str(e))
+        
+        self.llm_usage.record(result)
+        self._store_response(result)
+        return self._record_interaction(result)
+    
+    def enhanced_ask_gpt_many(self, requests: List[LLMRequest], bypass_cache: bool = False) -> List[str]:
+        """Send independent prompts concurrently; responses are returned in request order.
+        
+        Requests carrying a cache_key are answered from the cache when possible;
+        only the misses go to the LLM.
+        """
+        responses = [self._cached_response(request, bypass_cache) for request in requests]
+        misses = [request for request, response in zip(requests, responses) if response is None]
+        
+        fresh = iter(self.llm_executor.run_sync(misses))
+        for i, response in enumerate(responses):
+            if response is None:
+                result = next(fresh)
+                self._store_response(result)
+                responses[i] = self._record_interaction(result)
+        
+        return responses
+    
+    def _cache_key(self, prompt_type: str, ticker: Optional[str], inputs: Optional[Any]) -> Optional[str]:
+        """Cache key for a prompt built from inputs, or None when caching does not apply."""
+        if self.llm_cache is None or inputs is None:
+            return None
+        return self.llm_cache.make_key(prompt_type, ticker, {
+            'market_cap_category': self.market_cap_category,
+            'risk_tolerance': self.risk_tolerance,
+            'inputs': inputs
+        })
+    
+    def _cached_response(self, request: LLMRequest, bypass_cache: bool) -> Optional[str]:
+        if bypass_cache or request.cache_key is None:
+            return None
+        
+        response = self.llm_cache.get(request.cache_key)
+        if response is not None:
+            enhanced_logger.info(f"LLM cache hit: {request.prompt_type}" + (f" for {request.ticker}" if request.ticker else ""))
+        return response
+    
+    def _store_response(self, result: LLMResult):
+        """Cache a successful response; API errors are never cached."""
+        if result.request.cache_key is None or not result.ok or result.response.lstrip().startswith('{"error"'):
+            return
+        self.llm_cache.put(result.request.cache_key, result.response, result.request.prompt_type, result.request.ticker)
+    
+    def _record_interaction(self, result: LLMResult) -> str:
+        """Track a finished LLM call and queue it for the database; returns the response."""
+        if not result.ok:
+            enhanced_logger.error(f"LLM interaction failed: {result.error}")
             if self.current_session:
-                self.current_session.errors.append(f"LLM error: {str(e)}")
-            return f"Error: {str(e)}"
+                self.current_session.errors.append(f"LLM error: {result.error}")
+            return result.response
+        
+        # Create interaction record
+        interaction = LLMInteraction(
+            session_id=self.current_session.session_id if self.current_session else 'no_session',
+            interaction_id=f"{datetime.now().strftime('%Y%m%d_%H%M%S_%f')}",
+            timestamp=datetime.now(),
+            market_cap_category=self.market_cap_category,
+            prompt_type=result.request.prompt_type,
+            prompt=result.request.prompt,
+            response=result.response,
+            tokens_used=result.tokens_used,
+            response_time=result.response_time,
+            ticker_analyzed=result.request.ticker
+        )
+        
+        self.llm_interactions.append(interaction)
+        
+        if self.current_session:
+            self.current_session.llm_interactions += 1
+        
+        # Save to database if enabled
+        if self.trading_engine.db_connected:
+            self._save_interaction_to_database(interaction)
+        
+        enhanced_logger.info(f"LLM interaction completed: {result.request.prompt_type} in {result.response_time:.2f}s")
+        return result.response
     
-    def enhanced_portfolio_analysis(self, portfolio: pd.DataFrame, cash: float) -> Dict[str, Any]:
+    def enhanced_portfolio_analysis(self, portfolio: pd.DataFrame, cash: float,
+                                    bypass_cache: bool = False) -> Dict[str, Any]:
         """Enhanced portfolio analysis with market cap specific insights."""
         analysis = {}
         
@@ -316,7 +439,9 @@ class EnhancedAutomationEngine:
         
         # Generate LLM-based analysis
         llm_prompt = self._create_portfolio_analysis_prompt(portfolio, cash, analysis)
-        llm_analysis = self.enhanced_ask_gpt(llm_prompt, 'portfolio_analysis')
+        llm_analysis = self.enhanced_ask_gpt(llm_prompt, 'portfolio_analysis',
+                                             cache_inputs={'portfolio': portfolio, 'cash': cash, 'analysis': analysis},
+                                             bypass_cache=bypass_cache)
         analysis['llm_insights'] = llm_analysis
         
         return analysis
@@ -457,7 +582,8 @@ class EnhancedAutomationEngine:
         
         return prompt
     
-    def enhanced_buy_sell_decision(self, ticker: str, current_data: Dict[str, Any]) -> Dict[str, Any]:
+    def enhanced_buy_sell_decision(self, ticker: str, current_data: Dict[str, Any],
+                                   bypass_cache: bool = False) -> Dict[str, Any]:
         """Enhanced buy/sell decision with risk management."""
         # Load current portfolio
         portfolio, cash = self.trading_engine.load_portfolio_state()
@@ -476,13 +602,56 @@ class EnhancedAutomationEngine:
         )
         
         # Get LLM decision
-        llm_response = self.enhanced_ask_gpt(enhanced_prompt, 'buy_sell', ticker)
+        llm_response = self.enhanced_ask_gpt(
+            enhanced_prompt, 'buy_sell', ticker,
+            cache_inputs=self._buy_sell_cache_inputs(current_data, portfolio, cash, risk_assessment),
+            bypass_cache=bypass_cache
+        )
         
         # Parse and enhance decision
         decision = self._parse_buy_sell_decision(llm_response, risk_assessment)
         
         return decision
     
+    def enhanced_buy_sell_decisions(self, tickers_data: Dict[str, Dict[str, Any]],
+                                    bypass_cache: bool = False) -> Dict[str, Dict[str, Any]]:
+        """enhanced_buy_sell_decision for several tickers, with the LLM prompts issued in parallel.
+        
+        All decisions are made against the same portfolio snapshot, so each is sized as if
+        it were the only trade; callers executing several BUYs must track the cash they spend.
+        """
+        portfolio, cash = self.trading_engine.load_portfolio_state()
+        
+        risk_assessments = {}
+        requests = []
+        for ticker, current_data in tickers_data.items():
+            risk_assessments[ticker] = self._assess_trade_risk(ticker, current_data, portfolio, cash)
+            prompt = self._create_enhanced_buy_sell_prompt(
+                ticker, current_data, portfolio, cash, risk_assessments[ticker]
+            )
+            cache_key = self._cache_key('buy_sell', ticker, self._buy_sell_cache_inputs(
+                current_data, portfolio, cash, risk_assessments[ticker]
+            ))
+            requests.append(LLMRequest(prompt, 'buy_sell', ticker, cache_key))
+        
+        responses = self.enhanced_ask_gpt_many(requests, bypass_cache=bypass_cache)
+        
+        return {
+            request.ticker: self._parse_buy_sell_decision(response, risk_assessments[request.ticker])
+            for request, response in zip(requests, responses)
+        }
+    
+    def _buy_sell_cache_inputs(self, current_data: Dict[str, Any], portfolio: pd.DataFrame,
+                               cash: float, risk_assessment: Dict[str, Any]) -> Dict[str, Any]:
+        """Everything _create_enhanced_buy_sell_prompt reads, for the cache key."""
+        return {
+            'current_data': current_data,
+            'portfolio': portfolio,
+            'cash': cash,
+            'risk_assessment': risk_assessment,
+            'risk_params': self.risk_params
+        }
+    
     def _assess_trade_risk(self, ticker: str, current_data: Dict[str, Any], 
                           portfolio: pd.DataFrame, cash: float) -> Dict[str, Any]:
         """Assess risk for a potential trade."""
@@ -618,8 +787,12 @@ class EnhancedAutomationEngine:
         
         return decision
     
-    def run_automated_trading_session(self, max_trades: int = 3, session_duration_hours: float = 1.0) -> Dict[str, Any]:
-        """Run an automated trading session with enhanced controls."""
+    def run_automated_trading_session(self, max_trades: int = 3, session_duration_hours: float = 1.0,
+                                      fresh_decisions: bool = False) -> Dict[str, Any]:
+        """Run an automated trading session with enhanced controls.
+        
+        fresh_decisions bypasses the LLM response cache for every prompt in the session.
+        """
         session_id = self.start_trading_session()
         session_results = {'session_id': session_id, 'trades': [], 'errors': []}
         
@@ -635,42 +808,58 @@ class EnhancedAutomationEngine:
                     portfolio, cash = self.trading_engine.load_portfolio_state()
                     
                     # Portfolio analysis
-                    analysis = self.enhanced_portfolio_analysis(portfolio, cash)
+                    analysis = self.enhanced_portfolio_analysis(portfolio, cash, bypass_cache=fresh_decisions)
                     
                     # Get LLM recommendations for new opportunities
                     opportunity_prompt = self._create_opportunity_prompt(portfolio, cash, analysis)
-                    opportunities = self.enhanced_ask_gpt(opportunity_prompt, 'opportunity_analysis')
+                    opportunities = self.enhanced_ask_gpt(
+                        opportunity_prompt, 'opportunity_analysis',
+                        cache_inputs={'portfolio': portfolio, 'cash': cash, 'analysis': analysis,
+                                      'risk_params': self.risk_params},
+                        bypass_cache=fresh_decisions
+                    )
                     
                     # Parse opportunities and execute trades
                     potential_trades = self._parse_trading_opportunities(opportunities)
                     
-                    for trade in potential_trades:
+                    # Decide on every candidate at once; the LLM calls run in parallel
+                    tickers = [trade['ticker'] for trade in potential_trades if trade.get('ticker')]
+                    decisions = self.enhanced_buy_sell_decisions(
+                        {ticker: get_latest_financial_data(ticker) for ticker in tickers},
+                        bypass_cache=fresh_decisions
+                    ) if tickers else {}
+                    
+                    # Decisions were all sized against the same snapshot; spend it only once
+                    remaining_cash = cash
+                    
+                    for ticker, decision in decisions.items():
                         if self.current_session.total_trades >= max_trades:
                             break
+                        
+                        # Execute if buy decision
+                        if decision['action'] == 'BUY' and decision['position_size'] > 0:
+                            if decision['position_size'] > remaining_cash:
+                                if remaining_cash <= 0:
+                                    enhanced_logger.info(f"Skipping BUY {ticker}: no cash left in this batch")
+                                    continue
+                                decision['position_size'] = remaining_cash
+                                decision['reasoning'] += '\n\nCASH OVERRIDE: Resized to the cash left in this batch.'
+                                decision['risk_adjusted'] = True
+                            
+                            success = self._execute_trade(ticker, decision)
                             
-                        ticker = trade.get('ticker')
-                        if ticker:
-                            # Get current data
-                            current_data = get_latest_financial_data(ticker)
+                            session_results['trades'].append({
+                                'ticker': ticker,
+                                'action': decision['action'],
+                                'success': success,
+                                'decision': decision
+                            })
                             
-                            # Make decision
-                            decision = self.enhanced_buy_sell_decision(ticker, current_data)
+                            if success:
+                                self.current_session.successful_trades += 1
+                                remaining_cash -= decision['position_size']
                             
-                            # Execute if buy decision
-                            if decision['action'] == 'BUY' and decision['position_size'] > 0:
-                                success = self._execute_trade(ticker, decision)
-                                
-                                session_results['trades'].append({
-                                    'ticker': ticker,
-                                    'action': decision['action'],
-                                    'success': success,
-                                    'decision': decision
-                                })
-                                
-                                if success:
-                                    self.current_session.successful_trades += 1
-                                
-                                self.current_session.total_trades += 1
+                            self.current_session.total_trades += 1
                     
                     # Wait before next iteration
                     time.sleep(60)  # Wait 1 minute
@@ -775,17 +964,24 @@ class EnhancedAutomationEngine:
         return False
     
     def _save_session_data(self):
-        """Save session data to JSON files."""
+        """Queue the current session and its interactions for the JSON files."""
         if not self.current_session:
             return
-            
-        # Save session
+        
+        self.file_writer.submit({
+            'session': self.current_session.to_dict(),
+            'interactions': [interaction.to_dict() for interaction in self.llm_interactions]
+        })
+    
+    def _write_session_files(self, snapshots: List[Dict[str, Any]]):
+        """Append queued sessions/interactions to the JSON files; runs on the writer thread only."""
+        # Save sessions
         sessions = []
         if self.sessions_file.exists():
             with open(self.sessions_file, 'r') as f:
                 sessions = json.load(f)
         
-        sessions.append(self.current_session.to_dict())
+        sessions.extend(snapshot['session'] for snapshot in snapshots)
         
         with open(self.sessions_file, 'w') as f:
             json.dump(sessions, f, indent=2, default=str)
@@ -796,88 +992,83 @@ class EnhancedAutomationEngine:
             with open(self.interactions_file, 'r') as f:
                 interactions = json.load(f)
         
-        interactions.extend([interaction.to_dict() for interaction in self.llm_interactions])
+        for snapshot in snapshots:
+            interactions.extend(snapshot['interactions'])
         
         with open(self.interactions_file, 'w') as f:
             json.dump(interactions, f, indent=2, default=str)
     
     def _save_session_to_database(self):
-        """Save session data to database."""
+        """Queue the current session row for the background database writer."""
         if not self.trading_engine.db_connected or not self.current_session:
             return
-            
-        try:
-            cursor = self.trading_engine.db.legacy_connection.cursor()
-            
-            # Save session
-            session_query = """
-                INSERT INTO trading_sessions 
-                (session_id, market_cap_category, start_time, end_time, total_trades, 
-                 successful_trades, total_pnl, starting_cash, ending_cash, 
-                 starting_equity, ending_equity, llm_interactions)
-                VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
-            """
-            
-            cursor.execute(session_query, (
-                self.current_session.session_id,
-                self.current_session.market_cap_category,
-                self.current_session.start_time,
-                self.current_session.end_time,
-                self.current_session.total_trades,
-                self.current_session.successful_trades,
-                self.current_session.total_pnl,
-                self.current_session.starting_cash,
-                self.current_session.ending_cash,
-                self.current_session.starting_equity,
-                self.current_session.ending_equity,
-                self.current_session.llm_interactions
-            ))
-            
-            self.trading_engine.db.legacy_connection.commit()
-            cursor.close()
-            
-            enhanced_logger.info("Session data saved to database")
-            
-        except Error as e:
-            enhanced_logger.error(f"Failed to save session to database: {e}")
+        
+        session = self.current_session
+        self.db_writer.submit({'table': 'trading_sessions', 'row': {
+            'session_id': session.session_id,
+            'market_cap_category': session.market_cap_category,
+            'start_time': session.start_time,
+            'end_time': session.end_time,
+            'total_trades': session.total_trades,
+            'successful_trades': session.successful_trades,
+            'total_pnl': session.total_pnl,
+            'starting_cash': session.starting_cash,
+            'ending_cash': session.ending_cash,
+            'starting_equity': session.starting_equity,
+            'ending_equity': session.ending_equity,
+            'llm_interactions': session.llm_interactions
+        }})
     
     def _save_interaction_to_database(self, interaction: LLMInteraction):
-        """Save LLM interaction to database."""
+        """Queue an LLM interaction row for the background database writer."""
         if not self.trading_engine.db_connected:
             return
-            
+        
+        self.db_writer.submit({'table': 'llm_interactions', 'row': {
+            'session_id': interaction.session_id,
+            'interaction_id': interaction.interaction_id,
+            'timestamp': interaction.timestamp,
+            'market_cap_category': interaction.market_cap_category,
+            'prompt_type': interaction.prompt_type,
+            'prompt': interaction.prompt[:1000],  # Truncate for database
+            'response': interaction.response[:2000],  # Truncate for database
+            'tokens_used': interaction.tokens_used,
+            'response_time': interaction.response_time,
+            'action_taken': interaction.action_taken,
+            'ticker_analyzed': interaction.ticker_analyzed
+        }})
+    
+    def _write_db_rows(self, records: List[Dict[str, Any]]):
+        """Insert a batch of queued rows, one executemany per table; runs on the writer thread only.
+        
+        Errors propagate so the writer spools the batch for replay.
+        """
+        by_table: Dict[str, List[Dict[str, Any]]] = {}
+        for record in records:
+            by_table.setdefault(record['table'], []).append(record['row'])
+        
         try:
-            cursor = self.trading_engine.db.legacy_connection.cursor()
+            if self._writer_connection is None or not self._writer_connection.is_connected():
+                self._writer_connection = self.trading_engine.db.open_legacy_connection()
             
-            query = """
-                INSERT INTO llm_interactions 
-                (session_id, interaction_id, timestamp, market_cap_category, prompt_type, 
-                 prompt, response, tokens_used, response_time, action_taken, ticker_analyzed)
-                VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s, %s)
-            """
+            cursor = self._writer_connection.cursor()
+            for table, rows in by_table.items():
+                columns = list(rows[0].keys())
+                query = (f"INSERT INTO {table} ({', '.join(columns)}) "
+                         f"VALUES ({', '.join(['%s'] * len(columns))})")
+                cursor.executemany(query, [tuple(row.get(column) for column in columns) for row in rows])
             
-            cursor.execute(query, (
-                interaction.session_id,
-                interaction.interaction_id,
-                interaction.timestamp,
-                interaction.market_cap_category,
-                interaction.prompt_type,
-                interaction.prompt[:1000],  # Truncate for database
-                interaction.response[:2000],  # Truncate for database
-                interaction.tokens_used,
-                interaction.response_time,
-                interaction.action_taken,
-                interaction.ticker_analyzed
-            ))
-            
-            self.trading_engine.db.legacy_connection.commit()
+            self._writer_connection.commit()
             cursor.close()
             
-        except Error as e:
-            enhanced_logger.error(f"Failed to save interaction to database: {e}")
+        except Exception as e:
+            enhanced_logger.error(f"Failed to save {len(records)} rows to database: {e}")
+            self._writer_connection = None
+            raise
     
     def get_session_history(self, limit: int = 10) -> List[Dict[str, Any]]:
         """Get recent trading session history."""
+        self.file_writer.flush()
         if self.sessions_file.exists():
             with open(self.sessions_file, 'r') as f:
                 sessions = json.load(f)
@@ -895,6 +1086,7 @@ class EnhancedAutomationEngine:
             'worst_session': 0
         }
         
+        self.file_writer.flush()
         if not self.sessions_file.exists():
             return metrics
         
@@ -107,15 +107,7 @@ class DatabaseManager:
             )
             
             # Connect to legacy database for historical data
-            legacy_config = db_config.get('legacy', {})
-            self.legacy_connection = mysql.connector.connect(
-                host=db_config.get('host', 'localhost'),
-                port=db_config.get('port', 3306),
-                database=legacy_config.get('database', 'stock_market_2'),
-                user=db_config.get('username'),
-                password=db_config.get('password'),
-                charset='utf8mb4'
-            )
+            self.legacy_connection = self.open_legacy_connection()
             
             logger.info("Database connections established successfully")
             return True
@@ -124,6 +116,23 @@ class DatabaseManager:
             logger.error(f"Database connection failed: {e}")
             return False
     
+    def open_legacy_connection(self):
+        """Open a new, independent connection to the legacy database.
+        
+        Used for legacy_connection and by background writers, which need a
+        connection of their own (connections must not be shared across threads).
+        """
+        db_config = self.config.get('database', {})
+        legacy_config = db_config.get('legacy', {})
+        return mysql.connector.connect(
+            host=db_config.get('host', 'localhost'),
+            port=db_config.get('port', 3306),
+            database=legacy_config.get('database', 'stock_market_2'),
+            user=db_config.get('username'),
+            password=db_config.get('password'),
+            charset='utf8mb4'
+        )
+    
     def disconnect(self):
         """Close database connections."""
         if self.connection and self.connection.is_connected():
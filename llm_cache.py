@@ -0,0 +1,156 @@
+"""Content-addressed cache for LLM responses.
+
+Prompts such as the portfolio analysis or a ticker's buy/sell prompt are
+rebuilt from the same inputs many times a day. The cache key is a hash of
+the prompt type, the ticker, and the market inputs feeding the prompt,
+quantized so that noise below a few significant digits does not force a
+new paid round trip. Entries expire after a TTL and are kept in SQLite so
+the cache survives restarts.
+
+Usage:
+    cache = LLMResponseCache('automation_micro_cap/llm_cache.sqlite', ttl_seconds=6 * 3600)
+    key = cache.make_key('buy_sell', 'ABCD', {'price': 1.2345, 'cash': 100.0})
+    response = cache.get(key)
+    if response is None:
+        response = ask_llm(prompt)
+        cache.put(key, response, 'buy_sell', 'ABCD')
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import logging
+import math
+import sqlite3
+import threading
+import time
+from datetime import date, datetime
+from pathlib import Path
+from typing import Any, Dict, Optional, Union
+
+import pandas as pd
+
+
+def normalize_market_state(value: Any, significant_digits: int = 4) -> Any:
+    """Turn prompt inputs into a canonical, JSON-serializable structure.
+
+    Floats are rounded to significant_digits, dict keys are sorted by the
+    JSON encoder, DataFrames become row lists sorted by their first column,
+    and dates become ISO strings.
+    """
+    if isinstance(value, pd.DataFrame):
+        frame = value.sort_values(value.columns[0]) if len(value.columns) else value
+        return [normalize_market_state(row, significant_digits) for row in frame.to_dict('records')]
+    if isinstance(value, pd.Series):
+        return normalize_market_state(value.to_dict(), significant_digits)
+    if isinstance(value, dict):
+        return {str(k): normalize_market_state(v, significant_digits) for k, v in value.items()}
+    if isinstance(value, (list, tuple)):
+        return [normalize_market_state(v, significant_digits) for v in value]
+    if isinstance(value, bool) or value is None or isinstance(value, str):
+        return value
+    if isinstance(value, (datetime, date)):
+        return value.isoformat()
+    try:
+        number = float(value)
+    except (TypeError, ValueError):
+        return str(value)
+    if math.isnan(number) or math.isinf(number):
+        return None
+    if number == int(number) and abs(number) < 1e15:
+        return int(number)
+    return float(f"{number:.{significant_digits}g}")
+
+
+class LLMResponseCache:
+    """SQLite-backed response cache with TTL and hit/miss counters."""
+
+    def __init__(self,
+                 path: Union[str, Path],
+                 ttl_seconds: float = 6 * 3600,
+                 significant_digits: int = 4):
+        """
+        Args:
+            path: SQLite database file (created if missing).
+            ttl_seconds: How long a stored response stays valid.
+            significant_digits: Precision numeric inputs are quantized to.
+        """
+        self.path = str(path)
+        self.ttl_seconds = ttl_seconds
+        self.significant_digits = significant_digits
+        self.logger = logging.getLogger(__name__)
+        self.stats = {'hits': 0, 'misses': 0, 'expired': 0, 'stores': 0}
+
+        self._lock = threading.Lock()
+        self._conn = sqlite3.connect(self.path, check_same_thread=False)
+        self._conn.execute("""
+            CREATE TABLE IF NOT EXISTS llm_response_cache (
+                cache_key TEXT PRIMARY KEY,
+                prompt_type TEXT,
+                ticker TEXT,
+                response TEXT NOT NULL,
+                created_at REAL NOT NULL,
+                expires_at REAL NOT NULL
+            )
+        """)
+        self._conn.execute("CREATE INDEX IF NOT EXISTS idx_llm_cache_expires ON llm_response_cache (expires_at)")
+        self._conn.commit()
+
+    def make_key(self, prompt_type: str, ticker: Optional[str], inputs: Any) -> str:
+        """Hash of prompt type, ticker and quantized inputs."""
+        payload = json.dumps({
+            'prompt_type': prompt_type,
+            'ticker': ticker.upper() if ticker else None,
+            'inputs': normalize_market_state(inputs, self.significant_digits)
+        }, sort_keys=True, separators=(',', ':'))
+        return hashlib.sha256(payload.encode('utf-8')).hexdigest()
+
+    def get(self, key: str) -> Optional[str]:
+        """Cached response for key, or None if missing or expired."""
+        with self._lock:
+            row = self._conn.execute(
+                "SELECT response, expires_at FROM llm_response_cache WHERE cache_key = ?", (key,)
+            ).fetchone()
+
+            if row is None:
+                self.stats['misses'] += 1
+                return None
+
+            if row[1] < time.time():
+                self._conn.execute("DELETE FROM llm_response_cache WHERE cache_key = ?", (key,))
+                self._conn.commit()
+                self.stats['expired'] += 1
+                self.stats['misses'] += 1
+                return None
+
+            self.stats['hits'] += 1
+            return row[0]
+
+    def put(self, key: str, response: str, prompt_type: Optional[str] = None, ticker: Optional[str] = None):
+        """Store a response under key for ttl_seconds."""
+        now = time.time()
+        with self._lock:
+            self._conn.execute(
+                "INSERT OR REPLACE INTO llm_response_cache "
+                "(cache_key, prompt_type, ticker, response, created_at, expires_at) VALUES (?, ?, ?, ?, ?, ?)",
+                (key, prompt_type, ticker, response, now, now + self.ttl_seconds)
+            )
+            self._conn.commit()
+            self.stats['stores'] += 1
+
+    def purge_expired(self) -> int:
+        """Delete expired entries; returns how many were removed."""
+        with self._lock:
+            cursor = self._conn.execute("DELETE FROM llm_response_cache WHERE expires_at < ?", (time.time(),))
+            self._conn.commit()
+            return cursor.rowcount
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Counters plus hit rate."""
+        lookups = self.stats['hits'] + self.stats['misses']
+        return dict(self.stats, hit_rate=self.stats['hits'] / lookups if lookups else 0.0)
+
+    def close(self):
+        with self._lock:
+            self._conn.close()
@@ -0,0 +1,195 @@
+"""Concurrency-limited async LLM executor.
+
+Issues independent prompts (e.g. one buy/sell decision per ticker) in
+parallel instead of one after another, while capping the number of
+requests in flight. Every call is measured, and the per-session totals
+(requests, failures, tokens, latency) are kept in an ``LLMUsage``.
+
+Uses ``openai.AsyncOpenAI`` when the installed openai package provides it,
+and otherwise runs the blocking ``call_openai_api`` on a thread pool.
+
+Usage:
+    executor = AsyncLLMExecutor(api_key, max_concurrency=4)
+    results = executor.run_sync([LLMRequest(prompt, 'buy_sell', 'ABCD'), ...])
+"""
+
+from __future__ import annotations
+
+import asyncio
+import logging
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional
+
+try:
+    import openai
+    HAS_ASYNC_OPENAI = hasattr(openai, 'AsyncOpenAI')
+except ImportError:
+    HAS_ASYNC_OPENAI = False
+
+# Same system prompt as simple_automation.call_openai_api
+SYSTEM_PROMPT = "You are a professional portfolio analyst. Always respond with valid JSON in the exact format requested."
+
+
+@dataclass
+class LLMRequest:
+    """One prompt to send."""
+    prompt: str
+    prompt_type: str = 'analysis'
+    ticker: Optional[str] = None
+    cache_key: Optional[str] = None  # set when the response may be served from/stored in a cache
+
+
+@dataclass
+class LLMResult:
+    """Outcome of one LLMRequest."""
+    request: LLMRequest
+    response: str
+    response_time: float
+    tokens_used: Optional[int] = None
+    prompt_tokens: Optional[int] = None
+    completion_tokens: Optional[int] = None
+    error: Optional[str] = None
+
+    @property
+    def ok(self) -> bool:
+        return self.error is None
+
+
+@dataclass
+class LLMUsage:
+    """Token and latency totals for a session."""
+    requests: int = 0
+    failures: int = 0
+    prompt_tokens: int = 0
+    completion_tokens: int = 0
+    total_tokens: int = 0
+    total_latency: float = 0.0
+    max_latency: float = 0.0
+    by_prompt_type: Dict[str, int] = field(default_factory=dict)
+
+    def record(self, result: LLMResult):
+        """Add one result to the totals."""
+        self.requests += 1
+        if not result.ok:
+            self.failures += 1
+        self.prompt_tokens += result.prompt_tokens or 0
+        self.completion_tokens += result.completion_tokens or 0
+        self.total_tokens += result.tokens_used or 0
+        self.total_latency += result.response_time
+        self.max_latency = max(self.max_latency, result.response_time)
+        prompt_type = result.request.prompt_type
+        self.by_prompt_type[prompt_type] = self.by_prompt_type.get(prompt_type, 0) + 1
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Totals plus average latency, for logging and JSON."""
+        return {
+            'requests': self.requests,
+            'failures': self.failures,
+            'prompt_tokens': self.prompt_tokens,
+            'completion_tokens': self.completion_tokens,
+            'total_tokens': self.total_tokens,
+            'total_latency': round(self.total_latency, 3),
+            'avg_latency': round(self.total_latency / self.requests, 3) if self.requests else 0.0,
+            'max_latency': round(self.max_latency, 3),
+            'by_prompt_type': dict(self.by_prompt_type)
+        }
+
+
+class AsyncLLMExecutor:
+    """Send LLM requests concurrently, at most max_concurrency at a time.
+
+    The chat completions endpoint takes one conversation per request, so a
+    batch is a set of concurrent requests rather than a single call.
+    Results come back in request order; a failed request yields a result
+    with ``error`` set and a response of ``"Error: ..."``, matching what
+    EnhancedAutomationEngine.enhanced_ask_gpt returns on failure.
+    """
+
+    def __init__(self,
+                 api_key: Optional[str],
+                 model: str = 'gpt-4',
+                 max_concurrency: int = 4,
+                 temperature: float = 0.3,
+                 max_tokens: int = 1500,
+                 usage: Optional[LLMUsage] = None):
+        self.api_key = api_key
+        self.model = model
+        self.max_concurrency = max(1, max_concurrency)
+        self.temperature = temperature
+        self.max_tokens = max_tokens
+        self.usage = usage if usage is not None else LLMUsage()
+        self.logger = logging.getLogger(__name__)
+
+    async def run(self, requests: List[LLMRequest]) -> List[LLMResult]:
+        """Execute all requests concurrently and return results in order."""
+        if not requests:
+            return []
+
+        semaphore = asyncio.Semaphore(self.max_concurrency)
+        client = openai.AsyncOpenAI(api_key=self.api_key) if HAS_ASYNC_OPENAI and self.api_key else None
+
+        async def bounded(request: LLMRequest) -> LLMResult:
+            async with semaphore:
+                return await self._complete(client, request)
+
+        started = time.time()
+        try:
+            results = await asyncio.gather(*(bounded(request) for request in requests))
+        finally:
+            if client is not None:
+                await client.close()
+
+        for result in results:
+            self.usage.record(result)
+
+        self.logger.info(
+            f"LLM batch of {len(requests)} finished in {time.time() - started:.2f}s "
+            f"(concurrency {self.max_concurrency}, {sum(1 for r in results if not r.ok)} failed)"
+        )
+        return list(results)
+
+    def run_sync(self, requests: List[LLMRequest]) -> List[LLMResult]:
+        """Blocking wrapper around run() for synchronous callers."""
+        return asyncio.run(self.run(requests))
+
+    async def _complete(self, client, request: LLMRequest) -> LLMResult:
+        start_time = time.time()
+        try:
+            if not self.api_key:
+                raise ValueError("API key not configured for LLM interactions")
+
+            if client is not None:
+                response = await client.chat.completions.create(
+                    model=self.model,
+                    messages=[
+                        {"role": "system", "content": SYSTEM_PROMPT},
+                        {"role": "user", "content": request.prompt}
+                    ],
+                    temperature=self.temperature,
+                    max_tokens=self.max_tokens
+                )
+                usage = getattr(response, 'usage', None)
+                return LLMResult(
+                    request=request,
+                    response=response.choices[0].message.content,
+                    response_time=time.time() - start_time,
+                    tokens_used=getattr(usage, 'total_tokens', None),
+                    prompt_tokens=getattr(usage, 'prompt_tokens', None),
+                    completion_tokens=getattr(usage, 'completion_tokens', None)
+                )
+
+            # No async client: run the blocking call on the default thread pool
+            from simple_automation import call_openai_api
+            loop = asyncio.get_running_loop()
+            response = await loop.run_in_executor(None, call_openai_api, request.prompt, self.api_key, self.model)
+            return LLMResult(request=request, response=response, response_time=time.time() - start_time)
+
+        except Exception as e:
+            self.logger.error(f"LLM request failed ({request.prompt_type}, {request.ticker}): {e}")
+            return LLMResult(
+                request=request,
+                response=f"Error: {str(e)}",
+                response_time=time.time() - start_time,
+                error=str(e)
+            )
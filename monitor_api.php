@@ -17,16 +17,51 @@ if ($_SERVER['REQUEST_METHOD'] === 'OPTIONS') {
 
 require_once 'DatabaseConfig.php';
 require_once 'JobLogger.php';
+require_once __DIR__ . '/src/ResponseCache.php';
+require_once __DIR__ . '/src/HttpCache.php';
+require_once __DIR__ . '/src/Metrics.php';
+require_once __DIR__ . '/src/JobProgressOverlay.php';
 
 class MonitorAPI
 {
     private $pdo;
     private $logger;
+    private $brokerBackend = false;
+    private $config = null;
+    private $cache = null;
+    
+    /**
+     * Seconds a payload is shared between pollers, per cacheable action
+     * (overridable via monitoring.cache_ttl in job_processor.yml)
+     */
+    private const CACHE_TTL = [
+        'overview' => 2,
+        'workers' => 2,
+        'queues' => 2,
+        'jobs' => 2,
+        'job_details' => 2,
+        'job_stats' => 15
+    ];
+    
+    /**
+     * Query parameters each cacheable action reads; only these key the cache,
+     * so cache busters such as _=<timestamp> share one entry
+     */
+    private const CACHE_PARAMS = [
+        'jobs' => ['limit', 'offset'],
+        'job_details' => ['job_id'],
+        'job_stats' => ['hours']
+    ];
+    
+    /**
+     * Actions pushed by the event stream
+     */
+    private const STREAM_TOPICS = ['overview', 'workers', 'queues'];
     
     public function __construct()
     {
         try {
-            $this->pdo = DatabaseConfig::createLegacyConnection();
+            $this->pdo = DatabaseConfig::getLegacyConnection();
             $this->logger = new JobLogger('logs/monitor_api.log');
         } catch (Exception $e) {
             $this->sendError('Database connection failed: ' . $e->getMessage());
@@ -43,23 +78,20 @@ class MonitorAPI
         try {
             switch ($action) {
                 case 'overview':
-                    $this->getOverview();
-                    break;
-                    
                 case 'workers':
-                    $this->getWorkers();
-                    break;
-                    
                 case 'queues':
-                    $this->getQueues();
+                case 'jobs':
+                case 'job_stats':
+                case 'job_details':
+                    $this->sendCached($action);
                     break;
                     
-                case 'jobs':
-                    $this->getJobs();
+                case 'stream':
+                    $this->streamEvents();
                     break;
                     
-                case 'job_stats':
-                    $this->getJobStats();
+                case 'metrics':
+                    $this->sendMetrics();
                     break;
                     
                 case 'logs':
@@ -74,10 +106,6 @@ class MonitorAPI
                     $this->addJob();
                     break;
                     
-                case 'job_details':
-                    $this->getJobDetails();
-                    break;
-                    
                 default:
                     $this->sendError('Unknown action: ' . $action);
             }
@@ -131,7 +159,7 @@ class MonitorAPI
             }
         }
         
-        $this->sendSuccess($overview);
+        return $overview;
     }
     
     /**
@@ -173,7 +201,7 @@ class MonitorAPI
             ];
         }
         
-        $this->sendSuccess($workers);
+        return $workers;
     }
     
     /**
@@ -199,7 +227,7 @@ class MonitorAPI
             $queues[$row['queue_name']] = $row['count'];
         }
         
-        $this->sendSuccess($queues);
+        return $queues;
     }
     
     /**
@@ -239,7 +267,76 @@ class MonitorAPI
             ];
         }
         
-        $this->sendSuccess($jobs);
+        return $this->overlayLiveProgress($jobs);
+    }
+    
+    /**
+     * Broker queue backend (Redis, RabbitMQ, MQTT) from job_processor.yml
+     *
+     * Built the first time it is needed. Returns null for the database
+     * backend, where ta_analysis_jobs is the queue.
+     */
+    private function getBrokerBackend()
+    {
+        if ($this->brokerBackend !== false) {
+            return $this->brokerBackend;
+        }
+        
+        $this->brokerBackend = null;
+        $config = $this->getConfig();
+        if (empty($config)) {
+            return null;
+        }
+        
+        try {
+            $backendType = $config['queue']['backend'] ?? 'database';
+            
+            if ($backendType === 'redis' && class_exists('Redis')) {
+                require_once __DIR__ . '/RedisJobBackend.php';
+                $this->brokerBackend = new RedisJobBackend($config, $this->logger);
+            } elseif ($backendType === 'rabbitmq' && class_exists('PhpAmqpLib\Connection\AMQPStreamConnection')) {
+                require_once __DIR__ . '/RabbitMQJobBackend.php';
+                $this->brokerBackend = new RabbitMQJobBackend($config, $this->logger);
+            } elseif (in_array($backendType, ['mqtt', 'mosquitto']) && class_exists('Mosquitto\Client')) {
+                require_once __DIR__ . '/MQTTJobBackend.php';
+                $this->brokerBackend = new MQTTJobBackend($config, $this->logger);
+            }
+        } catch (Exception $e) {
+            $this->logger->warning('Queue backend unavailable: ' . $e->getMessage());
+        }
+        
+        return $this->brokerBackend;
+    }
+    
+    /**
+     * Backend that carries live job progress (Redis hash / MQTT topic)
+     *
+     * Null for the database/rabbitmq backends, where ta_analysis_jobs is
+     * current.
+     */
+    private function getProgressChannel()
+    {
+        $backend = $this->getBrokerBackend();
+        return $backend && method_exists($backend, 'getProgress') ? $backend : null;
+    }
+    
+    /**
+     * Replace progress/status_message of running jobs with the live values
+     * published by workers
+     */
+    private function overlayLiveProgress(array $jobs)
+    {
+        $channel = $this->getProgressChannel();
+        if (!$channel) {
+            return $jobs;
+        }
+        
+        try {
+            return JobProgressOverlay::apply($jobs, $channel);
+        } catch (Exception $e) {
+            $this->logger->warning('Live progress read failed: ' . $e->getMessage());
+            return $jobs;
+        }
     }
     
     /**
@@ -287,14 +384,14 @@ class MonitorAPI
             $running[] = (int)$stmt->fetchColumn();
         }
         
-        $this->sendSuccess([
+        return [
             'labels' => $labels,
             'data' => [
                 'completed' => $completed,
                 'failed' => $failed,
                 'running' => $running
             ]
-        ]);
+        ];
     }
     
     /**
@@ -390,24 +487,26 @@ class MonitorAPI
             $priority = 'normal';
         }
         
-        // Generate job ID
-        $jobId = uniqid('job_', true);
-        
-        // Insert job into database
-        $sql = "INSERT INTO ta_analysis_jobs 
-                (id, job_type, priority, parameters, status, created_at) 
-                VALUES (?, ?, ?, ?, 'pending', NOW())";
-        
-        $stmt = $this->pdo->prepare($sql);
-        $success = $stmt->execute([
-            $jobId,
-            $jobType,
-            $priority,
-            json_encode($parameters)
-        ]);
+        require_once __DIR__ . '/JobProcessors.php';
+        
+        // The row is the job on the database backend, and the tracking row
+        // (progress, status) of one queued on a broker
+        $jobId = AbstractJobProcessor::createTrackingRow($this->pdo, $jobType, $priority, $parameters);
+        $success = $jobId > 0;
+        
+        $broker = $this->getBrokerBackend();
+        if ($success && $broker) {
+            $broker->addJob([
+                'job_type' => $jobType,
+                'priority' => $priority,
+                'parameters' => json_encode($parameters),
+                'tracking_id' => $jobId
+            ]);
+        }
         
         if ($success) {
             $this->logger->info("Added test job: {$jobId} ({$jobType})");
+            $this->getCache()->invalidate('monitor');
             $this->sendSuccess(['job_id' => $jobId, 'message' => 'Job added successfully']);
         } else {
             $this->sendError('Failed to add job to database');
@@ -446,9 +545,174 @@ class MonitorAPI
         $job['parameters'] = $job['parameters'] ? json_decode($job['parameters'], true) : [];
         $job['result'] = $job['result'] ? json_decode($job['result'], true) : null;
         
-        $this->sendSuccess($job);
+        $jobs = $this->overlayLiveProgress([$job]);
+        
+        return $jobs[0];
     }
     
+    /**
+     * job_processor.yml contents (empty array when missing or unreadable)
+     */
+    private function getConfig()
+    {
+        if ($this->config !== null) {
+            return $this->config;
+        }
+
+        $this->config = [];
+        $configFile = __DIR__ . '/job_processor.yml';
+        if (file_exists($configFile)) {
+            try {
+                $this->config = DatabaseConfig::parseYaml(file_get_contents($configFile)) ?: [];
+            } catch (Exception $e) {
+                $this->logger->warning('Could not read job_processor.yml: ' . $e->getMessage());
+            }
+        }
+
+        return $this->config;
+    }
+
+    /**
+     * Response cache shared by every request on this host
+     */
+    private function getCache()
+    {
+        if ($this->cache === null) {
+            $this->cache = new ResponseCache(['prefix' => 'monitor_api']);
+        }
+        return $this->cache;
+    }
+
+    /**
+     * Cache lifetime for an action (0 disables caching)
+     */
+    private function getCacheTtl($action)
+    {
+        $configured = $this->getConfig()['monitoring']['cache_ttl'] ?? [];
+        return (int)($configured[$action] ?? self::CACHE_TTL[$action]);
+    }
+
+    /**
+     * JSON body for an action, computed at most once per TTL across all
+     * requests with the same parameters
+     */
+    private function getCachedBody($action, array $params)
+    {
+        $producer = function () use ($action) {
+            return json_encode(['success' => true, 'data' => $this->fetchAction($action)]);
+        };
+
+        $ttl = $this->getCacheTtl($action);
+        if ($ttl <= 0) {
+            return $producer();
+        }
+
+        ksort($params);
+        return $this->getCache()->remember('monitor', $action . '?' . http_build_query($params), $ttl, $producer);
+    }
+
+    /**
+     * Data for a cacheable action
+     */
+    private function fetchAction($action)
+    {
+        switch ($action) {
+            case 'overview':
+                return $this->getOverview();
+            case 'workers':
+                return $this->getWorkers();
+            case 'queues':
+                return $this->getQueues();
+            case 'jobs':
+                return $this->getJobs();
+            case 'job_stats':
+                return $this->getJobStats();
+            case 'job_details':
+                return $this->getJobDetails();
+        }
+        throw new InvalidArgumentException('Not a cacheable action: ' . $action);
+    }
+
+    /**
+     * Send a cacheable action with ETag/Cache-Control (304 when unchanged)
+     */
+    private function sendCached($action)
+    {
+        $params = array_intersect_key($_GET, array_flip(self::CACHE_PARAMS[$action] ?? []));
+
+        $body = $this->getCachedBody($action, $params);
+        HttpCache::send($body, $this->getCacheTtl($action));
+        exit;
+    }
+
+    /**
+     * Server-Sent Events stream of overview/workers/queues
+     *
+     * Each topic is sent once on connect and then whenever its payload
+     * changes. Payloads come from the same shared cache as the polling
+     * endpoints, so any number of open dashboards costs one query per topic
+     * per TTL. The stream ends after monitoring.stream_max_duration seconds
+     * and the browser's EventSource reconnects on its own.
+     */
+    private function streamEvents()
+    {
+        $monitoring = $this->getConfig()['monitoring'] ?? [];
+        $interval = max(1, (int)($monitoring['stream_interval'] ?? 2));
+        $maxDuration = max($interval, (int)($monitoring['stream_max_duration'] ?? 300));
+        $heartbeat = 15;
+
+        header('Content-Type: text/event-stream');
+        header('Cache-Control: no-cache');
+        header('X-Accel-Buffering: no'); // nginx: do not buffer the stream
+        set_time_limit(0);
+        while (ob_get_level() > 0) {
+            ob_end_flush();
+        }
+
+        echo 'retry: ' . ($interval * 1000) . "\n\n";
+        flush();
+
+        $sent = [];
+        $started = time();
+        $lastWrite = $started;
+        while (!connection_aborted() && time() - $started < $maxDuration) {
+            foreach (self::STREAM_TOPICS as $topic) {
+                $body = $this->getCachedBody($topic, []);
+                $etag = HttpCache::etag($body);
+                if (($sent[$topic] ?? null) === $etag) {
+                    continue;
+                }
+                $sent[$topic] = $etag;
+                echo "event: {$topic}\n";
+                echo 'id: ' . trim($etag, '"') . "\n";
+                echo "data: {$body}\n\n";
+                $lastWrite = time();
+            }
+
+            if (time() - $lastWrite >= $heartbeat) {
+                echo ": heartbeat\n\n"; // keeps proxies from closing an idle stream
+                $lastWrite = time();
+            }
+            flush();
+            sleep($interval);
+        }
+        exit;
+    }
+
+    /**
+     * Prometheus scrape target: hot-path counters and timings of every
+     * worker and analyzer process writing to the metrics directory
+     */
+    private function sendMetrics()
+    {
+        Metrics::configure($this->getConfig()['metrics'] ?? []);
+
+        header('Content-Type: text/plain; version=0.0.4');
+        header('Cache-Control: no-cache');
+        echo Metrics::render(Metrics::collect());
+        exit;
+    }
+
     /**
      * Send success response
      */
@@ -0,0 +1,288 @@
+"""Vectorized portfolio revaluation and risk/CAPM metrics.
+
+daily_results computes drawdown, Sharpe/Sortino and CAPM beta/alpha for
+one portfolio from its TOTAL rows with a pandas pipeline. This module does
+the same arithmetic on numpy arrays so many portfolios are evaluated in one
+pass (leading axis = portfolio), plus an incremental state whose update for
+a new day is O(1) per portfolio.
+
+Conventions (matching daily_results):
+- returns are simple daily returns of total equity
+- std uses ddof=1; downside deviation is sqrt(mean(min(r - rf_daily, 0)^2))
+- Sharpe/Sortino "period" use the compounded return over the window,
+  "annual" use the daily mean scaled by sqrt(252)
+- CAPM regresses excess portfolio returns on excess market returns;
+  alpha is annualized as (1 + alpha_daily)^252 - 1
+- NaN marks missing days (e.g. a portfolio with shorter history) and is
+  ignored by every statistic; a return is always against the previous day,
+  so the returns on both sides of a NaN day are dropped too
+
+daily_results revalues the holdings with revalue(), reports whole-history
+metrics from risk_metrics() and trailing-window metrics from a windowed
+RollingRiskState. A caller that keeps a RollingRiskState across days uses
+update() instead of rescanning the history.
+
+Usage:
+    rev = revalue(prices, positions, cash)            # prices: dates x tickers
+    metrics = risk_metrics(rev.equity, market_returns)
+    state = RollingRiskState.from_history(rev.equity, market_returns)
+    state.update(todays_equity, todays_market_return)
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from typing import Dict, Optional
+
+import numpy as np
+
+TRADING_DAYS = 252
+RISK_FREE_ANNUAL = 0.045
+
+
+def daily_risk_free(rf_annual: float = RISK_FREE_ANNUAL) -> float:
+    return (1 + rf_annual) ** (1 / TRADING_DAYS) - 1
+
+
+@dataclass
+class Revaluation:
+    """Mark-to-market of P portfolios over D dates and T tickers."""
+    values: np.ndarray      # (P, D, T) position market values
+    exposures: np.ndarray   # (P, D, T) position value / equity
+    market_value: np.ndarray  # (P, D) sum of position values
+    equity: np.ndarray      # (P, D) market value + cash
+    pnl: np.ndarray         # (P, D) market value - cost basis
+
+
+def revalue(prices: np.ndarray,
+            positions: np.ndarray,
+            cash: np.ndarray,
+            cost_basis: Optional[np.ndarray] = None) -> Revaluation:
+    """Value positions against an aligned price matrix by broadcasting.
+
+    Args:
+        prices: (D, T) closes, NaN where a ticker has no price that day.
+        positions: (P, T) constant share counts or (P, D, T) per-day holdings.
+        cash: (P,) constant or (P, D) per-day cash.
+        cost_basis: like positions, total cost per position (for P&L).
+    """
+    prices = np.asarray(prices, dtype=float)
+    positions = np.asarray(positions, dtype=float)
+    if positions.ndim == 2:
+        positions = positions[:, None, :]
+    cash = np.asarray(cash, dtype=float)
+    if cash.ndim == 1:
+        cash = cash[:, None]
+
+    # Unpriced + unheld contributes nothing; unpriced + held stays NaN
+    held = positions != 0
+    values = np.where(held, positions * prices[None, :, :], 0.0)
+    market_value = values.sum(axis=-1)
+    equity = market_value + cash
+
+    with np.errstate(invalid='ignore', divide='ignore'):
+        exposures = values / equity[..., None]
+
+    if cost_basis is not None:
+        cost_basis = np.asarray(cost_basis, dtype=float)
+        if cost_basis.ndim == 2:
+            cost_basis = cost_basis[:, None, :]
+        pnl = market_value - np.where(held, cost_basis, 0.0).sum(axis=-1)
+    else:
+        pnl = np.full_like(market_value, np.nan)
+
+    return Revaluation(values, exposures, market_value, equity, pnl)
+
+
+def simple_returns(equity: np.ndarray) -> np.ndarray:
+    """(..., D) equity -> (..., D-1) daily simple returns."""
+    equity = np.asarray(equity, dtype=float)
+    with np.errstate(invalid='ignore', divide='ignore'):
+        return equity[..., 1:] / equity[..., :-1] - 1.0
+
+
+def max_drawdown(equity: np.ndarray):
+    """Largest peak-to-trough drop, and the index of the trough, per series."""
+    equity = np.asarray(equity, dtype=float)
+    peaks = np.fmax.accumulate(np.where(np.isnan(equity), -np.inf, equity), axis=-1)
+    with np.errstate(invalid='ignore', divide='ignore'):
+        drawdowns = np.where(np.isnan(equity), np.nan, equity / peaks - 1.0)
+    filled = np.where(np.isnan(drawdowns), np.inf, drawdowns)
+    return filled.min(axis=-1), filled.argmin(axis=-1)
+
+
+# Per-day terms whose sums give every statistic; see _metrics_from_sums
+_N, _S, _SS, _DD, _LOG, _NX, _X, _XX, _Y, _YY, _XY = range(11)
+_TERMS = 11
+
+
+def _contributions(r: np.ndarray, rm: Optional[np.ndarray], rf_daily: float) -> np.ndarray:
+    """(..., K) terms for returns r (...,) and market returns rm (broadcastable)."""
+    r = np.asarray(r, dtype=float)
+    ok = np.isfinite(r)
+    rz = np.where(ok, r, 0.0)
+    terms = np.zeros(r.shape + (_TERMS,))
+    terms[..., _N] = ok
+    terms[..., _S] = rz
+    terms[..., _SS] = rz * rz
+    terms[..., _DD] = np.minimum(rz - rf_daily, 0.0) ** 2 * ok
+    with np.errstate(invalid='ignore', divide='ignore'):
+        terms[..., _LOG] = np.where(ok, np.log1p(rz), 0.0)
+
+    if rm is not None:
+        rm = np.broadcast_to(np.asarray(rm, dtype=float), r.shape)
+        pair = ok & np.isfinite(rm)
+        x = np.where(pair, rm - rf_daily, 0.0)
+        y = np.where(pair, rz - rf_daily, 0.0)
+        terms[..., _NX] = pair
+        terms[..., _X] = x
+        terms[..., _XX] = x * x
+        terms[..., _Y] = y
+        terms[..., _YY] = y * y
+        terms[..., _XY] = x * y
+    return terms
+
+
+def _metrics_from_sums(sums: np.ndarray, rf_daily: float) -> Dict[str, np.ndarray]:
+    n = sums[..., _N]
+    nx = sums[..., _NX]
+    nan = np.nan
+
+    with np.errstate(invalid='ignore', divide='ignore'):
+        mean = np.where(n > 0, sums[..., _S] / n, nan)
+        var = np.where(n > 1, (sums[..., _SS] - sums[..., _S] ** 2 / n) / (n - 1), nan)
+        std = np.sqrt(np.maximum(var, 0.0))
+        downside_std = np.where(n > 0, np.sqrt(sums[..., _DD] / n), nan)
+        period_return = np.where(n > 0, np.expm1(sums[..., _LOG]), nan)
+        rf_period = (1 + rf_daily) ** n - 1
+
+        sharpe_period = np.where(std > 0, (period_return - rf_period) / (std * np.sqrt(n)), nan)
+        sharpe_annual = np.where(std > 0, (mean - rf_daily) / std * np.sqrt(TRADING_DAYS), nan)
+        sortino_period = np.where(downside_std > 0, (period_return - rf_period) / (downside_std * np.sqrt(n)), nan)
+        sortino_annual = np.where(downside_std > 0, (mean - rf_daily) / downside_std * np.sqrt(TRADING_DAYS), nan)
+
+        sxx = sums[..., _XX] - sums[..., _X] ** 2 / nx
+        syy = sums[..., _YY] - sums[..., _Y] ** 2 / nx
+        sxy = sums[..., _XY] - sums[..., _X] * sums[..., _Y] / nx
+        fit = (nx >= 2) & (sxx > 0)
+        beta = np.where(fit, sxy / sxx, nan)
+        alpha_daily = np.where(fit, (sums[..., _Y] - beta * sums[..., _X]) / nx, nan)
+        alpha_annual = (1 + alpha_daily) ** TRADING_DAYS - 1
+        r2 = np.where(fit & (syy > 0), sxy ** 2 / (sxx * syy), nan)
+
+    return {
+        'n_days': n.astype(int),
+        'mean_daily': mean,
+        'std_daily': std,
+        'downside_std': downside_std,
+        'period_return': period_return,
+        'sharpe_period': sharpe_period,
+        'sharpe_annual': sharpe_annual,
+        'sortino_period': sortino_period,
+        'sortino_annual': sortino_annual,
+        'beta': beta,
+        'alpha_annual': alpha_annual,
+        'r2': r2,
+        'n_obs': nx.astype(int),
+    }
+
+
+def risk_metrics(equity: np.ndarray,
+                 market_returns: Optional[np.ndarray] = None,
+                 rf_daily: Optional[float] = None) -> Dict[str, np.ndarray]:
+    """Drawdown, return, Sharpe/Sortino and CAPM metrics for (P, D) or (D,) equity.
+
+    Args:
+        equity: Total equity per date; NaN for dates a portfolio did not exist.
+        market_returns: (D-1,) benchmark returns aligned with simple_returns(equity),
+            NaN where the benchmark has no return that day.
+        rf_daily: Daily risk-free rate (default: from RISK_FREE_ANNUAL).
+    """
+    rf_daily = daily_risk_free() if rf_daily is None else rf_daily
+    metrics = _metrics_from_sums(
+        _contributions(simple_returns(equity), market_returns, rf_daily).sum(axis=-2), rf_daily
+    )
+    metrics['max_drawdown'], metrics['max_drawdown_index'] = max_drawdown(equity)
+    return metrics
+
+
+class RollingRiskState:
+    """Running sums behind risk_metrics, updated in O(1) per portfolio per day.
+
+    With window=None the statistics cover all history (as daily_results
+    does); with a window they cover the last `window` returns. Drawdown is
+    always since inception. Seeding with from_history and then calling
+    update gives the same metrics as risk_metrics over the whole history.
+    """
+
+    def __init__(self, portfolios: int, window: Optional[int] = None, rf_daily: Optional[float] = None):
+        self.rf_daily = daily_risk_free() if rf_daily is None else rf_daily
+        self.window = window
+        self.days = 0
+        self._sums = np.zeros((portfolios, _TERMS))
+        self._ring = np.zeros((window, portfolios, _TERMS)) if window else None
+        self._last_equity = np.full(portfolios, np.nan)
+        self._peak = np.full(portfolios, -np.inf)
+        self._max_drawdown = np.full(portfolios, np.inf)
+        self._max_drawdown_day = np.zeros(portfolios, dtype=int)
+        self._equity_days = 0
+
+    @classmethod
+    def from_history(cls,
+                     equity: np.ndarray,
+                     market_returns: Optional[np.ndarray] = None,
+                     window: Optional[int] = None,
+                     rf_daily: Optional[float] = None) -> 'RollingRiskState':
+        """Seed from (P, D) equity history in one vectorized pass."""
+        equity = np.atleast_2d(np.asarray(equity, dtype=float))
+        state = cls(equity.shape[0], window, rf_daily)
+
+        terms = np.moveaxis(_contributions(simple_returns(equity), market_returns, state.rf_daily), -2, 0)
+        state.days = len(terms)
+        if window:
+            # Ring slot of return k is k % window, so later updates evict the oldest
+            recent = np.arange(len(terms))[-window:]
+            state._ring[recent % window] = terms[recent]
+            state._sums = terms[recent].sum(axis=0)
+        else:
+            state._sums = terms.sum(axis=0)
+
+        state._peak = np.where(np.isnan(equity), -np.inf, equity).max(axis=1)
+        state._max_drawdown, state._max_drawdown_day = max_drawdown(equity)
+        state._equity_days = equity.shape[1]
+        if equity.shape[1]:
+            state._last_equity = equity[:, -1].copy()
+        return state
+
+    def update(self, equity: np.ndarray, market_return: Optional[float] = None) -> Dict[str, np.ndarray]:
+        """Add one day of (P,) equity and the benchmark's return; returns current metrics."""
+        equity = np.asarray(equity, dtype=float)
+        with np.errstate(invalid='ignore', divide='ignore'):
+            r = equity / self._last_equity - 1.0
+        terms = _contributions(r, None if market_return is None else np.float64(market_return), self.rf_daily)
+
+        if self._ring is not None:
+            slot = self.days % self.window
+            self._sums += terms - self._ring[slot]
+            self._ring[slot] = terms
+        else:
+            self._sums += terms
+        self.days += 1
+
+        priced = np.isfinite(equity)
+        self._peak = np.where(priced, np.fmax(self._peak, equity), self._peak)
+        with np.errstate(invalid='ignore', divide='ignore'):
+            drawdown = np.where(priced, equity / self._peak - 1.0, np.inf)
+        deeper = drawdown < self._max_drawdown
+        self._max_drawdown = np.where(deeper, drawdown, self._max_drawdown)
+        self._max_drawdown_day = np.where(deeper, self._equity_days, self._max_drawdown_day)
+        self._equity_days += 1
+        self._last_equity = equity.copy()
+        return self.metrics()
+
+    def metrics(self) -> Dict[str, np.ndarray]:
+        """Same keys as risk_metrics."""
+        metrics = _metrics_from_sums(self._sums, self.rf_daily)
+        metrics['max_drawdown'] = self._max_drawdown.copy()
+        metrics['max_drawdown_index'] = self._max_drawdown_day.copy()
+        return metrics
@@ -0,0 +1,278 @@
+"""Append-only, date-indexed history store behind trading_script's CSVs.
+
+trading_script used to read the whole portfolio/trade-log CSV, append a
+day's rows and write the file back, and re-read it again just to find the
+TOTAL rows or the latest date. Here each CSV gets a SQLite sidecar
+(``chatgpt_portfolio_update.csv`` -> ``chatgpt_portfolio_update.sqlite``)
+holding one row per CSV line, indexed by date and TOTAL flag, plus a
+``latest_state`` snapshot refreshed on every write.
+
+The CSV stays the compatibility/export format:
+- New rows are appended to it; it is only rewritten when a day's rows are
+  replaced (re-running process_portfolio on the same day) or a new column
+  shows up.
+- When the CSV was changed outside this store (size/mtime differ from the
+  last export) or the sidecar is new, the store is rebuilt from the CSV.
+- When a CSV the store exported has been deleted, the history is treated as
+  cleared: the sidecar is emptied and the next write starts a fresh CSV.
+
+Usage:
+    store = get_history_store(PORTFOLIO_CSV)
+    store.append(rows, replace_date=today_iso)
+    totals = store.totals()
+    state = store.latest_state()
+"""
+
+from __future__ import annotations
+
+import csv
+import json
+import logging
+import math
+import os
+import sqlite3
+import threading
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Union
+
+import pandas as pd
+
+logger = logging.getLogger(__name__)
+
+TOTAL_TICKER = "TOTAL"
+
+_STORES: Dict[str, "CsvHistoryStore"] = {}
+_STORES_LOCK = threading.Lock()
+
+
+def get_history_store(csv_path: Union[str, Path]) -> "CsvHistoryStore":
+    """Shared store for a CSV path (one connection per file per process)."""
+    key = str(Path(csv_path).resolve())
+    with _STORES_LOCK:
+        store = _STORES.get(key)
+        if store is None:
+            store = CsvHistoryStore(csv_path)
+            _STORES[key] = store
+        return store
+
+
+def _clean(value: Any) -> Any:
+    """JSON-safe scalar: numpy -> python, NaN -> None."""
+    if hasattr(value, "item"):
+        value = value.item()
+    if isinstance(value, float) and math.isnan(value):
+        return None
+    if isinstance(value, pd.Timestamp):
+        return value.isoformat()
+    return value
+
+
+def _date_key(value: Any) -> str:
+    """ISO date used for indexing; the row keeps its original Date text."""
+    ts = pd.to_datetime(value, format="mixed", errors="coerce")
+    return "" if pd.isna(ts) else ts.date().isoformat()
+
+
+class CsvHistoryStore:
+    """SQLite sidecar for one append-mostly CSV."""
+
+    def __init__(self, csv_path: Union[str, Path], db_path: Union[str, Path, None] = None):
+        """
+        Args:
+            csv_path: CSV file the store mirrors (created/appended on write).
+            db_path: SQLite file (default: csv_path with a .sqlite suffix).
+        """
+        self.csv_path = Path(csv_path)
+        self.db_path = Path(db_path) if db_path else self.csv_path.with_suffix(".sqlite")
+        self._lock = threading.RLock()
+
+        self._conn = sqlite3.connect(str(self.db_path), check_same_thread=False)
+        self._conn.executescript("""
+            CREATE TABLE IF NOT EXISTS history (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                date TEXT NOT NULL,
+                ticker TEXT,
+                is_total INTEGER NOT NULL DEFAULT 0,
+                data TEXT NOT NULL
+            );
+            CREATE INDEX IF NOT EXISTS idx_history_date ON history (date);
+            CREATE INDEX IF NOT EXISTS idx_history_total_date ON history (is_total, date);
+            CREATE TABLE IF NOT EXISTS meta (
+                key TEXT PRIMARY KEY,
+                value TEXT NOT NULL
+            );
+        """)
+        self._conn.commit()
+        self._sync_from_csv()
+
+    # ------------------------------
+    # Writes
+    # ------------------------------
+
+    def append(self, rows: List[Dict[str, Any]], replace_date: Optional[str] = None) -> None:
+        """Append rows; with replace_date, that day's existing rows are replaced."""
+        if not rows and replace_date is None:
+            return
+
+        with self._lock:
+            self._sync_from_csv()
+            columns = self._columns()
+            new_columns = [k for row in rows for k in row if k not in columns]
+            for column in dict.fromkeys(new_columns):
+                columns.append(column)
+
+            replaced = 0
+            if replace_date is not None:
+                replaced = self._conn.execute(
+                    "DELETE FROM history WHERE date = ?", (_date_key(replace_date),)
+                ).rowcount
+
+            self._insert(rows)
+            self._set_meta("columns", columns)
+            self._refresh_latest_state()
+            self._conn.commit()
+
+            if replaced or new_columns or not self.csv_path.exists():
+                self.export_csv()
+            else:
+                self._append_csv(rows, columns)
+
+    def export_csv(self, path: Union[str, Path, None] = None) -> Path:
+        """Write the full history as CSV (default: the mirrored CSV)."""
+        target = Path(path) if path else self.csv_path
+        with self._lock:
+            self.frame().to_csv(target, index=False)
+            if target == self.csv_path:
+                self._remember_csv()
+        return target
+
+    # ------------------------------
+    # Reads
+    # ------------------------------
+
+    def frame(self) -> pd.DataFrame:
+        """Whole history in CSV row order."""
+        return self._query("SELECT data FROM history ORDER BY id")
+
+    def totals(self) -> pd.DataFrame:
+        """TOTAL rows only, by date."""
+        return self._query("SELECT data FROM history WHERE is_total = 1 ORDER BY date, id")
+
+    def latest_state(self) -> Optional[Dict[str, Any]]:
+        """Snapshot of the latest positions and TOTAL row, or None when empty.
+
+        positions are the non-TOTAL rows of the latest non-TOTAL date; total
+        is the latest TOTAL row (None if there is none).
+        """
+        with self._lock:
+            row = self._conn.execute("SELECT value FROM meta WHERE key = 'latest_state'").fetchone()
+        return json.loads(row[0]) if row else None
+
+    def row_count(self) -> int:
+        with self._lock:
+            return self._conn.execute("SELECT COUNT(*) FROM history").fetchone()[0]
+
+    def close(self) -> None:
+        with self._lock:
+            self._conn.close()
+
+    # ------------------------------
+    # Internals
+    # ------------------------------
+
+    def _insert(self, rows: List[Dict[str, Any]]) -> None:
+        self._conn.executemany(
+            "INSERT INTO history (date, ticker, is_total, data) VALUES (?, ?, ?, ?)",
+            [(
+                _date_key(row.get("Date")),
+                row.get("Ticker"),
+                1 if str(row.get("Ticker")) == TOTAL_TICKER else 0,
+                json.dumps({k: _clean(v) for k, v in row.items()}, default=str)
+            ) for row in rows]
+        )
+
+    def _query(self, sql: str, params: tuple = ()) -> pd.DataFrame:
+        with self._lock:
+            records = [json.loads(r[0]) for r in self._conn.execute(sql, params)]
+            columns = self._columns()
+        df = pd.DataFrame.from_records(records, columns=columns or None)
+        # Same shape read_csv produced: blanks are NaN, numeric columns numeric
+        return df.replace("", float("nan")).infer_objects()
+
+    def _refresh_latest_state(self) -> None:
+        latest_date = self._conn.execute("SELECT MAX(date) FROM history WHERE is_total = 0").fetchone()[0]
+        positions = [json.loads(r[0]) for r in self._conn.execute(
+            "SELECT data FROM history WHERE is_total = 0 AND date = ? ORDER BY id", (latest_date,)
+        )] if latest_date is not None else []
+        total = self._conn.execute(
+            "SELECT data FROM history WHERE is_total = 1 ORDER BY date DESC, id DESC LIMIT 1"
+        ).fetchone()
+
+        if not positions and total is None:
+            self._conn.execute("DELETE FROM meta WHERE key = 'latest_state'")
+            return
+        self._set_meta("latest_state", {
+            "date": latest_date,
+            "positions": positions,
+            "total": json.loads(total[0]) if total else None
+        })
+
+    def _columns(self) -> List[str]:
+        row = self._conn.execute("SELECT value FROM meta WHERE key = 'columns'").fetchone()
+        return json.loads(row[0]) if row else []
+
+    def _set_meta(self, key: str, value: Any) -> None:
+        self._conn.execute(
+            "INSERT OR REPLACE INTO meta (key, value) VALUES (?, ?)", (key, json.dumps(value, default=str))
+        )
+
+    def _csv_signature(self) -> Optional[List[int]]:
+        try:
+            stat = os.stat(self.csv_path)
+        except OSError:
+            return None
+        return [stat.st_size, stat.st_mtime_ns]
+
+    def _remember_csv(self) -> None:
+        self._set_meta("csv_signature", self._csv_signature())
+        self._conn.commit()
+
+    def _sync_from_csv(self) -> None:
+        """Rebuild from the CSV when it changed outside the store, or clear it when the CSV was deleted."""
+        signature = self._csv_signature()
+        row = self._conn.execute("SELECT value FROM meta WHERE key = 'csv_signature'").fetchone()
+        if signature is None:
+            if row is not None:
+                logger.info("%s was deleted; clearing %s", self.csv_path.name, self.db_path.name)
+                self._conn.execute("DELETE FROM history")
+                self._conn.execute("DELETE FROM meta WHERE key = 'csv_signature'")
+                self._refresh_latest_state()
+                self._conn.commit()
+            return
+        if row and json.loads(row[0]) == signature:
+            return
+
+        try:
+            df = pd.read_csv(self.csv_path)
+        except pd.errors.EmptyDataError:
+            df = pd.DataFrame()
+        logger.info("Rebuilding %s from %s (%d rows)", self.db_path.name, self.csv_path.name, len(df))
+        self._conn.execute("DELETE FROM history")
+        self._insert(df.to_dict(orient="records"))
+        self._set_meta("columns", list(df.columns))
+        self._refresh_latest_state()
+        self._remember_csv()
+
+    def _append_csv(self, rows: List[Dict[str, Any]], columns: List[str]) -> None:
+        with open(self.csv_path, "r", newline="") as handle:
+            header = next(csv.reader(handle), [])
+        if header != columns:
+            # Column order differs from what the store would write: realign once
+            self.export_csv()
+            return
+
+        with open(self.csv_path, "a", newline="") as handle:
+            writer = csv.DictWriter(handle, fieldnames=header, restval="", extrasaction="ignore")
+            for row in rows:
+                writer.writerow({k: "" if _clean(v) is None else _clean(v) for k, v in row.items()})
+        self._remember_csv()
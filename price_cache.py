@@ -0,0 +1,299 @@
+"""Local OHLCV cache for trading_script.download_price_data.
+
+Layers:
+- In-memory LRU of per-ticker frames (hot within a run)
+- On-disk columnar store, one file per ticker (Parquet when pyarrow or
+  fastparquet is installed, pickle otherwise; Feather on request)
+- A JSON index recording, per ticker, the date ranges already covered and the
+  provider that last succeeded
+
+A lookup for [start, end) fetches only the sub-ranges not yet covered, which
+in the daily run is just the trailing day or two, and merges them in. The
+current day is never marked as covered, so intraday bars get refreshed.
+
+Notes:
+- Ranges are half-open [start, end), matching download_price_data.
+- Only successful (non-empty) fetches extend coverage, so an outage doesn't
+  leave holes that read as "no data".
+"""
+
+from __future__ import annotations
+
+import json
+import logging
+import os
+import re
+import threading
+from collections import OrderedDict
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+import pandas as pd
+
+logger = logging.getLogger(__name__)
+
+OHLCV_COLUMNS = ["Open", "High", "Low", "Close", "Adj Close", "Volume"]
+
+# fetcher(ticker, start, end, preferred_provider) -> (frame, provider)
+Fetcher = Callable[[str, pd.Timestamp, pd.Timestamp, Optional[str]], Tuple[pd.DataFrame, str]]
+
+
+def _detect_format() -> str:
+    """Pick the best on-disk format the installed libraries support."""
+    try:
+        import pyarrow  # noqa: F401
+        return "parquet"
+    except Exception:
+        pass
+    try:
+        import fastparquet  # noqa: F401
+        return "parquet"
+    except Exception:
+        pass
+    return "pickle"
+
+
+def _merge_ranges(ranges: List[Tuple[pd.Timestamp, pd.Timestamp]]) -> List[Tuple[pd.Timestamp, pd.Timestamp]]:
+    """Merge overlapping or touching [start, end) ranges."""
+    merged: List[Tuple[pd.Timestamp, pd.Timestamp]] = []
+    for s, e in sorted(ranges):
+        if merged and s <= merged[-1][1]:
+            merged[-1] = (merged[-1][0], max(merged[-1][1], e))
+        else:
+            merged.append((s, e))
+    return merged
+
+
+def _missing_ranges(
+    covered: List[Tuple[pd.Timestamp, pd.Timestamp]],
+    start: pd.Timestamp,
+    end: pd.Timestamp,
+) -> List[Tuple[pd.Timestamp, pd.Timestamp]]:
+    """Sub-ranges of [start, end) not inside any covered range."""
+    missing = []
+    cursor = start
+    for s, e in covered:
+        if e <= cursor:
+            continue
+        if s >= end:
+            break
+        if s > cursor:
+            missing.append((cursor, min(s, end)))
+        cursor = max(cursor, e)
+        if cursor >= end:
+            break
+    if cursor < end:
+        missing.append((cursor, end))
+    return missing
+
+
+class PriceCache:
+    """Three-tier (memory / disk / network) daily OHLCV cache."""
+
+    INDEX_FILE = "_index.json"
+
+    def __init__(self, cache_dir: Path | str, max_memory_items: int = 256, fmt: str | None = None) -> None:
+        self.cache_dir = Path(cache_dir)
+        self.cache_dir.mkdir(parents=True, exist_ok=True)
+        self.max_memory_items = max_memory_items
+        self.fmt = fmt or _detect_format()
+        self._memory: "OrderedDict[str, pd.DataFrame]" = OrderedDict()
+        self._lock = threading.RLock()
+        self._index: Dict[str, dict] = self._load_index()
+        self.stats = {"memory_hits": 0, "disk_hits": 0, "network_fetches": 0}
+
+    # ---------- public API ----------
+
+    def get(
+        self,
+        ticker: str,
+        start: pd.Timestamp,
+        end: pd.Timestamp,
+        fetcher: Fetcher,
+        variant: str = "",
+    ) -> Tuple[pd.DataFrame, str]:
+        """Return (frame for [start, end), source), fetching only uncovered ranges.
+
+        `source` is "cache" when nothing had to be fetched, otherwise the
+        provider that served the newest delta.
+        """
+        missing, provider = self.plan(ticker, start, end, variant)
+
+        fetched = []
+        for ms, me in missing:
+            df, used = fetcher(ticker, ms, me, provider)
+            self.stats["network_fetches"] += 1
+            fetched.append((ms, me, df, used))
+            if df is not None and not df.empty:
+                provider = used
+
+        source = self.update(ticker, fetched, variant) or "cache"
+        return self.read(ticker, start, end, variant, source)
+
+    def plan(
+        self, ticker: str, start: pd.Timestamp, end: pd.Timestamp, variant: str = ""
+    ) -> Tuple[List[Tuple[pd.Timestamp, pd.Timestamp]], Optional[str]]:
+        """Ranges of [start, end) that still need fetching, plus the preferred provider."""
+        start = pd.Timestamp(start).normalize()
+        end = pd.Timestamp(end).normalize()
+        key = f"{ticker}{variant}"
+
+        with self._lock:
+            frame = self._load_frame(key)
+            entry = self._index.setdefault(key, {"ranges": [], "provider": None})
+            if frame is None:
+                entry["ranges"] = []  # Data file gone; coverage no longer holds
+            covered = [(pd.Timestamp(s), pd.Timestamp(e)) for s, e in entry["ranges"]]
+            return _missing_ranges(covered, start, end), entry.get("provider")
+
+    def update(
+        self,
+        ticker: str,
+        fetched: List[Tuple[pd.Timestamp, pd.Timestamp, Optional[pd.DataFrame], str]],
+        variant: str = "",
+    ) -> Optional[str]:
+        """Merge fetched (start, end, frame, provider) deltas into the cache.
+
+        Returns the provider of the last non-empty delta, or None if every
+        delta was empty.
+        """
+        key = f"{ticker}{variant}"
+        today = pd.Timestamp.now().normalize()
+        deltas = []
+        provider = None
+
+        with self._lock:
+            entry = self._index.setdefault(key, {"ranges": [], "provider": None})
+            covered = [(pd.Timestamp(s), pd.Timestamp(e)) for s, e in entry["ranges"]]
+
+            for ms, me, df, used in fetched:
+                if df is None or df.empty:
+                    continue
+                deltas.append(df)
+                provider = used
+                # Never mark today as settled; its bar may still change
+                ms, me = pd.Timestamp(ms).normalize(), pd.Timestamp(me).normalize()
+                covered.append((ms, min(me, today)))
+
+            if not deltas:
+                return None
+
+            frame = self._merge(self._load_frame(key), deltas)
+            entry["ranges"] = [
+                (s.isoformat(), e.isoformat()) for s, e in _merge_ranges([r for r in covered if r[0] < r[1]])
+            ]
+            entry["provider"] = provider
+            self._store_frame(key, frame)
+            self._save_index()
+
+        return provider
+
+    def read(
+        self, ticker: str, start: pd.Timestamp, end: pd.Timestamp, variant: str = "", source: str = "cache"
+    ) -> Tuple[pd.DataFrame, str]:
+        """Return (cached frame for [start, end), source) without touching the network."""
+        start = pd.Timestamp(start).normalize()
+        end = pd.Timestamp(end).normalize()
+
+        with self._lock:
+            frame = self._load_frame(f"{ticker}{variant}")
+
+        if frame is None or frame.empty:
+            return pd.DataFrame(columns=OHLCV_COLUMNS), "empty"
+
+        window = frame.loc[(frame.index >= start) & (frame.index < end)]
+        return window.copy(), source
+
+    def preferred_provider(self, ticker: str, variant: str = "") -> Optional[str]:
+        """Provider that last served this ticker, if any."""
+        return self._index.get(f"{ticker}{variant}", {}).get("provider")
+
+    def invalidate(self, ticker: str | None = None) -> None:
+        """Drop one ticker (all variants), or everything, from every tier."""
+        with self._lock:
+            keys = [k for k in list(self._index) if ticker is None or k == ticker or k.startswith(f"{ticker}@")]
+            for key in keys:
+                self._index.pop(key, None)
+                self._memory.pop(key, None)
+                path = self._path(key)
+                if path.exists():
+                    path.unlink()
+            self._save_index()
+
+    # ---------- tiers ----------
+
+    def _load_frame(self, key: str) -> Optional[pd.DataFrame]:
+        if key in self._memory:
+            self._memory.move_to_end(key)
+            self.stats["memory_hits"] += 1
+            return self._memory[key]
+
+        path = self._path(key)
+        if not path.exists():
+            return None
+
+        try:
+            if self.fmt == "parquet":
+                df = pd.read_parquet(path)
+            elif self.fmt == "feather":
+                df = pd.read_feather(path).set_index("Date")
+            else:
+                df = pd.read_pickle(path)
+        except Exception as exc:
+            logger.warning("Discarding unreadable price cache file %s: %s", path, exc)
+            self._index.pop(key, None)
+            return None
+
+        df.index = pd.to_datetime(df.index)
+        self.stats["disk_hits"] += 1
+        self._remember(key, df)
+        return df
+
+    def _store_frame(self, key: str, df: pd.DataFrame) -> None:
+        path = self._path(key)
+        tmp = path.with_suffix(path.suffix + ".tmp")
+        if self.fmt == "parquet":
+            df.to_parquet(tmp)
+        elif self.fmt == "feather":
+            df.rename_axis("Date").reset_index().to_feather(tmp)
+        else:
+            df.to_pickle(tmp)
+        os.replace(tmp, path)  # Atomic, so readers never see a half-written file
+        self._remember(key, df)
+
+    def _remember(self, key: str, df: pd.DataFrame) -> None:
+        self._memory[key] = df
+        self._memory.move_to_end(key)
+        while len(self._memory) > self.max_memory_items:
+            self._memory.popitem(last=False)
+
+    @staticmethod
+    def _merge(frame: Optional[pd.DataFrame], deltas: List[pd.DataFrame]) -> pd.DataFrame:
+        parts = ([frame] if frame is not None and not frame.empty else []) + deltas
+        merged = pd.concat(parts)
+        # Newer fetches win for overlapping dates (e.g. today's refreshed bar)
+        merged = merged[~merged.index.duplicated(keep="last")].sort_index()
+        return merged
+
+    # ---------- index / paths ----------
+
+    def _path(self, key: str) -> Path:
+        safe = re.sub(r"[^A-Za-z0-9_.@-]", "_", key)
+        ext = {"parquet": ".parquet", "feather": ".feather"}.get(self.fmt, ".pkl")
+        return self.cache_dir / f"{safe}{ext}"
+
+    def _load_index(self) -> Dict[str, dict]:
+        path = self.cache_dir / self.INDEX_FILE
+        try:
+            return json.loads(path.read_text(encoding="utf-8"))
+        except FileNotFoundError:
+            return {}
+        except Exception as exc:
+            logger.warning("Price cache index unreadable, starting empty: %s", exc)
+            return {}
+
+    def _save_index(self) -> None:
+        path = self.cache_dir / self.INDEX_FILE
+        tmp = path.with_suffix(".tmp")
+        tmp.write_text(json.dumps(self._index, indent=1), encoding="utf-8")
+        os.replace(tmp, path)
@@ -0,0 +1,435 @@
+"""Hot-path counters, histograms and timing spans with a Prometheus exporter.
+
+The Python side of src/Metrics.php. Both write per-process snapshots in the
+same JSON format, with the same buckets, to one shared directory, so either
+exporter (monitor_api.php?action=metrics or `python3 runtime_metrics.py`)
+reports PHP workers and Python analyzers together.
+
+- Every span counts into <name>_total. A sampled fraction also records its
+  duration in <name>_seconds.
+- The sample rate comes from WEALTHSYSTEM_METRICS_SAMPLE_RATE (0..1). It
+  defaults to 0, which turns recording off: span() then returns a shared
+  no-op and the other calls return after one comparison.
+- Snapshots go to WEALTHSYSTEM_METRICS_DIR, written every flush_interval
+  seconds while recording and at exit. collect() folds the files of exited
+  processes into archive.json.
+
+Usage:
+    import runtime_metrics as metrics
+
+    with metrics.span("price_provider_fetch", provider="yahoo") as s:
+        frame = fetch()
+        if frame.empty:
+            s.label(outcome="empty")
+
+    python3 runtime_metrics.py --port 9464   # serve /metrics
+    python3 runtime_metrics.py --once        # print it and exit
+"""
+
+from __future__ import annotations
+
+import argparse
+import atexit
+import bisect
+import fcntl
+import functools
+import glob
+import json
+import logging
+import os
+import random
+import socket
+import tempfile
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Any, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+PREFIX = "wealthsystem_"
+
+# Bucket upper bounds in seconds, shared with Metrics::BUCKETS
+BUCKETS = [0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60]
+
+_lock = threading.Lock()
+_sample_rate: Optional[float] = None
+_dir = ""
+_flush_interval = 10.0
+_last_flush = 0.0
+_pid = os.getpid()
+_counters: Dict[str, Dict[str, Any]] = {}
+_histograms: Dict[str, Dict[str, Any]] = {}
+_dirty = False
+
+
+def configure(sample_rate: Optional[float] = None, directory: Optional[str] = None,
+              flush_interval: float = 10.0) -> None:
+    """Apply settings. Unset ones fall back to the environment, then to defaults."""
+    global _sample_rate, _dir, _flush_interval
+    if sample_rate is None:
+        try:
+            sample_rate = float(os.environ.get("WEALTHSYSTEM_METRICS_SAMPLE_RATE") or 0)
+        except ValueError:
+            sample_rate = 0.0
+    _sample_rate = max(0.0, min(1.0, sample_rate))
+    _dir = (directory or os.environ.get("WEALTHSYSTEM_METRICS_DIR")
+            or os.path.join(tempfile.gettempdir(), "wealthsystem_metrics"))
+    _flush_interval = flush_interval
+
+
+def is_enabled() -> bool:
+    if _sample_rate is None:
+        configure()
+    return _sample_rate > 0
+
+
+def _key(name: str, labels: Dict[str, Any]) -> str:
+    return name + json.dumps(labels, sort_keys=True, separators=(",", ":"))
+
+
+def increment(name: str, value: float = 1, **labels: Any) -> None:
+    """Add to a counter. Use low-cardinality labels only (no symbols or ids)."""
+    global _dirty
+    if not is_enabled():
+        return
+    labels = {k: str(v) for k, v in labels.items()}
+    with _lock:
+        series = _counters.setdefault(_key(name, labels), {"name": name, "labels": labels, "value": 0})
+        series["value"] += value
+        _dirty = True
+    _maybe_flush()
+
+
+def observe(name: str, seconds: float, **labels: Any) -> None:
+    """Record a duration in a histogram."""
+    global _dirty
+    if not is_enabled():
+        return
+    labels = {k: str(v) for k, v in labels.items()}
+    with _lock:
+        series = _histograms.setdefault(_key(name, labels), {
+            "name": name, "labels": labels, "counts": [0] * (len(BUCKETS) + 1), "sum": 0.0, "count": 0
+        })
+        series["counts"][bisect.bisect_left(BUCKETS, seconds)] += 1
+        series["sum"] += seconds
+        series["count"] += 1
+        _dirty = True
+    _maybe_flush()
+
+
+class _Span:
+    """Times a block and records it on exit, with outcome="ok" or "error" unless overridden."""
+
+    __slots__ = ("name", "labels", "started")
+
+    def __init__(self, name: str, labels: Dict[str, Any], sampled: bool):
+        self.name = name
+        self.labels = labels
+        self.started = time.perf_counter() if sampled else None
+
+    def label(self, **labels: Any) -> "_Span":
+        """Set labels only known inside the block."""
+        self.labels.update(labels)
+        return self
+
+    def __enter__(self) -> "_Span":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> bool:
+        self.labels.setdefault("outcome", "error" if exc_type else "ok")
+        increment(f"{self.name}_total", **self.labels)
+        if self.started is not None:
+            observe(f"{self.name}_seconds", time.perf_counter() - self.started, **self.labels)
+        return False
+
+
+class _NoopSpan:
+    __slots__ = ()
+
+    def label(self, **labels: Any) -> "_NoopSpan":
+        return self
+
+    def __enter__(self) -> "_NoopSpan":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> bool:
+        return False
+
+
+_NOOP_SPAN = _NoopSpan()
+
+
+def span(name: str, **labels: Any):
+    """Context manager that counts into <name>_total and, when sampled, times into <name>_seconds."""
+    if _sample_rate is None:
+        configure()
+    if _sample_rate <= 0:
+        return _NOOP_SPAN
+    sampled = _sample_rate >= 1 or random.random() < _sample_rate
+    return _Span(name, labels, sampled)
+
+
+def timed(name: str, **labels: Any):
+    """Decorator form of span()."""
+    def decorator(fn):
+        @functools.wraps(fn)
+        def wrapper(*args, **kwargs):
+            with span(name, **labels):
+                return fn(*args, **kwargs)
+        return wrapper
+    return decorator
+
+
+def _maybe_flush() -> None:
+    if time.monotonic() - _last_flush >= _flush_interval:
+        flush()
+
+
+def _host() -> str:
+    return socket.gethostname()
+
+
+def _host_tag() -> str:
+    return "".join(c if c.isalnum() or c in "_." else "_" for c in _host())
+
+
+def snapshot() -> Dict[str, Any]:
+    """This process's totals, in the file format Metrics.php shares."""
+    with _lock:
+        counters = [dict(series) for series in _counters.values()]
+        histograms = [dict(series, buckets=BUCKETS) for series in _histograms.values()]
+    return {
+        "lang": "python", "host": _host(), "pid": _pid, "updated_at": int(time.time()),
+        "counters": counters, "histograms": histograms
+    }
+
+
+def _write_json(path: str, data: Dict[str, Any]) -> None:
+    tmp = f"{path}.{os.getpid()}.tmp"
+    try:
+        with open(tmp, "w") as handle:
+            json.dump(data, handle)
+        os.replace(tmp, path)
+    except OSError as e:
+        logger.debug(f"Could not write metrics snapshot {path}: {e}")
+        try:
+            os.unlink(tmp)
+        except OSError:
+            pass
+
+
+def _read_json(path: str) -> Optional[Dict[str, Any]]:
+    try:
+        with open(path) as handle:
+            data = json.load(handle)
+    except (OSError, ValueError):
+        return None
+    return data if isinstance(data, dict) else None
+
+
+def flush() -> None:
+    """Write this process's totals to its snapshot file."""
+    global _dirty, _last_flush
+    if _sample_rate is None or not _dirty:
+        return
+    data = snapshot()
+    try:
+        os.makedirs(_dir, exist_ok=True)
+    except OSError:
+        return
+    _write_json(os.path.join(_dir, f"py-{_host_tag()}-{_pid}.json"), data)
+    _dirty = False
+    _last_flush = time.monotonic()
+
+
+def reset() -> None:
+    """Drop everything recorded in this process."""
+    global _dirty, _pid, _last_flush
+    with _lock:
+        _counters.clear()
+        _histograms.clear()
+        _dirty = False
+        _pid = os.getpid()
+        _last_flush = time.monotonic()
+
+
+def _has_exited(data: Dict[str, Any]) -> bool:
+    pid = int(data.get("pid") or 0)
+    if pid <= 0 or data.get("host") != _host() or pid == os.getpid():
+        return False
+    try:
+        os.kill(pid, 0)
+    except ProcessLookupError:
+        return True
+    except PermissionError:
+        return False
+    return False
+
+
+def merge(snapshots: List[Optional[Dict[str, Any]]]) -> Dict[str, List[Dict[str, Any]]]:
+    """Sum counters and histograms series by series."""
+    counters: Dict[str, Dict[str, Any]] = {}
+    histograms: Dict[str, Dict[str, Any]] = {}
+    for data in snapshots:
+        if not data:
+            continue
+        for series in data.get("counters", []):
+            labels = dict(series.get("labels") or {})
+            merged = counters.setdefault(_key(series["name"], labels),
+                                         {"name": series["name"], "labels": labels, "value": 0})
+            merged["value"] += series["value"]
+        for series in data.get("histograms", []):
+            if [float(b) for b in series.get("buckets", [])] != [float(b) for b in BUCKETS]:
+                continue
+            labels = dict(series.get("labels") or {})
+            merged = histograms.setdefault(_key(series["name"], labels), {
+                "name": series["name"], "labels": labels, "counts": [0] * (len(BUCKETS) + 1),
+                "sum": 0.0, "count": 0, "buckets": BUCKETS
+            })
+            for i, count in enumerate(series["counts"]):
+                merged["counts"][i] += count
+            merged["sum"] += series["sum"]
+            merged["count"] += series["count"]
+    return {
+        "counters": [counters[k] for k in sorted(counters)],
+        "histograms": [histograms[k] for k in sorted(histograms)]
+    }
+
+
+def collect(directory: Optional[str] = None) -> Dict[str, List[Dict[str, Any]]]:
+    """Totals across every process writing to the metrics directory."""
+    if _sample_rate is None:
+        configure()
+    flush()
+    directory = directory or _dir
+    if not os.path.isdir(directory):
+        return merge([])
+
+    with open(os.path.join(directory, ".lock"), "a") as lock:
+        fcntl.flock(lock, fcntl.LOCK_EX)
+        try:
+            archive_path = os.path.join(directory, "archive.json")
+            archive = _read_json(archive_path)
+            live, exited = [], {}
+            for path in glob.glob(os.path.join(directory, "*-*.json")):
+                data = _read_json(path)
+                if data is None:
+                    continue
+                if _has_exited(data):
+                    exited[path] = data
+                else:
+                    live.append(data)
+
+            if exited:
+                archive = merge([archive] + list(exited.values()))
+                _write_json(archive_path, archive)
+                for path in exited:
+                    try:
+                        os.unlink(path)
+                    except OSError:
+                        pass
+            return merge([archive] + live)
+        finally:
+            fcntl.flock(lock, fcntl.LOCK_UN)
+
+
+def _metric_name(name: str) -> str:
+    return PREFIX + "".join(c if c.isalnum() or c in "_:" else "_" for c in name)
+
+
+def _format_labels(labels: Dict[str, Any]) -> str:
+    if not labels:
+        return ""
+    pairs = []
+    for key, value in labels.items():
+        value = str(value).replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+        key = "".join(c if c.isalnum() or c == "_" else "_" for c in key)
+        pairs.append(f'{key}="{value}"')
+    return "{" + ",".join(pairs) + "}"
+
+
+def _format_value(value: float) -> str:
+    return str(value) if isinstance(value, int) else f"{value:.10g}"
+
+
+def render(metrics: Dict[str, List[Dict[str, Any]]]) -> str:
+    """Prometheus text exposition of collect() output."""
+    lines: List[str] = []
+    typed = set()
+    for series in metrics["counters"]:
+        name = _metric_name(series["name"])
+        if name not in typed:
+            lines.append(f"# TYPE {name} counter")
+            typed.add(name)
+        lines.append(f"{name}{_format_labels(series['labels'])} {_format_value(series['value'])}")
+
+    for series in metrics["histograms"]:
+        name = _metric_name(series["name"])
+        if name not in typed:
+            lines.append(f"# TYPE {name} histogram")
+            typed.add(name)
+        labels = series["labels"]
+        cumulative = 0
+        for le, count in zip(BUCKETS, series["counts"]):
+            cumulative += count
+            lines.append(f"{name}_bucket{_format_labels(dict(labels, le=f'{le:g}'))} {cumulative}")
+        lines.append(f"{name}_bucket{_format_labels(dict(labels, le='+Inf'))} {series['count']}")
+        lines.append(f"{name}_sum{_format_labels(labels)} {_format_value(series['sum'])}")
+        lines.append(f"{name}_count{_format_labels(labels)} {series['count']}")
+    return "\n".join(lines) + "\n" if lines else ""
+
+
+def serve(port: int = 9464, host: str = "", directory: Optional[str] = None) -> None:
+    """Serve the merged metrics at http://host:port/metrics until interrupted."""
+
+    class Handler(BaseHTTPRequestHandler):
+        def do_GET(self):
+            if self.path.split("?")[0] != "/metrics":
+                self.send_error(404)
+                return
+            body = render(collect(directory)).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "text/plain; version=0.0.4")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):
+            logger.debug(format % args)
+
+    server = ThreadingHTTPServer((host, port), Handler)
+    logger.info(f"Serving metrics from {directory or _dir} on :{port}/metrics")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+
+
+# A forked child starts empty: the inherited totals are the parent's to report
+if hasattr(os, "register_at_fork"):
+    os.register_at_fork(after_in_child=reset)
+atexit.register(flush)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Prometheus exporter for WealthSystem runtime metrics")
+    parser.add_argument("--port", type=int, default=9464, help="Port to serve /metrics on")
+    parser.add_argument("--host", default="", help="Address to bind")
+    parser.add_argument("--dir", help="Metrics directory (default WEALTHSYSTEM_METRICS_DIR)")
+    parser.add_argument("--once", action="store_true", help="Print the metrics once and exit")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO, format="%(asctime)s - %(levelname)s - %(message)s")
+    configure(directory=args.dir)
+    if args.once:
+        print(render(collect()), end="")
+    else:
+        serve(args.port, args.host)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,19 @@
+#!/usr/bin/env php
+<?php
+/**
+ * Storage Backend Migration Script
+ * Copies prices, indicators and patterns between per-symbol tables and the
+ * shared partitioned tables, for every symbol in the registry.
+ *
+ * Usage: php MigrateStorageBackend.php [--to=partitioned|per_symbol] [--symbol=SYMBOL]
+ *                                      [--batch-size=N] [--include-inactive] [--dry-run]
+ */
+
+if (php_sapi_name() !== 'cli') {
+    die("This script must be run from the command line\n");
+}
+
+require_once __DIR__ . '/../src/MigrateStorageBackendCliHandler.php';
+
+$handler = new MigrateStorageBackendCliHandler();
+$handler->run($argv);
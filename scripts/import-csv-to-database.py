@@ -7,10 +7,19 @@ so that the PHP migration scripts can then migrate them to per-symbol tables.
 
 Usage:
     python3 import-csv-to-database.py [options]
+
+Bulk mode (--bulk) reads CSVs in chunks and writes them with large executemany
+batches, or LOAD DATA LOCAL INFILE with --load-data, and reports rows/second.
+Price files can be loaded straight into the per-symbol <symbol>_prices tables
+managed by StockTableManager with --per-symbol.
 """
 
 import sys
 import os
+import re
+import csv
+import time
+import tempfile
 import pandas as pd
 import mysql.connector
 from mysql.connector import Error
@@ -19,17 +28,226 @@ import yaml
 import argparse
 from pathlib import Path
 import logging
+from contextlib import contextmanager
+
+# Random walk shared with the benchmark suite
+from sample_data import PRICE_COLUMNS, sample_price_records
 
 # Configure logging
 logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(levelname)s - %(message)s')
 logger = logging.getLogger(__name__)
 
+# Shared-backend keys of SymbolRegistryCache.php
+REGISTRY_CACHE_PREFIX = 'stock_symbol_registry:'
+
+# Mirrors the historical_prices template in StockTableManager.php
+PER_SYMBOL_PRICES_SCHEMA = """
+    CREATE TABLE IF NOT EXISTS {table_name} (
+        id INT AUTO_INCREMENT PRIMARY KEY,
+        symbol VARCHAR(10) NOT NULL,
+        date DATE NOT NULL,
+        open DECIMAL(10,4) NOT NULL,
+        high DECIMAL(10,4) NOT NULL,
+        low DECIMAL(10,4) NOT NULL,
+        close DECIMAL(10,4) NOT NULL,
+        adj_close DECIMAL(10,4),
+        volume BIGINT,
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+        updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+        UNIQUE KEY unique_date_symbol (symbol, date),
+        INDEX idx_date (date),
+        INDEX idx_symbol (symbol)
+    ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci
+"""
+
+
+def per_symbol_table_name(symbol, suffix='_prices'):
+    """Per-symbol table name, sanitized the same way as StockTableManager."""
+    sanitized = re.sub(r'[^A-Za-z0-9]', '_', symbol)
+    if sanitized[:1].isdigit():
+        sanitized = 'stock_' + sanitized
+    return sanitized.lower() + suffix
+
+
+def iter_csv_chunks(csv_file, chunk_size):
+    """Yield the CSV as DataFrames of roughly chunk_size rows.
+
+    Uses pyarrow's streaming reader when available, falling back to
+    pandas' chunked C parser. Every column is read as a string; callers
+    convert the columns they need.
+    """
+    try:
+        import pyarrow as pa
+        from pyarrow import csv as pa_csv
+    except ImportError:
+        pa_csv = None
+
+    if pa_csv is not None:
+        with open(csv_file, 'rb') as handle:
+            header = next(csv.reader([handle.readline().decode('utf-8-sig')]))
+        reader = pa_csv.open_csv(
+            csv_file,
+            read_options=pa_csv.ReadOptions(block_size=1 << 22),
+            convert_options=pa_csv.ConvertOptions(column_types={name: pa.string() for name in header})
+        )
+        pending = []
+        pending_rows = 0
+        for batch in reader:
+            pending.append(batch)
+            pending_rows += batch.num_rows
+            if pending_rows >= chunk_size:
+                yield pa.Table.from_batches(pending).to_pandas()
+                pending, pending_rows = [], 0
+        if pending:
+            yield pa.Table.from_batches(pending).to_pandas()
+        return
+
+    for chunk in pd.read_csv(csv_file, chunksize=chunk_size, dtype=str, keep_default_na=False):
+        yield chunk
+
+
+def parse_dates(column):
+    """Vectorized version of the row-by-row m/d/Y or Y-m-d date parsing."""
+    values = column.astype(str).str.strip()
+    iso = pd.to_datetime(values, format='%Y-%m-%d', errors='coerce')
+    us = pd.to_datetime(values, format='%m/%d/%Y', errors='coerce')
+    return iso.where(values.str.find('/') < 0, us).dt.date
+
+
+def numeric(df, column, default=0.0):
+    """Float column, or default when the column is missing or a value does not parse.
+
+    A default of None leaves unparseable values as NaN.
+    """
+    if column not in df.columns:
+        return pd.Series(default, index=df.index, dtype='float64')
+    values = pd.to_numeric(df[column], errors='coerce')
+    return values if default is None else values.fillna(default)
+
+
+class BulkLoader:
+    """Batched writer for seeding tables quickly.
+
+    Rows are written with executemany in batches of batch_size, or through
+    LOAD DATA LOCAL INFILE when use_load_data is set. For the duration of a
+    load, foreign key checks are off and ALTER TABLE ... DISABLE KEYS defers
+    non-unique index maintenance on engines that support it (MyISAM; InnoDB
+    ignores it). Unique checks stay on because INSERT IGNORE / IGNORE depends
+    on them to skip duplicate rows.
+
+    Loads into many tables (e.g. one per symbol) should run inside
+    session(), so the checks are toggled once and each table's keys are
+    rebuilt once, at the end, instead of around every load() call.
+    """
+
+    def __init__(self, connection, batch_size=10000, use_load_data=False):
+        self.connection = connection
+        self.batch_size = batch_size
+        self.use_load_data = use_load_data
+        self.logger = logging.getLogger(__name__)
+        # Tables with keys disabled in the open session; None outside one
+        self._deferred = None
+
+    @contextmanager
+    def session(self):
+        """Keep foreign key checks off and keys disabled across several load() calls."""
+        if self._deferred is not None:
+            yield self
+            return
+
+        cursor = self.connection.cursor()
+        self._deferred = []
+        try:
+            cursor.execute("SET SESSION foreign_key_checks = 0")
+            yield self
+        finally:
+            for table in self._deferred:
+                cursor.execute(f"ALTER TABLE {table} ENABLE KEYS")
+            cursor.execute("SET SESSION foreign_key_checks = 1")
+            cursor.close()
+            self._deferred = None
+
+    def load(self, table, columns, frames):
+        """Write every DataFrame in frames into table.
+
+        Args:
+            table: Target table name.
+            columns: Column names, in the order of the DataFrame columns.
+            frames: Iterable of DataFrames whose columns match columns.
+
+        Returns:
+            Number of rows sent to the server.
+        """
+        if self._deferred is None:
+            with self.session():
+                return self.load(table, columns, frames)
+
+        cursor = self.connection.cursor()
+        started = time.time()
+        rows = 0
+
+        try:
+            if table not in self._deferred:
+                cursor.execute(f"ALTER TABLE {table} DISABLE KEYS")
+                self._deferred.append(table)
+
+            for frame in frames:
+                if frame.empty:
+                    continue
+                if self.use_load_data:
+                    self._load_data_infile(cursor, table, columns, frame)
+                else:
+                    self._executemany(cursor, table, columns, frame)
+                self.connection.commit()
+                rows += len(frame)
+        finally:
+            cursor.close()
+
+        elapsed = max(time.time() - started, 1e-6)
+        self.logger.info(f"Loaded {rows} rows into {table} in {elapsed:.2f}s ({rows / elapsed:,.0f} rows/s)")
+        return rows
+
+    def _executemany(self, cursor, table, columns, frame):
+        placeholders = ', '.join(['%s'] * len(columns))
+        query = f"INSERT IGNORE INTO {table} ({', '.join(columns)}) VALUES ({placeholders})"
+        records = list(frame.astype(object).where(frame.notna(), None).itertuples(index=False, name=None))
+
+        for start in range(0, len(records), self.batch_size):
+            cursor.executemany(query, records[start:start + self.batch_size])
+
+    def _load_data_infile(self, cursor, table, columns, frame):
+        with tempfile.NamedTemporaryFile('w', suffix='.csv', delete=False, newline='') as handle:
+            frame.to_csv(handle, header=False, index=False, na_rep='\\N')
+            path = handle.name
+
+        try:
+            cursor.execute(
+                f"LOAD DATA LOCAL INFILE %s IGNORE INTO TABLE {table} "
+                "FIELDS TERMINATED BY ',' OPTIONALLY ENCLOSED BY '\"' "
+                "LINES TERMINATED BY '\\n' "
+                f"({', '.join(columns)})",
+                (path,)
+            )
+        finally:
+            os.unlink(path)
+
+
 class CSVToDatabaseImporter:
-    def __init__(self, config_file=None):
-        """Initialize the importer with database configuration."""
+    def __init__(self, config_file=None, bulk=False, batch_size=10000, load_data=False):
+        """Initialize the importer with database configuration.
+
+        Args:
+            config_file: Path to db_config.yml.
+            bulk: Use chunked parsing and BulkLoader instead of per-row inserts.
+            batch_size: Rows per parsed chunk and per executemany batch.
+            load_data: In bulk mode, load through LOAD DATA LOCAL INFILE.
+        """
         self.config = self.load_config(config_file)
         self.connection = None
         self.cursor = None
+        self.bulk = bulk
+        self.batch_size = batch_size
+        self.load_data = load_data
         
     def load_config(self, config_file):
         """Load database configuration from YAML file."""
@@ -68,7 +286,8 @@ class CSVToDatabaseImporter:
                 user=db_config['username'],
                 password=db_config['password'],
                 charset='utf8mb4',
-                use_unicode=True
+                use_unicode=True,
+                allow_local_infile=self.load_data
             )
             
             self.cursor = self.connection.cursor()
@@ -86,6 +305,10 @@ class CSVToDatabaseImporter:
             self.connection.close()
         logger.info("Database connection closed")
         
+    def bulk_loader(self):
+        """BulkLoader on the current connection."""
+        return BulkLoader(self.connection, self.batch_size, self.load_data)
+        
     def import_portfolio_data(self, csv_file):
         """Import portfolio data from CSV file."""
         logger.info(f"Importing portfolio data from {csv_file}")
@@ -94,6 +317,9 @@ class CSVToDatabaseImporter:
             logger.warning(f"Portfolio CSV file not found: {csv_file}")
             return 0
             
+        if self.bulk:
+            return self.bulk_import_portfolio_data(csv_file)
+            
         try:
             df = pd.read_csv(csv_file)
             
@@ -146,6 +372,39 @@ class CSVToDatabaseImporter:
             logger.error(f"Error importing portfolio data: {e}")
             return 0
             
+    def bulk_import_portfolio_data(self, csv_file):
+        """Chunked, batched equivalent of import_portfolio_data."""
+        columns = ['symbol', 'date', 'position_size', 'avg_cost', 'current_price', 'market_value', 'unrealized_pnl']
+        
+        def frames():
+            for chunk in iter_csv_chunks(csv_file, self.batch_size):
+                if 'Date' not in chunk.columns or 'Symbol' not in chunk.columns:
+                    raise ValueError("Missing required columns in portfolio CSV: ['Date', 'Symbol']")
+                    
+                frame = pd.DataFrame({
+                    'symbol': chunk['Symbol'].astype(str).str.upper(),
+                    'date': parse_dates(chunk['Date']),
+                    'position_size': numeric(chunk, 'Position_Size'),
+                    'avg_cost': numeric(chunk, 'Avg_Cost'),
+                    'current_price': numeric(chunk, 'Current_Price'),
+                    'market_value': numeric(chunk, 'Market_Value'),
+                    'unrealized_pnl': numeric(chunk, 'Unrealized_PnL')
+                })
+                yield self._drop_undated(frame)
+                
+        try:
+            return self.bulk_loader().load('portfolio_data', columns, frames())
+        except Exception as e:
+            logger.error(f"Error importing portfolio data: {e}")
+            return 0
+            
+    def _drop_undated(self, frame):
+        """Drop rows whose date did not parse, logging how many."""
+        undated = frame['date'].isna()
+        if undated.any():
+            logger.warning(f"Skipping {int(undated.sum())} rows with unparseable dates")
+        return frame[~undated]
+        
     def import_trade_log(self, csv_file):
         """Import trade log data from CSV file."""
         logger.info(f"Importing trade log from {csv_file}")
@@ -154,6 +413,9 @@ class CSVToDatabaseImporter:
             logger.warning(f"Trade log CSV file not found: {csv_file}")
             return 0
             
+        if self.bulk:
+            return self.bulk_import_trade_log(csv_file)
+            
         try:
             df = pd.read_csv(csv_file)
             
@@ -212,54 +474,166 @@ class CSVToDatabaseImporter:
             logger.error(f"Error importing trade log: {e}")
             return 0
             
-    def generate_sample_price_data(self, symbols, days=30):
+    def bulk_import_trade_log(self, csv_file):
+        """Chunked, batched equivalent of import_trade_log."""
+        columns = ['symbol', 'date', 'action', 'quantity', 'price', 'amount', 'reasoning']
+        
+        def frames():
+            for chunk in iter_csv_chunks(csv_file, self.batch_size):
+                missing = [col for col in ['Date', 'Symbol', 'Action'] if col not in chunk.columns]
+                if missing:
+                    raise ValueError(f"Missing required columns in trade log CSV: {missing}")
+                    
+                reasoning = chunk['Reasoning'] if 'Reasoning' in chunk.columns else pd.Series('', index=chunk.index)
+                frame = pd.DataFrame({
+                    'symbol': chunk['Symbol'].astype(str).str.upper(),
+                    'date': parse_dates(chunk['Date']),
+                    'action': chunk['Action'].astype(str).str.upper(),
+                    'quantity': numeric(chunk, 'Quantity'),
+                    'price': numeric(chunk, 'Price'),
+                    'amount': numeric(chunk, 'Amount'),
+                    'reasoning': reasoning.fillna('').astype(str).str.slice(0, 500)
+                })
+                
+                unknown = ~frame['action'].isin(['BUY', 'SELL', 'HOLD'])
+                if unknown.any():
+                    logger.warning(f"Skipping {int(unknown.sum())} rows with unknown actions")
+                yield self._drop_undated(frame[~unknown])
+                
+        try:
+            return self.bulk_loader().load('trade_log', columns, frames())
+        except Exception as e:
+            logger.error(f"Error importing trade log: {e}")
+            return 0
+            
+    def import_price_data(self, csv_file, per_symbol=False):
+        """Bulk-load OHLCV bars from a CSV file.
+        
+        Expected columns: Date, Symbol, Open, High, Low, Close, Volume and
+        optionally Adj_Close / Adj Close. With per_symbol, rows go to the
+        StockTableManager <symbol>_prices tables instead of historical_prices.
+        """
+        logger.info(f"Importing price data from {csv_file}")
+        
+        if not os.path.exists(csv_file):
+            logger.warning(f"Price CSV file not found: {csv_file}")
+            return 0
+            
+        def frames():
+            for chunk in iter_csv_chunks(csv_file, self.batch_size):
+                missing = [col for col in ['Date', 'Symbol', 'Open', 'High', 'Low', 'Close'] if col not in chunk.columns]
+                if missing:
+                    raise ValueError(f"Missing required columns in price CSV: {missing}")
+                    
+                adj_column = 'Adj_Close' if 'Adj_Close' in chunk.columns else 'Adj Close'
+                close = numeric(chunk, 'Close')
+                frame = pd.DataFrame({
+                    'symbol': chunk['Symbol'].astype(str).str.upper(),
+                    'date': parse_dates(chunk['Date']),
+                    'open': numeric(chunk, 'Open'),
+                    'high': numeric(chunk, 'High'),
+                    'low': numeric(chunk, 'Low'),
+                    'close': close,
+                    'adj_close': numeric(chunk, adj_column, None).fillna(close),
+                    'volume': numeric(chunk, 'Volume').astype('int64')
+                }, columns=PRICE_COLUMNS)
+                yield self._drop_undated(frame)
+                
+        try:
+            return self.load_prices(frames(), per_symbol)
+        except Exception as e:
+            logger.error(f"Error importing price data: {e}")
+            return 0
+            
+    def load_prices(self, frames, per_symbol=False):
+        """Write price DataFrames (PRICE_COLUMNS) to historical_prices or per-symbol tables."""
+        loader = self.bulk_loader()
+        
+        if not per_symbol:
+            return loader.load('historical_prices', PRICE_COLUMNS, frames)
+            
+        rows = 0
+        ensured = set()
+        try:
+            with loader.session():
+                for frame in frames:
+                    for symbol, group in frame.groupby('symbol', sort=False):
+                        table = per_symbol_table_name(symbol)
+                        if table not in ensured:
+                            self.ensure_per_symbol_prices_table(symbol, table)
+                            ensured.add(table)
+                        rows += loader.load(table, PRICE_COLUMNS, [group])
+        finally:
+            if ensured:
+                self.invalidate_registry_cache()
+        return rows
+        
+    def ensure_per_symbol_prices_table(self, symbol, table):
+        """Create <symbol>_prices if missing and make sure the symbol is registered.
+        
+        Only the prices table is created here; tables_created is left alone so
+        StockTableManager still creates the remaining per-symbol tables.
+        Callers must call invalidate_registry_cache() once they are done.
+        """
+        self.cursor.execute(PER_SYMBOL_PRICES_SCHEMA.format(table_name=table))
+        self.cursor.execute(
+            "INSERT INTO stock_symbol_registry (symbol, status) VALUES (%s, 'ACTIVE') "
+            "ON DUPLICATE KEY UPDATE symbol = symbol",
+            (symbol,)
+        )
+        self.connection.commit()
+        
+    def invalidate_registry_cache(self):
+        """Retire the PHP SymbolRegistryCache snapshot after writing stock_symbol_registry.
+        
+        Bumps the shared version exactly as SymbolRegistryCache::invalidate()
+        does for the redis backend. The apcu and memory backends live inside
+        PHP processes and cannot be reached from here. They are still
+        correct, because the rows written here have tables_created = 0 and
+        the cache sends every lookup without tables_created to the database.
+        """
+        cache = self.config.get('cache') or {}
+        if cache.get('backend') != 'redis':
+            return
+            
+        try:
+            import redis
+        except ImportError:
+            logger.warning("redis package not installed; symbol registry cache refreshes after its TTL")
+            return
+            
+        settings = cache.get('redis') or {}
+        try:
+            client = redis.Redis(
+                host=settings.get('host', 'localhost'),
+                port=int(settings.get('port', 6379)),
+                db=int(settings.get('database', 0)),
+                password=settings.get('password') or None,
+                socket_timeout=float(settings.get('timeout', 1))
+            )
+            client.incr(REGISTRY_CACHE_PREFIX + 'version')
+            client.delete(REGISTRY_CACHE_PREFIX + 'snapshot')
+        except Exception as e:
+            logger.warning(f"Failed to invalidate shared symbol registry cache: {e}")
+        
+    def generate_sample_price_data(self, symbols, days=30, per_symbol=False):
         """Generate sample historical price data for testing."""
         logger.info(f"Generating sample price data for {len(symbols)} symbols, {days} days")
         
+        if self.bulk or per_symbol:
+            return self.bulk_generate_sample_price_data(symbols, days, per_symbol)
+            
+
         insert_query = """
             INSERT IGNORE INTO historical_prices 
             (symbol, date, open, high, low, close, adj_close, volume)
             VALUES (%s, %s, %s, %s, %s, %s, %s, %s)
         """
         
-        import random
-        
         rows_inserted = 0
-        start_date = datetime.now() - timedelta(days=days)
         
-        for symbol in symbols:
-            base_price = random.uniform(10, 200)  # Random base price
-            
-            for i in range(days):
-                current_date = start_date + timedelta(days=i)
-                
-                # Skip weekends
-                if current_date.weekday() >= 5:
-                    continue
-                    
-                # Simulate price movement
-                daily_change = random.uniform(-0.1, 0.1)  # ±10% daily change
-                base_price *= (1 + daily_change)
-                base_price = max(1.0, base_price)  # Don't go below $1
-                
-                # Generate OHLC data
-                open_price = round(base_price * random.uniform(0.98, 1.02), 2)
-                high_price = round(open_price * random.uniform(1.0, 1.08), 2)
-                low_price = round(open_price * random.uniform(0.92, 1.0), 2)
-                close_price = round(low_price + random.random() * (high_price - low_price), 2)
-                volume = random.randint(100000, 2000000)
-                
-                values = (
-                    symbol,
-                    current_date.date(),
-                    open_price,
-                    high_price,
-                    low_price,
-                    close_price,
-                    close_price,  # adj_close = close for simplicity
-                    volume
-                )
-                
+        for _, records in sample_price_records(symbols, days):
+            for values in records:
                 self.cursor.execute(insert_query, values)
                 rows_inserted += 1
                 
@@ -267,6 +641,17 @@ class CSVToDatabaseImporter:
         logger.info(f"Generated {rows_inserted} sample price records")
         return rows_inserted
         
+    def bulk_generate_sample_price_data(self, symbols, days, per_symbol=False):
+        """Same random walk as generate_sample_price_data, one DataFrame per symbol."""
+        frames = (
+            pd.DataFrame.from_records(records, columns=PRICE_COLUMNS)
+            for _, records in sample_price_records(symbols, days)
+        )
+        
+        rows = self.load_prices(frames, per_symbol)
+        logger.info(f"Generated {rows} sample price records")
+        return rows
+        
     def import_all_csv_files(self, csv_directory):
         """Import all relevant CSV files from a directory."""
         csv_dir = Path(csv_directory)
@@ -303,10 +688,13 @@ class CSVToDatabaseImporter:
             if options.get('trade_log_file'):
                 self.import_trade_log(options['trade_log_file'])
                 
+            if options.get('price_file'):
+                self.import_price_data(options['price_file'], options.get('per_symbol', False))
+                
             if options.get('generate_sample'):
                 symbols = options.get('sample_symbols', ['IBM', 'AAPL', 'GOOGL', 'TSLA', 'MSFT'])
                 days = options.get('sample_days', 30)
-                self.generate_sample_price_data(symbols, days)
+                self.generate_sample_price_data(symbols, days, options.get('per_symbol', False))
                 
         finally:
             self.disconnect_from_database()
@@ -319,10 +707,16 @@ def main():
     parser.add_argument('--config', help='Database configuration file')
     parser.add_argument('--generate-sample', action='store_true', help='Generate sample data for testing')
     parser.add_argument('--sample-days', type=int, default=30, help='Number of days of sample data to generate')
+    parser.add_argument('--price-file', help='OHLCV price CSV file to bulk-load')
+    parser.add_argument('--per-symbol', action='store_true',
+                        help='Load prices into the per-symbol <symbol>_prices tables instead of historical_prices')
+    parser.add_argument('--bulk', action='store_true', help='Chunked parsing and batched writes instead of per-row inserts')
+    parser.add_argument('--batch-size', type=int, default=10000, help='Rows per chunk/batch in bulk mode')
+    parser.add_argument('--load-data', action='store_true', help='Bulk mode: write through LOAD DATA LOCAL INFILE')
     
     args = parser.parse_args()
     
-    if not any([args.csv_dir, args.portfolio_file, args.trade_log_file, args.generate_sample]):
+    if not any([args.csv_dir, args.portfolio_file, args.trade_log_file, args.price_file, args.generate_sample]):
         print("Error: Please specify at least one import option")
         parser.print_help()
         sys.exit(1)
@@ -332,11 +726,14 @@ def main():
         'portfolio_file': args.portfolio_file,
         'trade_log_file': args.trade_log_file,
         'generate_sample': args.generate_sample,
-        'sample_days': args.sample_days
+        'sample_days': args.sample_days,
+        'price_file': args.price_file,
+        'per_symbol': args.per_symbol
     }
     
     try:
-        importer = CSVToDatabaseImporter(args.config)
+        importer = CSVToDatabaseImporter(args.config, bulk=args.bulk, batch_size=args.batch_size,
+                                         load_data=args.load_data)
         importer.run_import(options)
         print("Import completed successfully!")
         
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""
+Synthetic price data
+
+The random walk behind import-csv-to-database.py's generate_sample_price_data,
+shared so the benchmark suite (benchmarks/run_benchmarks.py) runs against the
+same shape of data that sample imports load.
+
+Usage:
+    from sample_data import PRICE_COLUMNS, sample_price_records
+
+    for symbol, records in sample_price_records(['IBM', 'MSFT'], days=365, seed=42):
+        ...
+"""
+
+import random
+from datetime import datetime, timedelta
+
+PRICE_COLUMNS = ['symbol', 'date', 'open', 'high', 'low', 'close', 'adj_close', 'volume']
+
+
+def sample_price_records(symbols, days=30, seed=None, start_date=None):
+    """Yield (symbol, records) with one weekday bar per day over the last `days` days.
+
+    Args:
+        symbols: Symbols to generate.
+        days: Calendar days covered; weekends are skipped.
+        seed: Seed for a reproducible walk, or None to use the global RNG.
+        start_date: First calendar day (defaults to `days` days ago).
+
+    Yields:
+        (symbol, list of tuples in PRICE_COLUMNS order)
+    """
+    rng = random.Random(seed) if seed is not None else random
+    start_date = start_date or datetime.now() - timedelta(days=days)
+
+    for symbol in symbols:
+        base_price = rng.uniform(10, 200)  # Random base price
+        records = []
+
+        for i in range(days):
+            current_date = start_date + timedelta(days=i)
+
+            # Skip weekends
+            if current_date.weekday() >= 5:
+                continue
+
+            # Simulate price movement, ±10% daily, never below $1
+            base_price = max(1.0, base_price * (1 + rng.uniform(-0.1, 0.1)))
+
+            open_price = round(base_price * rng.uniform(0.98, 1.02), 2)
+            high_price = round(open_price * rng.uniform(1.0, 1.08), 2)
+            low_price = round(open_price * rng.uniform(0.92, 1.0), 2)
+            close_price = round(low_price + rng.random() * (high_price - low_price), 2)
+            volume = rng.randint(100000, 2000000)
+
+            # adj_close = close for simplicity
+            records.append((symbol, current_date.date(), open_price, high_price, low_price,
+                            close_price, close_price, volume))
+
+        yield symbol, records
+
@@ -0,0 +1,195 @@
+<?php
+require_once __DIR__ . '/BenchmarkSuite.php';
+
+/**
+ * Class BenchmarkCliHandler
+ * Parses benchmarks/php_benchmarks.php options, runs the selected
+ * BenchmarkSuite benchmarks and prints one JSON document on stdout.
+ *
+ * Backends whose extension, library or server is unavailable are reported
+ * under "skipped" with the reason instead of failing the run.
+ *
+ * @package MicroCapExperiment
+ */
+class BenchmarkCliHandler
+{
+    /**
+     * Queue backends and the class each one needs
+     */
+    const QUEUE_BACKENDS = [
+        'database' => 'DatabaseJobBackend',
+        'redis' => 'Redis',
+        'rabbitmq' => 'PhpAmqpLib\Connection\AMQPStreamConnection',
+        'mqtt' => 'Mosquitto\Client'
+    ];
+
+    public function run($argv)
+    {
+        $options = [
+            'prices' => null,
+            'passes' => 3,
+            'db' => false,
+            'read_passes' => 5,
+            'backends' => ['database'],
+            'workers' => [1, 4],
+            'jobs' => 500,
+            'queue_db' => 'sqlite',
+            'queue_config' => null,
+            'work_us' => 0,
+            'timeout' => 120
+        ];
+        for ($i = 1; $i < count($argv); $i++) {
+            $arg = $argv[$i];
+            if ($arg === '--db') {
+                $options['db'] = true;
+            } elseif (strpos($arg, '--prices=') === 0) {
+                $options['prices'] = substr($arg, 9);
+            } elseif (strpos($arg, '--passes=') === 0) {
+                $options['passes'] = max(1, intval(substr($arg, 9)));
+            } elseif (strpos($arg, '--read-passes=') === 0) {
+                $options['read_passes'] = max(1, intval(substr($arg, 14)));
+            } elseif (strpos($arg, '--backends=') === 0) {
+                $options['backends'] = array_filter(explode(',', substr($arg, 11)));
+            } elseif (strpos($arg, '--workers=') === 0) {
+                $options['workers'] = array_map('intval', array_filter(explode(',', substr($arg, 10))));
+            } elseif (strpos($arg, '--jobs=') === 0) {
+                $options['jobs'] = max(1, intval(substr($arg, 7)));
+            } elseif (strpos($arg, '--queue-db=') === 0) {
+                $options['queue_db'] = substr($arg, 11);
+            } elseif (strpos($arg, '--queue-config=') === 0) {
+                $options['queue_config'] = substr($arg, 15);
+            } elseif (strpos($arg, '--work-us=') === 0) {
+                $options['work_us'] = max(0, intval(substr($arg, 10)));
+            } elseif (strpos($arg, '--timeout=') === 0) {
+                $options['timeout'] = max(1, intval(substr($arg, 10)));
+            }
+        }
+
+        if ($options['prices'] === null) {
+            fwrite(STDERR, "Usage: php benchmarks/php_benchmarks.php --prices=FILE [options]\n");
+            return 2;
+        }
+
+        $suite = new BenchmarkSuite();
+        $fixture = BenchmarkSuite::loadPriceFixture($options['prices']);
+        $results = [];
+        $skipped = [];
+
+        $results += $suite->benchIndicators($fixture, $options['passes']);
+
+        if ($options['db']) {
+            try {
+                DatabaseConfig::load();
+                $results += $suite->benchDataAccess($fixture, $options['read_passes']);
+            } catch (Exception $e) {
+                $skipped['data_access'] = $e->getMessage();
+            }
+        }
+
+        $queueConfig = $this->loadQueueConfig($options['queue_config']);
+        foreach ($options['backends'] as $backend) {
+            try {
+                $factory = $this->getQueueFactory($backend, $queueConfig, $suite, $options);
+            } catch (Exception $e) {
+                $skipped["queue.{$backend}"] = $e->getMessage();
+                continue;
+            }
+
+            foreach ($options['workers'] as $workers) {
+                try {
+                    $results += $suite->benchQueue($backend, $factory, $options['jobs'], max(1, $workers), [
+                        'timeout' => $options['timeout'],
+                        'work_us' => $options['work_us']
+                    ]);
+                } catch (Exception $e) {
+                    $skipped["queue.{$backend}.w{$workers}"] = $e->getMessage();
+                }
+            }
+        }
+
+        echo json_encode([
+            'meta' => [
+                'php_version' => PHP_VERSION,
+                'pcntl' => function_exists('pcntl_fork'),
+                'symbols' => count($fixture),
+                'bars' => array_sum(array_map('count', $fixture)),
+                'jobs' => $options['jobs']
+            ],
+            'results' => $results,
+            'skipped' => (object)$skipped
+        ], JSON_PRETTY_PRINT) . "\n";
+
+        $suite->getLogger()->flush();
+        return 0;
+    }
+
+    /**
+     * Backend settings (redis/rabbitmq/mqtt sections of job_processor.yml, or JSON)
+     */
+    private function loadQueueConfig($file)
+    {
+        if ($file === null) {
+            return [];
+        }
+        if (preg_match('/\.ya?ml$/', $file)) {
+            if (!function_exists('yaml_parse_file')) {
+                throw new RuntimeException("The yaml extension is required to read {$file}; pass a .json file instead");
+            }
+            $config = yaml_parse_file($file);
+        } else {
+            $config = json_decode(file_get_contents($file), true);
+        }
+        if (!is_array($config)) {
+            throw new RuntimeException("Unreadable queue config: {$file}");
+        }
+        return $config['job_processor'] ?? $config;
+    }
+
+    /**
+     * Factory building one backend per process
+     *
+     * @throws Exception when the backend cannot be used here
+     */
+    private function getQueueFactory($backend, array $config, BenchmarkSuite $suite, array $options)
+    {
+        if (!isset(self::QUEUE_BACKENDS[$backend])) {
+            throw new InvalidArgumentException("Unknown backend: {$backend}");
+        }
+
+        $logger = $suite->getLogger();
+        if ($backend === 'database') {
+            if ($options['queue_db'] === 'mysql') {
+                DatabaseConfig::load();
+                return function () use ($config, $logger) {
+                    return new DatabaseJobBackend($config, $logger);
+                };
+            }
+
+            $file = sys_get_temp_dir() . '/wealthsystem_bench_queue_' . getmypid() . '.sqlite';
+            BenchmarkSuite::openSqliteQueue($file);
+            register_shutdown_function(function () use ($file) {
+                foreach ([$file, "{$file}-wal", "{$file}-shm"] as $path) {
+                    if (is_file($path)) {
+                        unlink($path);
+                    }
+                }
+            });
+            return function () use ($config, $logger, $file) {
+                return new DatabaseJobBackend($config, $logger, BenchmarkSuite::openSqliteQueue($file));
+            };
+        }
+
+        if ($backend === 'rabbitmq' && is_file(__DIR__ . '/../vendor/autoload.php')) {
+            require_once __DIR__ . '/../vendor/autoload.php';
+        }
+        if (!class_exists(self::QUEUE_BACKENDS[$backend])) {
+            throw new RuntimeException(self::QUEUE_BACKENDS[$backend] . " is not available");
+        }
+
+        $class = ['redis' => 'RedisJobBackend', 'rabbitmq' => 'RabbitMQJobBackend', 'mqtt' => 'MQTTJobBackend'][$backend];
+        require_once __DIR__ . "/../{$class}.php";
+        return function () use ($class, $config, $logger) {
+            return new $class($config, $logger);
+        };
+    }
+}
@@ -0,0 +1,541 @@
+<?php
+require_once __DIR__ . '/../JobLogger.php';
+require_once __DIR__ . '/../DatabaseConfig.php';
+require_once __DIR__ . '/../JobProcessors.php';
+require_once __DIR__ . '/../DatabaseJobBackend.php';
+
+/**
+ * Class BenchmarkSuite
+ * Repeatable timings for the PHP hot paths: per-symbol price inserts and
+ * reads, the technical analysis indicator pass, and job round trips through
+ * each queue backend.
+ *
+ * Every benchmark returns a flat map of result name => ['value', 'unit',
+ * 'higher_is_better'], which benchmarks/run_benchmarks.py merges and
+ * compares against a baseline. Price data comes from the CSV fixture written
+ * by scripts/sample_data.py.
+ *
+ * @package MicroCapExperiment
+ */
+class BenchmarkSuite
+{
+    /**
+     * Job type used for queue round trips
+     */
+    const JOB_TYPE = 'benchmark';
+
+    /**
+     * Symbols the data access benchmark may create and drop tables for
+     */
+    const SYMBOL_PREFIX = 'BENCH';
+
+    /**
+     * @var JobLogger
+     */
+    private $logger;
+
+    /**
+     * @var string Scratch directory for queue worker results
+     */
+    private $workDir;
+
+    /**
+     * BenchmarkSuite constructor.
+     * @param string|null $workDir Scratch directory (defaults to the system temp dir)
+     */
+    public function __construct($workDir = null)
+    {
+        $this->workDir = $workDir ?? sys_get_temp_dir() . '/wealthsystem_bench_' . getmypid();
+        if (!is_dir($this->workDir)) {
+            mkdir($this->workDir, 0700, true);
+        }
+        $this->logger = new JobLogger($this->workDir . '/benchmark.log');
+    }
+
+    /**
+     * Load a price fixture CSV (symbol, date, open, high, low, close, adj_close, volume).
+     *
+     * @param string $file
+     * @return array symbol => bars in chronological order
+     */
+    public static function loadPriceFixture($file)
+    {
+        $handle = fopen($file, 'r');
+        if ($handle === false) {
+            throw new RuntimeException("Cannot read price fixture: {$file}");
+        }
+
+        $header = fgetcsv($handle);
+        $fixture = [];
+        while (($row = fgetcsv($handle)) !== false) {
+            if (count($row) !== count($header)) {
+                continue;
+            }
+            $bar = array_combine($header, $row);
+            $fixture[$bar['symbol']][] = $bar;
+        }
+        fclose($handle);
+
+        foreach ($fixture as &$bars) {
+            usort($bars, function ($a, $b) {
+                return strcmp($a['date'], $b['date']);
+            });
+        }
+        unset($bars);
+
+        return $fixture;
+    }
+
+    /**
+     * Indicator and pattern pass of TechnicalAnalysisJobProcessor over every
+     * fixture symbol, without the database reads and writes around it.
+     *
+     * Also times the nightly case: resuming from saved state and appending
+     * only the newest bar.
+     *
+     * @param array $fixture symbol => bars
+     * @param int $passes Repetitions over the whole fixture
+     * @return array Results
+     */
+    public function benchIndicators(array $fixture, $passes = 3)
+    {
+        $processor = (new ReflectionClass('TechnicalAnalysisJobProcessor'))->newInstanceWithoutConstructor();
+        $detectPatterns = new ReflectionMethod($processor, 'detectCandlestickPatterns');
+        $detectPatterns->setAccessible(true);
+
+        $bars = 0;
+        $values = 0;
+        $elapsed = 0.0;
+        for ($pass = 0; $pass < $passes; $pass++) {
+            foreach ($fixture as $symbolBars) {
+                $started = microtime(true);
+                $engine = new IncrementalIndicatorEngine();
+                $output = $engine->appendAll($symbolBars);
+                $detectPatterns->invoke($processor, $symbolBars);
+                $elapsed += microtime(true) - $started;
+
+                $bars += count($output);
+                foreach ($output as $bar) {
+                    $values += count(array_filter($bar, function ($value) {
+                        return $value !== null;
+                    })) - 1; // date
+                }
+            }
+        }
+
+        // Resume from yesterday's state and compute the newest bar only
+        $states = [];
+        foreach ($fixture as $symbol => $symbolBars) {
+            $engine = new IncrementalIndicatorEngine();
+            $engine->appendAll(array_slice($symbolBars, 0, -1));
+            $states[$symbol] = json_encode($engine->getState());
+        }
+
+        $resumed = 0;
+        $started = microtime(true);
+        for ($pass = 0; $pass < $passes; $pass++) {
+            foreach ($fixture as $symbol => $symbolBars) {
+                $engine = new IncrementalIndicatorEngine(json_decode($states[$symbol], true));
+                $engine->appendAll(array_slice($symbolBars, -1));
+                $resumed++;
+            }
+        }
+        $resumeElapsed = microtime(true) - $started;
+
+        return [
+            'indicators.bars_per_sec' => self::result(self::rate($bars, $elapsed), 'bars/s'),
+            'indicators.values_per_sec' => self::result(self::rate($values, $elapsed), 'values/s'),
+            'indicators.symbols_per_sec' => self::result(self::rate(count($fixture) * $passes, $elapsed), 'symbols/s'),
+            'indicators.resume_symbols_per_sec' => self::result(self::rate($resumed, $resumeElapsed), 'symbols/s')
+        ];
+    }
+
+    /**
+     * DynamicStockDataAccess insert (row at a time vs bulkInsertPriceData)
+     * and read throughput against the configured legacy database.
+     *
+     * Only symbols starting with SYMBOL_PREFIX are used: their tables are
+     * created for the run and dropped afterwards.
+     *
+     * @param array $fixture symbol => bars
+     * @param int $readPasses Reads per symbol
+     * @return array Results
+     */
+    public function benchDataAccess(array $fixture, $readPasses = 5)
+    {
+        foreach (array_keys($fixture) as $symbol) {
+            if (strpos($symbol, self::SYMBOL_PREFIX) !== 0) {
+                throw new InvalidArgumentException("Refusing to benchmark against non-fixture symbol {$symbol}");
+            }
+        }
+
+        require_once __DIR__ . '/../DynamicStockDataAccess.php';
+        $dataAccess = new DynamicStockDataAccess();
+        $tableManager = new StockTableManager();
+        $pdo = DatabaseConfig::getLegacyConnection();
+
+        $rows = 0;
+        foreach ($fixture as $symbol => $bars) {
+            $tableManager->registerSymbol($symbol);
+            $rows += count($bars);
+        }
+
+        try {
+            $started = microtime(true);
+            foreach ($fixture as $symbol => $bars) {
+                foreach ($bars as $bar) {
+                    $dataAccess->insertPriceData($symbol, $bar);
+                }
+            }
+            $singleElapsed = microtime(true) - $started;
+
+            foreach (array_keys($fixture) as $symbol) {
+                $pdo->exec("TRUNCATE TABLE " . $tableManager->getTableName($symbol, 'historical_prices'));
+            }
+
+            $started = microtime(true);
+            foreach ($fixture as $symbol => $bars) {
+                $dataAccess->bulkInsertPriceData($symbol, $bars);
+            }
+            $bulkElapsed = microtime(true) - $started;
+
+            $readRows = 0;
+            $started = microtime(true);
+            for ($pass = 0; $pass < $readPasses; $pass++) {
+                foreach (array_keys($fixture) as $symbol) {
+                    $readRows += count($dataAccess->getPriceData($symbol));
+                }
+            }
+            $readElapsed = microtime(true) - $started;
+
+            $analysisReads = 0;
+            $started = microtime(true);
+            for ($pass = 0; $pass < $readPasses; $pass++) {
+                foreach (array_keys($fixture) as $symbol) {
+                    $dataAccess->getPriceDataForAnalysis($symbol, 200);
+                    $analysisReads++;
+                }
+            }
+            $analysisElapsed = microtime(true) - $started;
+
+            $cache = $dataAccess->getStatementCacheStats();
+        } finally {
+            foreach (array_keys($fixture) as $symbol) {
+                $tableManager->removeTablesForSymbol($symbol, true);
+            }
+        }
+
+        $singleRate = self::rate($rows, $singleElapsed);
+        $bulkRate = self::rate($rows, $bulkElapsed);
+
+        return [
+            'data_access.insert_single_rows_per_sec' => self::result($singleRate, 'rows/s'),
+            'data_access.insert_bulk_rows_per_sec' => self::result($bulkRate, 'rows/s'),
+            'data_access.bulk_speedup' => self::result($singleRate > 0 ? $bulkRate / $singleRate : 0.0, 'x'),
+            'data_access.read_rows_per_sec' => self::result(self::rate($readRows, $readElapsed), 'rows/s'),
+            'data_access.analysis_reads_per_sec' => self::result(self::rate($analysisReads, $analysisElapsed), 'queries/s'),
+            'data_access.statement_cache_hit_rate' => self::result($cache['hit_rate'], 'ratio')
+        ];
+    }
+
+    /**
+     * End-to-end job latency and throughput through one queue backend.
+     *
+     * Forks $workers processes that each build their own backend, claim
+     * benchmark jobs the way worker.php does (waitForJob()/ackJob() when the
+     * backend supports it, else getNextJob() polling) and complete them.
+     * Latency runs from addJob()/createJob() in the parent to completeJob()
+     * in the worker. Without pcntl a single in-process worker drains the
+     * queue after every job is enqueued.
+     *
+     * @param string $name Backend name used in result keys
+     * @param callable $factory function (): backend, called once per process
+     * @param int $jobs Jobs to enqueue
+     * @param int $workers Worker processes
+     * @param array $options 'timeout' seconds, 'poll_us' polling sleep, 'work_us' simulated job time, 'fork'
+     * @return array Results
+     */
+    public function benchQueue($name, callable $factory, $jobs, $workers, array $options = [])
+    {
+        $timeout = $options['timeout'] ?? 120;
+        $fork = ($options['fork'] ?? true) && function_exists('pcntl_fork');
+        $runId = uniqid('run_', true);
+        $runDir = $this->workDir . '/' . $name . '_' . getmypid();
+        if (!is_dir($runDir)) {
+            mkdir($runDir, 0700, true);
+        }
+
+        if (!$fork) {
+            $backend = $factory();
+            $enqueueStarted = microtime(true);
+            for ($i = 0; $i < $jobs; $i++) {
+                $this->enqueue($backend, $runId);
+            }
+            touch("{$runDir}/stop");
+            $this->runWorker($backend, "{$name}-bench-0", $runDir, $runId, $options);
+            $workers = 1;
+        } else {
+            // Fail fast when the backend is unreachable, but keep no backend
+            // open across fork: the children would share its socket
+            $probe = $factory();
+            unset($probe);
+
+            $pids = [];
+            for ($i = 0; $i < $workers; $i++) {
+                $this->logger->flush();
+                $pid = pcntl_fork();
+                if ($pid === -1) {
+                    throw new RuntimeException("Failed to fork benchmark worker {$i}");
+                }
+                if ($pid === 0) {
+                    $code = 0;
+                    try {
+                        $this->runWorker($factory(), "{$name}-bench-{$i}", $runDir, $runId, $options);
+                    } catch (Throwable $e) {
+                        file_put_contents("{$runDir}/error", $e->getMessage());
+                        $code = 1;
+                    }
+                    $this->logger->flush();
+                    // Replace the process image so nothing inherited from the parent is destructed
+                    pcntl_exec('/bin/sh', ['-c', "exit {$code}"]);
+                    exit($code);
+                }
+                $pids[] = $pid;
+            }
+
+            try {
+                $this->waitFor(function () use ($runDir, $workers) {
+                    return count(glob("{$runDir}/ready.*")) >= $workers || is_file("{$runDir}/error");
+                }, 30);
+                $this->assertNoWorkerError($runDir);
+
+                $backend = $factory();
+                $enqueueStarted = microtime(true);
+                for ($i = 0; $i < $jobs; $i++) {
+                    $this->enqueue($backend, $runId);
+                }
+
+                $this->waitFor(function () use ($runDir, $jobs) {
+                    return $this->countCompleted($runDir) >= $jobs || is_file("{$runDir}/error");
+                }, $timeout);
+            } finally {
+                touch("{$runDir}/stop");
+                foreach ($pids as $pid) {
+                    pcntl_waitpid($pid, $status);
+                }
+            }
+            $this->assertNoWorkerError($runDir);
+        }
+
+        $latencies = [];
+        $lastCompleted = $enqueueStarted;
+        foreach (glob("{$runDir}/done.*") as $file) {
+            foreach (file($file, FILE_IGNORE_NEW_LINES | FILE_SKIP_EMPTY_LINES) as $line) {
+                list($completedAt, $latency) = explode(' ', $line);
+                $latencies[] = (float)$latency;
+                $lastCompleted = max($lastCompleted, (float)$completedAt);
+            }
+        }
+        $this->cleanupQueue($backend, $runDir);
+
+        if (count($latencies) < $jobs) {
+            throw new RuntimeException(sprintf("%s: %d of %d jobs completed within %ds", $name, count($latencies), $jobs, $timeout));
+        }
+        sort($latencies);
+
+        $prefix = "queue.{$name}.w{$workers}";
+        return [
+            "{$prefix}.jobs_per_sec" => self::result(self::rate(count($latencies), $lastCompleted - $enqueueStarted), 'jobs/s'),
+            "{$prefix}.latency_p50_ms" => self::result(self::percentile($latencies, 0.50) * 1000, 'ms', false),
+            "{$prefix}.latency_p95_ms" => self::result(self::percentile($latencies, 0.95) * 1000, 'ms', false),
+            "{$prefix}.latency_max_ms" => self::result(end($latencies) * 1000, 'ms', false)
+        ];
+    }
+
+    /**
+     * SQLite database with the ta_analysis_jobs schema, for benchmarking the
+     * database backend without a MySQL server.
+     *
+     * @param string $file Database file (shared by the worker processes)
+     * @return PDO
+     */
+    public static function openSqliteQueue($file)
+    {
+        $pdo = new PDO("sqlite:{$file}", null, null, [
+            PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION,
+            PDO::ATTR_TIMEOUT => 30
+        ]);
+        $pdo->exec("PRAGMA journal_mode = WAL");
+        $pdo->exec("
+            CREATE TABLE IF NOT EXISTS ta_analysis_jobs (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                job_type VARCHAR(50) DEFAULT 'technical_analysis',
+                idstockinfo INT NULL,
+                symbol VARCHAR(10) NULL,
+                analysis_type VARCHAR(50) NULL,
+                status VARCHAR(20) DEFAULT 'pending',
+                priority INT DEFAULT 5,
+                parameters TEXT,
+                worker_id VARCHAR(255) NULL,
+                retry_count INT DEFAULT 0,
+                max_retries INT DEFAULT 3,
+                scheduled_at TIMESTAMP NULL,
+                claimed_at TIMESTAMP NULL,
+                started_at TIMESTAMP NULL,
+                completed_at TIMESTAMP NULL,
+                progress INT DEFAULT 0,
+                result_data TEXT NULL,
+                error_details TEXT NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+        ");
+        return $pdo;
+    }
+
+    /**
+     * Logger shared by the backends under test
+     *
+     * @return JobLogger
+     */
+    public function getLogger()
+    {
+        return $this->logger;
+    }
+
+    /**
+     * Claim and complete benchmark jobs until the stop marker is set and the
+     * queue is empty, appending "completed_at latency" lines to done.<worker>.
+     */
+    private function runWorker($backend, $workerId, $runDir, $runId, array $options)
+    {
+        $blocking = method_exists($backend, 'waitForJob');
+        $pollUs = $options['poll_us'] ?? 10000;
+        $workUs = $options['work_us'] ?? 0;
+
+        if (!$backend instanceof DatabaseJobBackend) {
+            $backend->registerWorker($workerId, [
+                'hostname' => gethostname(),
+                'pid' => getmypid(),
+                'job_types' => [self::JOB_TYPE],
+                'max_concurrent_jobs' => 1
+            ]);
+        }
+
+        // First claim subscribes/consumes, so a broker-pushed queue is bound before jobs are sent
+        $job = $blocking
+            ? $backend->waitForJob($workerId, [self::JOB_TYPE], 1)
+            : $backend->getNextJob($workerId, [self::JOB_TYPE]);
+        touch("{$runDir}/ready.{$workerId}");
+
+        $results = fopen("{$runDir}/done.{$workerId}", 'a');
+        while (true) {
+            if ($job) {
+                $parameters = $job['parameters'] ?? [];
+                if (is_string($parameters)) {
+                    $parameters = json_decode($parameters, true) ?: [];
+                }
+                if ($workUs > 0) {
+                    usleep($workUs);
+                }
+                $backend->completeJob($job['id'], $workerId, ['success' => true]);
+                if ($blocking && method_exists($backend, 'ackJob')) {
+                    $backend->ackJob($job['id'], $workerId, true);
+                }
+
+                // Leftovers from an aborted earlier run are drained but not counted
+                if (($parameters['run_id'] ?? null) === $runId) {
+                    $now = microtime(true);
+                    fwrite($results, sprintf("%.6f %.6f\n", $now, $now - $parameters['enqueued_at']));
+                    fflush($results);
+                }
+            } elseif (is_file("{$runDir}/stop")) {
+                break;
+            } elseif (!$blocking) {
+                usleep($pollUs);
+            }
+
+            $job = $blocking
+                ? $backend->waitForJob($workerId, [self::JOB_TYPE], 1)
+                : $backend->getNextJob($workerId, [self::JOB_TYPE]);
+        }
+        fclose($results);
+
+        if (!$backend instanceof DatabaseJobBackend) {
+            $backend->unregisterWorker($workerId);
+        }
+    }
+
+    /**
+     * Enqueue one benchmark job stamped with its enqueue time
+     */
+    private function enqueue($backend, $runId)
+    {
+        $job = [
+            'job_type' => self::JOB_TYPE,
+            'parameters' => ['run_id' => $runId, 'enqueued_at' => microtime(true)]
+        ];
+
+        if ($backend instanceof DatabaseJobBackend) {
+            $backend->createJob($job);
+        } else {
+            $backend->addJob($job);
+        }
+    }
+
+    /**
+     * Remove benchmark rows and scratch files
+     */
+    private function cleanupQueue($backend, $runDir)
+    {
+        if ($backend instanceof DatabaseJobBackend) {
+            $backend->deleteJobsByType(self::JOB_TYPE);
+        }
+
+        foreach (glob("{$runDir}/*") as $file) {
+            unlink($file);
+        }
+        rmdir($runDir);
+    }
+
+    private function countCompleted($runDir)
+    {
+        $completed = 0;
+        foreach (glob("{$runDir}/done.*") as $file) {
+            $completed += substr_count(file_get_contents($file), "\n");
+        }
+        return $completed;
+    }
+
+    private function assertNoWorkerError($runDir)
+    {
+        if (is_file("{$runDir}/error")) {
+            throw new RuntimeException("Benchmark worker failed: " . file_get_contents("{$runDir}/error"));
+        }
+    }
+
+    private function waitFor(callable $condition, $timeout)
+    {
+        $deadline = microtime(true) + $timeout;
+        while (!$condition() && microtime(true) < $deadline) {
+            usleep(20000);
+        }
+    }
+
+    private static function rate($count, $seconds)
+    {
+        return $seconds > 0 ? $count / $seconds : 0.0;
+    }
+
+    private static function percentile(array $sorted, $fraction)
+    {
+        if (empty($sorted)) {
+            return 0.0;
+        }
+        return $sorted[(int)min(count($sorted) - 1, floor($fraction * count($sorted)))];
+    }
+
+    private static function result($value, $unit, $higherIsBetter = true)
+    {
+        return ['value' => round($value, 4), 'unit' => $unit, 'higher_is_better' => $higherIsBetter];
+    }
+}
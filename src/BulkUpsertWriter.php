@@ -0,0 +1,246 @@
+<?php
+
+/**
+ * Class BulkUpsertWriter
+ * Packs rows into multi-row INSERT ... ON DUPLICATE KEY UPDATE statements and
+ * commits them in fixed-size chunks, one transaction per chunk.
+ *
+ * A chunk that fails is rolled back and replayed row by row, so a single bad
+ * row costs one chunk's worth of round trips instead of the whole batch.
+ *
+ * @package MicroCapExperiment
+ */
+class BulkUpsertWriter
+{
+    /**
+     * Default number of rows per INSERT statement / transaction.
+     */
+    public const DEFAULT_CHUNK_SIZE = 500;
+
+    /**
+     * MySQL refuses statements with more than 65535 placeholders.
+     */
+    private const MAX_PLACEHOLDERS = 65535;
+
+    /**
+     * @var \PDO
+     */
+    private $pdo;
+
+    /**
+     * @var string
+     */
+    private $tableName;
+
+    /**
+     * @var string[]
+     */
+    private $columns;
+
+    /**
+     * @var string[]
+     */
+    private $updateAssignments;
+
+    /**
+     * @var int
+     */
+    private $chunkSize;
+
+    /**
+     * @var JobLogger|null
+     */
+    private $logger;
+
+    /**
+     * Prepared statements keyed by row count.
+     *
+     * @var array
+     */
+    private $statements = [];
+
+    /**
+     * BulkUpsertWriter constructor.
+     * @param \PDO $pdo
+     * @param string $tableName
+     * @param string[] $columns Column names, in the order row values are supplied
+     * @param string[] $updateAssignments e.g. ['close = VALUES(close)', 'updated_at = CURRENT_TIMESTAMP']
+     * @param int $chunkSize Rows per statement and per commit
+     * @param JobLogger|null $logger
+     */
+    public function __construct($pdo, $tableName, array $columns, array $updateAssignments, $chunkSize = self::DEFAULT_CHUNK_SIZE, $logger = null)
+    {
+        if (empty($columns)) {
+            throw new InvalidArgumentException('BulkUpsertWriter requires at least one column');
+        }
+
+        $this->pdo = $pdo;
+        $this->tableName = $tableName;
+        $this->columns = array_values($columns);
+        $this->updateAssignments = $updateAssignments;
+        $this->logger = $logger;
+
+        $maxRows = intdiv(self::MAX_PLACEHOLDERS, count($this->columns));
+        $this->chunkSize = max(1, min((int)$chunkSize, $maxRows));
+    }
+
+    /**
+     * Write rows in chunks.
+     *
+     * @param iterable $rows Positional value arrays matching the column order
+     * @return array ['rows' => int, 'chunks' => array[]] where each chunk entry is
+     *               ['rows' => int, 'written' => int, 'status' => 'committed'|'row_fallback']
+     */
+    public function write($rows)
+    {
+        $report = [
+            'rows' => 0,
+            'chunks' => []
+        ];
+
+        $chunk = [];
+        foreach ($rows as $row) {
+            $chunk[] = array_values($row);
+            if (count($chunk) >= $this->chunkSize) {
+                $report['chunks'][] = $this->writeChunk($chunk);
+                $chunk = [];
+            }
+        }
+
+        if (!empty($chunk)) {
+            $report['chunks'][] = $this->writeChunk($chunk);
+        }
+
+        foreach ($report['chunks'] as $chunkReport) {
+            $report['rows'] += $chunkReport['written'];
+        }
+
+        return $report;
+    }
+
+    /**
+     * Get the effective chunk size (after clamping to the placeholder limit).
+     *
+     * @return int
+     */
+    public function getChunkSize()
+    {
+        return $this->chunkSize;
+    }
+
+    /**
+     * Write a single chunk inside its own transaction.
+     *
+     * @param array $chunk
+     * @return array
+     */
+    private function writeChunk(array $chunk)
+    {
+        $rowCount = count($chunk);
+        $ownsTransaction = !$this->pdo->inTransaction();
+
+        try {
+            if ($ownsTransaction) {
+                $this->pdo->beginTransaction();
+            }
+
+            $this->getStatement($rowCount)->execute(array_merge(...$chunk));
+
+            if ($ownsTransaction) {
+                $this->pdo->commit();
+            }
+
+            return ['rows' => $rowCount, 'written' => $rowCount, 'status' => 'committed'];
+
+        } catch (Exception $e) {
+            if ($ownsTransaction && $this->pdo->inTransaction()) {
+                $this->pdo->rollBack();
+            }
+
+            if (!$ownsTransaction) {
+                // The caller's transaction is now in an unknown state; let them decide.
+                throw $e;
+            }
+
+            $this->log('warning', "Chunk of {$rowCount} rows failed for {$this->tableName}, retrying row by row: " . $e->getMessage());
+
+            return [
+                'rows' => $rowCount,
+                'written' => $this->writeRowByRow($chunk),
+                'status' => 'row_fallback'
+            ];
+        }
+    }
+
+    /**
+     * Replay a failed chunk one row at a time, skipping rows that still fail.
+     *
+     * @param array $chunk
+     * @return int Number of rows written
+     */
+    private function writeRowByRow(array $chunk)
+    {
+        $stmt = $this->getStatement(1);
+        $written = 0;
+
+        foreach ($chunk as $row) {
+            try {
+                if ($stmt->execute($row)) {
+                    $written++;
+                }
+            } catch (Exception $e) {
+                $this->log('error', "Failed to upsert row into {$this->tableName}: " . $e->getMessage());
+            }
+        }
+
+        return $written;
+    }
+
+    /**
+     * Get (or prepare) the multi-VALUES statement for a given row count.
+     *
+     * @param int $rowCount
+     * @return \PDOStatement
+     */
+    private function getStatement($rowCount)
+    {
+        if (!isset($this->statements[$rowCount])) {
+            $this->statements[$rowCount] = $this->pdo->prepare($this->buildSql($rowCount));
+        }
+
+        return $this->statements[$rowCount];
+    }
+
+    /**
+     * Build the INSERT ... ON DUPLICATE KEY UPDATE statement for N rows.
+     *
+     * @param int $rowCount
+     * @return string
+     */
+    public function buildSql($rowCount)
+    {
+        $tuple = '(' . implode(', ', array_fill(0, count($this->columns), '?')) . ')';
+
+        $sql = "INSERT INTO {$this->tableName} (" . implode(', ', $this->columns) . ") VALUES "
+            . implode(', ', array_fill(0, $rowCount, $tuple));
+
+        if (!empty($this->updateAssignments)) {
+            $sql .= " ON DUPLICATE KEY UPDATE " . implode(', ', $this->updateAssignments);
+        }
+
+        return $sql;
+    }
+
+    /**
+     * Log through the optional logger.
+     *
+     * @param string $level
+     * @param string $message
+     */
+    private function log($level, $message)
+    {
+        if ($this->logger) {
+            $this->logger->$level($message);
+        }
+    }
+}
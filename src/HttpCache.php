@@ -0,0 +1,73 @@
+<?php
+
+/**
+ * Class HttpCache
+ * ETag / If-None-Match / Cache-Control handling for JSON endpoints.
+ *
+ * send() tags the body with a strong ETag of its contents and answers 304
+ * Not Modified (no body) when the client already holds that version, so a
+ * polling dashboard only downloads payloads that changed.
+ *
+ * @package MicroCapExperiment
+ */
+class HttpCache
+{
+    /**
+     * Send $body with validators, or a 304 if the client's copy is current
+     *
+     * @param string $body
+     * @param int $maxAge Seconds the client may reuse the response without asking
+     * @param string $contentType
+     * @return bool True if a 304 was sent
+     */
+    public static function send($body, $maxAge = 0, $contentType = 'application/json')
+    {
+        $etag = self::etag($body);
+        header('ETag: ' . $etag);
+        header('Cache-Control: private, max-age=' . max(0, (int)$maxAge) . ', must-revalidate');
+        header('Vary: Accept-Encoding');
+
+        if (self::matches($etag, $_SERVER['HTTP_IF_NONE_MATCH'] ?? null)) {
+            http_response_code(304);
+            return true;
+        }
+
+        header('Content-Type: ' . $contentType);
+        echo $body;
+        return false;
+    }
+
+    /**
+     * @param string $body
+     * @return string Quoted strong ETag
+     */
+    public static function etag($body)
+    {
+        return '"' . sha1($body) . '"';
+    }
+
+    /**
+     * Whether an If-None-Match header value matches $etag (weak comparison)
+     *
+     * @param string $etag
+     * @param string|null $ifNoneMatch
+     * @return bool
+     */
+    public static function matches($etag, $ifNoneMatch)
+    {
+        if ($ifNoneMatch === null || $ifNoneMatch === '') {
+            return false;
+        }
+        if (trim($ifNoneMatch) === '*') {
+            return true;
+        }
+
+        $bare = preg_replace('/^W\//', '', $etag);
+        foreach (explode(',', $ifNoneMatch) as $candidate) {
+            if (preg_replace('/^W\//', '', trim($candidate)) === $bare) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -5,6 +5,7 @@ interface IStockTableManager
     public function createTablesForSymbol($symbol);
     public function getTableName($symbol, $tableType);
     public function tablesExistForSymbol($symbol);
+    public function getSymbolsWithTables(array $symbols);
     public function getAllSymbols($activeOnly = true);
     public function removeTablesForSymbol($symbol, $confirm = false);
     public function deactivateSymbol($symbol);
@@ -0,0 +1,390 @@
+<?php
+require_once __DIR__ . '/IndicatorEngine.php';
+
+/**
+ * Class IncrementalIndicatorEngine
+ * Append-one-bar indicator engine whose state can be persisted and resumed.
+ *
+ * It produces the same values as IndicatorEngine, but it carries the rolling
+ * window buffers and the EMA/Wilder accumulators between runs. A nightly job
+ * can then restore yesterday's state and compute only the newest bar, in
+ * O(1) per bar. getState() returns a JSON-serializable array.
+ *
+ * @package MicroCapExperiment
+ */
+class IncrementalIndicatorEngine
+{
+    /**
+     * Default indicator configuration.
+     */
+    public const DEFAULT_CONFIG = [
+        'sma' => [20, 50],
+        'ema' => [12, 26],
+        'rsi' => 14,
+        'macd' => [12, 26, 9],
+        'bollinger' => [20, 2.0],
+        'atr' => 14
+    ];
+
+    /**
+     * @var array
+     */
+    private $config;
+
+    /**
+     * @var array
+     */
+    private $state;
+
+    /**
+     * IncrementalIndicatorEngine constructor.
+     * @param array $state State previously returned by getState(); ignored if the config changed
+     * @param array $config Overrides for DEFAULT_CONFIG
+     */
+    public function __construct(array $state = [], array $config = [])
+    {
+        $this->config = array_replace(self::DEFAULT_CONFIG, $config);
+
+        if (($state['config_hash'] ?? null) === $this->configHash()) {
+            $this->state = $state;
+        } else {
+            $this->state = $this->emptyState();
+        }
+    }
+
+    /**
+     * Names of the indicators produced by append(), in output order.
+     *
+     * @return string[]
+     */
+    public function getIndicatorNames()
+    {
+        $names = [];
+        foreach ($this->config['sma'] as $period) {
+            $names[] = "SMA_{$period}";
+        }
+        foreach ($this->config['ema'] as $period) {
+            $names[] = "EMA_{$period}";
+        }
+
+        return array_merge($names, [
+            'RSI', 'MACD', 'MACD_SIGNAL', 'MACD_HIST', 'BB_UPPER', 'BB_MIDDLE', 'BB_LOWER', 'ATR'
+        ]);
+    }
+
+    /**
+     * Period stored alongside each indicator value.
+     *
+     * @param string $name
+     * @return int|null
+     */
+    public function getIndicatorPeriod($name)
+    {
+        if (preg_match('/^(SMA|EMA)_(\d+)$/', $name, $matches)) {
+            return (int)$matches[2];
+        }
+
+        switch ($name) {
+            case 'RSI':
+                return $this->config['rsi'];
+            case 'MACD':
+            case 'MACD_HIST':
+                return $this->config['macd'][0];
+            case 'MACD_SIGNAL':
+                return $this->config['macd'][2];
+            case 'BB_UPPER':
+            case 'BB_MIDDLE':
+            case 'BB_LOWER':
+                return $this->config['bollinger'][0];
+            case 'ATR':
+                return $this->config['atr'];
+            default:
+                return null;
+        }
+    }
+
+    /**
+     * Append one bar and return the indicator values for it.
+     *
+     * @param array $bar ['date', 'high', 'low', 'close', ...]
+     * @return array ['date' => string, <indicator name> => float|null, ...]
+     * @throws InvalidArgumentException if the bar is not newer than the last one
+     */
+    public function append(array $bar)
+    {
+        $date = $bar['date'];
+        if ($this->state['last_date'] !== null && strcmp($date, $this->state['last_date']) <= 0) {
+            throw new InvalidArgumentException("Bar {$date} is not newer than last processed bar {$this->state['last_date']}");
+        }
+
+        $high = (float)$bar['high'];
+        $low = (float)$bar['low'];
+        $close = (float)$bar['close'];
+        $prevClose = $this->state['last_close'];
+
+        $out = ['date' => $date];
+
+        foreach ($this->windowPeriods() as $period) {
+            $this->pushWindow($period, $close);
+        }
+
+        foreach ($this->config['sma'] as $period) {
+            $window = $this->state['windows'][$period];
+            $out["SMA_{$period}"] = count($window['buf']) === $period ? $window['sum'] / $period : null;
+        }
+
+        foreach ($this->config['ema'] as $period) {
+            $out["EMA_{$period}"] = $this->stepEma("EMA_{$period}", $period, $close);
+        }
+
+        $out['RSI'] = $this->stepRsi($close, $prevClose);
+
+        list($fastPeriod, $slowPeriod, $signalPeriod) = $this->config['macd'];
+        $fast = $this->stepEma('MACD_FAST', $fastPeriod, $close);
+        $slow = $this->stepEma('MACD_SLOW', $slowPeriod, $close);
+        $macd = ($fast !== null && $slow !== null) ? $fast - $slow : null;
+        $signal = $this->stepEma('MACD_SIGNAL', $signalPeriod, $macd);
+        $out['MACD'] = $macd;
+        $out['MACD_SIGNAL'] = $signal;
+        $out['MACD_HIST'] = $signal !== null ? $macd - $signal : null;
+
+        list($bbPeriod, $bbStdDevs) = $this->config['bollinger'];
+        $window = $this->state['windows'][$bbPeriod];
+        if (count($window['buf']) === $bbPeriod) {
+            list($out['BB_MIDDLE'], $out['BB_UPPER'], $out['BB_LOWER']) =
+                IndicatorEngine::bandsFromSums($window['sum'], $window['sum_sq'], $bbPeriod, $bbStdDevs);
+        } else {
+            $out['BB_MIDDLE'] = $out['BB_UPPER'] = $out['BB_LOWER'] = null;
+        }
+
+        $out['ATR'] = $this->stepAtr(IndicatorEngine::trueRange($high, $low, $prevClose));
+
+        $this->state['last_date'] = $date;
+        $this->state['last_close'] = $close;
+        $this->state['bars']++;
+
+        return $out;
+    }
+
+    /**
+     * Append bars in chronological order, skipping any already processed.
+     *
+     * @param iterable $bars
+     * @return array List of append() results
+     */
+    public function appendAll($bars)
+    {
+        $results = [];
+
+        foreach ($bars as $bar) {
+            if ($this->state['last_date'] !== null && strcmp($bar['date'], $this->state['last_date']) <= 0) {
+                continue;
+            }
+            $results[] = $this->append($bar);
+        }
+
+        return $results;
+    }
+
+    /**
+     * Get the persistable engine state.
+     *
+     * @return array
+     */
+    public function getState()
+    {
+        return $this->state;
+    }
+
+    /**
+     * Date of the last appended bar, or null for a fresh engine.
+     *
+     * @return string|null
+     */
+    public function getLastDate()
+    {
+        return $this->state['last_date'];
+    }
+
+    /**
+     * Number of bars appended over the engine's lifetime.
+     *
+     * @return int
+     */
+    public function getBarCount()
+    {
+        return $this->state['bars'];
+    }
+
+    /**
+     * Push a close into the rolling window for a period.
+     *
+     * @param int $period
+     * @param float $value
+     */
+    private function pushWindow($period, $value)
+    {
+        $window = &$this->state['windows'][$period];
+
+        if (count($window['buf']) < $period) {
+            $window['buf'][] = $value;
+            $window['sum'] += $value;
+            $window['sum_sq'] += $value * $value;
+            return;
+        }
+
+        $old = $window['buf'][$window['pos']];
+        $window['buf'][$window['pos']] = $value;
+        $window['sum'] += $value - $old;
+        $window['sum_sq'] += $value * $value - $old * $old;
+        $window['pos'] = ($window['pos'] + 1) % $period;
+
+        if ($window['pos'] === 0) {
+            // Re-sum once per full cycle so rolling-sum drift never accumulates
+            $window['sum'] = array_sum($window['buf']);
+            $window['sum_sq'] = 0.0;
+            foreach ($window['buf'] as $v) {
+                $window['sum_sq'] += $v * $v;
+            }
+        }
+    }
+
+    /**
+     * Advance an EMA accumulator; returns null until seeded.
+     *
+     * @param string $key
+     * @param int $period
+     * @param float|null $value
+     * @return float|null
+     */
+    private function stepEma($key, $period, $value)
+    {
+        $ema = &$this->state['emas'][$key];
+
+        if ($value === null) {
+            return $ema['value'];
+        }
+
+        if ($ema['value'] === null) {
+            $ema['seed'] += $value;
+            $ema['n']++;
+            if ($ema['n'] === $period) {
+                $ema['value'] = $ema['seed'] / $period;
+            }
+            return $ema['value'];
+        }
+
+        $ema['value'] += ($value - $ema['value']) * (2.0 / ($period + 1));
+        return $ema['value'];
+    }
+
+    /**
+     * Advance the Wilder RSI accumulator.
+     *
+     * @param float $close
+     * @param float|null $prevClose
+     * @return float|null
+     */
+    private function stepRsi($close, $prevClose)
+    {
+        if ($prevClose === null) {
+            return null;
+        }
+
+        $period = $this->config['rsi'];
+        $rsi = &$this->state['rsi'];
+        $change = $close - $prevClose;
+        $gain = $change > 0 ? $change : 0.0;
+        $loss = $change < 0 ? -$change : 0.0;
+
+        $rsi['n']++;
+        if ($rsi['n'] <= $period) {
+            $rsi['avg_gain'] += $gain / $period;
+            $rsi['avg_loss'] += $loss / $period;
+            if ($rsi['n'] < $period) {
+                return null;
+            }
+        } else {
+            $rsi['avg_gain'] = ($rsi['avg_gain'] * ($period - 1) + $gain) / $period;
+            $rsi['avg_loss'] = ($rsi['avg_loss'] * ($period - 1) + $loss) / $period;
+        }
+
+        return IndicatorEngine::rsiFromAverages($rsi['avg_gain'], $rsi['avg_loss']);
+    }
+
+    /**
+     * Advance the Wilder ATR accumulator.
+     *
+     * @param float $trueRange
+     * @return float|null
+     */
+    private function stepAtr($trueRange)
+    {
+        $period = $this->config['atr'];
+        $atr = &$this->state['atr'];
+
+        $atr['n']++;
+        if ($atr['n'] <= $period) {
+            $atr['value'] += $trueRange / $period;
+            return $atr['n'] === $period ? $atr['value'] : null;
+        }
+
+        $atr['value'] = ($atr['value'] * ($period - 1) + $trueRange) / $period;
+        return $atr['value'];
+    }
+
+    /**
+     * Distinct rolling-window periods (SMA periods plus Bollinger period).
+     *
+     * @return int[]
+     */
+    private function windowPeriods()
+    {
+        return array_values(array_unique(array_merge($this->config['sma'], [$this->config['bollinger'][0]])));
+    }
+
+    /**
+     * Build a zeroed state for the current config.
+     *
+     * @return array
+     */
+    private function emptyState()
+    {
+        $emptyEma = ['n' => 0, 'seed' => 0.0, 'value' => null];
+
+        $state = [
+            'config_hash' => $this->configHash(),
+            'last_date' => null,
+            'last_close' => null,
+            'bars' => 0,
+            'windows' => [],
+            'emas' => [
+                'MACD_FAST' => $emptyEma,
+                'MACD_SLOW' => $emptyEma,
+                'MACD_SIGNAL' => $emptyEma
+            ],
+            'rsi' => ['n' => 0, 'avg_gain' => 0.0, 'avg_loss' => 0.0],
+            'atr' => ['n' => 0, 'value' => 0.0]
+        ];
+
+        foreach ($this->windowPeriods() as $period) {
+            $state['windows'][$period] = ['buf' => [], 'pos' => 0, 'sum' => 0.0, 'sum_sq' => 0.0];
+        }
+
+        foreach ($this->config['ema'] as $period) {
+            $state['emas']["EMA_{$period}"] = $emptyEma;
+        }
+
+        return $state;
+    }
+
+    /**
+     * Fingerprint of the config, so stale state is discarded when periods change.
+     *
+     * @return string
+     */
+    private function configHash()
+    {
+        return md5(json_encode($this->config));
+    }
+}
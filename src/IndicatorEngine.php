@@ -0,0 +1,301 @@
+<?php
+
+/**
+ * Class IndicatorEngine
+ * Single-pass technical indicators over columnar price data.
+ *
+ * Inputs are packed (0-indexed, float) arrays such as the 'close' column
+ * returned by columns(). Every indicator returns an array aligned with its
+ * input, holding null until the indicator has warmed up. Each one runs in
+ * O(n), using rolling sums or recursive smoothing instead of re-summing
+ * the window for every bar.
+ *
+ * @package MicroCapExperiment
+ */
+class IndicatorEngine
+{
+    /**
+     * Convert associative price rows (oldest first) into packed columns.
+     *
+     * @param array $rows Rows with date/open/high/low/close/volume keys
+     * @return array ['date' => string[], 'open' => float[], 'high' => float[], 'low' => float[], 'close' => float[], 'volume' => float[]]
+     */
+    public static function columns(array $rows)
+    {
+        $columns = [
+            'date' => [],
+            'open' => [],
+            'high' => [],
+            'low' => [],
+            'close' => [],
+            'volume' => []
+        ];
+
+        foreach ($rows as $row) {
+            $columns['date'][] = $row['date'];
+            $columns['open'][] = (float)$row['open'];
+            $columns['high'][] = (float)$row['high'];
+            $columns['low'][] = (float)$row['low'];
+            $columns['close'][] = (float)$row['close'];
+            $columns['volume'][] = (float)($row['volume'] ?? 0);
+        }
+
+        return $columns;
+    }
+
+    /**
+     * Simple moving average using a rolling sum.
+     *
+     * @param float[] $values
+     * @param int $period
+     * @return array
+     */
+    public static function sma(array $values, $period)
+    {
+        $n = count($values);
+        $out = array_fill(0, $n, null);
+        $sum = 0.0;
+
+        for ($i = 0; $i < $n; $i++) {
+            $sum += $values[$i];
+            if ($i >= $period) {
+                $sum -= $values[$i - $period];
+            }
+            if ($i >= $period - 1) {
+                $out[$i] = $sum / $period;
+            }
+        }
+
+        return $out;
+    }
+
+    /**
+     * Exponential moving average, seeded with the SMA of the first period values.
+     *
+     * @param array $values May contain leading nulls (e.g. a MACD line)
+     * @param int $period
+     * @return array
+     */
+    public static function ema(array $values, $period)
+    {
+        $n = count($values);
+        $out = array_fill(0, $n, null);
+        $k = 2.0 / ($period + 1);
+        $seen = 0;
+        $seed = 0.0;
+        $ema = null;
+
+        for ($i = 0; $i < $n; $i++) {
+            $value = $values[$i];
+            if ($value === null) {
+                continue;
+            }
+
+            if ($ema === null) {
+                $seed += $value;
+                $seen++;
+                if ($seen === $period) {
+                    $ema = $seed / $period;
+                    $out[$i] = $ema;
+                }
+                continue;
+            }
+
+            $ema += ($value - $ema) * $k;
+            $out[$i] = $ema;
+        }
+
+        return $out;
+    }
+
+    /**
+     * Relative Strength Index with Wilder smoothing.
+     *
+     * @param float[] $closes
+     * @param int $period
+     * @return array
+     */
+    public static function rsi(array $closes, $period = 14)
+    {
+        $n = count($closes);
+        $out = array_fill(0, $n, null);
+
+        if ($n <= $period) {
+            return $out;
+        }
+
+        $avgGain = 0.0;
+        $avgLoss = 0.0;
+
+        for ($i = 1; $i < $n; $i++) {
+            $change = $closes[$i] - $closes[$i - 1];
+            $gain = $change > 0 ? $change : 0.0;
+            $loss = $change < 0 ? -$change : 0.0;
+
+            if ($i <= $period) {
+                $avgGain += $gain / $period;
+                $avgLoss += $loss / $period;
+                if ($i < $period) {
+                    continue;
+                }
+            } else {
+                $avgGain = ($avgGain * ($period - 1) + $gain) / $period;
+                $avgLoss = ($avgLoss * ($period - 1) + $loss) / $period;
+            }
+
+            $out[$i] = self::rsiFromAverages($avgGain, $avgLoss);
+        }
+
+        return $out;
+    }
+
+    /**
+     * MACD line, signal line and histogram.
+     *
+     * @param float[] $closes
+     * @param int $fastPeriod
+     * @param int $slowPeriod
+     * @param int $signalPeriod
+     * @return array ['macd' => array, 'signal' => array, 'histogram' => array]
+     */
+    public static function macd(array $closes, $fastPeriod = 12, $slowPeriod = 26, $signalPeriod = 9)
+    {
+        $fast = self::ema($closes, $fastPeriod);
+        $slow = self::ema($closes, $slowPeriod);
+        $n = count($closes);
+
+        $macd = array_fill(0, $n, null);
+        for ($i = 0; $i < $n; $i++) {
+            if ($fast[$i] !== null && $slow[$i] !== null) {
+                $macd[$i] = $fast[$i] - $slow[$i];
+            }
+        }
+
+        $signal = self::ema($macd, $signalPeriod);
+        $histogram = array_fill(0, $n, null);
+        for ($i = 0; $i < $n; $i++) {
+            if ($signal[$i] !== null) {
+                $histogram[$i] = $macd[$i] - $signal[$i];
+            }
+        }
+
+        return ['macd' => $macd, 'signal' => $signal, 'histogram' => $histogram];
+    }
+
+    /**
+     * Bollinger Bands using rolling sum and sum of squares (population std dev).
+     *
+     * @param float[] $closes
+     * @param int $period
+     * @param float $stdDevs
+     * @return array ['upper' => array, 'middle' => array, 'lower' => array]
+     */
+    public static function bollinger(array $closes, $period = 20, $stdDevs = 2.0)
+    {
+        $n = count($closes);
+        $upper = array_fill(0, $n, null);
+        $middle = array_fill(0, $n, null);
+        $lower = array_fill(0, $n, null);
+        $sum = 0.0;
+        $sumSq = 0.0;
+
+        for ($i = 0; $i < $n; $i++) {
+            $sum += $closes[$i];
+            $sumSq += $closes[$i] * $closes[$i];
+            if ($i >= $period) {
+                $old = $closes[$i - $period];
+                $sum -= $old;
+                $sumSq -= $old * $old;
+            }
+            if ($i >= $period - 1) {
+                list($middle[$i], $upper[$i], $lower[$i]) = self::bandsFromSums($sum, $sumSq, $period, $stdDevs);
+            }
+        }
+
+        return ['upper' => $upper, 'middle' => $middle, 'lower' => $lower];
+    }
+
+    /**
+     * Average True Range with Wilder smoothing.
+     *
+     * @param float[] $highs
+     * @param float[] $lows
+     * @param float[] $closes
+     * @param int $period
+     * @return array
+     */
+    public static function atr(array $highs, array $lows, array $closes, $period = 14)
+    {
+        $n = count($closes);
+        $out = array_fill(0, $n, null);
+        $atr = 0.0;
+
+        for ($i = 0; $i < $n; $i++) {
+            $tr = self::trueRange($highs[$i], $lows[$i], $i > 0 ? $closes[$i - 1] : null);
+
+            if ($i < $period) {
+                $atr += $tr / $period;
+                if ($i < $period - 1) {
+                    continue;
+                }
+            } else {
+                $atr = ($atr * ($period - 1) + $tr) / $period;
+            }
+
+            $out[$i] = $atr;
+        }
+
+        return $out;
+    }
+
+    /**
+     * True range of a bar given the previous close (null for the first bar).
+     *
+     * @param float $high
+     * @param float $low
+     * @param float|null $prevClose
+     * @return float
+     */
+    public static function trueRange($high, $low, $prevClose)
+    {
+        if ($prevClose === null) {
+            return $high - $low;
+        }
+
+        return max($high - $low, abs($high - $prevClose), abs($low - $prevClose));
+    }
+
+    /**
+     * RSI from Wilder-smoothed average gain/loss.
+     *
+     * @param float $avgGain
+     * @param float $avgLoss
+     * @return float
+     */
+    public static function rsiFromAverages($avgGain, $avgLoss)
+    {
+        if ($avgLoss == 0) {
+            return 100.0;
+        }
+
+        return 100 - (100 / (1 + $avgGain / $avgLoss));
+    }
+
+    /**
+     * Middle/upper/lower band from window sums.
+     *
+     * @param float $sum
+     * @param float $sumSq
+     * @param int $period
+     * @param float $stdDevs
+     * @return float[] [middle, upper, lower]
+     */
+    public static function bandsFromSums($sum, $sumSq, $period, $stdDevs)
+    {
+        $mean = $sum / $period;
+        // Clamp tiny negative variance from floating point error
+        $stdDev = sqrt(max(0.0, $sumSq / $period - $mean * $mean));
+
+        return [$mean, $mean + $stdDevs * $stdDev, $mean - $stdDevs * $stdDev];
+    }
+}
@@ -0,0 +1,109 @@
+<?php
+
+/**
+ * Class IndicatorStateStore
+ * Persists IncrementalIndicatorEngine state per symbol, so the nightly run
+ * can resume from the last processed bar.
+ *
+ * @package MicroCapExperiment
+ */
+class IndicatorStateStore
+{
+    /**
+     * @var \PDO
+     */
+    private $pdo;
+
+    /**
+     * @var bool
+     */
+    private $tableEnsured = false;
+
+    /**
+     * IndicatorStateStore constructor.
+     * @param \PDO $pdo
+     */
+    public function __construct($pdo)
+    {
+        $this->pdo = $pdo;
+    }
+
+    /**
+     * Load the saved engine state for a symbol.
+     *
+     * @param string $symbol
+     * @return array|null
+     */
+    public function load($symbol)
+    {
+        $this->ensureTable();
+
+        $stmt = $this->pdo->prepare("SELECT state FROM indicator_engine_state WHERE symbol = ?");
+        $stmt->execute([$symbol]);
+        $state = $stmt->fetchColumn();
+
+        if ($state === false || $state === null) {
+            return null;
+        }
+
+        $decoded = json_decode($state, true);
+        return is_array($decoded) ? $decoded : null;
+    }
+
+    /**
+     * Save the engine state for a symbol.
+     *
+     * @param string $symbol
+     * @param array $state
+     * @return bool
+     */
+    public function save($symbol, array $state)
+    {
+        $this->ensureTable();
+
+        $sql = "INSERT INTO indicator_engine_state (symbol, last_date, state)
+                VALUES (?, ?, ?)
+                ON DUPLICATE KEY UPDATE
+                last_date = VALUES(last_date),
+                state = VALUES(state),
+                updated_at = CURRENT_TIMESTAMP";
+
+        $stmt = $this->pdo->prepare($sql);
+        return $stmt->execute([$symbol, $state['last_date'] ?? null, json_encode($state)]);
+    }
+
+    /**
+     * Forget the saved state so the next run recomputes from full history.
+     *
+     * @param string $symbol
+     * @return bool
+     */
+    public function reset($symbol)
+    {
+        $this->ensureTable();
+
+        $stmt = $this->pdo->prepare("DELETE FROM indicator_engine_state WHERE symbol = ?");
+        return $stmt->execute([$symbol]);
+    }
+
+    /**
+     * Create the state table on first use.
+     */
+    private function ensureTable()
+    {
+        if ($this->tableEnsured) {
+            return;
+        }
+
+        $this->pdo->exec("
+            CREATE TABLE IF NOT EXISTS indicator_engine_state (
+                symbol VARCHAR(10) NOT NULL PRIMARY KEY,
+                last_date DATE NULL,
+                state MEDIUMTEXT NOT NULL,
+                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP
+            ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci
+        ");
+
+        $this->tableEnsured = true;
+    }
+}
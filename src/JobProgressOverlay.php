@@ -0,0 +1,49 @@
+<?php
+
+/**
+ * Class JobProgressOverlay
+ * Merges the live progress workers publish on a backend channel (Redis hash,
+ * MQTT retained topic) into ta_analysis_jobs rows.
+ *
+ * Workers publish under AbstractJobProcessor::progressJobId(), which is the
+ * ta_analysis_jobs row id for every backend, so rows are matched on their id.
+ *
+ * @package MicroCapExperiment
+ */
+class JobProgressOverlay
+{
+    /**
+     * Replace progress/status_message of running jobs with the live values.
+     *
+     * @param array $jobs Rows with 'id', 'status', 'progress', 'status_message'
+     * @param object $channel Backend with getProgress(array $jobIds)
+     * @return array
+     */
+    public static function apply(array $jobs, $channel)
+    {
+        $runningIds = [];
+        foreach ($jobs as $job) {
+            if ($job['status'] === 'running') {
+                $runningIds[] = (string)$job['id'];
+            }
+        }
+        if (empty($runningIds)) {
+            return $jobs;
+        }
+
+        $live = $channel->getProgress($runningIds);
+
+        foreach ($jobs as &$job) {
+            $id = (string)$job['id'];
+            if ($job['status'] === 'running' && isset($live[$id])) {
+                $job['progress'] = (int)$live[$id]['progress'];
+                if ($live[$id]['status_message'] !== null) {
+                    $job['status_message'] = $live[$id]['status_message'];
+                }
+            }
+        }
+        unset($job);
+
+        return $jobs;
+    }
+}
@@ -0,0 +1,142 @@
+<?php
+
+/**
+ * Class JobProgressReporter
+ * Coalesces job progress updates in memory and publishes them at a bounded rate.
+ *
+ * report() only records the latest progress/message for a job. That state is
+ * published when at least min_interval_ms have passed since the job's last
+ * publish, or when progress moved by at least min_delta points. Reaching 100
+ * (or calling flush()) always publishes. Thousands of per-stock updates become
+ * a handful of writes.
+ *
+ * @package MicroCapExperiment
+ */
+class JobProgressReporter
+{
+    /**
+     * @var callable function ($jobId, $progress, $message, $final)
+     */
+    private $publisher;
+
+    /**
+     * @var float Seconds
+     */
+    private $minInterval;
+
+    /**
+     * @var float Percentage points
+     */
+    private $minDelta;
+
+    /**
+     * Latest unpublished state per job: ['progress', 'message']
+     *
+     * @var array
+     */
+    private $pending = [];
+
+    /**
+     * Last published state per job: ['progress', 'message', 'at']
+     *
+     * @var array
+     */
+    private $published = [];
+
+    /**
+     * @var int
+     */
+    private $reported = 0;
+
+    /**
+     * @var int
+     */
+    private $flushes = 0;
+
+    /**
+     * JobProgressReporter constructor.
+     * @param callable $publisher function ($jobId, $progress, $message, $final)
+     * @param array $options ['min_interval_ms' => int, 'min_delta' => float]
+     */
+    public function __construct(callable $publisher, array $options = [])
+    {
+        $this->publisher = $publisher;
+        $this->minInterval = ($options['min_interval_ms'] ?? 1000) / 1000;
+        $this->minDelta = (float)($options['min_delta'] ?? 5);
+    }
+
+    /**
+     * Record progress for a job, publishing it if the throttle allows.
+     *
+     * @param string|int $jobId
+     * @param float $progress 0-100
+     * @param string|null $message Kept from earlier reports when null
+     */
+    public function report($jobId, $progress, $message = null)
+    {
+        $this->reported++;
+
+        $state = $this->pending[$jobId] ?? [
+            'progress' => $progress,
+            'message' => $this->published[$jobId]['message'] ?? null
+        ];
+        $state['progress'] = $progress;
+        if ($message !== null) {
+            $state['message'] = $message;
+        }
+        $this->pending[$jobId] = $state;
+
+        if ($progress >= 100 || $this->isDue($jobId, $progress)) {
+            $this->publish($jobId, $progress >= 100);
+        }
+    }
+
+    /**
+     * Publish any pending state, for one job or all of them.
+     *
+     * @param string|int|null $jobId
+     */
+    public function flush($jobId = null)
+    {
+        foreach ($jobId === null ? array_keys($this->pending) : [$jobId] as $id) {
+            if (isset($this->pending[$id])) {
+                $this->publish($id, true);
+            }
+        }
+    }
+
+    /**
+     * @return array ['reported' => int, 'flushes' => int]
+     */
+    public function getStats()
+    {
+        return ['reported' => $this->reported, 'flushes' => $this->flushes];
+    }
+
+    private function isDue($jobId, $progress)
+    {
+        if (!isset($this->published[$jobId])) {
+            return true;
+        }
+
+        $last = $this->published[$jobId];
+
+        return abs($progress - $last['progress']) >= $this->minDelta
+            || microtime(true) - $last['at'] >= $this->minInterval;
+    }
+
+    private function publish($jobId, $final)
+    {
+        $state = $this->pending[$jobId];
+        unset($this->pending[$jobId]);
+
+        $this->published[$jobId] = $state + ['at' => microtime(true)];
+        $this->flushes++;
+
+        call_user_func($this->publisher, $jobId, $state['progress'], $state['message'], $final);
+
+        if ($final) {
+            unset($this->published[$jobId]);
+        }
+    }
+}
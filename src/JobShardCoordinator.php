@@ -0,0 +1,293 @@
+<?php
+
+/**
+ * Class JobShardCoordinator
+ * Tracks the shards of a fanned-out (map/reduce) job in ta_job_shards.
+ *
+ * The parent job splits its work into shards and enqueues one child job per
+ * shard through the configured backend. Shards are claimed with an atomic
+ * conditional UPDATE, so a shard runs only once, whether a child worker
+ * picks it up or the waiting parent runs it itself. Children report
+ * progress and results here, and the parent rolls them up.
+ *
+ * @package MicroCapExperiment
+ */
+class JobShardCoordinator
+{
+    /**
+     * @var \PDO
+     */
+    private $pdo;
+
+    /**
+     * @var bool
+     */
+    private $tableEnsured = false;
+
+    /**
+     * JobShardCoordinator constructor.
+     * @param \PDO $pdo
+     */
+    public function __construct($pdo)
+    {
+        $this->pdo = $pdo;
+    }
+
+    /**
+     * Split items into shards for a parent job.
+     *
+     * @param string|int $parentJobId
+     * @param array $items e.g. stock ids
+     * @param int $shardSize
+     * @return int[] Shard ids, in shard order
+     */
+    public function createShards($parentJobId, array $items, $shardSize)
+    {
+        $this->ensureTable();
+
+        $sql = "INSERT INTO ta_job_shards (parent_job_id, shard_index, items, status) VALUES (?, ?, ?, 'pending')";
+        $stmt = $this->pdo->prepare($sql);
+        $shardIds = [];
+
+        foreach (array_chunk(array_values($items), max(1, (int)$shardSize)) as $index => $chunk) {
+            $stmt->execute([$parentJobId, $index, json_encode($chunk)]);
+            $shardIds[] = (int)$this->pdo->lastInsertId();
+        }
+
+        return $shardIds;
+    }
+
+    /**
+     * Record the backend job id of the child job that carries a shard.
+     *
+     * @param int $shardId
+     * @param string|int $childJobId
+     */
+    public function setChildJobId($shardId, $childJobId)
+    {
+        $stmt = $this->pdo->prepare("UPDATE ta_job_shards SET child_job_id = ? WHERE id = ?");
+        $stmt->execute([$childJobId, $shardId]);
+    }
+
+    /**
+     * Atomically claim a pending shard.
+     *
+     * @param int $shardId
+     * @param string|null $claimedBy
+     * @return array|null The shard (with decoded items) if this caller won the claim
+     */
+    public function claimShard($shardId, $claimedBy = null)
+    {
+        $this->ensureTable();
+
+        $sql = "UPDATE ta_job_shards
+                SET status = 'running', claimed_by = ?, claimed_at = CURRENT_TIMESTAMP
+                WHERE id = ? AND status = 'pending'";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$claimedBy, $shardId]);
+
+        if ($stmt->rowCount() !== 1) {
+            return null;
+        }
+
+        $stmt = $this->pdo->prepare("SELECT * FROM ta_job_shards WHERE id = ?");
+        $stmt->execute([$shardId]);
+        $shard = $stmt->fetch(PDO::FETCH_ASSOC);
+        $shard['items'] = json_decode($shard['items'], true) ?: [];
+
+        return $shard;
+    }
+
+    /**
+     * Claim the next pending shard of a parent job, if any.
+     *
+     * @param string|int $parentJobId
+     * @param string|null $claimedBy
+     * @return array|null
+     */
+    public function claimNextShard($parentJobId, $claimedBy = null)
+    {
+        $this->ensureTable();
+
+        $sql = "SELECT id FROM ta_job_shards WHERE parent_job_id = ? AND status = 'pending' ORDER BY shard_index";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$parentJobId]);
+
+        foreach ($stmt->fetchAll(PDO::FETCH_COLUMN) as $shardId) {
+            $shard = $this->claimShard($shardId, $claimedBy);
+            if ($shard) {
+                return $shard;
+            }
+        }
+
+        return null;
+    }
+
+    /**
+     * Record shard progress (0-100) and refresh the claim.
+     *
+     * Only the current claimant of a running shard can write to it, so a
+     * worker whose shard was released as stale and claimed by someone else
+     * finds out here (false) and must stop working on it.
+     *
+     * @param int $shardId
+     * @param string|null $claimedBy
+     * @param float $progress
+     * @return bool Whether the caller still holds the claim
+     */
+    public function updateShardProgress($shardId, $claimedBy, $progress)
+    {
+        $sql = "UPDATE ta_job_shards SET progress = ?, claimed_at = CURRENT_TIMESTAMP
+                WHERE id = ? AND claimed_by = ? AND status = 'running'";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([round($progress, 2), $shardId, $claimedBy]);
+
+        return $stmt->rowCount() === 1;
+    }
+
+    /**
+     * Mark a shard completed with its result.
+     *
+     * @param int $shardId
+     * @param string|null $claimedBy
+     * @param array $result
+     * @return bool False if the caller no longer held the claim
+     */
+    public function completeShard($shardId, $claimedBy, array $result)
+    {
+        $sql = "UPDATE ta_job_shards SET status = 'completed', progress = 100, result = ?, completed_at = CURRENT_TIMESTAMP
+                WHERE id = ? AND claimed_by = ? AND status = 'running'";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([json_encode($result), $shardId, $claimedBy]);
+
+        return $stmt->rowCount() === 1;
+    }
+
+    /**
+     * Mark a shard failed.
+     *
+     * @param int $shardId
+     * @param string|null $claimedBy
+     * @param string $error
+     * @return bool False if the caller no longer held the claim
+     */
+    public function failShard($shardId, $claimedBy, $error)
+    {
+        $sql = "UPDATE ta_job_shards SET status = 'failed', error = ?, completed_at = CURRENT_TIMESTAMP
+                WHERE id = ? AND claimed_by = ? AND status = 'running'";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$error, $shardId, $claimedBy]);
+
+        return $stmt->rowCount() === 1;
+    }
+
+    /**
+     * Return shards stuck in 'running' (e.g. their worker died) to 'pending'.
+     *
+     * A shard is stale when its claim has not been refreshed by
+     * updateShardProgress() for $timeoutSeconds.
+     *
+     * @param string|int $parentJobId
+     * @param int $timeoutSeconds
+     * @return int Number of shards released
+     */
+    public function releaseStaleShards($parentJobId, $timeoutSeconds)
+    {
+        $sql = "UPDATE ta_job_shards
+                SET status = 'pending', claimed_by = NULL, claimed_at = NULL
+                WHERE parent_job_id = ? AND status = 'running'
+                AND claimed_at < DATE_SUB(NOW(), INTERVAL ? SECOND)";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$parentJobId, (int)$timeoutSeconds]);
+
+        return $stmt->rowCount();
+    }
+
+    /**
+     * Roll up shard status, progress and summed numeric results for a parent job.
+     *
+     * @param string|int $parentJobId
+     * @return array ['total', 'pending', 'running', 'completed', 'failed', 'progress', 'result', 'errors']
+     */
+    public function getSummary($parentJobId)
+    {
+        $this->ensureTable();
+
+        $stmt = $this->pdo->prepare("SELECT status, progress, result, error FROM ta_job_shards WHERE parent_job_id = ?");
+        $stmt->execute([$parentJobId]);
+
+        $summary = [
+            'total' => 0,
+            'pending' => 0,
+            'running' => 0,
+            'completed' => 0,
+            'failed' => 0,
+            'progress' => 0.0,
+            'result' => [],
+            'errors' => []
+        ];
+        $progressSum = 0.0;
+
+        while ($row = $stmt->fetch(PDO::FETCH_ASSOC)) {
+            $summary['total']++;
+            $summary[$row['status']]++;
+
+            if ($row['status'] === 'completed' || $row['status'] === 'failed') {
+                $progressSum += 100;
+            } else {
+                $progressSum += (float)$row['progress'];
+            }
+
+            if ($row['result']) {
+                foreach (json_decode($row['result'], true) ?: [] as $key => $value) {
+                    if (is_int($value) || is_float($value)) {
+                        $summary['result'][$key] = ($summary['result'][$key] ?? 0) + $value;
+                    }
+                }
+            }
+
+            if ($row['error']) {
+                $summary['errors'][] = $row['error'];
+            }
+        }
+
+        if ($summary['total'] > 0) {
+            $summary['progress'] = $progressSum / $summary['total'];
+        }
+
+        return $summary;
+    }
+
+    /**
+     * Create the shard table on first use.
+     */
+    private function ensureTable()
+    {
+        if ($this->tableEnsured) {
+            return;
+        }
+
+        $this->pdo->exec("
+            CREATE TABLE IF NOT EXISTS ta_job_shards (
+                id INT AUTO_INCREMENT PRIMARY KEY,
+                parent_job_id VARCHAR(64) NOT NULL,
+                shard_index INT NOT NULL,
+                child_job_id VARCHAR(64) NULL,
+                items TEXT NOT NULL,
+                status ENUM('pending', 'running', 'completed', 'failed') DEFAULT 'pending',
+                progress DECIMAL(5,2) DEFAULT 0,
+                claimed_by VARCHAR(255) NULL,
+                claimed_at TIMESTAMP NULL,
+                completed_at TIMESTAMP NULL,
+                result TEXT NULL,
+                error TEXT NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+                UNIQUE KEY unique_parent_shard (parent_job_id, shard_index),
+                INDEX idx_parent_status (parent_job_id, status)
+            ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci
+        ");
+
+        $this->tableEnsured = true;
+    }
+}
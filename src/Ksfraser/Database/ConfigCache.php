@@ -0,0 +1,141 @@
+<?php
+/**
+ * Compiled configuration cache
+ *
+ * @package Ksfraser\Database
+ */
+
+namespace Ksfraser\Database;
+
+/**
+ * Caches parsed configuration files as PHP arrays
+ *
+ * Parsing db_config.yml / .ini on every request is wasted work: the parsed
+ * array is written once to a PHP file that returns it, which opcache then
+ * keeps compiled in shared memory. The entry is rebuilt whenever the source
+ * file's mtime or size changes.
+ *
+ * Cache files hold credentials, so they are written 0600 into a 0700
+ * directory and only included when owned by the current user.
+ */
+class ConfigCache
+{
+    /** @var string|null Cache directory override (tests) */
+    protected static $directory = null;
+
+    /** @var array Per-process memo: source path => config */
+    protected static $memo = [];
+
+    /**
+     * Load a configuration file through the cache
+     *
+     * @param string $file Source configuration file
+     * @param callable $parser function (string $file): array, used on a miss
+     * @return array Parsed configuration
+     */
+    public static function load(string $file, callable $parser): array
+    {
+        $source = realpath($file) ?: $file;
+        $stat = @stat($source);
+        if ($stat === false) {
+            return $parser($file);
+        }
+        $signature = [$stat['mtime'], $stat['size']];
+
+        if (isset(self::$memo[$source]) && self::$memo[$source]['signature'] === $signature) {
+            return self::$memo[$source]['config'];
+        }
+
+        $cacheFile = self::getCacheFile($source);
+        $entry = self::readEntry($cacheFile);
+        if ($entry === null || $entry['signature'] !== $signature) {
+            $entry = ['signature' => $signature, 'config' => $parser($file)];
+            self::writeEntry($cacheFile, $entry);
+        }
+
+        self::$memo[$source] = $entry;
+        return $entry['config'];
+    }
+
+    /**
+     * Use another cache directory (null restores the default)
+     *
+     * @param string|null $directory Directory path
+     */
+    public static function setDirectory(?string $directory): void
+    {
+        self::$directory = $directory;
+        self::$memo = [];
+    }
+
+    /**
+     * Forget the per-process memo (cache files are kept)
+     */
+    public static function reset(): void
+    {
+        self::$memo = [];
+    }
+
+    /**
+     * Cache file for a source path
+     *
+     * @param string $source Resolved source path
+     * @return string Cache file path
+     */
+    protected static function getCacheFile(string $source): string
+    {
+        $directory = self::$directory ?? sys_get_temp_dir() . '/ksfraser_config_cache';
+        return $directory . '/' . sha1($source) . '.php';
+    }
+
+    /**
+     * Read a cache entry, or null when missing or not trustworthy
+     *
+     * @param string $cacheFile Cache file path
+     * @return array|null Entry with 'signature' and 'config'
+     */
+    protected static function readEntry(string $cacheFile): ?array
+    {
+        if (!is_file($cacheFile)) {
+            return null;
+        }
+        if (function_exists('posix_geteuid') && @fileowner($cacheFile) !== posix_geteuid()) {
+            return null;
+        }
+
+        $entry = @include $cacheFile;
+        if (!is_array($entry) || !isset($entry['signature'], $entry['config']) || !is_array($entry['config'])) {
+            return null;
+        }
+        return $entry;
+    }
+
+    /**
+     * Write a cache entry atomically
+     *
+     * @param string $cacheFile Cache file path
+     * @param array $entry Entry with 'signature' and 'config'
+     */
+    protected static function writeEntry(string $cacheFile, array $entry): void
+    {
+        $directory = dirname($cacheFile);
+        if (!is_dir($directory) && !@mkdir($directory, 0700, true)) {
+            return;
+        }
+
+        $tmp = $cacheFile . '.' . getmypid() . '.tmp';
+        $code = '<?php return ' . var_export($entry, true) . ';' . PHP_EOL;
+        if (@file_put_contents($tmp, $code, LOCK_EX) === false) {
+            return;
+        }
+        @chmod($tmp, 0600);
+        if (@rename($tmp, $cacheFile)) {
+            if (function_exists('opcache_invalidate')) {
+                opcache_invalidate($cacheFile, true);
+            }
+        } else {
+            @unlink($tmp);
+        }
+    }
+}
+?>
@@ -16,6 +16,9 @@ use PDOException;
 use mysqli;
 use mysqli_result;
 
+require_once __DIR__ . '/ConfigCache.php';
+require_once __DIR__ . '/StatementCache.php';
+
 /**
  * Database connection interface for consistent API across drivers
  */
@@ -62,6 +65,18 @@ class EnhancedDbManager
     /** @var array Available driver priorities */
     protected static $driverPriority = ['pdo_mysql', 'mysqli', 'pdo_sqlite'];
     
+    /** @var int|null PID that opened the current connection */
+    protected static $connectionPid = null;
+    
+    /** @var int|null PID of the process that first connected (before any fork) */
+    protected static $originPid = null;
+    
+    /** @var int Unix time the connection was last known to be healthy */
+    protected static $lastHealthy = 0;
+    
+    /** @var array Connections inherited across fork, kept so they are not closed */
+    protected static $inherited = [];
+    
     /**
      * Load database configuration from multiple sources
      * 
@@ -89,7 +104,9 @@ class EnhancedDbManager
         $configLoaded = false;
         foreach ($possibleFiles as $file) {
             if ($file && file_exists($file)) {
-                $config = self::loadConfigFile($file);
+                $config = ConfigCache::load($file, function (string $file): array {
+                    return self::loadConfigFile($file);
+                });
                 $configLoaded = true;
                 break;
             }
@@ -115,8 +132,13 @@ class EnhancedDbManager
             'password' => '',
             'database' => '',
             'charset' => 'utf8mb4',
+            'persistent' => false,
+            'health_check_interval' => 60,
         ], $config);
         
+        $config['persistent'] = filter_var($config['persistent'], FILTER_VALIDATE_BOOLEAN);
+        $config['health_check_interval'] = (int)$config['health_check_interval'];
+        
         self::$config = $config;
         return $config;
     }
@@ -205,6 +227,8 @@ class EnhancedDbManager
                 'password' => $dbConfig['password'] ?? '',
                 'database' => $dbConfig['legacy']['database'] ?? $dbConfig['database'] ?? '',
                 'charset' => $dbConfig['charset'] ?? 'utf8mb4',
+                'persistent' => $dbConfig['persistent'] ?? false,
+                'health_check_interval' => $dbConfig['health_check_interval'] ?? 60,
             ];
         }
         
@@ -214,16 +238,39 @@ class EnhancedDbManager
     /**
      * Get database connection with automatic fallback
      * 
+     * The connection is shared for the life of the process. A forked child
+     * gets its own connection instead of the parent's socket, and a
+     * connection idle for more than health_check_interval seconds is pinged
+     * (and reopened if the server dropped it).
+     * 
      * @return DatabaseConnectionInterface Database connection
      * @throws Exception If no suitable driver is available
      */
     public static function getConnection(): DatabaseConnectionInterface
     {
         if (self::$connection !== null) {
-            return self::$connection;
+            if (self::$connectionPid !== getmypid()) {
+                // Forked: the socket belongs to the parent. Keep the object
+                // alive (closing it would end the parent's session) and reconnect.
+                self::$inherited[] = self::$connection;
+                self::resetConnection();
+            } elseif (!self::isHealthy(self::$connection)) {
+                self::resetConnection();
+            } else {
+                return self::$connection;
+            }
         }
         
         $config = self::getConfig();
+        if (self::$originPid === null) {
+            self::$originPid = getmypid();
+        } elseif (self::$originPid !== getmypid()) {
+            // Persistent handles are found by DSN in the process-wide list the
+            // child inherited, which would hand back the parent's socket
+            $config['persistent'] = false;
+        }
+        self::$connectionPid = getmypid();
+        self::$lastHealthy = time();
         $lastException = null;
         
         foreach (self::$driverPriority as $driver) {
@@ -265,6 +312,48 @@ class EnhancedDbManager
         );
     }
     
+    /**
+     * Get a connection that only connects when first used
+     * 
+     * For pages that may not touch the database at all. Every call is
+     * routed through getConnection(), so fork and health checks still apply.
+     * 
+     * @return DatabaseConnectionInterface Lazy connection
+     */
+    public static function getLazyConnection(): DatabaseConnectionInterface
+    {
+        return new LazyConnection(function () {
+            return self::getConnection();
+        });
+    }
+    
+    /**
+     * Whether the shared connection can be reused
+     * 
+     * Pings with SELECT 1 once it has been idle for health_check_interval
+     * seconds (0 disables the check).
+     * 
+     * @param DatabaseConnectionInterface $connection Connection to check
+     * @return bool True if usable
+     */
+    protected static function isHealthy(DatabaseConnectionInterface $connection): bool
+    {
+        $interval = self::getConfig()['health_check_interval'];
+        $now = time();
+        if ($interval <= 0 || $now - self::$lastHealthy < $interval) {
+            self::$lastHealthy = $now;
+            return true;
+        }
+        
+        try {
+            $connection->prepare('SELECT 1')->execute();
+        } catch (\Throwable $e) {
+            return false;
+        }
+        self::$lastHealthy = $now;
+        return true;
+    }
+    
     /**
      * Check if PDO MySQL is available
      * 
@@ -316,6 +405,16 @@ class EnhancedDbManager
     {
         self::$connection = null;
         self::$currentDriver = null;
+        self::$connectionPid = null;
+    }
+    
+    /**
+     * Reset cached configuration (for testing)
+     */
+    public static function resetConfig(): void
+    {
+        self::$config = null;
+        ConfigCache::reset();
     }
     
     /**
@@ -346,6 +445,7 @@ class EnhancedDbManager
         $stmt = $connection->prepare($sql);
         $stmt->execute($params);
         $result = $stmt->fetch();
+        self::closeCursor($stmt);
         return $result ?: null;
     }
     
@@ -361,7 +461,9 @@ class EnhancedDbManager
         $connection = self::getConnection();
         $stmt = $connection->prepare($sql);
         $stmt->execute($params);
-        return $stmt->fetchColumn();
+        $value = $stmt->fetchColumn();
+        self::closeCursor($stmt);
+        return $value;
     }
     
     /**
@@ -379,6 +481,28 @@ class EnhancedDbManager
         return $stmt->rowCount();
     }
     
+    /**
+     * Prepared statement cache counters for this process
+     * 
+     * @return array hits, misses, evictions, hit_rate
+     */
+    public static function getStatementCacheStats(): array
+    {
+        return StatementCache::getGlobalStats();
+    }
+    
+    /**
+     * Release a partly read result (statements are cached and reused)
+     * 
+     * @param DatabaseStatementInterface $stmt Statement
+     */
+    protected static function closeCursor(DatabaseStatementInterface $stmt): void
+    {
+        if (method_exists($stmt, 'closeCursor')) {
+            $stmt->closeCursor();
+        }
+    }
+    
     /**
      * Get last insert ID
      * 
@@ -423,4 +547,73 @@ class EnhancedDbManager
         return $connection->rollback();
     }
 }
+
+/**
+ * Connection proxy that defers connecting until first use
+ */
+class LazyConnection implements DatabaseConnectionInterface
+{
+    /** @var callable Returns the real connection */
+    protected $resolver;
+    
+    /**
+     * Constructor
+     * 
+     * @param callable $resolver function (): DatabaseConnectionInterface
+     */
+    public function __construct(callable $resolver)
+    {
+        $this->resolver = $resolver;
+    }
+    
+    /**
+     * Resolve the underlying connection
+     * 
+     * @return DatabaseConnectionInterface Real connection
+     */
+    protected function connection(): DatabaseConnectionInterface
+    {
+        return ($this->resolver)();
+    }
+    
+    public function prepare(string $sql): DatabaseStatementInterface
+    {
+        return $this->connection()->prepare($sql);
+    }
+    
+    public function exec(string $sql): int
+    {
+        return $this->connection()->exec($sql);
+    }
+    
+    public function lastInsertId(): string
+    {
+        return $this->connection()->lastInsertId();
+    }
+    
+    public function beginTransaction(): bool
+    {
+        return $this->connection()->beginTransaction();
+    }
+    
+    public function commit(): bool
+    {
+        return $this->connection()->commit();
+    }
+    
+    public function rollback(): bool
+    {
+        return $this->connection()->rollback();
+    }
+    
+    public function getAttribute(int $attribute)
+    {
+        return $this->connection()->getAttribute($attribute);
+    }
+    
+    public function setAttribute(int $attribute, $value): bool
+    {
+        return $this->connection()->setAttribute($attribute, $value);
+    }
+}
 ?>
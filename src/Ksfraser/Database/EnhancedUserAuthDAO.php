@@ -19,10 +19,13 @@ class EnhancedUserAuthDAO
     
     /**
      * Constructor
+     * 
+     * Connects on first query, so pages that only check the session never
+     * open a database connection.
      */
     public function __construct()
     {
-        $this->connection = EnhancedDbManager::getConnection();
+        $this->connection = EnhancedDbManager::getLazyConnection();
     }
     
     /**
@@ -292,9 +295,11 @@ class EnhancedUserAuthDAO
      */
     public function getDatabaseInfo(): array
     {
+        $connection = EnhancedDbManager::getConnection();
+        
         return [
             'driver' => EnhancedDbManager::getCurrentDriver(),
-            'connection_class' => get_class($this->connection),
+            'connection_class' => get_class($connection),
         ];
     }
 }
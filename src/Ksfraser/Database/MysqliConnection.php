@@ -12,6 +12,8 @@ use mysqli_stmt;
 use mysqli_result;
 use Exception;
 
+require_once __DIR__ . '/StatementCache.php';
+
 /**
  * MySQLi connection wrapper implementing DatabaseConnectionInterface
  */
@@ -23,6 +25,9 @@ class MysqliConnection implements DatabaseConnectionInterface
     /** @var bool Transaction status */
     protected $inTransaction = false;
     
+    /** @var StatementCache Prepared statements by SQL */
+    protected $statementCache;
+    
     /**
      * Constructor
      * 
@@ -31,8 +36,9 @@ class MysqliConnection implements DatabaseConnectionInterface
      */
     public function __construct(array $config)
     {
+        // A "p:" host prefix reuses a pooled connection across requests
         $this->mysqli = new mysqli(
-            $config['host'],
+            (!empty($config['persistent']) ? 'p:' : '') . $config['host'],
             $config['username'],
             $config['password'],
             $config['database'],
@@ -55,13 +61,28 @@ class MysqliConnection implements DatabaseConnectionInterface
      */
     public function prepare(string $sql): DatabaseStatementInterface
     {
-        $stmt = $this->mysqli->prepare($sql);
-        
-        if (!$stmt) {
-            throw new Exception('MySQLi prepare failed: ' . $this->mysqli->error);
+        return $this->getStatementCache()->get($sql, function (string $sql) {
+            $stmt = $this->mysqli->prepare($sql);
+            
+            if (!$stmt) {
+                throw new Exception('MySQLi prepare failed: ' . $this->mysqli->error);
+            }
+            
+            return new MysqliStatementWrapper($stmt);
+        });
+    }
+    
+    /**
+     * Statement cache behind prepare()
+     * 
+     * @return StatementCache Cache for this connection
+     */
+    public function getStatementCache(): StatementCache
+    {
+        if ($this->statementCache === null) {
+            $this->statementCache = new StatementCache();
         }
-        
-        return new MysqliStatementWrapper($stmt);
+        return $this->statementCache;
     }
     
     /**
@@ -304,6 +325,20 @@ class MysqliStatementWrapper implements DatabaseStatementInterface
         return $this->stmt->affected_rows;
     }
     
+    /**
+     * Release the result set so a cached statement holds no cursor
+     * 
+     * @return bool Success status
+     */
+    public function closeCursor(): bool
+    {
+        if ($this->result instanceof mysqli_result) {
+            $this->result->free();
+        }
+        $this->result = null;
+        return true;
+    }
+    
     /**
      * Bind parameter by reference
      * 
@@ -11,6 +11,8 @@ use PDO;
 use PDOException;
 use PDOStatement;
 
+require_once __DIR__ . '/StatementCache.php';
+
 /**
  * PDO connection wrapper implementing DatabaseConnectionInterface
  */
@@ -19,6 +21,9 @@ class PdoConnection implements DatabaseConnectionInterface
     /** @var PDO The PDO instance */
     protected $pdo;
     
+    /** @var StatementCache Prepared statements by SQL */
+    protected $statementCache;
+    
     /**
      * Constructor
      * 
@@ -39,6 +44,8 @@ class PdoConnection implements DatabaseConnectionInterface
             PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION,
             PDO::ATTR_DEFAULT_FETCH_MODE => PDO::FETCH_ASSOC,
             PDO::ATTR_EMULATE_PREPARES => false,
+            // Reuse a pooled connection from this PHP worker across requests
+            PDO::ATTR_PERSISTENT => !empty($config['persistent']),
         ];
         
         $this->pdo = new PDO($dsn, $config['username'], $config['password'], $options);
@@ -52,8 +59,22 @@ class PdoConnection implements DatabaseConnectionInterface
      */
     public function prepare(string $sql): DatabaseStatementInterface
     {
-        $stmt = $this->pdo->prepare($sql);
-        return new PdoStatementWrapper($stmt);
+        return $this->getStatementCache()->get($sql, function (string $sql) {
+            return new PdoStatementWrapper($this->pdo->prepare($sql));
+        });
+    }
+    
+    /**
+     * Statement cache behind prepare()
+     * 
+     * @return StatementCache Cache for this connection
+     */
+    public function getStatementCache(): StatementCache
+    {
+        if ($this->statementCache === null) {
+            $this->statementCache = new StatementCache();
+        }
+        return $this->statementCache;
     }
     
     /**
@@ -203,6 +224,16 @@ class PdoStatementWrapper implements DatabaseStatementInterface
         return $this->stmt->rowCount();
     }
     
+    /**
+     * Release the result set so a cached statement holds no cursor
+     * 
+     * @return bool Success status
+     */
+    public function closeCursor(): bool
+    {
+        return $this->stmt->closeCursor();
+    }
+    
     /**
      * Bind parameter by reference
      * 
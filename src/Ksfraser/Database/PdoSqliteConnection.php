@@ -11,6 +11,8 @@ use PDO;
 use PDOException;
 use Exception;
 
+require_once __DIR__ . '/StatementCache.php';
+
 /**
  * SQLite connection wrapper implementing DatabaseConnectionInterface
  * This is used as a fallback when MySQL is not available
@@ -20,6 +22,9 @@ class PdoSqliteConnection implements DatabaseConnectionInterface
     /** @var PDO The PDO instance */
     protected $pdo;
     
+    /** @var StatementCache Prepared statements by SQL */
+    protected $statementCache;
+    
     /**
      * Constructor - creates in-memory SQLite database
      * 
@@ -67,8 +72,22 @@ class PdoSqliteConnection implements DatabaseConnectionInterface
      */
     public function prepare(string $sql): DatabaseStatementInterface
     {
-        $stmt = $this->pdo->prepare($sql);
-        return new PdoStatementWrapper($stmt);
+        return $this->getStatementCache()->get($sql, function (string $sql) {
+            return new PdoStatementWrapper($this->pdo->prepare($sql));
+        });
+    }
+    
+    /**
+     * Statement cache behind prepare()
+     * 
+     * @return StatementCache Cache for this connection
+     */
+    public function getStatementCache(): StatementCache
+    {
+        if ($this->statementCache === null) {
+            $this->statementCache = new StatementCache();
+        }
+        return $this->statementCache;
     }
     
     /**
@@ -0,0 +1,146 @@
+<?php
+/**
+ * Prepared statement cache
+ *
+ * @package Ksfraser\Database
+ */
+
+namespace Ksfraser\Database;
+
+/**
+ * LRU cache of prepared statements for one connection
+ *
+ * Per-symbol table names are interpolated into the SQL, so the SQL text
+ * (table plus query shape) is the key. A statement is prepared once and
+ * re-executed on later calls until it is evicted as least recently used;
+ * eviction drops the last reference, which deallocates it on the server.
+ *
+ * A statement returned by get() is shared: finish reading its results
+ * before the same SQL is requested again.
+ *
+ * Counters are kept per cache and for the whole process (getGlobalStats()).
+ */
+class StatementCache
+{
+    /** @var int Default number of statements kept per connection */
+    const DEFAULT_CAPACITY = 128;
+
+    /** @var int Maximum cached statements */
+    protected $capacity;
+
+    /** @var array SQL => statement, least recently used first */
+    protected $statements = [];
+
+    /** @var array Counters for this cache */
+    protected $stats = ['hits' => 0, 'misses' => 0, 'evictions' => 0];
+
+    /** @var array Counters across every cache in the process */
+    protected static $globalStats = ['hits' => 0, 'misses' => 0, 'evictions' => 0];
+
+    /**
+     * Constructor
+     *
+     * @param int $capacity Maximum cached statements (0 disables caching)
+     */
+    public function __construct(int $capacity = self::DEFAULT_CAPACITY)
+    {
+        $this->capacity = max(0, $capacity);
+    }
+
+    /**
+     * Cached statement for $sql, prepared with $prepare on a miss
+     *
+     * @param string $sql SQL text
+     * @param callable $prepare function (string $sql): statement
+     * @return mixed Prepared statement
+     */
+    public function get(string $sql, callable $prepare)
+    {
+        if (isset($this->statements[$sql])) {
+            // Move to the most recently used end
+            $stmt = $this->statements[$sql];
+            unset($this->statements[$sql]);
+            $this->statements[$sql] = $stmt;
+            $this->count('hits');
+            return $stmt;
+        }
+
+        $this->count('misses');
+        $stmt = $prepare($sql);
+        if ($this->capacity === 0) {
+            return $stmt;
+        }
+
+        $this->statements[$sql] = $stmt;
+        if (count($this->statements) > $this->capacity) {
+            reset($this->statements);
+            unset($this->statements[key($this->statements)]);
+            $this->count('evictions');
+        }
+        return $stmt;
+    }
+
+    /**
+     * Drop every cached statement
+     */
+    public function clear(): void
+    {
+        $this->statements = [];
+    }
+
+    /**
+     * Counters for this cache
+     *
+     * @return array hits, misses, evictions, size, capacity, hit_rate
+     */
+    public function getStats(): array
+    {
+        return self::withHitRate($this->stats) + [
+            'size' => count($this->statements),
+            'capacity' => $this->capacity,
+        ];
+    }
+
+    /**
+     * Counters across every cache in this process
+     *
+     * @return array hits, misses, evictions, hit_rate
+     */
+    public static function getGlobalStats(): array
+    {
+        return self::withHitRate(self::$globalStats);
+    }
+
+    /**
+     * Reset the process-wide counters (for testing)
+     */
+    public static function resetGlobalStats(): void
+    {
+        self::$globalStats = ['hits' => 0, 'misses' => 0, 'evictions' => 0];
+    }
+
+    /**
+     * Increment a counter locally and process-wide
+     *
+     * @param string $counter Counter name
+     */
+    protected function count(string $counter): void
+    {
+        $this->stats[$counter]++;
+        self::$globalStats[$counter]++;
+    }
+
+    /**
+     * Add hit_rate (0..1) to a set of counters
+     *
+     * @param array $stats Counters
+     * @return array Counters with hit_rate
+     */
+    protected static function withHitRate(array $stats): array
+    {
+        $lookups = $stats['hits'] + $stats['misses'];
+        $stats['hit_rate'] = $lookups > 0 ? $stats['hits'] / $lookups : 0.0;
+        return $stats;
+    }
+}
+?>
@@ -6,6 +6,8 @@ use PHPUnit\Framework\TestCase;
 use Ksfraser\Database\EnhancedDbManager;
 use Ksfraser\Database\DatabaseConnectionInterface;
 use Ksfraser\Database\PdoSqliteConnection;
+use Ksfraser\Database\LazyConnection;
+use Ksfraser\Database\ConfigCache;
 
 /**
  * Test suite for EnhancedDbManager class
@@ -242,4 +244,49 @@ INI;
         $this->assertIsString($lastId);
         $this->assertGreaterThan(0, (int)$lastId);
     }
+
+    public function testLazyConnectionDefersConnect()
+    {
+        $connection = EnhancedDbManager::getLazyConnection();
+        
+        $this->assertInstanceOf(LazyConnection::class, $connection);
+        $this->assertNull(EnhancedDbManager::getCurrentDriver());
+        
+        $stmt = $connection->prepare("SELECT 1 as test");
+        $stmt->execute();
+        
+        $this->assertEquals('pdo_sqlite', EnhancedDbManager::getCurrentDriver());
+        $this->assertEquals(1, $stmt->fetchColumn());
+    }
+
+    public function testConfigCacheParsesOncePerChange()
+    {
+        ConfigCache::setDirectory($this->testConfigDir . '/cache');
+        $parses = 0;
+        $parser = function (string $file) use (&$parses): array {
+            $parses++;
+            return parse_ini_file($file, true);
+        };
+        
+        try {
+            $first = ConfigCache::load($this->testConfigFile, $parser);
+            ConfigCache::reset(); // as in a new request
+            $second = ConfigCache::load($this->testConfigFile, $parser);
+            
+            $this->assertSame(1, $parses);
+            $this->assertSame($first, $second);
+            $this->assertEquals('test_user', $second['database']['username']);
+            
+            file_put_contents($this->testConfigFile, "[database]\nusername = changed_user\n");
+            clearstatcache();
+            $third = ConfigCache::load($this->testConfigFile, $parser);
+            
+            $this->assertSame(2, $parses);
+            $this->assertEquals('changed_user', $third['database']['username']);
+        } finally {
+            array_map('unlink', glob($this->testConfigDir . '/cache/*'));
+            rmdir($this->testConfigDir . '/cache');
+            ConfigCache::setDirectory(null);
+        }
+    }
 }
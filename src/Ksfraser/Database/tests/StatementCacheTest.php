@@ -0,0 +1,117 @@
+<?php
+
+namespace Ksfraser\Database\Tests;
+
+use PHPUnit\Framework\TestCase;
+use Ksfraser\Database\EnhancedDbManager;
+use Ksfraser\Database\StatementCache;
+
+require_once __DIR__ . '/../StatementCache.php';
+
+/**
+ * Test suite for StatementCache
+ *
+ * Tests that:
+ * - Identical SQL is prepared once and the statement reused
+ * - The least recently used statement is evicted at capacity
+ * - Hit/miss counters are kept per cache and per process
+ * - Connections route prepare() through the cache
+ */
+class StatementCacheTest extends TestCase
+{
+    /** @var int */
+    private $prepared;
+
+    protected function setUp(): void
+    {
+        StatementCache::resetGlobalStats();
+        EnhancedDbManager::resetConnection();
+        $this->prepared = 0;
+    }
+
+    private function getPreparer(): callable
+    {
+        return function (string $sql) {
+            $this->prepared++;
+            return (object)['sql' => $sql, 'n' => $this->prepared];
+        };
+    }
+
+    public function testIdenticalSqlIsPreparedOnce()
+    {
+        $cache = new StatementCache();
+
+        $first = $cache->get('SELECT * FROM IBM_prices WHERE symbol = ?', $this->getPreparer());
+        $second = $cache->get('SELECT * FROM IBM_prices WHERE symbol = ?', $this->getPreparer());
+        $other = $cache->get('SELECT * FROM AAPL_prices WHERE symbol = ?', $this->getPreparer());
+
+        $this->assertSame($first, $second);
+        $this->assertNotSame($first, $other);
+        $this->assertSame(2, $this->prepared);
+    }
+
+    public function testLeastRecentlyUsedIsEvicted()
+    {
+        $cache = new StatementCache(2);
+        $cache->get('A', $this->getPreparer());
+        $cache->get('B', $this->getPreparer());
+        $cache->get('A', $this->getPreparer()); // B is now least recently used
+        $cache->get('C', $this->getPreparer());
+
+        $cache->get('A', $this->getPreparer());
+        $this->assertSame(3, $this->prepared);
+
+        $cache->get('B', $this->getPreparer());
+        $this->assertSame(4, $this->prepared);
+
+        $stats = $cache->getStats();
+        $this->assertSame(2, $stats['size']);
+        $this->assertSame(2, $stats['evictions']);
+    }
+
+    public function testZeroCapacityDisablesCaching()
+    {
+        $cache = new StatementCache(0);
+        $cache->get('A', $this->getPreparer());
+        $cache->get('A', $this->getPreparer());
+
+        $this->assertSame(2, $this->prepared);
+        $this->assertSame(0, $cache->getStats()['size']);
+    }
+
+    public function testHitRateCounters()
+    {
+        $first = new StatementCache();
+        $second = new StatementCache();
+        $first->get('A', $this->getPreparer());
+        $first->get('A', $this->getPreparer());
+        $first->get('A', $this->getPreparer());
+        $second->get('A', $this->getPreparer());
+
+        $stats = $first->getStats();
+        $this->assertSame(2, $stats['hits']);
+        $this->assertSame(1, $stats['misses']);
+        $this->assertEqualsWithDelta(2 / 3, $stats['hit_rate'], 0.0001);
+
+        $global = StatementCache::getGlobalStats();
+        $this->assertSame(2, $global['hits']);
+        $this->assertSame(2, $global['misses']);
+        $this->assertEqualsWithDelta(0.5, $global['hit_rate'], 0.0001);
+    }
+
+    public function testConnectionReusesPreparedStatements()
+    {
+        $connection = EnhancedDbManager::getConnection();
+        $connection->exec("CREATE TABLE IF NOT EXISTS cache_test (id INTEGER PRIMARY KEY, value TEXT)");
+
+        for ($i = 0; $i < 5; $i++) {
+            EnhancedDbManager::execute("INSERT INTO cache_test (value) VALUES (?)", ["row{$i}"]);
+        }
+        $count = EnhancedDbManager::fetchValue("SELECT COUNT(*) FROM cache_test");
+
+        $this->assertEquals(5, $count);
+        $stats = EnhancedDbManager::getStatementCacheStats();
+        $this->assertSame(4, $stats['hits']);
+        $this->assertSame(2, $stats['misses']);
+    }
+}
@@ -0,0 +1,543 @@
+<?php
+
+/**
+ * Class Metrics
+ * In-process counters, histograms and timing spans for the hot paths,
+ * exported in the Prometheus text format.
+ *
+ * Instrumented code wraps its work in startSpan()/endSpan(). Every span
+ * counts into <name>_total, and a sampled fraction of them (sample_rate)
+ * also records its duration in the <name>_seconds histogram. With the
+ * default sample_rate of 0 recording is off, and each call returns after
+ * one comparison.
+ *
+ * Each process aggregates in memory and writes its totals to
+ * <dir>/php-<host>-<pid>.json at most every flush_interval seconds and at
+ * exit. collect() merges the files of every process, including Python
+ * processes using runtime_metrics.py (same format). It also folds the
+ * files of exited processes into archive.json, so counters never go
+ * backwards and the directory does not grow with every forked job.
+ *
+ * Configuration comes from the metrics section of job_processor.yml
+ * (configure()), or from the WEALTHSYSTEM_METRICS_SAMPLE_RATE and
+ * WEALTHSYSTEM_METRICS_DIR environment variables.
+ *
+ * @package MicroCapExperiment
+ */
+class Metrics
+{
+    /**
+     * Prefix of every exported metric name
+     */
+    const PREFIX = 'wealthsystem_';
+
+    /**
+     * Histogram bucket upper bounds in seconds (shared with runtime_metrics.py)
+     */
+    const BUCKETS = [0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60];
+
+    /**
+     * @var float|null Fraction of spans timed; null until configured
+     */
+    private static $sampleRate = null;
+
+    /**
+     * @var string
+     */
+    private static $dir;
+
+    /**
+     * @var float Seconds between snapshot writes while recording
+     */
+    private static $flushInterval = 10.0;
+
+    /**
+     * @var float
+     */
+    private static $lastFlush = 0.0;
+
+    /**
+     * @var int|null Process the aggregates belong to
+     */
+    private static $pid = null;
+
+    /**
+     * @var array series key => ['name', 'labels', 'value']
+     */
+    private static $counters = [];
+
+    /**
+     * @var array series key => ['name', 'labels', 'counts', 'sum', 'count']
+     */
+    private static $histograms = [];
+
+    /**
+     * @var bool Unflushed changes
+     */
+    private static $dirty = false;
+
+    /**
+     * @var bool
+     */
+    private static $shutdownRegistered = false;
+
+    /**
+     * Apply settings; unset keys fall back to the environment, then defaults.
+     *
+     * @param array $config ['sample_rate' => 0..1, 'dir' => string, 'flush_interval' => seconds]
+     */
+    public static function configure(array $config = [])
+    {
+        $rate = $config['sample_rate'] ?? getenv('WEALTHSYSTEM_METRICS_SAMPLE_RATE');
+        self::$sampleRate = max(0.0, min(1.0, (float)$rate));
+
+        $dir = $config['dir'] ?? getenv('WEALTHSYSTEM_METRICS_DIR');
+        self::$dir = $dir ?: sys_get_temp_dir() . '/wealthsystem_metrics';
+
+        self::$flushInterval = (float)($config['flush_interval'] ?? 10);
+        if (self::$pid === null) {
+            self::$pid = getmypid();
+        }
+    }
+
+    /**
+     * Whether anything is being recorded
+     *
+     * @return bool
+     */
+    public static function isEnabled()
+    {
+        if (self::$sampleRate === null) {
+            self::configure();
+        }
+        return self::$sampleRate > 0;
+    }
+
+    /**
+     * Add to a counter
+     *
+     * @param string $name e.g. 'worker_jobs_total'
+     * @param array $labels Low-cardinality labels only (no symbols or ids)
+     * @param int|float $value
+     */
+    public static function increment($name, array $labels = [], $value = 1)
+    {
+        if (!self::isEnabled()) {
+            return;
+        }
+        self::claimProcess();
+
+        ksort($labels);
+        $key = $name . json_encode($labels);
+        if (!isset(self::$counters[$key])) {
+            self::$counters[$key] = ['name' => $name, 'labels' => $labels, 'value' => 0];
+        }
+        self::$counters[$key]['value'] += $value;
+        self::recorded();
+    }
+
+    /**
+     * Record a duration in a histogram
+     *
+     * @param string $name e.g. 'stock_data_query_seconds'
+     * @param float $seconds
+     * @param array $labels
+     */
+    public static function observe($name, $seconds, array $labels = [])
+    {
+        if (!self::isEnabled()) {
+            return;
+        }
+        self::claimProcess();
+
+        ksort($labels);
+        $key = $name . json_encode($labels);
+        if (!isset(self::$histograms[$key])) {
+            self::$histograms[$key] = [
+                'name' => $name,
+                'labels' => $labels,
+                'counts' => array_fill(0, count(self::BUCKETS) + 1, 0),
+                'sum' => 0.0,
+                'count' => 0
+            ];
+        }
+
+        $bucket = count(self::BUCKETS);
+        foreach (self::BUCKETS as $i => $le) {
+            if ($seconds <= $le) {
+                $bucket = $i;
+                break;
+            }
+        }
+        self::$histograms[$key]['counts'][$bucket]++;
+        self::$histograms[$key]['sum'] += $seconds;
+        self::$histograms[$key]['count']++;
+        self::recorded();
+    }
+
+    /**
+     * Start timing an operation
+     *
+     * @param string $name Span name; exported as <name>_total and <name>_seconds
+     * @param array $labels
+     * @return array|null Pass to endSpan(); null when recording is off
+     */
+    public static function startSpan($name, array $labels = [])
+    {
+        if (self::$sampleRate === null) {
+            self::configure();
+        }
+        if (self::$sampleRate <= 0) {
+            return null;
+        }
+
+        $sampled = self::$sampleRate >= 1 || mt_rand() / mt_getrandmax() < self::$sampleRate;
+        return [$name, $labels, $sampled ? microtime(true) : null];
+    }
+
+    /**
+     * Finish a span started with startSpan()
+     *
+     * @param array|null $span
+     * @param array $labels Labels known only at the end (e.g. outcome)
+     */
+    public static function endSpan($span, array $labels = [])
+    {
+        if ($span === null) {
+            return;
+        }
+
+        list($name, $spanLabels, $started) = $span;
+        $labels += $spanLabels;
+        self::increment("{$name}_total", $labels);
+        if ($started !== null) {
+            self::observe("{$name}_seconds", microtime(true) - $started, $labels);
+        }
+    }
+
+    /**
+     * Run $fn inside a span labelled outcome="ok" or outcome="error"
+     *
+     * @param string $name
+     * @param callable $fn
+     * @param array $labels
+     * @return mixed $fn's result
+     */
+    public static function time($name, callable $fn, array $labels = [])
+    {
+        $span = self::startSpan($name, $labels);
+        try {
+            $result = $fn();
+        } catch (Throwable $e) {
+            self::endSpan($span, ['outcome' => 'error']);
+            throw $e;
+        }
+        self::endSpan($span, ['outcome' => 'ok']);
+        return $result;
+    }
+
+    /**
+     * Write this process's totals to its snapshot file
+     */
+    public static function flush()
+    {
+        if (self::$pid === null) {
+            return;
+        }
+        if (getmypid() !== self::$pid) {
+            // Forked child that recorded nothing: the totals are the parent's
+            self::claimProcess();
+            return;
+        }
+        if (!self::$dirty) {
+            return;
+        }
+
+        if (!is_dir(self::$dir) && !@mkdir(self::$dir, 0775, true) && !is_dir(self::$dir)) {
+            return;
+        }
+        self::writeJson(self::$dir . '/php-' . self::hostTag() . '-' . self::$pid . '.json', self::snapshot());
+        self::$dirty = false;
+        self::$lastFlush = microtime(true);
+    }
+
+    /**
+     * This process's totals
+     *
+     * @return array ['lang', 'host', 'pid', 'updated_at', 'counters', 'histograms']
+     */
+    public static function snapshot()
+    {
+        $histograms = [];
+        foreach (self::$histograms as $histogram) {
+            $histograms[] = $histogram + ['buckets' => self::BUCKETS];
+        }
+
+        return [
+            'lang' => 'php',
+            'host' => gethostname(),
+            'pid' => self::$pid,
+            'updated_at' => time(),
+            'counters' => array_values(self::$counters),
+            'histograms' => $histograms
+        ];
+    }
+
+    /**
+     * Drop everything recorded (tests)
+     */
+    public static function reset()
+    {
+        self::$counters = [];
+        self::$histograms = [];
+        self::$dirty = false;
+        self::$pid = getmypid();
+    }
+
+    /**
+     * Totals across every process writing to the metrics directory
+     *
+     * @param string|null $dir Defaults to the configured directory
+     * @return array ['counters' => [...], 'histograms' => [...]]
+     */
+    public static function collect($dir = null)
+    {
+        if (self::$sampleRate === null) {
+            self::configure();
+        }
+        self::flush();
+
+        $dir = $dir ?? self::$dir;
+        if (!is_dir($dir)) {
+            return self::merge([]);
+        }
+
+        $lock = fopen("{$dir}/.lock", 'c');
+        if ($lock === false) {
+            return self::merge([]);
+        }
+        flock($lock, LOCK_EX);
+
+        try {
+            $archiveFile = "{$dir}/archive.json";
+            $archive = self::readJson($archiveFile);
+            $live = [];
+            $exited = [];
+            foreach (glob("{$dir}/*-*.json") as $file) {
+                $snapshot = self::readJson($file);
+                if ($snapshot === null) {
+                    continue;
+                }
+                if (self::hasExited($snapshot)) {
+                    $exited[$file] = $snapshot;
+                } else {
+                    $live[] = $snapshot;
+                }
+            }
+
+            if (!empty($exited)) {
+                $archive = self::merge(array_merge([$archive], array_values($exited)));
+                self::writeJson($archiveFile, $archive);
+                foreach (array_keys($exited) as $file) {
+                    @unlink($file);
+                }
+            }
+
+            return self::merge(array_merge([$archive], $live));
+        } finally {
+            flock($lock, LOCK_UN);
+            fclose($lock);
+        }
+    }
+
+    /**
+     * Prometheus text exposition of collect() output
+     *
+     * @param array $metrics ['counters', 'histograms']
+     * @return string
+     */
+    public static function render(array $metrics)
+    {
+        $lines = [];
+        $typed = [];
+
+        foreach ($metrics['counters'] as $counter) {
+            $name = self::metricName($counter['name']);
+            if (!isset($typed[$name])) {
+                $lines[] = "# TYPE {$name} counter";
+                $typed[$name] = true;
+            }
+            $lines[] = $name . self::formatLabels($counter['labels']) . ' ' . self::formatValue($counter['value']);
+        }
+
+        foreach ($metrics['histograms'] as $histogram) {
+            $name = self::metricName($histogram['name']);
+            if (!isset($typed[$name])) {
+                $lines[] = "# TYPE {$name} histogram";
+                $typed[$name] = true;
+            }
+
+            $cumulative = 0;
+            foreach (self::BUCKETS as $i => $le) {
+                $cumulative += $histogram['counts'][$i];
+                $lines[] = "{$name}_bucket" . self::formatLabels($histogram['labels'] + ['le' => sprintf('%g', $le)]) . " {$cumulative}";
+            }
+            $lines[] = "{$name}_bucket" . self::formatLabels($histogram['labels'] + ['le' => '+Inf']) . " {$histogram['count']}";
+            $lines[] = "{$name}_sum" . self::formatLabels($histogram['labels']) . ' ' . self::formatValue($histogram['sum']);
+            $lines[] = "{$name}_count" . self::formatLabels($histogram['labels']) . " {$histogram['count']}";
+        }
+
+        return empty($lines) ? '' : implode("\n", $lines) . "\n";
+    }
+
+    /**
+     * Sum counters and histograms series by series
+     */
+    private static function merge(array $snapshots)
+    {
+        $counters = [];
+        $histograms = [];
+
+        foreach ($snapshots as $snapshot) {
+            foreach ($snapshot['counters'] ?? [] as $counter) {
+                $labels = (array)$counter['labels'];
+                ksort($labels);
+                $key = $counter['name'] . json_encode($labels);
+                if (!isset($counters[$key])) {
+                    $counters[$key] = ['name' => $counter['name'], 'labels' => $labels, 'value' => 0];
+                }
+                $counters[$key]['value'] += $counter['value'];
+            }
+
+            foreach ($snapshot['histograms'] ?? [] as $histogram) {
+                if (($histogram['buckets'] ?? null) != self::BUCKETS) {
+                    continue;
+                }
+                $labels = (array)$histogram['labels'];
+                ksort($labels);
+                $key = $histogram['name'] . json_encode($labels);
+                if (!isset($histograms[$key])) {
+                    $histograms[$key] = [
+                        'name' => $histogram['name'],
+                        'labels' => $labels,
+                        'counts' => array_fill(0, count(self::BUCKETS) + 1, 0),
+                        'sum' => 0.0,
+                        'count' => 0,
+                        'buckets' => self::BUCKETS
+                    ];
+                }
+                foreach ($histogram['counts'] as $i => $count) {
+                    $histograms[$key]['counts'][$i] += $count;
+                }
+                $histograms[$key]['sum'] += $histogram['sum'];
+                $histograms[$key]['count'] += $histogram['count'];
+            }
+        }
+
+        ksort($counters);
+        ksort($histograms);
+        return ['counters' => array_values($counters), 'histograms' => array_values($histograms)];
+    }
+
+    /**
+     * Start afresh in a forked child, which inherited the parent's totals
+     */
+    private static function claimProcess()
+    {
+        $pid = getmypid();
+        if ($pid === self::$pid) {
+            return;
+        }
+        self::$counters = [];
+        self::$histograms = [];
+        self::$dirty = false;
+        self::$pid = $pid;
+        self::$lastFlush = microtime(true);
+    }
+
+    /**
+     * Mark unflushed changes and flush when the interval has passed
+     */
+    private static function recorded()
+    {
+        self::$dirty = true;
+        if (!self::$shutdownRegistered) {
+            register_shutdown_function([self::class, 'flush']);
+            self::$shutdownRegistered = true;
+            self::$lastFlush = microtime(true);
+        }
+        if (microtime(true) - self::$lastFlush >= self::$flushInterval) {
+            self::flush();
+        }
+    }
+
+    /**
+     * Whether a snapshot belongs to a process on this host that has exited
+     */
+    private static function hasExited(array $snapshot)
+    {
+        $pid = (int)($snapshot['pid'] ?? 0);
+        if ($pid <= 0 || ($snapshot['host'] ?? null) !== gethostname() || $pid === getmypid()) {
+            return false;
+        }
+        if (function_exists('posix_kill')) {
+            return !posix_kill($pid, 0) && posix_get_last_error() === 3; // ESRCH
+        }
+        if (is_dir('/proc/self')) {
+            return !is_dir("/proc/{$pid}");
+        }
+        return false;
+    }
+
+    private static function hostTag()
+    {
+        return preg_replace('/[^A-Za-z0-9_.]/', '_', gethostname());
+    }
+
+    private static function readJson($file)
+    {
+        $data = is_file($file) ? json_decode((string)@file_get_contents($file), true) : null;
+        return is_array($data) ? $data : null;
+    }
+
+    /**
+     * Write atomically; labels are written as JSON objects even when empty
+     */
+    private static function writeJson($file, array $data)
+    {
+        foreach (['counters', 'histograms'] as $type) {
+            foreach ($data[$type] as &$series) {
+                $series['labels'] = (object)$series['labels'];
+            }
+            unset($series);
+        }
+
+        $tmp = $file . '.' . getmypid() . '.tmp';
+        if (@file_put_contents($tmp, json_encode($data)) !== false && !@rename($tmp, $file)) {
+            @unlink($tmp);
+        }
+    }
+
+    private static function metricName($name)
+    {
+        return self::PREFIX . preg_replace('/[^a-zA-Z0-9_:]/', '_', $name);
+    }
+
+    private static function formatLabels(array $labels)
+    {
+        if (empty($labels)) {
+            return '';
+        }
+        $pairs = [];
+        foreach ($labels as $key => $value) {
+            $value = str_replace(['\\', '"', "\n"], ['\\\\', '\\"', '\\n'], (string)$value);
+            $pairs[] = preg_replace('/[^a-zA-Z0-9_]/', '_', $key) . "=\"{$value}\"";
+        }
+        return '{' . implode(',', $pairs) . '}';
+    }
+
+    private static function formatValue($value)
+    {
+        return is_int($value) ? (string)$value : sprintf('%.10g', $value);
+    }
+}
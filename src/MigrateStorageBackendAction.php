@@ -0,0 +1,155 @@
+<?php
+require_once __DIR__ . '/IStockTableManager.php';
+require_once __DIR__ . '/IStockDataAccess.php';
+
+/**
+ * Class MigrateStorageBackendAction
+ * Copies stock data between IStockDataAccess backends (e.g. per-symbol tables to
+ * partitioned tables), symbol by symbol, for every symbol in the registry.
+ *
+ * Copies are upserts, so an interrupted run can simply be repeated.
+ *
+ * @package MicroCapExperiment
+ */
+class MigrateStorageBackendAction
+{
+    /**
+     * Table types both backends store
+     */
+    const TABLE_TYPES = ['historical_prices', 'technical_indicators', 'candlestick_patterns'];
+
+    /**
+     * @var IStockTableManager
+     */
+    private $tableManager;
+
+    /**
+     * @var IStockDataAccess
+     */
+    private $source;
+
+    /**
+     * @var IStockDataAccess
+     */
+    private $target;
+
+    /**
+     * MigrateStorageBackendAction constructor.
+     * @param IStockTableManager $tableManager Symbol registry that drives the migration
+     * @param IStockDataAccess $source
+     * @param IStockDataAccess $target
+     */
+    public function __construct(IStockTableManager $tableManager, IStockDataAccess $source, IStockDataAccess $target)
+    {
+        $this->tableManager = $tableManager;
+        $this->source = $source;
+        $this->target = $target;
+    }
+
+    /**
+     * Migrate all registered symbols, or only $options['symbol'].
+     *
+     * @param array $options ['symbol' => string|null, 'dry_run' => bool, 'batch_size' => int, 'include_inactive' => bool]
+     * @param callable|null $onSymbol Called with each per-symbol result as it completes
+     * @return array ['symbols' => int, 'total_records' => int, 'results' => array[]]
+     */
+    public function execute(array $options = [], callable $onSymbol = null)
+    {
+        $summary = [
+            'symbols' => 0,
+            'total_records' => 0,
+            'results' => []
+        ];
+
+        foreach ($this->getSymbols($options) as $symbol) {
+            $result = $this->migrateSymbol($symbol, $options);
+
+            $summary['symbols']++;
+            $summary['total_records'] += $result['total_records'];
+            $summary['results'][] = $result;
+
+            if ($onSymbol) {
+                $onSymbol($result);
+            }
+        }
+
+        return $summary;
+    }
+
+    /**
+     * Copy one symbol's prices, indicators and patterns.
+     *
+     * @param string $symbol
+     * @param array $options
+     * @return array ['symbol', 'records' => [tableType => count], 'total_records', 'errors']
+     */
+    public function migrateSymbol($symbol, array $options = [])
+    {
+        $dryRun = $options['dry_run'] ?? false;
+        $batchSize = $options['batch_size'] ?? 1000;
+        $result = [
+            'symbol' => $symbol,
+            'records' => [],
+            'total_records' => 0,
+            'errors' => []
+        ];
+
+        try {
+            $data = $this->source->exportSymbolData($symbol, self::TABLE_TYPES);
+        } catch (Exception $e) {
+            $result['errors'][] = "Export failed: " . $e->getMessage();
+            return $result;
+        }
+
+        foreach (self::TABLE_TYPES as $tableType) {
+            $rows = $data[$tableType] ?? [];
+            if (empty($rows)) {
+                $result['records'][$tableType] = 0;
+                continue;
+            }
+
+            try {
+                if ($dryRun) {
+                    $written = count($rows);
+                } else {
+                    switch ($tableType) {
+                        case 'historical_prices':
+                            $written = $this->target->bulkInsertPriceData($symbol, $rows, $batchSize)['rows'];
+                            break;
+                        case 'technical_indicators':
+                            $written = $this->target->bulkInsertTechnicalIndicators($symbol, $rows, $batchSize)['rows'];
+                            break;
+                        case 'candlestick_patterns':
+                            $written = $this->target->bulkInsertCandlestickPatterns($symbol, $rows, $batchSize)['rows'];
+                            break;
+                    }
+                }
+
+                $result['records'][$tableType] = $written;
+                $result['total_records'] += $written;
+
+                if ($written < count($rows)) {
+                    $result['errors'][] = "{$tableType}: wrote {$written} of " . count($rows) . " rows";
+                }
+            } catch (Exception $e) {
+                $result['records'][$tableType] = 0;
+                $result['errors'][] = "{$tableType}: " . $e->getMessage();
+            }
+        }
+
+        return $result;
+    }
+
+    /**
+     * Symbols to migrate, from StockTableManager::getAllSymbols
+     */
+    private function getSymbols(array $options)
+    {
+        if (!empty($options['symbol'])) {
+            return [strtoupper(trim($options['symbol']))];
+        }
+
+        $activeOnly = empty($options['include_inactive']);
+        return array_column($this->tableManager->getAllSymbols($activeOnly), 'symbol');
+    }
+}
@@ -0,0 +1,64 @@
+<?php
+require_once __DIR__ . '/../DatabaseConfig.php';
+require_once __DIR__ . '/../StockTableManager.php';
+require_once __DIR__ . '/StockDataAccessFactory.php';
+require_once __DIR__ . '/MigrateStorageBackendAction.php';
+
+class MigrateStorageBackendCliHandler
+{
+    public function run($argv)
+    {
+        $options = [
+            'symbol' => null,
+            'dry_run' => false,
+            'batch_size' => 1000,
+            'include_inactive' => false,
+            'to' => StockDataAccessFactory::BACKEND_PARTITIONED
+        ];
+        for ($i = 1; $i < count($argv); $i++) {
+            $arg = $argv[$i];
+            if ($arg === '--dry-run') {
+                $options['dry_run'] = true;
+            } elseif ($arg === '--include-inactive') {
+                $options['include_inactive'] = true;
+            } elseif (strpos($arg, '--symbol=') === 0) {
+                $options['symbol'] = strtoupper(substr($arg, 9));
+            } elseif (strpos($arg, '--batch-size=') === 0) {
+                $options['batch_size'] = intval(substr($arg, 13));
+            } elseif (strpos($arg, '--to=') === 0) {
+                $options['to'] = substr($arg, 5);
+            }
+        }
+
+        $from = $options['to'] === StockDataAccessFactory::BACKEND_PARTITIONED
+            ? StockDataAccessFactory::BACKEND_PER_SYMBOL
+            : StockDataAccessFactory::BACKEND_PARTITIONED;
+
+        DatabaseConfig::load();
+        $action = new MigrateStorageBackendAction(
+            new StockTableManager(),
+            StockDataAccessFactory::create($from),
+            StockDataAccessFactory::create($options['to'])
+        );
+
+        echo "Migrating {$from} -> {$options['to']}" . ($options['dry_run'] ? " (dry run)" : "") . "\n";
+        $started = microtime(true);
+
+        $summary = $action->execute($options, function ($result) {
+            echo "{$result['symbol']}: {$result['total_records']} records\n";
+            foreach ($result['errors'] as $err) {
+                echo "  - {$err}\n";
+            }
+        });
+
+        if ($summary['symbols'] === 0) {
+            echo "No symbols found to migrate.\n";
+            return;
+        }
+
+        printf("\nSymbols: %d, records: %d, %.1fs\n", $summary['symbols'], $summary['total_records'], microtime(true) - $started);
+        if ($options['to'] === StockDataAccessFactory::BACKEND_PARTITIONED && !$options['dry_run']) {
+            echo "Set storage.backend: partitioned in db_config.yml to switch readers over.\n";
+        }
+    }
+}
@@ -93,22 +93,24 @@ class MigrateSymbolAction
                         LIMIT {$batchSize} OFFSET {$offset}
                     ");
                     $dataStmt->execute([$symbol]);
-                    $batchCount = 0;
+                    $batchRows = [];
                     while ($row = $dataStmt->fetch(PDO::FETCH_ASSOC)) {
+                        $batchRows[] = $row;
+                    }
+                    if (!empty($batchRows)) {
                         switch ($config['target']) {
                             case 'prices':
-                                $this->dataAccess->insertPriceData($symbol, [$row]);
+                                $this->dataAccess->bulkInsertPriceData($symbol, $batchRows, $batchSize);
                                 break;
                             case 'indicators':
-                                $this->dataAccess->insertTechnicalIndicator($symbol, $row);
+                                $this->dataAccess->bulkInsertTechnicalIndicators($symbol, $batchRows, $batchSize);
                                 break;
                             case 'patterns':
-                                $this->dataAccess->insertCandlestickPattern($symbol, $row);
+                                $this->dataAccess->bulkInsertCandlestickPatterns($symbol, $batchRows, $batchSize);
                                 break;
                         }
-                        $batchCount++;
                     }
-                    $migratedCount += $batchCount;
+                    $migratedCount += count($batchRows);
                     $offset += $batchSize;
                 }
                 $results['total_records'] += $migratedCount;
@@ -0,0 +1,585 @@
+<?php
+require_once __DIR__ . '/IStockDataAccess.php';
+require_once __DIR__ . '/BulkUpsertWriter.php';
+
+/**
+ * Class PartitionedStockDataAccess
+ * IStockDataAccess backend that keeps every symbol in one shared table per data type.
+ *
+ * Instead of five or more InnoDB tables per symbol, bars, indicators and
+ * patterns live in ts_prices, ts_indicators and ts_patterns:
+ * - RANGE COLUMNS(date) partitions, one per year, so old years can be pruned
+ *   or dropped cheaply. ensurePartitions() splits next year out of pmax
+ *   ahead of time, so new years never pile up in the catch-all.
+ * - The primary key leads with symbol, so InnoDB clusters each symbol's rows
+ *   together and single-symbol range reads stay sequential. There is no
+ *   surrogate id, no per-row timestamps and no secondary indexes.
+ * - DOUBLE/FLOAT columns and (optionally) compressed pages
+ * - Cross-symbol reads are one IN (...) query rather than a UNION per symbol
+ *
+ * Only prices, indicators and patterns have shared tables; the other
+ * per-symbol table types stay with DynamicStockDataAccess.
+ *
+ * @package MicroCapExperiment
+ */
+class PartitionedStockDataAccess implements IStockDataAccess
+{
+    /**
+     * Maximum number of symbols in one IN (...) list
+     */
+    const MULTI_SYMBOL_CHUNK_SIZE = 500;
+
+    /**
+     * Table types this backend stores
+     */
+    const TABLE_TYPES = ['historical_prices', 'technical_indicators', 'candlestick_patterns'];
+
+    /**
+     * @var \PDO
+     */
+    private $pdo;
+
+    /**
+     * @var JobLogger|null
+     */
+    private $logger;
+
+    /**
+     * @var int First year with its own partition; earlier dates share the first one
+     */
+    private $partitionStartYear;
+
+    /**
+     * @var bool
+     */
+    private $compressed;
+
+    /**
+     * @var bool
+     */
+    private $tablesEnsured = false;
+
+    /**
+     * Query shapes for getMultiSymbolData / streamMultiSymbolData
+     *
+     * @var array
+     */
+    private $multiSymbolQueries = [
+        'historical_prices' => ['table' => 'ts_prices', 'order' => 'date DESC', 'latest' => false],
+        'technical_indicators' => ['table' => 'ts_indicators', 'order' => 'date DESC, indicator_name', 'latest' => false],
+        'candlestick_patterns' => ['table' => 'ts_patterns', 'order' => 'date DESC', 'latest' => false],
+        'latest_prices' => ['table' => 'ts_prices', 'order' => 'date DESC', 'latest' => true]
+    ];
+
+    /**
+     * PartitionedStockDataAccess constructor.
+     * @param \PDO $pdo
+     * @param JobLogger|null $logger
+     * @param array $options ['partition_start_year' => int, 'compressed' => bool]
+     */
+    public function __construct($pdo, $logger = null, array $options = [])
+    {
+        $this->pdo = $pdo;
+        $this->logger = $logger;
+        $this->partitionStartYear = (int)($options['partition_start_year'] ?? 2000);
+        $this->compressed = (bool)($options['compressed'] ?? true);
+    }
+
+    public function insertPriceData($symbol, $priceData)
+    {
+        $rows = is_array($priceData[0] ?? null) ? $priceData : [$priceData];
+        return $this->bulkInsertPriceData($symbol, $rows)['rows'];
+    }
+
+    public function insertTechnicalIndicator($symbol, $indicatorData)
+    {
+        $rows = is_array($indicatorData[0] ?? null) ? $indicatorData : [$indicatorData];
+        return $this->bulkInsertTechnicalIndicators($symbol, $rows)['rows'];
+    }
+
+    public function insertCandlestickPattern($symbol, $patternData)
+    {
+        $rows = is_array($patternData[0] ?? null) ? $patternData : [$patternData];
+        return $this->bulkInsertCandlestickPatterns($symbol, $rows)['rows'];
+    }
+
+    public function bulkInsertPriceData($symbol, $priceRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
+
+        return $this->writer('ts_prices',
+            ['symbol', 'date', 'open', 'high', 'low', 'close', 'adj_close', 'volume'],
+            [
+                'open = VALUES(open)',
+                'high = VALUES(high)',
+                'low = VALUES(low)',
+                'close = VALUES(close)',
+                'adj_close = VALUES(adj_close)',
+                'volume = VALUES(volume)'
+            ],
+            $chunkSize
+        )->write($this->mapRows($priceRows, function ($data) use ($symbol) {
+            return [
+                $symbol,
+                $data['date'],
+                $data['open'],
+                $data['high'],
+                $data['low'],
+                $data['close'],
+                $data['adj_close'] ?? $data['close'],
+                $data['volume'] ?? 0
+            ];
+        }));
+    }
+
+    public function bulkInsertTechnicalIndicators($symbol, $indicatorRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
+
+        return $this->writer('ts_indicators',
+            ['symbol', 'date', 'indicator_name', 'period', 'timeframe', 'value'],
+            ['value = VALUES(value)'],
+            $chunkSize
+        )->write($this->mapRows($indicatorRows, function ($data) use ($symbol) {
+            return [
+                $symbol,
+                $data['date'],
+                $data['indicator_name'],
+                (int)($data['period'] ?? 0),
+                $data['timeframe'] ?? 'daily',
+                $data['value']
+            ];
+        }));
+    }
+
+    public function bulkInsertCandlestickPatterns($symbol, $patternRows, $chunkSize = null)
+    {
+        $symbol = strtoupper(trim($symbol));
+
+        return $this->writer('ts_patterns',
+            ['symbol', 'date', 'pattern_name', 'timeframe', 'strength', '`signal`'],
+            ['strength = VALUES(strength)', '`signal` = VALUES(`signal`)'],
+            $chunkSize
+        )->write($this->mapRows($patternRows, function ($data) use ($symbol) {
+            return [
+                $symbol,
+                $data['date'],
+                $data['pattern_name'],
+                $data['timeframe'] ?? 'daily',
+                $data['strength'] ?? 50,
+                $data['signal'] ?? 'NEUTRAL'
+            ];
+        }));
+    }
+
+    public function getPriceData($symbol, $startDate = null, $endDate = null, $limit = null)
+    {
+        list($sql, $params) = $this->symbolQuery('ts_prices', $symbol, [], $startDate, $endDate);
+        $sql .= " ORDER BY date DESC";
+
+        if ($limit) {
+            $sql .= " LIMIT " . (int)$limit;
+        }
+
+        return $this->fetchAll($sql, $params);
+    }
+
+    public function getTechnicalIndicators($symbol, $indicatorName = null, $startDate = null, $endDate = null)
+    {
+        $filters = $indicatorName ? ['indicator_name' => $indicatorName] : [];
+        list($sql, $params) = $this->symbolQuery('ts_indicators', $symbol, $filters, $startDate, $endDate);
+
+        return $this->fetchAll($sql . " ORDER BY date DESC, indicator_name", $params);
+    }
+
+    public function getCandlestickPatterns($symbol, $patternName = null, $startDate = null, $endDate = null)
+    {
+        $filters = $patternName ? ['pattern_name' => $patternName] : [];
+        list($sql, $params) = $this->symbolQuery('ts_patterns', $symbol, $filters, $startDate, $endDate);
+
+        return $this->fetchAll($sql . " ORDER BY date DESC", $params);
+    }
+
+    public function getLatestPrice($symbol)
+    {
+        $rows = $this->getPriceData($symbol, null, null, 1);
+        return $rows[0] ?? false;
+    }
+
+    public function getPriceDataForAnalysis($symbol, $days = 200)
+    {
+        $this->ensureTables();
+
+        $sql = "SELECT date, open, high, low, close, volume
+                FROM ts_prices
+                WHERE symbol = ?
+                ORDER BY date DESC
+                LIMIT " . (int)$days;
+
+        // Return in chronological order for calculations
+        return array_reverse($this->fetchAll($sql, [strtoupper(trim($symbol))]));
+    }
+
+    public function getMultiSymbolData($symbols, $dataType = 'historical_prices', $startDate = null, $endDate = null)
+    {
+        if (!isset($this->multiSymbolQueries[$dataType])) {
+            $this->log('warning', "Unknown data type requested: {$dataType}");
+            return [];
+        }
+
+        $empty = $dataType === 'latest_prices' ? null : [];
+        $results = [];
+
+        foreach ($symbols as $symbol) {
+            $results[strtoupper(trim($symbol))] = $empty;
+        }
+
+        foreach ($this->streamMultiSymbolData(array_keys($results), $dataType, $startDate, $endDate) as $symbol => $data) {
+            $results[$symbol] = $data;
+        }
+
+        return $results;
+    }
+
+    /**
+     * Stream cross-symbol data grouped by symbol, one query per chunk of symbols.
+     * Yields symbol => rows (or symbol => row for latest_prices).
+     */
+    public function streamMultiSymbolData($symbols, $dataType = 'historical_prices', $startDate = null, $endDate = null)
+    {
+        if (!isset($this->multiSymbolQueries[$dataType])) {
+            $this->log('warning', "Unknown data type requested: {$dataType}");
+            return;
+        }
+
+        $this->ensureTables();
+        $query = $this->multiSymbolQueries[$dataType];
+        $symbols = array_values(array_unique(array_map(function ($symbol) {
+            return strtoupper(trim($symbol));
+        }, $symbols)));
+
+        foreach (array_chunk($symbols, self::MULTI_SYMBOL_CHUNK_SIZE) as $chunk) {
+            $in = implode(', ', array_fill(0, count($chunk), '?'));
+            $params = $chunk;
+
+            if ($query['latest']) {
+                $sql = "SELECT p.* FROM ts_prices p
+                        JOIN (SELECT symbol, MAX(date) AS date FROM ts_prices WHERE symbol IN ({$in}) GROUP BY symbol) m
+                        ON p.symbol = m.symbol AND p.date = m.date
+                        ORDER BY p.symbol";
+            } else {
+                $sql = "SELECT * FROM {$query['table']} WHERE symbol IN ({$in})";
+                if ($startDate) {
+                    $sql .= " AND date >= ?";
+                    $params[] = $startDate;
+                }
+                if ($endDate) {
+                    $sql .= " AND date <= ?";
+                    $params[] = $endDate;
+                }
+                $sql .= " ORDER BY symbol, {$query['order']}";
+            }
+
+            $stmt = $this->pdo->prepare($sql);
+            $stmt->execute($params);
+
+            $currentSymbol = null;
+            $rows = [];
+
+            while ($row = $stmt->fetch(PDO::FETCH_ASSOC)) {
+                if ($row['symbol'] !== $currentSymbol) {
+                    if ($currentSymbol !== null) {
+                        yield $currentSymbol => $query['latest'] ? $rows[0] : $rows;
+                    }
+                    $currentSymbol = $row['symbol'];
+                    $rows = [];
+                }
+                $rows[] = $row;
+            }
+
+            if ($currentSymbol !== null) {
+                yield $currentSymbol => $query['latest'] ? $rows[0] : $rows;
+            }
+        }
+    }
+
+    public function exportSymbolData($symbol, $tableTypes = null)
+    {
+        $exportData = [];
+
+        foreach ($tableTypes ?? self::TABLE_TYPES as $tableType) {
+            switch ($tableType) {
+                case 'historical_prices':
+                    $exportData[$tableType] = array_reverse($this->getPriceData($symbol));
+                    break;
+                case 'technical_indicators':
+                    $exportData[$tableType] = array_reverse($this->getTechnicalIndicators($symbol));
+                    break;
+                case 'candlestick_patterns':
+                    $exportData[$tableType] = array_reverse($this->getCandlestickPatterns($symbol));
+                    break;
+                default:
+                    $exportData[$tableType] = [];
+            }
+        }
+
+        return $exportData;
+    }
+
+    public function importSymbolData($symbol, $importData)
+    {
+        $results = [];
+
+        foreach ($importData as $tableType => $data) {
+            try {
+                switch ($tableType) {
+                    case 'historical_prices':
+                        $results[$tableType] = $this->bulkInsertPriceData($symbol, $data)['rows'];
+                        break;
+                    case 'technical_indicators':
+                        $results[$tableType] = $this->bulkInsertTechnicalIndicators($symbol, $data)['rows'];
+                        break;
+                    case 'candlestick_patterns':
+                        $results[$tableType] = $this->bulkInsertCandlestickPatterns($symbol, $data)['rows'];
+                        break;
+                    default:
+                        $this->log('warning', "Partitioned storage has no table for {$tableType}; skipped for {$symbol}");
+                        $results[$tableType] = 0;
+                }
+            } catch (Exception $e) {
+                $this->log('error', "Failed to import {$tableType} for {$symbol}: " . $e->getMessage());
+                $results[$tableType] = 0;
+            }
+        }
+
+        return $results;
+    }
+
+    public function cleanupOldData($symbol, $daysToKeep = 365)
+    {
+        $this->ensureTables();
+
+        $symbol = strtoupper(trim($symbol));
+        $cutoffDate = date('Y-m-d', strtotime("-{$daysToKeep} days"));
+        $cleanupResults = [];
+
+        foreach (['historical_prices' => 'ts_prices', 'technical_indicators' => 'ts_indicators', 'candlestick_patterns' => 'ts_patterns'] as $tableType => $table) {
+            try {
+                $stmt = $this->pdo->prepare("DELETE FROM {$table} WHERE symbol = ? AND date < ?");
+                $stmt->execute([$symbol, $cutoffDate]);
+                $cleanupResults[$tableType] = $stmt->rowCount();
+            } catch (Exception $e) {
+                $this->log('error', "Failed to cleanup {$tableType} for {$symbol}: " . $e->getMessage());
+                $cleanupResults[$tableType] = 0;
+            }
+        }
+
+        return $cleanupResults;
+    }
+
+    /**
+     * Create the shared tables on first use.
+     */
+    public function ensureTables()
+    {
+        if ($this->tablesEnsured) {
+            return;
+        }
+
+        $options = "ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci"
+            . ($this->compressed ? " ROW_FORMAT=COMPRESSED KEY_BLOCK_SIZE=8" : "");
+        $partitions = $this->partitionClause();
+
+        $this->pdo->exec("
+            CREATE TABLE IF NOT EXISTS ts_prices (
+                symbol VARCHAR(10) CHARACTER SET ascii NOT NULL,
+                date DATE NOT NULL,
+                open DOUBLE NOT NULL,
+                high DOUBLE NOT NULL,
+                low DOUBLE NOT NULL,
+                close DOUBLE NOT NULL,
+                adj_close DOUBLE,
+                volume BIGINT UNSIGNED,
+                PRIMARY KEY (symbol, date)
+            ) {$options}
+            {$partitions}
+        ");
+
+        $this->pdo->exec("
+            CREATE TABLE IF NOT EXISTS ts_indicators (
+                symbol VARCHAR(10) CHARACTER SET ascii NOT NULL,
+                date DATE NOT NULL,
+                indicator_name VARCHAR(50) CHARACTER SET ascii NOT NULL,
+                period SMALLINT UNSIGNED NOT NULL DEFAULT 0,
+                timeframe VARCHAR(10) CHARACTER SET ascii NOT NULL DEFAULT 'daily',
+                value DOUBLE,
+                PRIMARY KEY (symbol, date, indicator_name, period, timeframe)
+            ) {$options}
+            {$partitions}
+        ");
+
+        $this->pdo->exec("
+            CREATE TABLE IF NOT EXISTS ts_patterns (
+                symbol VARCHAR(10) CHARACTER SET ascii NOT NULL,
+                date DATE NOT NULL,
+                pattern_name VARCHAR(100) CHARACTER SET ascii NOT NULL,
+                timeframe VARCHAR(10) CHARACTER SET ascii NOT NULL DEFAULT 'daily',
+                strength TINYINT UNSIGNED DEFAULT 50,
+                `signal` ENUM('BUY', 'SELL', 'NEUTRAL') DEFAULT 'NEUTRAL',
+                PRIMARY KEY (symbol, date, pattern_name, timeframe)
+            ) {$options}
+            {$partitions}
+        ");
+
+        $this->tablesEnsured = true;
+        $this->ensurePartitions();
+    }
+
+    /**
+     * Split yearly partitions out of pmax through $yearsAhead years from now.
+     *
+     * Tables created in an earlier year only have partitions up to the year
+     * after their creation. pmax is normally empty at this point, so the
+     * REORGANIZE is cheap. Runs from ensureTables(); long-lived processes can
+     * call it from a scheduled job.
+     *
+     * @param int $yearsAhead
+     * @return array Partitions added, by table
+     */
+    public function ensurePartitions($yearsAhead = 1)
+    {
+        $added = [];
+        $lastYear = (int)date('Y') + (int)$yearsAhead;
+
+        try {
+            $stmt = $this->pdo->query("
+                SELECT TABLE_NAME, PARTITION_NAME FROM information_schema.PARTITIONS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME IN ('ts_prices', 'ts_indicators', 'ts_patterns')
+            ");
+            if (!$stmt) {
+                return $added;
+            }
+
+            $partitions = [];
+            foreach ($stmt->fetchAll(PDO::FETCH_ASSOC) as $row) {
+                $partitions[$row['TABLE_NAME']][] = $row['PARTITION_NAME'];
+            }
+
+            foreach ($partitions as $table => $names) {
+                $years = [];
+                foreach ($names as $name) {
+                    if (preg_match('/^p(\d{4})$/', (string)$name, $matches)) {
+                        $years[] = (int)$matches[1];
+                    }
+                }
+                if (!$years || !in_array('pmax', $names, true) || max($years) >= $lastYear) {
+                    continue;
+                }
+
+                $parts = [];
+                for ($year = max($years) + 1; $year <= $lastYear; $year++) {
+                    $parts[] = $this->yearPartition($year);
+                    $added[$table][] = "p{$year}";
+                }
+                $parts[] = "PARTITION pmax VALUES LESS THAN (MAXVALUE)";
+
+                $this->pdo->exec("ALTER TABLE {$table} REORGANIZE PARTITION pmax INTO (" . implode(', ', $parts) . ")");
+                $this->log('info', "Added partitions " . implode(', ', $added[$table]) . " to {$table}");
+            }
+        } catch (Exception $e) {
+            $this->log('error', "Failed to extend partitions: " . $e->getMessage());
+        }
+
+        return $added;
+    }
+
+    /**
+     * Yearly RANGE COLUMNS(date) partitions through next year, plus a catch-all.
+     *
+     * @return string
+     */
+    public function partitionClause()
+    {
+        $parts = [];
+        $lastYear = (int)date('Y') + 1;
+
+        for ($year = $this->partitionStartYear; $year <= $lastYear; $year++) {
+            $parts[] = $this->yearPartition($year);
+        }
+        $parts[] = "PARTITION pmax VALUES LESS THAN (MAXVALUE)";
+
+        return "PARTITION BY RANGE COLUMNS(date) (\n                " . implode(",\n                ", $parts) . "\n            )";
+    }
+
+    private function yearPartition($year)
+    {
+        return sprintf("PARTITION p%d VALUES LESS THAN ('%d-01-01')", $year, $year + 1);
+    }
+
+    /**
+     * Base SELECT for one symbol with optional equality filters and date range
+     */
+    private function symbolQuery($table, $symbol, array $filters, $startDate, $endDate)
+    {
+        $this->ensureTables();
+
+        $sql = "SELECT * FROM {$table} WHERE symbol = ?";
+        $params = [strtoupper(trim($symbol))];
+
+        foreach ($filters as $column => $value) {
+            $sql .= " AND {$column} = ?";
+            $params[] = $value;
+        }
+
+        if ($startDate) {
+            $sql .= " AND date >= ?";
+            $params[] = $startDate;
+        }
+
+        if ($endDate) {
+            $sql .= " AND date <= ?";
+            $params[] = $endDate;
+        }
+
+        return [$sql, $params];
+    }
+
+    private function fetchAll($sql, array $params)
+    {
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute($params);
+
+        return $stmt->fetchAll(PDO::FETCH_ASSOC);
+    }
+
+    private function writer($table, array $columns, array $updates, $chunkSize)
+    {
+        $this->ensureTables();
+
+        return new BulkUpsertWriter(
+            $this->pdo,
+            $table,
+            $columns,
+            $updates,
+            $chunkSize ?? BulkUpsertWriter::DEFAULT_CHUNK_SIZE,
+            $this->logger
+        );
+    }
+
+    /**
+     * Lazily map associative rows to positional values for BulkUpsertWriter
+     */
+    private function mapRows($rows, callable $mapper)
+    {
+        foreach ($rows as $row) {
+            yield $mapper($row);
+        }
+    }
+
+    private function log($level, $message)
+    {
+        if ($this->logger) {
+            $this->logger->$level($message);
+        }
+    }
+}
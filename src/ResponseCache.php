@@ -0,0 +1,292 @@
+<?php
+
+/**
+ * Class ResponseCache
+ * Short-TTL response cache shared by all PHP processes on the host.
+ *
+ * Dashboards poll the same endpoints every few seconds from many tabs;
+ * remember() lets one request compute a payload and every other request
+ * within the TTL reuse it. Only one process recomputes an expired entry
+ * (the others wait briefly for it), so a burst of polls costs one query.
+ *
+ * Uses APCu when it is enabled, otherwise small files under the system
+ * temp directory. Keys live in namespaces that invalidate() retires at once
+ * (e.g. after a write). The file backend sweeps out expired and retired
+ * entries at most once per gc_interval.
+ *
+ * @package MicroCapExperiment
+ */
+class ResponseCache
+{
+    /**
+     * @var string 'apcu' or 'file'
+     */
+    private $backend;
+
+    /**
+     * @var string
+     */
+    private $prefix;
+
+    /**
+     * @var string
+     */
+    private $dir;
+
+    /**
+     * @var float Longest a request waits for another one's recompute
+     */
+    private $lockWait;
+
+    /**
+     * @var int Seconds between file backend sweeps
+     */
+    private $gcInterval;
+
+    /**
+     * @var array
+     */
+    private $stats = ['hits' => 0, 'misses' => 0, 'waits' => 0];
+
+    /**
+     * ResponseCache constructor.
+     * @param array $options ['backend' => 'apcu'|'file', 'prefix' => string, 'dir' => string,
+     *                       'lock_wait' => seconds, 'gc_interval' => seconds]
+     */
+    public function __construct(array $options = [])
+    {
+        $apcu = function_exists('apcu_enabled') && apcu_enabled();
+        $this->backend = $options['backend'] ?? ($apcu ? 'apcu' : 'file');
+        $this->prefix = $options['prefix'] ?? 'wealthsystem';
+        $this->dir = $options['dir'] ?? sys_get_temp_dir() . '/wealthsystem_response_cache';
+        $this->lockWait = (float)($options['lock_wait'] ?? 1.0);
+        $this->gcInterval = (int)($options['gc_interval'] ?? 300);
+
+        if ($this->backend === 'file' && !is_dir($this->dir)) {
+            @mkdir($this->dir, 0775, true);
+        }
+    }
+
+    /**
+     * Cached value for ($namespace, $key), computing it with $producer on a miss
+     *
+     * @param string $namespace
+     * @param string $key
+     * @param int $ttl Seconds
+     * @param callable $producer function () returning a string
+     * @return string
+     */
+    public function remember($namespace, $key, $ttl, callable $producer)
+    {
+        $generation = $this->generation($namespace);
+        $fullKey = $this->prefix . ':' . $namespace . ':' . $generation . ':' . $key;
+
+        $value = $this->fetch($fullKey);
+        if ($value !== null) {
+            $this->stats['hits']++;
+            return $value;
+        }
+
+        $lock = $this->acquireLock($fullKey);
+        if ($lock === null) {
+            // Someone else is computing it: wait for their result
+            $this->stats['waits']++;
+            $deadline = microtime(true) + $this->lockWait;
+            while (microtime(true) < $deadline) {
+                usleep(50000);
+                $value = $this->fetch($fullKey);
+                if ($value !== null) {
+                    $this->stats['hits']++;
+                    return $value;
+                }
+            }
+        }
+
+        $this->stats['misses']++;
+        try {
+            $value = (string)$producer();
+            $this->storeRaw($fullKey, $value, max(1, (int)$ttl), [$namespace, $generation]);
+        } finally {
+            $this->releaseLock($fullKey, $lock);
+        }
+        return $value;
+    }
+
+    /**
+     * Retire every key in a namespace
+     *
+     * @param string $namespace
+     */
+    public function invalidate($namespace)
+    {
+        $generationKey = $this->prefix . ':gen:' . $namespace;
+        $this->storeRaw($generationKey, (string)($this->generation($namespace) + 1), 0);
+    }
+
+    /**
+     * Delete expired entries, entries of retired generations and leftover
+     * temp/lock files (file backend; APCu expires entries itself)
+     *
+     * @return int Files removed
+     */
+    public function collectGarbage()
+    {
+        if ($this->backend !== 'file') {
+            return 0;
+        }
+
+        $removed = 0;
+        $now = microtime(true);
+        $generations = [];
+
+        foreach (glob($this->dir . '/*.cache') ?: [] as $file) {
+            $entry = @unserialize((string)@file_get_contents($file));
+            if (!is_array($entry)) {
+                continue;
+            }
+            $expired = $entry[0] !== 0 && $entry[0] < $now;
+            $retired = false;
+            if (!$expired && isset($entry[2])) {
+                list($namespace, $generation) = $entry[2];
+                if (!isset($generations[$namespace])) {
+                    $generations[$namespace] = $this->generation($namespace);
+                }
+                $retired = $generation < $generations[$namespace];
+            }
+            if (($expired || $retired) && @unlink($file)) {
+                $removed++;
+            }
+        }
+
+        // Left behind by processes that died mid-write or mid-recompute
+        $orphanAge = time() - max(60, (int)ceil($this->lockWait * 5));
+        foreach (array_merge(glob($this->dir . '/*.tmp') ?: [], glob($this->dir . '/*.lock') ?: []) as $file) {
+            if (@filemtime($file) < $orphanAge && @unlink($file)) {
+                $removed++;
+            }
+        }
+
+        return $removed;
+    }
+
+    /**
+     * @return array
+     */
+    public function getStats()
+    {
+        return $this->stats + ['backend' => $this->backend];
+    }
+
+    private function generation($namespace)
+    {
+        $value = $this->fetchRaw($this->prefix . ':gen:' . $namespace);
+        return $value === null ? 0 : (int)$value;
+    }
+
+    private function fetch($fullKey)
+    {
+        return $this->fetchRaw($fullKey);
+    }
+
+    private function fetchRaw($key)
+    {
+        if ($this->backend === 'apcu') {
+            $value = apcu_fetch($key, $found);
+            return $found ? $value : null;
+        }
+
+        $file = $this->filePath($key);
+        $contents = @file_get_contents($file);
+        if ($contents === false) {
+            return null;
+        }
+        $entry = @unserialize($contents);
+        if (!is_array($entry) || ($entry[0] !== 0 && $entry[0] < microtime(true))) {
+            return null;
+        }
+        return $entry[1];
+    }
+
+    /**
+     * @param array|null $owner [namespace, generation] of a cached response
+     */
+    private function storeRaw($key, $value, $ttl, array $owner = null)
+    {
+        if ($this->backend === 'apcu') {
+            apcu_store($key, $value, $ttl);
+            return;
+        }
+
+        // Write then rename so readers never see a partial entry
+        $file = $this->filePath($key);
+        $tmp = $file . '.' . getmypid() . '.tmp';
+        $entry = [$ttl ? microtime(true) + $ttl : 0, $value];
+        if ($owner !== null) {
+            $entry[] = $owner;
+        }
+        if (@file_put_contents($tmp, serialize($entry)) !== false) {
+            @rename($tmp, $file);
+        }
+
+        $this->maybeCollectGarbage();
+    }
+
+    /**
+     * Sweep when no process on the host has done so for gc_interval seconds
+     */
+    private function maybeCollectGarbage()
+    {
+        $stamp = $this->dir . '/gc.stamp';
+        $last = @filemtime($stamp);
+        if ($last !== false && $last > time() - $this->gcInterval) {
+            return;
+        }
+        @touch($stamp);
+        if ($last !== false) {
+            $this->collectGarbage();
+        }
+    }
+
+    /**
+     * @return mixed Lock handle, or null if another process holds it
+     */
+    private function acquireLock($fullKey)
+    {
+        if ($this->backend === 'apcu') {
+            return apcu_add($fullKey . ':lock', 1, max(1, (int)ceil($this->lockWait * 5))) ? true : null;
+        }
+
+        $handle = @fopen($this->filePath($fullKey) . '.lock', 'c');
+        if ($handle === false) {
+            return false; // cannot lock: just compute
+        }
+        if (!flock($handle, LOCK_EX | LOCK_NB)) {
+            fclose($handle);
+            return null;
+        }
+        return $handle;
+    }
+
+    private function releaseLock($fullKey, $lock)
+    {
+        if ($this->backend === 'apcu') {
+            if ($lock === true) {
+                apcu_delete($fullKey . ':lock');
+            }
+            return;
+        }
+
+        if (is_resource($lock)) {
+            // A process that opened the file before the unlink can still lock it;
+            // at worst two processes recompute the same entry
+            @unlink($this->filePath($fullKey) . '.lock');
+            flock($lock, LOCK_UN);
+            fclose($lock);
+        }
+    }
+
+    private function filePath($key)
+    {
+        return $this->dir . '/' . sha1($key) . '.cache';
+    }
+}
@@ -0,0 +1,53 @@
+<?php
+require_once __DIR__ . '/IStockDataAccess.php';
+
+/**
+ * Class StockDataAccessFactory
+ * Builds the IStockDataAccess backend selected by the storage configuration.
+ *
+ * @package MicroCapExperiment
+ */
+class StockDataAccessFactory
+{
+    /**
+     * Five-plus tables per symbol (DynamicStockDataAccess)
+     */
+    const BACKEND_PER_SYMBOL = 'per_symbol';
+
+    /**
+     * Shared date-partitioned tables (PartitionedStockDataAccess)
+     */
+    const BACKEND_PARTITIONED = 'partitioned';
+
+    /**
+     * Create a data access backend.
+     *
+     * @param string|null $backend One of the BACKEND_* constants; null uses storage.backend from the config
+     * @return IStockDataAccess
+     */
+    public static function create($backend = null)
+    {
+        require_once __DIR__ . '/../DatabaseConfig.php';
+
+        $storage = DatabaseConfig::getStorageConfig();
+        $backend = $backend ?? $storage['backend'];
+
+        switch ($backend) {
+            case self::BACKEND_PER_SYMBOL:
+                require_once __DIR__ . '/../DynamicStockDataAccess.php';
+                return new DynamicStockDataAccess();
+
+            case self::BACKEND_PARTITIONED:
+                require_once __DIR__ . '/PartitionedStockDataAccess.php';
+                require_once __DIR__ . '/../JobLogger.php';
+                return new PartitionedStockDataAccess(
+                    DatabaseConfig::getLegacyConnection(),
+                    new JobLogger('logs/stock_data_access.log'),
+                    $storage
+                );
+
+            default:
+                throw new InvalidArgumentException("Unknown storage backend: {$backend}");
+        }
+    }
+}
@@ -0,0 +1,402 @@
+<?php
+
+/**
+ * Class SymbolRegistryCache
+ * Loaded-once, versioned snapshot of stock_symbol_registry.
+ *
+ * Positive lookups are answered from memory. Misses fall through to the
+ * database, so a symbol registered by another process is still found.
+ * Every write to the registry bumps a version number. With the 'apcu' or
+ * 'redis' backend that version (and the snapshot) is shared by all
+ * PHP-FPM/worker processes, so one process's invalidation is seen by the
+ * others. With the default 'memory' backend the snapshot is refreshed
+ * after 'ttl' seconds.
+ *
+ * @package MicroCapExperiment
+ */
+class SymbolRegistryCache
+{
+    /**
+     * Prefix for shared APCu/Redis keys.
+     */
+    public const KEY_PREFIX = 'stock_symbol_registry:';
+
+    /**
+     * @var \PDO
+     */
+    private $pdo;
+
+    /**
+     * @var string memory|apcu|redis
+     */
+    private $backend = 'memory';
+
+    /**
+     * @var \Redis|null
+     */
+    private $redis;
+
+    /**
+     * @var int Seconds before a memory-only snapshot is reloaded
+     */
+    private $ttl;
+
+    /**
+     * @var int Seconds between shared version checks on the redis backend
+     */
+    private $versionCheckInterval;
+
+    /**
+     * @var JobLogger|null
+     */
+    private $logger;
+
+    /**
+     * symbol => ['status' => string, 'tables_created' => bool], or null if not loaded.
+     *
+     * @var array|null
+     */
+    private $entries = null;
+
+    /**
+     * @var int
+     */
+    private $version = 0;
+
+    /**
+     * @var int
+     */
+    private $loadedAt = 0;
+
+    /**
+     * @var int
+     */
+    private $lastVersionCheck = 0;
+
+    /**
+     * SymbolRegistryCache constructor.
+     * @param \PDO $pdo
+     * @param array $config ['backend' => memory|apcu|redis, 'ttl' => int, 'version_check_interval' => int, 'redis' => [...]]
+     * @param JobLogger|null $logger
+     */
+    public function __construct($pdo, array $config = [], $logger = null)
+    {
+        $this->pdo = $pdo;
+        $this->logger = $logger;
+        $this->ttl = (int)($config['ttl'] ?? 300);
+        $this->versionCheckInterval = (int)($config['version_check_interval'] ?? 1);
+
+        $backend = $config['backend'] ?? 'memory';
+
+        if ($backend === 'apcu' && function_exists('apcu_enabled') && apcu_enabled()) {
+            $this->backend = 'apcu';
+        } elseif ($backend === 'redis') {
+            $this->redis = $this->connectRedis($config['redis'] ?? []);
+            if ($this->redis) {
+                $this->backend = 'redis';
+            }
+        }
+    }
+
+    /**
+     * Get the active backend (after any fallback to memory).
+     *
+     * @return string
+     */
+    public function getBackend()
+    {
+        return $this->backend;
+    }
+
+    /**
+     * Check whether tables exist for a symbol.
+     *
+     * @param string $symbol Normalized (upper-case) symbol
+     * @return bool
+     */
+    public function tablesExist($symbol)
+    {
+        $this->ensureLoaded();
+
+        if (!empty($this->entries[$symbol]['tables_created'])) {
+            return true;
+        }
+
+        // Miss: another process may have registered it since we loaded
+        $sql = "SELECT status, tables_created FROM stock_symbol_registry WHERE symbol = ?";
+        $stmt = $this->pdo->prepare($sql);
+        $stmt->execute([$symbol]);
+        $row = $stmt->fetch(PDO::FETCH_ASSOC);
+
+        if (!$row) {
+            return false;
+        }
+
+        $this->entries[$symbol] = $this->normalizeEntry($row);
+        return $this->entries[$symbol]['tables_created'];
+    }
+
+    /**
+     * Filter a list of normalized symbols down to those with tables.
+     *
+     * @param string[] $symbols
+     * @return string[]
+     */
+    public function getSymbolsWithTables(array $symbols)
+    {
+        $this->ensureLoaded();
+
+        $found = [];
+        $missing = [];
+
+        foreach ($symbols as $symbol) {
+            if (!empty($this->entries[$symbol]['tables_created'])) {
+                $found[] = $symbol;
+            } else {
+                $missing[] = $symbol;
+            }
+        }
+
+        if (!empty($missing)) {
+            $placeholders = implode(',', array_fill(0, count($missing), '?'));
+            $sql = "SELECT symbol, status, tables_created FROM stock_symbol_registry WHERE symbol IN ({$placeholders})";
+            $stmt = $this->pdo->prepare($sql);
+            $stmt->execute($missing);
+
+            while ($row = $stmt->fetch(PDO::FETCH_ASSOC)) {
+                $this->entries[$row['symbol']] = $this->normalizeEntry($row);
+                if ($this->entries[$row['symbol']]['tables_created']) {
+                    $found[] = $row['symbol'];
+                }
+            }
+        }
+
+        return $found;
+    }
+
+    /**
+     * Drop the snapshot here and, for shared backends, in every other process.
+     */
+    public function invalidate()
+    {
+        $this->entries = null;
+
+        switch ($this->backend) {
+            case 'apcu':
+                apcu_add(self::KEY_PREFIX . 'version', 0);
+                $this->version = (int)apcu_inc(self::KEY_PREFIX . 'version');
+                apcu_delete(self::KEY_PREFIX . 'snapshot');
+                break;
+
+            case 'redis':
+                try {
+                    $this->version = (int)$this->redis->incr(self::KEY_PREFIX . 'version');
+                    $this->redis->del(self::KEY_PREFIX . 'snapshot');
+                } catch (Exception $e) {
+                    $this->log('warning', 'Failed to invalidate shared symbol registry cache: ' . $e->getMessage());
+                }
+                break;
+
+            default:
+                $this->version++;
+        }
+    }
+
+    /**
+     * Get the version of the currently loaded snapshot.
+     *
+     * @return int
+     */
+    public function getVersion()
+    {
+        return $this->version;
+    }
+
+    /**
+     * Load the snapshot if missing or stale.
+     */
+    private function ensureLoaded()
+    {
+        if ($this->entries !== null && !$this->isStale()) {
+            return;
+        }
+
+        $sharedVersion = $this->fetchSharedVersion();
+
+        // Another process may already have published this version
+        $snapshot = $this->fetchSharedSnapshot();
+        if ($snapshot !== null && $sharedVersion !== null && $snapshot['version'] === $sharedVersion) {
+            $this->entries = $snapshot['entries'];
+            $this->version = $sharedVersion;
+            $this->loadedAt = time();
+            return;
+        }
+
+        $entries = [];
+        $stmt = $this->pdo->query("SELECT symbol, status, tables_created FROM stock_symbol_registry");
+        while ($row = $stmt->fetch(PDO::FETCH_ASSOC)) {
+            $entries[$row['symbol']] = $this->normalizeEntry($row);
+        }
+
+        $this->entries = $entries;
+        $this->loadedAt = time();
+
+        if ($sharedVersion !== null) {
+            // Tag with the version read *before* loading, so a concurrent
+            // invalidation makes this snapshot stale rather than authoritative
+            $this->version = $sharedVersion;
+            $this->storeSharedSnapshot(['version' => $sharedVersion, 'entries' => $entries]);
+        }
+    }
+
+    /**
+     * Decide whether the loaded snapshot must be reloaded.
+     *
+     * @return bool
+     */
+    private function isStale()
+    {
+        switch ($this->backend) {
+            case 'apcu':
+                return $this->fetchSharedVersion() !== $this->version;
+
+            case 'redis':
+                if (time() - $this->lastVersionCheck < $this->versionCheckInterval) {
+                    return false;
+                }
+                return $this->fetchSharedVersion() !== $this->version;
+
+            default:
+                return $this->ttl > 0 && (time() - $this->loadedAt) >= $this->ttl;
+        }
+    }
+
+    /**
+     * Read the shared registry version, or null for the memory backend.
+     *
+     * @return int|null
+     */
+    private function fetchSharedVersion()
+    {
+        switch ($this->backend) {
+            case 'apcu':
+                $version = apcu_fetch(self::KEY_PREFIX . 'version', $success);
+                return $success ? (int)$version : 0;
+
+            case 'redis':
+                $this->lastVersionCheck = time();
+                try {
+                    return (int)$this->redis->get(self::KEY_PREFIX . 'version');
+                } catch (Exception $e) {
+                    $this->log('warning', 'Failed to read shared symbol registry version: ' . $e->getMessage());
+                    return null;
+                }
+
+            default:
+                return null;
+        }
+    }
+
+    /**
+     * Read the shared snapshot, if any.
+     *
+     * @return array|null
+     */
+    private function fetchSharedSnapshot()
+    {
+        switch ($this->backend) {
+            case 'apcu':
+                $snapshot = apcu_fetch(self::KEY_PREFIX . 'snapshot', $success);
+                return $success ? $snapshot : null;
+
+            case 'redis':
+                try {
+                    $payload = $this->redis->get(self::KEY_PREFIX . 'snapshot');
+                } catch (Exception $e) {
+                    return null;
+                }
+                return $payload ? json_decode($payload, true) : null;
+
+            default:
+                return null;
+        }
+    }
+
+    /**
+     * Publish a snapshot for other processes.
+     *
+     * @param array $snapshot
+     */
+    private function storeSharedSnapshot(array $snapshot)
+    {
+        switch ($this->backend) {
+            case 'apcu':
+                apcu_store(self::KEY_PREFIX . 'snapshot', $snapshot, $this->ttl);
+                break;
+
+            case 'redis':
+                try {
+                    $this->redis->setex(self::KEY_PREFIX . 'snapshot', max(1, $this->ttl), json_encode($snapshot));
+                } catch (Exception $e) {
+                    $this->log('warning', 'Failed to store shared symbol registry snapshot: ' . $e->getMessage());
+                }
+                break;
+        }
+    }
+
+    /**
+     * Connect to Redis, falling back to the memory backend on failure.
+     *
+     * @param array $config
+     * @return \Redis|null
+     */
+    private function connectRedis(array $config)
+    {
+        if (!class_exists('Redis')) {
+            $this->log('warning', 'Redis extension not available, symbol registry cache falls back to memory');
+            return null;
+        }
+
+        try {
+            $redis = new Redis();
+            $redis->connect($config['host'] ?? 'localhost', (int)($config['port'] ?? 6379), (float)($config['timeout'] ?? 1));
+            if (!empty($config['password'])) {
+                $redis->auth($config['password']);
+            }
+            $redis->select((int)($config['database'] ?? 0));
+            return $redis;
+        } catch (Exception $e) {
+            $this->log('warning', 'Redis unavailable, symbol registry cache falls back to memory: ' . $e->getMessage());
+            return null;
+        }
+    }
+
+    /**
+     * Normalize a registry row.
+     *
+     * @param array $row
+     * @return array
+     */
+    private function normalizeEntry(array $row)
+    {
+        $tablesCreated = $row['tables_created'];
+
+        return [
+            'status' => $row['status'] ?? 'ACTIVE',
+            'tables_created' => $tablesCreated === '1' || $tablesCreated === 1 || $tablesCreated === true
+        ];
+    }
+
+    /**
+     * Log through the optional logger.
+     *
+     * @param string $level
+     * @param string $message
+     */
+    private function log($level, $message)
+    {
+        if ($this->logger) {
+            $this->logger->$level($message);
+        }
+    }
+}
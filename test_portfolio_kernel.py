@@ -0,0 +1,94 @@
+"""
+Equivalence tests for portfolio_kernel
+
+RollingRiskState must report what risk_metrics computes over the same
+history, whether it was seeded in one pass or fed one day at a time, and
+with the same NaN handling in both paths.
+
+Run: python -m unittest test_portfolio_kernel
+"""
+
+import unittest
+
+import numpy as np
+
+from portfolio_kernel import RollingRiskState, revalue, risk_metrics
+
+RETURN_KEYS = [
+    'n_days', 'mean_daily', 'std_daily', 'downside_std', 'period_return',
+    'sharpe_period', 'sharpe_annual', 'sortino_period', 'sortino_annual',
+    'beta', 'alpha_annual', 'r2', 'n_obs',
+]
+ALL_KEYS = RETURN_KEYS + ['max_drawdown', 'max_drawdown_index']
+
+
+def build_history(days=80, tickers=4, seed=7):
+    """Three portfolios revalued from a random walk, with missing days."""
+    rng = np.random.default_rng(seed)
+    prices = 50 * np.exp(np.cumsum(rng.normal(0, 0.02, (days, tickers)), axis=0))
+    positions = np.array([
+        [10, 0, 5, 0],
+        [0, 20, 0, 8],
+        [3, 3, 3, 3],
+    ], dtype=float)
+    cash = np.array([500.0, 100.0, 0.0])
+
+    equity = revalue(prices, positions, cash).equity
+    equity[0, :10] = np.nan        # started later
+    equity[1, 50:52] = np.nan      # two unpriced days mid-history
+    market = rng.normal(0.0004, 0.01, days - 1)
+    market[55] = np.nan            # benchmark holiday
+    return equity, market
+
+
+class RevalueTest(unittest.TestCase):
+
+    def test_unpriced_held_position_leaves_equity_missing(self):
+        prices = np.array([[10.0, np.nan], [11.0, 4.0]])
+        rev = revalue(prices, np.array([[2.0, 0.0], [1.0, 5.0]]), np.array([100.0, 0.0]),
+                      cost_basis=np.array([[18.0, 0.0], [9.0, 15.0]]))
+
+        np.testing.assert_allclose(rev.equity, [[120.0, 122.0], [np.nan, 31.0]])
+        np.testing.assert_allclose(rev.pnl, [[2.0, 4.0], [np.nan, 7.0]])
+        np.testing.assert_allclose(rev.exposures[0, 1], [22.0 / 122.0, 0.0])
+
+
+class RollingRiskStateTest(unittest.TestCase):
+
+    def assertMetricsEqual(self, got, want, keys):
+        for key in keys:
+            np.testing.assert_allclose(got[key], want[key], rtol=1e-9, atol=1e-12,
+                                       equal_nan=True, err_msg=key)
+
+    def test_updates_match_risk_metrics_over_the_history_so_far(self):
+        equity, market = build_history()
+        seed = 40
+        state = RollingRiskState.from_history(equity[:, :seed], market[:seed - 1])
+
+        for day in range(seed, equity.shape[1]):
+            got = state.update(equity[:, day], market[day - 1])
+            self.assertMetricsEqual(got, risk_metrics(equity[:, :day + 1], market[:day]), ALL_KEYS)
+
+    def test_seeding_and_updating_agree_across_missing_days(self):
+        equity, market = build_history()
+        seeded = RollingRiskState.from_history(equity, market)
+
+        fed = RollingRiskState.from_history(equity[:, :1])
+        for day in range(1, equity.shape[1]):
+            fed.update(equity[:, day], market[day - 1])
+
+        self.assertMetricsEqual(fed.metrics(), seeded.metrics(), ALL_KEYS)
+
+    def test_window_covers_the_most_recent_returns(self):
+        equity, market = build_history()
+        window, seed = 20, 30
+        state = RollingRiskState.from_history(equity[:, :seed], market[:seed - 1], window=window)
+
+        for day in range(seed, equity.shape[1]):
+            got = state.update(equity[:, day], market[day - 1])
+            want = risk_metrics(equity[:, day - window:day + 1], market[day - window:day])
+            self.assertMetricsEqual(got, want, RETURN_KEYS)
+
+
+if __name__ == '__main__':
+    unittest.main()
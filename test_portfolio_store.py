@@ -0,0 +1,66 @@
+"""
+Tests for portfolio_store
+
+The CSV is the source of truth: the SQLite sidecar must follow it when it
+is deleted, not bring the old history back.
+
+Run: python -m unittest test_portfolio_store
+"""
+
+import tempfile
+import unittest
+from pathlib import Path
+
+import pandas as pd
+
+from portfolio_store import CsvHistoryStore
+
+
+def day_rows(date, ticker, equity):
+    return [
+        {'Date': date, 'Ticker': ticker, 'Shares': 10, 'Total Value': equity - 100.0},
+        {'Date': date, 'Ticker': 'TOTAL', 'Shares': '', 'Total Value': equity},
+    ]
+
+
+class CsvHistoryStoreTest(unittest.TestCase):
+
+    def setUp(self):
+        tmp = tempfile.TemporaryDirectory()
+        self.addCleanup(tmp.cleanup)
+        self.csv_path = Path(tmp.name) / 'portfolio.csv'
+
+    def open_store(self):
+        store = CsvHistoryStore(self.csv_path)
+        self.addCleanup(store.close)
+        return store
+
+    def test_append_after_deleting_the_csv_starts_a_fresh_history(self):
+        store = self.open_store()
+        store.append(day_rows('2025-01-02', 'ABC', 1000.0))
+        store.append(day_rows('2025-01-03', 'ABC', 1010.0))
+
+        self.csv_path.unlink()
+        store.append(day_rows('2025-02-03', 'XYZ', 500.0))
+
+        written = pd.read_csv(self.csv_path)
+        self.assertEqual(list(written['Date']), ['2025-02-03', '2025-02-03'])
+        self.assertEqual(store.row_count(), 2)
+
+        state = store.latest_state()
+        self.assertEqual(state['date'], '2025-02-03')
+        self.assertEqual([p['Ticker'] for p in state['positions']], ['XYZ'])
+        self.assertEqual(state['total']['Total Value'], 500.0)
+
+    def test_reopening_after_deleting_the_csv_is_empty(self):
+        self.open_store().append(day_rows('2025-01-02', 'ABC', 1000.0))
+
+        self.csv_path.unlink()
+        store = self.open_store()
+
+        self.assertEqual(store.row_count(), 0)
+        self.assertIsNone(store.latest_state())
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,103 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/BenchmarkSuite.php';
+
+/**
+ * @covers BenchmarkSuite
+ */
+class BenchmarkSuiteTest extends TestCase
+{
+    private $workDir;
+
+    protected function setUp(): void
+    {
+        $this->workDir = sys_get_temp_dir() . '/benchmark_suite_test_' . uniqid();
+    }
+
+    protected function tearDown(): void
+    {
+        foreach (glob("{$this->workDir}/*") as $file) {
+            unlink($file);
+        }
+        if (is_dir($this->workDir)) {
+            rmdir($this->workDir);
+        }
+    }
+
+    private function writeFixture(array $rows)
+    {
+        $file = "{$this->workDir}/prices.csv";
+        $handle = fopen($file, 'w');
+        fputcsv($handle, ['symbol', 'date', 'open', 'high', 'low', 'close', 'adj_close', 'volume']);
+        foreach ($rows as $row) {
+            fputcsv($handle, $row);
+        }
+        fclose($handle);
+        return $file;
+    }
+
+    private function randomWalk($symbol, $bars)
+    {
+        $rows = [];
+        $close = 50.0;
+        for ($i = 0; $i < $bars; $i++) {
+            $close *= 1 + (mt_rand(-50, 50) / 1000);
+            $rows[] = [$symbol, date('Y-m-d', strtotime("2020-01-01 +{$i} days")), $close, $close * 1.02, $close * 0.98, $close, $close, 100000];
+        }
+        return $rows;
+    }
+
+    public function testLoadPriceFixtureGroupsBySymbolInDateOrder()
+    {
+        $suite = new BenchmarkSuite($this->workDir);
+        $file = $this->writeFixture([
+            ['BENCH001', '2020-01-03', 1, 2, 0.5, 1.5, 1.5, 100],
+            ['BENCH000', '2020-01-02', 1, 2, 0.5, 1.5, 1.5, 100],
+            ['BENCH001', '2020-01-02', 1, 2, 0.5, 1.5, 1.5, 100]
+        ]);
+
+        $fixture = BenchmarkSuite::loadPriceFixture($file);
+
+        $this->assertEquals(['BENCH001', 'BENCH000'], array_keys($fixture));
+        $this->assertEquals(['2020-01-02', '2020-01-03'], array_column($fixture['BENCH001'], 'date'));
+    }
+
+    public function testBenchIndicatorsReportsRates()
+    {
+        $suite = new BenchmarkSuite($this->workDir);
+        $fixture = ['BENCH000' => []];
+        foreach ($this->randomWalk('BENCH000', 80) as $row) {
+            $fixture['BENCH000'][] = array_combine(['symbol', 'date', 'open', 'high', 'low', 'close', 'adj_close', 'volume'], $row);
+        }
+
+        $results = $suite->benchIndicators($fixture, 1);
+
+        foreach (['bars_per_sec', 'values_per_sec', 'symbols_per_sec', 'resume_symbols_per_sec'] as $name) {
+            $this->assertArrayHasKey("indicators.{$name}", $results);
+            $this->assertGreaterThan(0, $results["indicators.{$name}"]['value']);
+            $this->assertTrue($results["indicators.{$name}"]['higher_is_better']);
+        }
+    }
+
+    public function testBenchQueueDrainsDatabaseBackendInline()
+    {
+        $suite = new BenchmarkSuite($this->workDir);
+        $file = "{$this->workDir}/queue.sqlite";
+        BenchmarkSuite::openSqliteQueue($file);
+
+        $pdo = null;
+        $results = $suite->benchQueue('database', function () use ($file, &$pdo) {
+            $pdo = BenchmarkSuite::openSqliteQueue($file);
+            return new DatabaseJobBackend([], null, $pdo);
+        }, 10, 4, ['fork' => false]);
+
+        $this->assertGreaterThan(0, $results['queue.database.w1.jobs_per_sec']['value']);
+        $this->assertFalse($results['queue.database.w1.latency_p95_ms']['higher_is_better']);
+        $this->assertGreaterThanOrEqual(
+            $results['queue.database.w1.latency_p50_ms']['value'],
+            $results['queue.database.w1.latency_max_ms']['value']
+        );
+        $this->assertEquals(0, $pdo->query("SELECT COUNT(*) FROM ta_analysis_jobs")->fetchColumn());
+        $pdo = null;
+    }
+}
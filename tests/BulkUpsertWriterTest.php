@@ -0,0 +1,79 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/BulkUpsertWriter.php';
+
+/**
+ * @covers BulkUpsertWriter
+ */
+class BulkUpsertWriterTest extends TestCase
+{
+    public function testBuildSqlPacksRowsIntoSingleStatement()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $writer = new BulkUpsertWriter($mockPdo, 'ibm_prices', ['symbol', 'date', 'close'], ['close = VALUES(close)']);
+
+        $sql = $writer->buildSql(3);
+
+        $this->assertStringStartsWith('INSERT INTO ibm_prices (symbol, date, close) VALUES (?, ?, ?), (?, ?, ?), (?, ?, ?)', $sql);
+        $this->assertStringEndsWith('ON DUPLICATE KEY UPDATE close = VALUES(close)', $sql);
+    }
+
+    public function testWriteCommitsOnePerChunk()
+    {
+        $mockStatement = $this->createMock(PDOStatement::class);
+        $mockStatement->expects($this->exactly(3))->method('execute')->willReturn(true);
+
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('inTransaction')->willReturn(false);
+        $mockPdo->method('prepare')->willReturn($mockStatement);
+        $mockPdo->expects($this->exactly(3))->method('beginTransaction');
+        $mockPdo->expects($this->exactly(3))->method('commit');
+
+        $writer = new BulkUpsertWriter($mockPdo, 'ibm_prices', ['symbol', 'date', 'close'], [], 2);
+        $rows = [
+            ['IBM', '2024-01-01', 1.0],
+            ['IBM', '2024-01-02', 2.0],
+            ['IBM', '2024-01-03', 3.0],
+            ['IBM', '2024-01-04', 4.0],
+            ['IBM', '2024-01-05', 5.0],
+        ];
+
+        $report = $writer->write($rows);
+
+        $this->assertEquals(5, $report['rows']);
+        $this->assertCount(3, $report['chunks']);
+        $this->assertEquals([2, 2, 1], array_column($report['chunks'], 'rows'));
+        $this->assertEquals(['committed', 'committed', 'committed'], array_column($report['chunks'], 'status'));
+    }
+
+    public function testFailedChunkFallsBackToRowByRow()
+    {
+        $chunkStatement = $this->createMock(PDOStatement::class);
+        $chunkStatement->method('execute')->willThrowException(new PDOException('Data too long'));
+
+        $rowStatement = $this->createMock(PDOStatement::class);
+        $rowStatement->method('execute')->willReturnOnConsecutiveCalls(
+            true,
+            $this->throwException(new PDOException('Data too long'))
+        );
+
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('inTransaction')->willReturnOnConsecutiveCalls(false, true);
+        $mockPdo->method('prepare')->willReturnOnConsecutiveCalls($chunkStatement, $rowStatement);
+        $mockPdo->expects($this->once())->method('rollBack');
+
+        $writer = new BulkUpsertWriter($mockPdo, 'ibm_prices', ['symbol', 'date'], [], 10);
+        $report = $writer->write([['IBM', '2024-01-01'], ['IBM', 'bad-date']]);
+
+        $this->assertEquals(1, $report['rows']);
+        $this->assertEquals('row_fallback', $report['chunks'][0]['status']);
+    }
+
+    public function testChunkSizeIsClampedToPlaceholderLimit()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $writer = new BulkUpsertWriter($mockPdo, 't', ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'], [], 100000);
+
+        $this->assertEquals(intdiv(65535, 8), $writer->getChunkSize());
+    }
+}
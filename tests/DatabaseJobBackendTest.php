@@ -0,0 +1,136 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../DatabaseJobBackend.php';
+
+/**
+ * @covers DatabaseJobBackend
+ */
+class DatabaseJobBackendTest extends TestCase
+{
+    private $pdo;
+
+    protected function setUp(): void
+    {
+        $this->pdo = new PDO('sqlite::memory:');
+        $this->pdo->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+        $this->pdo->exec("
+            CREATE TABLE ta_analysis_jobs (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                job_type VARCHAR(50) DEFAULT 'technical_analysis',
+                status VARCHAR(20) DEFAULT 'pending',
+                priority INT DEFAULT 5,
+                parameters TEXT,
+                worker_id VARCHAR(255) NULL,
+                retry_count INT DEFAULT 0,
+                max_retries INT DEFAULT 3,
+                scheduled_at TIMESTAMP NULL,
+                claimed_at TIMESTAMP NULL,
+                started_at TIMESTAMP NULL,
+                completed_at TIMESTAMP NULL,
+                progress INT DEFAULT 0,
+                result_data TEXT NULL,
+                error_details TEXT NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+        ");
+    }
+
+    private function addJob($jobType, $priority, $status = 'pending')
+    {
+        $stmt = $this->pdo->prepare("INSERT INTO ta_analysis_jobs (job_type, priority, status) VALUES (?, ?, ?)");
+        $stmt->execute([$jobType, $priority, $status]);
+        return (int)$this->pdo->lastInsertId();
+    }
+
+    public function testClaimJobsStampsWorkerAndOrdersByPriority()
+    {
+        $low = $this->addJob('technical_analysis', 1);
+        $high = $this->addJob('technical_analysis', 9);
+        $this->addJob('technical_analysis', 5, 'running');
+
+        $backend = new DatabaseJobBackend([], null, $this->pdo);
+        $jobs = $backend->claimJobs('worker-a', 5);
+
+        $this->assertEquals([$high, $low], array_map('intval', array_column($jobs, 'id')));
+
+        $rows = $this->pdo->query("SELECT worker_id, status, claimed_at FROM ta_analysis_jobs WHERE id IN ({$high}, {$low})")->fetchAll(PDO::FETCH_ASSOC);
+        foreach ($rows as $row) {
+            $this->assertEquals('worker-a', $row['worker_id']);
+            $this->assertEquals('claimed', $row['status']);
+            $this->assertNotNull($row['claimed_at']);
+        }
+    }
+
+    public function testJobsAreNeverClaimedTwice()
+    {
+        for ($i = 0; $i < 5; $i++) {
+            $this->addJob('technical_analysis', 5);
+        }
+
+        $backend = new DatabaseJobBackend([], null, $this->pdo);
+        $first = array_column($backend->claimJobs('worker-a', 3), 'id');
+        $second = array_column($backend->claimJobs('worker-b', 3), 'id');
+
+        $this->assertCount(3, $first);
+        $this->assertCount(2, $second);
+        $this->assertEmpty(array_intersect($first, $second));
+        $this->assertEmpty($backend->claimJobs('worker-c', 3));
+    }
+
+    public function testClaimJobsFiltersByType()
+    {
+        $this->addJob('price_update', 5);
+        $analysis = $this->addJob('technical_analysis', 5);
+
+        $backend = new DatabaseJobBackend([], null, $this->pdo);
+        $jobs = $backend->claimJobs('worker-a', 5, ['technical_analysis']);
+
+        $this->assertCount(1, $jobs);
+        $this->assertEquals($analysis, (int)$jobs[0]['id']);
+    }
+
+    public function testFailJobRequeuesWhileRetriesRemain()
+    {
+        $id = $this->addJob('technical_analysis', 5);
+
+        $backend = new DatabaseJobBackend([], null, $this->pdo);
+        $job = $backend->getNextJob('worker-a', ['technical_analysis']);
+        $this->assertEquals($id, (int)$job['id']);
+
+        $backend->failJob($id, 'worker-a', 'boom');
+
+        $row = $this->pdo->query("SELECT status, retry_count, worker_id FROM ta_analysis_jobs WHERE id = {$id}")->fetch(PDO::FETCH_ASSOC);
+        $this->assertEquals('pending', $row['status']);
+        $this->assertEquals(1, (int)$row['retry_count']);
+        $this->assertNull($row['worker_id']);
+    }
+
+    public function testInitializationMigratesAnOlderJobsTable()
+    {
+        $pdo = new PDO('sqlite::memory:');
+        $pdo->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+        $pdo->exec("
+            CREATE TABLE ta_analysis_jobs (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                status VARCHAR(20) DEFAULT 'pending',
+                parameters TEXT,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+        ");
+
+        new DatabaseJobBackend([], null, $pdo);
+        // Re-running on an up-to-date table is a no-op
+        $backend = new DatabaseJobBackend([], null, $pdo);
+
+        $columns = array_column($pdo->query("PRAGMA table_info(ta_analysis_jobs)")->fetchAll(PDO::FETCH_ASSOC), 'name');
+        $this->assertEmpty(array_diff(array_keys(DatabaseJobBackend::JOB_COLUMNS), $columns));
+
+        $indexes = array_column($pdo->query("PRAGMA index_list(ta_analysis_jobs)")->fetchAll(PDO::FETCH_ASSOC), 'name');
+        $this->assertEmpty(array_diff(array_keys(DatabaseJobBackend::JOB_INDEXES), $indexes));
+
+        $this->assertEquals(1, (int)$pdo->query("SELECT COUNT(*) FROM sqlite_master WHERE name = 'job_workers'")->fetchColumn());
+
+        $pdo->exec("INSERT INTO ta_analysis_jobs (status) VALUES ('pending')");
+        $this->assertCount(1, $backend->claimJobs('worker-a', 5));
+    }
+}
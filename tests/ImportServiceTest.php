@@ -0,0 +1,190 @@
+<?php
+
+use PHPUnit\Framework\TestCase;
+
+require_once __DIR__ . '/../web_ui/ImportService.php';
+
+/**
+ * @covers ImportService
+ */
+class ImportServiceTest extends TestCase
+{
+    private $tempCsvFile;
+    private $transactionDAO;
+    private $portfolioDAO;
+    private $service;
+
+    protected function setUp(): void
+    {
+        $logger = $this->createMock(LoggerInterface::class);
+        $this->transactionDAO = $this->createMock(TransactionDAO::class);
+        $this->portfolioDAO = $this->createMock(ImprovedPortfolioDAO::class);
+
+        $this->service = new ImportService(
+            new CsvParser($logger),
+            $this->createMock(SecureFileUploadHandler::class),
+            $this->transactionDAO,
+            $this->portfolioDAO,
+            new CsvFileValidator(['symbol', 'shares', 'price', 'txn_date'], $logger),
+            new TransactionDataValidator($logger),
+            $logger
+        );
+
+        $this->tempCsvFile = tempnam(sys_get_temp_dir(), 'import_test_');
+    }
+
+    protected function tearDown(): void
+    {
+        if (file_exists($this->tempCsvFile)) {
+            unlink($this->tempCsvFile);
+        }
+    }
+
+    private function writeCsv(array $lines)
+    {
+        file_put_contents($this->tempCsvFile, "symbol,shares,price,txn_date,type\n" . implode("\n", $lines) . "\n");
+    }
+
+    /**
+     * Stand-in for insertTransactions that runs the in-transaction callback
+     */
+    private function insertsRows(callable $onInsert = null)
+    {
+        return function ($rows, $inTransaction = null) use ($onInsert) {
+            if ($onInsert) {
+                $onInsert($rows);
+            }
+            if ($inTransaction) {
+                $inTransaction();
+            }
+            return count($rows);
+        };
+    }
+
+    public function testRowsAreWrittenInChunks()
+    {
+        $this->writeCsv([
+            'AAPL,10,100,2024-01-02,BUY',
+            'AAPL,5,110,2024-01-03,BUY',
+            'MSFT,1,300,2024-01-03,BUY',
+            'MSFT,-1,300,2024-01-04,BUY',
+            'IBM,2,150,2024-01-05,BUY',
+            'IBM,1,160,2024-01-06,SELL'
+        ]);
+
+        $chunkSizes = [];
+        $this->transactionDAO->method('insertTransactions')->willReturnCallback($this->insertsRows(function ($rows) use (&$chunkSizes) {
+            $chunkSizes[] = count($rows);
+        }));
+
+        $this->service->setChunkSize(2);
+        $result = $this->service->importTransactionsFromFile($this->tempCsvFile);
+
+        $this->assertTrue($result->isSuccess());
+        $this->assertEquals(5, $result->getProcessedCount());
+        $this->assertEquals([2, 2, 1], $chunkSizes);
+        $this->assertStringStartsWith('Row 5:', $result->getErrors()[0]);
+    }
+
+    public function testPositionIsWrittenOncePerTicker()
+    {
+        $this->writeCsv([
+            'AAPL,10,100,2024-01-02,BUY',
+            'AAPL,10,200,2024-01-03,BUY',
+            'AAPL,5,150,2024-01-04,SELL'
+        ]);
+
+        $this->transactionDAO->method('insertTransactions')->willReturnCallback($this->insertsRows());
+        $this->portfolioDAO->expects($this->once())->method('getPortfolioBySymbol')->with('AAPL')->willReturn(false);
+        $this->portfolioDAO->expects($this->once())->method('updatePortfolioPosition')->with('AAPL', 15, 150, 150);
+
+        $this->service->setChunkSize(1);
+        $this->service->importTransactionsFromFile($this->tempCsvFile);
+    }
+
+    public function testFailedChunkDoesNotMovePositions()
+    {
+        $this->writeCsv([
+            'AAPL,10,100,2024-01-02,BUY',
+            'IBM,2,150,2024-01-05,BUY'
+        ]);
+
+        $this->transactionDAO->method('insertTransactions')->willReturnCallback($this->insertsRows(function ($rows) {
+            if ($rows[0]['symbol'] === 'AAPL') {
+                throw new RuntimeException('Deadlock');
+            }
+        }));
+        $this->portfolioDAO->method('getPortfolioBySymbol')->willReturn(false);
+        $this->portfolioDAO->expects($this->once())->method('updatePortfolioPosition')->with('IBM', 2, 150, 150);
+
+        $this->service->setChunkSize(1);
+        $result = $this->service->importTransactionsFromFile($this->tempCsvFile);
+
+        $this->assertEquals(1, $result->getProcessedCount());
+        $this->assertStringContainsString('Deadlock', $result->getErrors()[0]);
+    }
+
+    public function testPositionsCommitWithTheFinalChunk()
+    {
+        $this->writeCsv([
+            'AAPL,10,100,2024-01-02,BUY',
+            'IBM,2,150,2024-01-05,BUY'
+        ]);
+
+        $events = [];
+        $this->transactionDAO->method('insertTransactions')->willReturnCallback(function ($rows, $inTransaction = null) use (&$events) {
+            $events[] = 'begin ' . $rows[0]['symbol'];
+            if ($inTransaction) {
+                $inTransaction();
+            }
+            $events[] = 'commit ' . $rows[0]['symbol'];
+            return count($rows);
+        });
+        $this->portfolioDAO->method('getPortfolioBySymbol')->willReturn(false);
+        $this->portfolioDAO->method('updatePortfolioPosition')->willReturnCallback(function ($symbol) use (&$events) {
+            $events[] = "position {$symbol}";
+        });
+
+        $this->service->setChunkSize(1);
+        $this->service->importTransactionsFromFile($this->tempCsvFile);
+
+        $this->assertEquals(['begin AAPL', 'commit AAPL', 'begin IBM', 'position AAPL', 'position IBM', 'commit IBM'], $events);
+    }
+
+    public function testFailedFinalChunkStillWritesEarlierPositions()
+    {
+        $this->writeCsv([
+            'AAPL,10,100,2024-01-02,BUY',
+            'IBM,2,150,2024-01-05,BUY'
+        ]);
+
+        $this->transactionDAO->method('insertTransactions')->willReturnCallback($this->insertsRows(function ($rows) {
+            if ($rows[0]['symbol'] === 'IBM') {
+                throw new RuntimeException('Deadlock');
+            }
+        }));
+        $this->portfolioDAO->method('getPortfolioBySymbol')->willReturn(false);
+        $this->portfolioDAO->expects($this->once())->method('updatePortfolioPosition')->with('AAPL', 10, 100, 100);
+
+        $this->service->setChunkSize(1);
+        $result = $this->service->importTransactionsFromFile($this->tempCsvFile);
+
+        $this->assertEquals(1, $result->getProcessedCount());
+    }
+
+    public function testBatchInsertValidatesEveryRow()
+    {
+        $logger = $this->createMock(LoggerInterface::class);
+        $db = $this->createMock(DatabaseConnectionInterface::class);
+        $db->expects($this->never())->method('getConnection');
+
+        $dao = new TransactionDAO($db, $logger, new TransactionDataValidator($logger));
+
+        $this->expectException(InvalidArgumentException::class);
+        $this->expectExceptionMessage('row 1');
+        $dao->insertTransactions([
+            ['symbol' => 'AAPL', 'shares' => 10, 'price' => 100, 'txn_date' => '2024-01-02', 'txn_type' => 'BUY'],
+            ['symbol' => 'IBM', 'shares' => 2, 'price' => -5, 'txn_date' => '2024-01-05', 'txn_type' => 'BUY']
+        ]);
+    }
+}
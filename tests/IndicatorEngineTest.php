@@ -0,0 +1,143 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/IndicatorEngine.php';
+require_once __DIR__ . '/../src/IncrementalIndicatorEngine.php';
+
+/**
+ * @covers IndicatorEngine
+ * @covers IncrementalIndicatorEngine
+ */
+class IndicatorEngineTest extends TestCase
+{
+    /**
+     * Deterministic synthetic OHLC bars.
+     */
+    private function makeBars($count)
+    {
+        $bars = [];
+        $date = strtotime('2024-01-01');
+        for ($i = 0; $i < $count; $i++) {
+            $close = 100 + 10 * sin($i / 7) + $i * 0.1;
+            $bars[] = [
+                'date' => date('Y-m-d', $date + $i * 86400),
+                'open' => $close - 0.5,
+                'high' => $close + 1 + ($i % 3) * 0.25,
+                'low' => $close - 1 - ($i % 5) * 0.2,
+                'close' => $close,
+                'volume' => 1000 + $i
+            ];
+        }
+        return $bars;
+    }
+
+    public function testSma()
+    {
+        $this->assertEquals([null, null, 2.0, 3.0, 4.0], IndicatorEngine::sma([1, 2, 3, 4, 5], 3));
+    }
+
+    public function testEmaIsSeededWithSma()
+    {
+        $this->assertEquals([null, null, 2.0, 3.0, 4.0], IndicatorEngine::ema([1, 2, 3, 4, 5], 3));
+    }
+
+    public function testRsiOfRisingSeriesIs100()
+    {
+        $rsi = IndicatorEngine::rsi(range(1, 20), 14);
+
+        $this->assertNull($rsi[13]);
+        $this->assertEquals(100.0, $rsi[14]);
+        $this->assertEquals(100.0, $rsi[19]);
+    }
+
+    public function testBollingerOfConstantSeriesCollapses()
+    {
+        $bands = IndicatorEngine::bollinger(array_fill(0, 25, 10.0), 20, 2.0);
+
+        $this->assertNull($bands['middle'][18]);
+        $this->assertEqualsWithDelta(10.0, $bands['upper'][24], 1e-9);
+        $this->assertEqualsWithDelta(10.0, $bands['lower'][24], 1e-9);
+    }
+
+    public function testAtrOfConstantRange()
+    {
+        $n = 20;
+        $atr = IndicatorEngine::atr(array_fill(0, $n, 2.0), array_fill(0, $n, 1.0), array_fill(0, $n, 1.5), 14);
+
+        $this->assertNull($atr[12]);
+        $this->assertEqualsWithDelta(1.0, $atr[13], 1e-9);
+        $this->assertEqualsWithDelta(1.0, $atr[19], 1e-9);
+    }
+
+    public function testIncrementalMatchesBatch()
+    {
+        $bars = $this->makeBars(120);
+        $columns = IndicatorEngine::columns($bars);
+
+        $expected = [
+            'SMA_20' => IndicatorEngine::sma($columns['close'], 20),
+            'EMA_12' => IndicatorEngine::ema($columns['close'], 12),
+            'RSI' => IndicatorEngine::rsi($columns['close'], 14),
+            'MACD' => IndicatorEngine::macd($columns['close'])['macd'],
+            'MACD_SIGNAL' => IndicatorEngine::macd($columns['close'])['signal'],
+            'BB_UPPER' => IndicatorEngine::bollinger($columns['close'])['upper'],
+            'ATR' => IndicatorEngine::atr($columns['high'], $columns['low'], $columns['close'])
+        ];
+
+        $engine = new IncrementalIndicatorEngine();
+        $results = $engine->appendAll($bars);
+
+        foreach ($expected as $name => $series) {
+            foreach ($series as $i => $value) {
+                if ($value === null) {
+                    $this->assertNull($results[$i][$name], "{$name}[{$i}] should be warming up");
+                } else {
+                    $this->assertEqualsWithDelta($value, $results[$i][$name], 1e-9, "{$name}[{$i}]");
+                }
+            }
+        }
+    }
+
+    public function testResumeFromPersistedState()
+    {
+        $bars = $this->makeBars(100);
+
+        $continuous = new IncrementalIndicatorEngine();
+        $all = $continuous->appendAll($bars);
+
+        $first = new IncrementalIndicatorEngine();
+        $first->appendAll(array_slice($bars, 0, 80));
+        $state = json_decode(json_encode($first->getState()), true);
+
+        $resumed = new IncrementalIndicatorEngine($state);
+        $this->assertEquals($bars[79]['date'], $resumed->getLastDate());
+
+        // Overlapping bars are skipped, only the 20 new ones are computed
+        $tail = $resumed->appendAll(array_slice($bars, 70));
+        $this->assertCount(20, $tail);
+
+        foreach ($resumed->getIndicatorNames() as $name) {
+            $this->assertEqualsWithDelta($all[99][$name], $tail[19][$name], 1e-9, $name);
+        }
+    }
+
+    public function testStateIsDiscardedWhenConfigChanges()
+    {
+        $engine = new IncrementalIndicatorEngine();
+        $engine->appendAll($this->makeBars(30));
+
+        $reconfigured = new IncrementalIndicatorEngine($engine->getState(), ['rsi' => 7]);
+
+        $this->assertNull($reconfigured->getLastDate());
+        $this->assertEquals(0, $reconfigured->getBarCount());
+    }
+
+    public function testAppendRejectsOutOfOrderBars()
+    {
+        $bars = $this->makeBars(2);
+        $engine = new IncrementalIndicatorEngine();
+        $engine->append($bars[1]);
+
+        $this->expectException(InvalidArgumentException::class);
+        $engine->append($bars[0]);
+    }
+}
@@ -0,0 +1,74 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../JobLogger.php';
+
+/**
+ * @covers JobLogger
+ */
+class JobLoggerTest extends TestCase
+{
+    private $logFile;
+
+    protected function setUp(): void
+    {
+        $this->logFile = tempnam(sys_get_temp_dir(), 'job_logger_test_');
+        unlink($this->logFile);
+    }
+
+    protected function tearDown(): void
+    {
+        if (file_exists($this->logFile)) {
+            unlink($this->logFile);
+        }
+    }
+
+    private function writtenLines()
+    {
+        clearstatcache();
+        return file_exists($this->logFile) ? file($this->logFile, FILE_IGNORE_NEW_LINES) : [];
+    }
+
+    public function testEntriesAreBufferedUntilBufferIsFull()
+    {
+        $logger = new JobLogger($this->logFile, ['buffer_size' => 3, 'flush_interval' => 60]);
+
+        $logger->info('one');
+        $logger->info('two');
+        $this->assertCount(0, $this->writtenLines());
+
+        $logger->info('three');
+        $this->assertCount(3, $this->writtenLines());
+    }
+
+    public function testErrorFlushesImmediately()
+    {
+        $logger = new JobLogger($this->logFile, ['buffer_size' => 100, 'flush_interval' => 60]);
+
+        $logger->info('starting');
+        $logger->error('failed');
+
+        $lines = $this->writtenLines();
+        $this->assertCount(2, $lines);
+        $this->assertStringContainsString('[ERROR]', $lines[1]);
+    }
+
+    public function testFlushAndRecentEntriesIncludeBufferedLines()
+    {
+        $logger = new JobLogger($this->logFile, ['buffer_size' => 100, 'flush_interval' => 60]);
+
+        $logger->info('buffered');
+        $this->assertStringContainsString('buffered', $logger->getRecentEntries(10)[0]);
+
+        $logger->warning('second');
+        $logger->flush();
+        $this->assertCount(2, $this->writtenLines());
+    }
+
+    public function testBufferSizeOneWritesThrough()
+    {
+        $logger = new JobLogger($this->logFile, ['buffer_size' => 1]);
+
+        $logger->debug('direct');
+        $this->assertCount(1, $this->writtenLines());
+    }
+}
@@ -0,0 +1,130 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../JobProcessors.php';
+require_once __DIR__ . '/../src/JobProgressOverlay.php';
+
+/**
+ * In-memory stand-in for the Redis/MQTT progress channel
+ */
+class FakeProgressChannel
+{
+    public $progress = [];
+
+    public function publishProgress($jobId, $progress, $message = null)
+    {
+        $this->progress[(string)$jobId] = [
+            'progress' => (float)$progress,
+            'status_message' => $message,
+            'progress_at' => time()
+        ];
+        return true;
+    }
+
+    public function clearProgress($jobId)
+    {
+        unset($this->progress[(string)$jobId]);
+        return true;
+    }
+
+    public function getProgress(array $jobIds)
+    {
+        return array_intersect_key($this->progress, array_flip(array_map('strval', $jobIds)));
+    }
+}
+
+/**
+ * @covers JobProgressOverlay
+ * @covers AbstractJobProcessor
+ */
+class JobProgressOverlayTest extends TestCase
+{
+    private $pdo;
+    private $channel;
+    private $processor;
+
+    protected function setUp(): void
+    {
+        $this->pdo = new PDO('sqlite::memory:', null, null, [PDO::ATTR_ERRMODE => PDO::ERRMODE_EXCEPTION]);
+        $this->pdo->exec("
+            CREATE TABLE ta_analysis_jobs (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                job_type VARCHAR(50),
+                status VARCHAR(20) DEFAULT 'pending',
+                priority INT DEFAULT 5,
+                parameters TEXT,
+                worker_id VARCHAR(255) NULL,
+                progress INT DEFAULT 0,
+                status_message TEXT NULL,
+                started_at TIMESTAMP NULL,
+                completed_at TIMESTAMP NULL,
+                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )
+        ");
+
+        // The processor's constructor connects to the configured database
+        $this->processor = (new ReflectionClass('PriceUpdateJobProcessor'))->newInstanceWithoutConstructor();
+        $pdo = new ReflectionProperty('AbstractJobProcessor', 'pdo');
+        $pdo->setAccessible(true);
+        $pdo->setValue($this->processor, $this->pdo);
+
+        $this->channel = new FakeProgressChannel();
+        $this->processor->setJobBackend($this->channel, ['min_interval_ms' => 0, 'min_delta' => 0]);
+    }
+
+    private function fetchJobs()
+    {
+        return $this->pdo->query("SELECT id, status, progress, status_message FROM ta_analysis_jobs")->fetchAll(PDO::FETCH_ASSOC);
+    }
+
+    public function testBrokerJobProgressIsReadBackThroughItsTrackingRow()
+    {
+        $rowId = AbstractJobProcessor::createTrackingRow($this->pdo, 'price_update', 'high', []);
+        $job = ['id' => 'job_5f1e2d3c4b5a6.12345678', 'job_type' => 'price_update', 'tracking_id' => $rowId];
+
+        $this->processor->trackStatus($job, 'running', 'worker-1');
+        $this->processor->publishProgress(AbstractJobProcessor::progressJobId($job), 40, 'Updating prices', false);
+
+        $jobs = JobProgressOverlay::apply($this->fetchJobs(), $this->channel);
+
+        $this->assertEquals($rowId, $jobs[0]['id']);
+        $this->assertEquals('running', $jobs[0]['status']);
+        $this->assertEquals(40, $jobs[0]['progress']);
+        $this->assertEquals('Updating prices', $jobs[0]['status_message']);
+        $this->assertArrayNotHasKey($job['id'], $this->channel->progress);
+    }
+
+    public function testFinalProgressAndCompletionReachTheTrackingRow()
+    {
+        $rowId = AbstractJobProcessor::createTrackingRow($this->pdo, 'price_update', 'normal', []);
+        $job = ['id' => 'job_abc', 'job_type' => 'price_update', 'tracking_id' => $rowId];
+
+        $this->processor->trackStatus($job, 'running', 'worker-1');
+        $this->processor->publishProgress(AbstractJobProcessor::progressJobId($job), 100, 'Price update completed', true);
+        $this->processor->trackStatus($job, 'completed');
+
+        $row = $this->fetchJobs()[0];
+        $this->assertEquals('completed', $row['status']);
+        $this->assertEquals(100, $row['progress']);
+        $this->assertEquals('Price update completed', $row['status_message']);
+    }
+
+    public function testFlushAtJobEndClearsTheLiveCopy()
+    {
+        $rowId = AbstractJobProcessor::createTrackingRow($this->pdo, 'price_update', 'normal', []);
+        $job = ['id' => 'job_abc', 'job_type' => 'price_update', 'tracking_id' => $rowId];
+
+        $this->processor->publishProgress($rowId, 60, 'Updating prices', false);
+        $this->processor->flushProgress($job);
+
+        $this->assertEmpty($this->channel->getProgress([$rowId]));
+    }
+
+    public function testDatabaseJobsUseTheirOwnId()
+    {
+        $this->assertEquals(12, AbstractJobProcessor::progressJobId(['id' => 12]));
+
+        // Nothing to mirror: the database backend updates its own rows
+        $this->processor->trackStatus(['id' => 12], 'running', 'worker-1');
+        $this->assertEmpty($this->fetchJobs());
+    }
+}
@@ -0,0 +1,77 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/JobProgressReporter.php';
+
+/**
+ * @covers JobProgressReporter
+ */
+class JobProgressReporterTest extends TestCase
+{
+    private $published;
+
+    protected function setUp(): void
+    {
+        $this->published = [];
+    }
+
+    private function createReporter(array $options)
+    {
+        return new JobProgressReporter(function ($jobId, $progress, $message, $final) {
+            $this->published[] = [$jobId, $progress, $message, $final];
+        }, $options);
+    }
+
+    public function testSmallStepsWithinIntervalAreCoalesced()
+    {
+        $reporter = $this->createReporter(['min_interval_ms' => 60000, 'min_delta' => 5]);
+
+        $reporter->report(7, 1, 'Processed 1/100 stocks');
+        $reporter->report(7, 2, 'Processed 2/100 stocks');
+        $reporter->report(7, 3, 'Processed 3/100 stocks');
+        $reporter->report(7, 6, 'Processed 6/100 stocks');
+
+        $this->assertEquals([
+            [7, 1, 'Processed 1/100 stocks', false],
+            [7, 6, 'Processed 6/100 stocks', false]
+        ], $this->published);
+        $this->assertEquals(['reported' => 4, 'flushes' => 2], $reporter->getStats());
+    }
+
+    public function testCompletionAlwaysPublishesAsFinal()
+    {
+        $reporter = $this->createReporter(['min_interval_ms' => 60000, 'min_delta' => 50]);
+
+        $reporter->report(7, 10);
+        $reporter->report(7, 100, 'Analysis completed');
+
+        $this->assertEquals([7, 100, 'Analysis completed', true], end($this->published));
+    }
+
+    public function testFlushPublishesPendingStateAndKeepsLastMessage()
+    {
+        $reporter = $this->createReporter(['min_interval_ms' => 60000, 'min_delta' => 50]);
+
+        $reporter->report(7, 10, 'Loading prices');
+        $reporter->report(7, 20);
+        $reporter->report(8, 5, 'Starting');
+        $reporter->report(8, 7);
+        $reporter->flush();
+
+        $this->assertContains([7, 20, 'Loading prices', true], $this->published);
+        $this->assertContains([8, 7, 'Starting', true], $this->published);
+
+        $count = count($this->published);
+        $reporter->flush();
+        $this->assertCount($count, $this->published);
+    }
+
+    public function testZeroIntervalPublishesEveryUpdate()
+    {
+        $reporter = $this->createReporter(['min_interval_ms' => 0, 'min_delta' => 100]);
+
+        $reporter->report(7, 1);
+        $reporter->report(7, 2);
+
+        $this->assertCount(2, $this->published);
+    }
+}
@@ -0,0 +1,123 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/JobShardCoordinator.php';
+
+/**
+ * @covers JobShardCoordinator
+ */
+class JobShardCoordinatorTest extends TestCase
+{
+    public function testCreateShardsChunksItems()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->method('prepare')->willReturn($stmt);
+        $pdo->method('lastInsertId')->willReturnOnConsecutiveCalls('1', '2', '3');
+
+        $executed = [];
+        $stmt->method('execute')->willReturnCallback(function ($params) use (&$executed) {
+            $executed[] = $params;
+            return true;
+        });
+
+        $coordinator = new JobShardCoordinator($pdo);
+        $ids = $coordinator->createShards('job-1', [10, 11, 12, 13, 14], 2);
+
+        $this->assertEquals([1, 2, 3], $ids);
+        $this->assertEquals(['job-1', 0, '[10,11]'], $executed[0]);
+        $this->assertEquals(['job-1', 2, '[14]'], $executed[2]);
+    }
+
+    public function testClaimShardReturnsNullWhenAlreadyClaimed()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->method('prepare')->willReturn($stmt);
+        $stmt->method('execute')->willReturn(true);
+        $stmt->method('rowCount')->willReturn(0);
+
+        $coordinator = new JobShardCoordinator($pdo);
+
+        $this->assertNull($coordinator->claimShard(7, 'worker-a'));
+    }
+
+    public function testClaimShardDecodesItems()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->method('prepare')->willReturn($stmt);
+        $stmt->method('execute')->willReturn(true);
+        $stmt->method('rowCount')->willReturn(1);
+        $stmt->method('fetch')->willReturn(['id' => 7, 'status' => 'running', 'items' => '[1,2,3]']);
+
+        $coordinator = new JobShardCoordinator($pdo);
+        $shard = $coordinator->claimShard(7, 'worker-a');
+
+        $this->assertEquals([1, 2, 3], $shard['items']);
+    }
+
+    public function testWritesFromALostClaimAreRejected()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->method('prepare')->willReturn($stmt);
+        $stmt->method('rowCount')->willReturn(0);
+
+        $executed = [];
+        $stmt->method('execute')->willReturnCallback(function ($params) use (&$executed) {
+            $executed[] = $params;
+            return true;
+        });
+
+        $coordinator = new JobShardCoordinator($pdo);
+
+        $this->assertFalse($coordinator->updateShardProgress(7, 'worker-a', 50));
+        $this->assertFalse($coordinator->completeShard(7, 'worker-a', ['processed_stocks' => 5]));
+        $this->assertFalse($coordinator->failShard(7, 'worker-a', 'boom'));
+        $this->assertEquals([50, 7, 'worker-a'], $executed[0]);
+        $this->assertEquals(['{"processed_stocks":5}', 7, 'worker-a'], $executed[1]);
+        $this->assertEquals(['boom', 7, 'worker-a'], $executed[2]);
+    }
+
+    public function testProgressFromTheClaimantRefreshesTheClaim()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->expects($this->once())->method('prepare')
+            ->with($this->stringContains('claimed_at = CURRENT_TIMESTAMP'))
+            ->willReturn($stmt);
+        $stmt->method('execute')->willReturn(true);
+        $stmt->method('rowCount')->willReturn(1);
+
+        $coordinator = new JobShardCoordinator($pdo);
+
+        $this->assertTrue($coordinator->updateShardProgress(7, 'worker-a', 50));
+    }
+
+    public function testSummaryRollsUpProgressAndResults()
+    {
+        $pdo = $this->createMock(PDO::class);
+        $stmt = $this->createMock(PDOStatement::class);
+        $pdo->method('prepare')->willReturn($stmt);
+        $stmt->method('execute')->willReturn(true);
+        $stmt->method('fetch')->willReturnOnConsecutiveCalls(
+            ['status' => 'completed', 'progress' => 100, 'result' => '{"processed_stocks":50,"indicators_calculated":600}', 'error' => null],
+            ['status' => 'running', 'progress' => 40, 'result' => null, 'error' => null],
+            ['status' => 'failed', 'progress' => 10, 'result' => null, 'error' => 'boom'],
+            ['status' => 'pending', 'progress' => 0, 'result' => null, 'error' => null],
+            false
+        );
+
+        $coordinator = new JobShardCoordinator($pdo);
+        $summary = $coordinator->getSummary('job-1');
+
+        $this->assertEquals(4, $summary['total']);
+        $this->assertEquals(1, $summary['completed']);
+        $this->assertEquals(1, $summary['running']);
+        $this->assertEquals(1, $summary['failed']);
+        $this->assertEquals(1, $summary['pending']);
+        $this->assertEqualsWithDelta(60.0, $summary['progress'], 1e-9);
+        $this->assertEquals(['processed_stocks' => 50, 'indicators_calculated' => 600], $summary['result']);
+        $this->assertEquals(['boom'], $summary['errors']);
+    }
+}
@@ -0,0 +1,123 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/Metrics.php';
+
+/**
+ * @covers Metrics
+ */
+class MetricsTest extends TestCase
+{
+    private $dir;
+
+    protected function setUp(): void
+    {
+        $this->dir = sys_get_temp_dir() . '/metrics_test_' . uniqid();
+        Metrics::configure(['sample_rate' => 1, 'dir' => $this->dir, 'flush_interval' => 3600]);
+        Metrics::reset();
+    }
+
+    protected function tearDown(): void
+    {
+        Metrics::reset();
+        Metrics::configure(['sample_rate' => 0]);
+        foreach (glob("{$this->dir}/{,.}*", GLOB_BRACE) as $file) {
+            if (is_file($file)) {
+                unlink($file);
+            }
+        }
+        if (is_dir($this->dir)) {
+            rmdir($this->dir);
+        }
+    }
+
+    public function testNothingIsRecordedWhenSamplingIsOff()
+    {
+        Metrics::configure(['sample_rate' => 0, 'dir' => $this->dir]);
+
+        $this->assertNull(Metrics::startSpan('worker_execute_job'));
+        Metrics::endSpan(null);
+        Metrics::increment('worker_jobs_total');
+        Metrics::observe('stock_data_query_seconds', 0.2);
+        $this->assertEquals('ok', Metrics::time('stock_data_query', function () {
+            return 'ok';
+        }));
+
+        $snapshot = Metrics::snapshot();
+        $this->assertEmpty($snapshot['counters']);
+        $this->assertEmpty($snapshot['histograms']);
+    }
+
+    public function testSpansCountAndTimeByLabels()
+    {
+        Metrics::endSpan(Metrics::startSpan('worker_execute_job', ['job_type' => 'import']), ['outcome' => 'ok']);
+        Metrics::endSpan(Metrics::startSpan('worker_execute_job', ['job_type' => 'import']), ['outcome' => 'ok']);
+        try {
+            Metrics::time('stock_data_query', function () {
+                throw new RuntimeException('lost connection');
+            }, ['operation' => 'select_prices']);
+            $this->fail('Exception was swallowed');
+        } catch (RuntimeException $e) {
+        }
+
+        $counters = [];
+        foreach (Metrics::snapshot()['counters'] as $counter) {
+            $counters[$counter['name'] . json_encode($counter['labels'])] = $counter['value'];
+        }
+        $this->assertEquals(2, $counters['worker_execute_job_total{"job_type":"import","outcome":"ok"}']);
+        $this->assertEquals(1, $counters['stock_data_query_total{"operation":"select_prices","outcome":"error"}']);
+        $this->assertCount(2, Metrics::snapshot()['histograms']);
+    }
+
+    public function testRenderWritesPrometheusHistogram()
+    {
+        Metrics::observe('stock_data_query_seconds', 0.003, ['operation' => 'select_prices']);
+        Metrics::observe('stock_data_query_seconds', 0.2, ['operation' => 'select_prices']);
+        Metrics::observe('stock_data_query_seconds', 120, ['operation' => 'select_prices']);
+        Metrics::increment('provider_retries_total', ['provider' => "a\"b"]);
+
+        $text = Metrics::render(Metrics::collect());
+
+        $this->assertStringContainsString("# TYPE wealthsystem_provider_retries_total counter\n", $text);
+        $this->assertStringContainsString('wealthsystem_provider_retries_total{provider="a\\"b"} 1', $text);
+        $this->assertStringContainsString("# TYPE wealthsystem_stock_data_query_seconds histogram\n", $text);
+        $this->assertStringContainsString('wealthsystem_stock_data_query_seconds_bucket{operation="select_prices",le="0.001"} 0', $text);
+        $this->assertStringContainsString('wealthsystem_stock_data_query_seconds_bucket{operation="select_prices",le="0.005"} 1', $text);
+        $this->assertStringContainsString('wealthsystem_stock_data_query_seconds_bucket{operation="select_prices",le="60"} 2', $text);
+        $this->assertStringContainsString('wealthsystem_stock_data_query_seconds_bucket{operation="select_prices",le="+Inf"} 3', $text);
+        $this->assertStringContainsString('wealthsystem_stock_data_query_seconds_count{operation="select_prices"} 3', $text);
+    }
+
+    public function testCollectMergesProcessesAndArchivesExitedOnes()
+    {
+        Metrics::increment('worker_jobs_total', ['job_type' => 'import'], 2);
+        mkdir($this->dir, 0775, true);
+
+        // A Python analyzer on this host that has since exited
+        $exited = [
+            'lang' => 'python',
+            'host' => gethostname(),
+            'pid' => 2147483646,
+            'updated_at' => time(),
+            'counters' => [['name' => 'worker_jobs_total', 'labels' => ['job_type' => 'import'], 'value' => 3]],
+            'histograms' => [[
+                'name' => 'analyzer_step_seconds',
+                'labels' => ['step' => 'technical', 'outcome' => 'ok'],
+                'buckets' => Metrics::BUCKETS,
+                'counts' => array_pad([1], count(Metrics::BUCKETS) + 1, 0),
+                'sum' => 0.0005,
+                'count' => 1
+            ]]
+        ];
+        file_put_contents("{$this->dir}/py-test-2147483646.json", json_encode($exited));
+
+        $merged = Metrics::collect();
+
+        $this->assertEquals(5, $merged['counters'][0]['value']);
+        $this->assertEquals(1, $merged['histograms'][0]['count']);
+        $this->assertFalse(file_exists("{$this->dir}/py-test-2147483646.json"));
+        $this->assertFileExists("{$this->dir}/archive.json");
+
+        // Archived totals stay in later scrapes
+        $this->assertEquals(5, Metrics::collect()['counters'][0]['value']);
+    }
+}
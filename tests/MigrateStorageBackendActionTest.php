@@ -0,0 +1,83 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/MigrateStorageBackendAction.php';
+require_once __DIR__ . '/../src/IStockTableManager.php';
+require_once __DIR__ . '/../src/IStockDataAccess.php';
+
+/**
+ * @covers MigrateStorageBackendAction
+ */
+class MigrateStorageBackendActionTest extends TestCase
+{
+    public function testExecuteCopiesEveryRegisteredSymbol()
+    {
+        $mockTableManager = $this->createMock(IStockTableManager::class);
+        $mockTableManager->method('getAllSymbols')->with(true)->willReturn([
+            ['symbol' => 'IBM'],
+            ['symbol' => 'AAPL']
+        ]);
+
+        $mockSource = $this->createMock(IStockDataAccess::class);
+        $mockSource->method('exportSymbolData')->willReturn([
+            'historical_prices' => [['date' => '2024-01-02', 'open' => 1, 'high' => 1, 'low' => 1, 'close' => 1]],
+            'technical_indicators' => [],
+            'candlestick_patterns' => []
+        ]);
+
+        $mockTarget = $this->createMock(IStockDataAccess::class);
+        $mockTarget->expects($this->exactly(2))->method('bulkInsertPriceData')->willReturn(['rows' => 1, 'chunks' => []]);
+        $mockTarget->expects($this->never())->method('bulkInsertTechnicalIndicators');
+
+        $action = new MigrateStorageBackendAction($mockTableManager, $mockSource, $mockTarget);
+        $seen = [];
+        $summary = $action->execute([], function ($result) use (&$seen) {
+            $seen[] = $result['symbol'];
+        });
+
+        $this->assertEquals(2, $summary['symbols']);
+        $this->assertEquals(2, $summary['total_records']);
+        $this->assertEquals(['IBM', 'AAPL'], $seen);
+    }
+
+    public function testDryRunWritesNothing()
+    {
+        $mockTableManager = $this->createMock(IStockTableManager::class);
+        $mockTableManager->expects($this->never())->method('getAllSymbols');
+
+        $mockSource = $this->createMock(IStockDataAccess::class);
+        $mockSource->method('exportSymbolData')->willReturn([
+            'historical_prices' => [['date' => '2024-01-02'], ['date' => '2024-01-03']],
+            'technical_indicators' => [['date' => '2024-01-02']],
+            'candlestick_patterns' => []
+        ]);
+
+        $mockTarget = $this->createMock(IStockDataAccess::class);
+        $mockTarget->expects($this->never())->method('bulkInsertPriceData');
+        $mockTarget->expects($this->never())->method('bulkInsertTechnicalIndicators');
+
+        $action = new MigrateStorageBackendAction($mockTableManager, $mockSource, $mockTarget);
+        $summary = $action->execute(['symbol' => 'ibm', 'dry_run' => true]);
+
+        $this->assertEquals('IBM', $summary['results'][0]['symbol']);
+        $this->assertEquals(3, $summary['total_records']);
+    }
+
+    public function testShortWriteIsReported()
+    {
+        $mockTableManager = $this->createMock(IStockTableManager::class);
+
+        $mockSource = $this->createMock(IStockDataAccess::class);
+        $mockSource->method('exportSymbolData')->willReturn([
+            'historical_prices' => [['date' => '2024-01-02'], ['date' => '2024-01-03']]
+        ]);
+
+        $mockTarget = $this->createMock(IStockDataAccess::class);
+        $mockTarget->method('bulkInsertPriceData')->willReturn(['rows' => 1, 'chunks' => []]);
+
+        $action = new MigrateStorageBackendAction($mockTableManager, $mockSource, $mockTarget);
+        $result = $action->migrateSymbol('IBM');
+
+        $this->assertEquals(1, $result['total_records']);
+        $this->assertEquals(['historical_prices: wrote 1 of 2 rows'], $result['errors']);
+    }
+}
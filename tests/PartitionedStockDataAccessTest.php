@@ -0,0 +1,104 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/PartitionedStockDataAccess.php';
+
+/**
+ * @covers PartitionedStockDataAccess
+ */
+class PartitionedStockDataAccessTest extends TestCase
+{
+    public function testPartitionClauseCoversStartYearThroughNextYear()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $dataAccess = new PartitionedStockDataAccess($mockPdo, null, ['partition_start_year' => 2020]);
+
+        $clause = $dataAccess->partitionClause();
+
+        $this->assertStringStartsWith('PARTITION BY RANGE COLUMNS(date)', $clause);
+        $this->assertStringContainsString("PARTITION p2020 VALUES LESS THAN ('2021-01-01')", $clause);
+        $nextYear = (int)date('Y') + 1;
+        $this->assertStringContainsString("PARTITION p{$nextYear} VALUES LESS THAN ('" . ($nextYear + 1) . "-01-01')", $clause);
+        $this->assertStringContainsString('PARTITION pmax VALUES LESS THAN (MAXVALUE)', $clause);
+    }
+
+    public function testEnsurePartitionsSplitsMissingYearsOutOfPmax()
+    {
+        $thisYear = (int)date('Y');
+        $rows = [
+            ['TABLE_NAME' => 'ts_prices', 'PARTITION_NAME' => 'p' . ($thisYear - 2)],
+            ['TABLE_NAME' => 'ts_prices', 'PARTITION_NAME' => 'p' . ($thisYear - 1)],
+            ['TABLE_NAME' => 'ts_prices', 'PARTITION_NAME' => 'pmax'],
+            ['TABLE_NAME' => 'ts_indicators', 'PARTITION_NAME' => 'p' . ($thisYear + 1)],
+            ['TABLE_NAME' => 'ts_indicators', 'PARTITION_NAME' => 'pmax']
+        ];
+        $mockStatement = $this->createMock(PDOStatement::class);
+        $mockStatement->method('fetchAll')->willReturn($rows);
+
+        $executed = [];
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('query')->willReturn($mockStatement);
+        $mockPdo->method('exec')->willReturnCallback(function ($sql) use (&$executed) {
+            $executed[] = $sql;
+            return 0;
+        });
+
+        $dataAccess = new PartitionedStockDataAccess($mockPdo);
+        $added = $dataAccess->ensurePartitions();
+
+        $this->assertEquals(['ts_prices' => ['p' . $thisYear, 'p' . ($thisYear + 1)]], $added);
+        $this->assertCount(1, $executed);
+        $this->assertStringStartsWith('ALTER TABLE ts_prices REORGANIZE PARTITION pmax INTO (', $executed[0]);
+        $this->assertStringContainsString("PARTITION p{$thisYear} VALUES LESS THAN ('" . ($thisYear + 1) . "-01-01')", $executed[0]);
+        $this->assertStringEndsWith('PARTITION pmax VALUES LESS THAN (MAXVALUE))', $executed[0]);
+    }
+
+    public function testMultiSymbolReadIsOneQueryPerChunk()
+    {
+        $prepared = [];
+        $mockStatement = $this->createMock(PDOStatement::class);
+        $mockStatement->method('execute')->willReturn(true);
+        $mockStatement->method('fetch')->willReturnOnConsecutiveCalls(
+            ['symbol' => 'AAPL', 'date' => '2024-01-03'],
+            ['symbol' => 'AAPL', 'date' => '2024-01-02'],
+            ['symbol' => 'IBM', 'date' => '2024-01-03'],
+            false
+        );
+
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('prepare')->willReturnCallback(function ($sql) use (&$prepared, $mockStatement) {
+            $prepared[] = $sql;
+            return $mockStatement;
+        });
+
+        $dataAccess = new PartitionedStockDataAccess($mockPdo);
+        $results = $dataAccess->getMultiSymbolData(['ibm', 'AAPL', 'MSFT']);
+
+        $this->assertCount(1, $prepared);
+        $this->assertStringContainsString('FROM ts_prices WHERE symbol IN (?, ?, ?)', $prepared[0]);
+        $this->assertCount(2, $results['AAPL']);
+        $this->assertCount(1, $results['IBM']);
+        $this->assertEquals([], $results['MSFT']);
+    }
+
+    public function testIndicatorRowsDefaultPeriodAndTimeframe()
+    {
+        $executed = [];
+        $mockStatement = $this->createMock(PDOStatement::class);
+        $mockStatement->method('execute')->willReturnCallback(function ($params) use (&$executed) {
+            $executed[] = $params;
+            return true;
+        });
+
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('inTransaction')->willReturn(false);
+        $mockPdo->method('prepare')->willReturn($mockStatement);
+
+        $dataAccess = new PartitionedStockDataAccess($mockPdo);
+        $report = $dataAccess->bulkInsertTechnicalIndicators('ibm', [
+            ['date' => '2024-01-02', 'indicator_name' => 'RSI', 'value' => 55.5]
+        ]);
+
+        $this->assertEquals(1, $report['rows']);
+        $this->assertEquals(['IBM', '2024-01-02', 'RSI', 0, 'daily', 55.5], $executed[0]);
+    }
+}
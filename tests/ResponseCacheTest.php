@@ -0,0 +1,116 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/ResponseCache.php';
+require_once __DIR__ . '/../src/HttpCache.php';
+
+/**
+ * @covers ResponseCache
+ * @covers HttpCache
+ */
+class ResponseCacheTest extends TestCase
+{
+    private $dir;
+
+    protected function setUp(): void
+    {
+        $this->dir = sys_get_temp_dir() . '/response_cache_test_' . uniqid();
+    }
+
+    protected function tearDown(): void
+    {
+        foreach (glob($this->dir . '/*') ?: [] as $file) {
+            unlink($file);
+        }
+        if (is_dir($this->dir)) {
+            rmdir($this->dir);
+        }
+    }
+
+    private function createCache()
+    {
+        return new ResponseCache(['backend' => 'file', 'dir' => $this->dir]);
+    }
+
+    public function testProducerRunsOncePerTtl()
+    {
+        $cache = $this->createCache();
+        $calls = 0;
+        $producer = function () use (&$calls) {
+            $calls++;
+            return '{"n":' . $calls . '}';
+        };
+
+        $this->assertSame('{"n":1}', $cache->remember('monitor', 'overview', 60, $producer));
+        $this->assertSame('{"n":1}', $cache->remember('monitor', 'overview', 60, $producer));
+        $this->assertSame(1, $calls);
+
+        // Another process sees the same entry
+        $this->assertSame('{"n":1}', $this->createCache()->remember('monitor', 'overview', 60, $producer));
+        $this->assertSame(1, $calls);
+    }
+
+    public function testKeysAreIndependent()
+    {
+        $cache = $this->createCache();
+        $cache->remember('monitor', 'jobs?limit=10', 60, function () { return 'ten'; });
+
+        $this->assertSame('fifty', $cache->remember('monitor', 'jobs?limit=50', 60, function () { return 'fifty'; }));
+    }
+
+    public function testExpiredEntryIsRecomputed()
+    {
+        $cache = $this->createCache();
+        $cache->remember('monitor', 'queues', 1, function () { return 'old'; });
+        sleep(2);
+
+        $this->assertSame('new', $cache->remember('monitor', 'queues', 1, function () { return 'new'; }));
+    }
+
+    public function testInvalidateRetiresNamespace()
+    {
+        $cache = $this->createCache();
+        $cache->remember('portfolio_a', 'read', 60, function () { return 'a1'; });
+        $cache->remember('portfolio_b', 'read', 60, function () { return 'b1'; });
+
+        $cache->invalidate('portfolio_a');
+
+        $this->assertSame('a2', $cache->remember('portfolio_a', 'read', 60, function () { return 'a2'; }));
+        $this->assertSame('b1', $cache->remember('portfolio_b', 'read', 60, function () { return 'b2'; }));
+    }
+
+    public function testGarbageCollectionRemovesExpiredAndRetiredEntries()
+    {
+        $cache = $this->createCache();
+        $cache->remember('monitor', 'queues', 1, function () { return 'short'; });
+        $cache->remember('portfolio_a', 'read', 60, function () { return 'a1'; });
+        $cache->remember('portfolio_b', 'read', 60, function () { return 'b1'; });
+        $cache->invalidate('portfolio_a');
+        sleep(2);
+
+        // queues expired, portfolio_a generation 0 retired
+        $this->assertSame(2, $cache->collectGarbage());
+        $this->assertCount(2, glob($this->dir . '/*.cache'));
+        $this->assertSame('b1', $cache->remember('portfolio_b', 'read', 60, function () { return 'b2'; }));
+    }
+
+    public function testLockFileIsRemovedAfterRecompute()
+    {
+        $cache = $this->createCache();
+        $cache->remember('monitor', 'overview', 60, function () { return 'x'; });
+
+        $this->assertEmpty(glob($this->dir . '/*.lock'));
+    }
+
+    public function testEtagMatching()
+    {
+        $etag = HttpCache::etag('{"success":true}');
+
+        $this->assertTrue(HttpCache::matches($etag, $etag));
+        $this->assertTrue(HttpCache::matches($etag, 'W/' . $etag));
+        $this->assertTrue(HttpCache::matches($etag, '"other", ' . $etag));
+        $this->assertTrue(HttpCache::matches($etag, '*'));
+        $this->assertFalse(HttpCache::matches($etag, '"other"'));
+        $this->assertFalse(HttpCache::matches($etag, null));
+        $this->assertNotSame($etag, HttpCache::etag('{"success":false}'));
+    }
+}
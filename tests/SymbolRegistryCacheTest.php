@@ -0,0 +1,85 @@
+<?php
+use PHPUnit\Framework\TestCase;
+require_once __DIR__ . '/../src/SymbolRegistryCache.php';
+
+/**
+ * @covers SymbolRegistryCache
+ */
+class SymbolRegistryCacheTest extends TestCase
+{
+    private function createRegistryStatement(array $rows)
+    {
+        $stmt = $this->createMock(PDOStatement::class);
+        $stmt->method('fetch')->willReturnOnConsecutiveCalls(...array_merge($rows, [false]));
+        return $stmt;
+    }
+
+    public function testRegistryIsLoadedOnce()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->expects($this->once())
+            ->method('query')
+            ->willReturn($this->createRegistryStatement([
+                ['symbol' => 'IBM', 'status' => 'ACTIVE', 'tables_created' => '1'],
+                ['symbol' => 'AAPL', 'status' => 'ACTIVE', 'tables_created' => '1'],
+            ]));
+        $mockPdo->expects($this->never())->method('prepare');
+
+        $cache = new SymbolRegistryCache($mockPdo);
+
+        $this->assertTrue($cache->tablesExist('IBM'));
+        $this->assertTrue($cache->tablesExist('AAPL'));
+        $this->assertTrue($cache->tablesExist('IBM'));
+        $this->assertEquals(['IBM', 'AAPL'], $cache->getSymbolsWithTables(['IBM', 'AAPL']));
+        $this->assertEquals('memory', $cache->getBackend());
+    }
+
+    public function testMissFallsThroughToDatabase()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->method('query')->willReturn($this->createRegistryStatement([]));
+
+        $lookup = $this->createMock(PDOStatement::class);
+        $lookup->method('execute')->willReturn(true);
+        $lookup->method('fetch')->willReturn(['status' => 'ACTIVE', 'tables_created' => 1]);
+        $mockPdo->expects($this->once())->method('prepare')->willReturn($lookup);
+
+        $cache = new SymbolRegistryCache($mockPdo);
+
+        $this->assertTrue($cache->tablesExist('MSFT'));
+        // Second lookup is now a cache hit
+        $this->assertTrue($cache->tablesExist('MSFT'));
+    }
+
+    public function testInvalidateBumpsVersionAndReloads()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $mockPdo->expects($this->exactly(2))
+            ->method('query')
+            ->willReturnOnConsecutiveCalls(
+                $this->createRegistryStatement([['symbol' => 'IBM', 'status' => 'ACTIVE', 'tables_created' => '1']]),
+                $this->createRegistryStatement([['symbol' => 'IBM', 'status' => 'ACTIVE', 'tables_created' => '1']])
+            );
+
+        $cache = new SymbolRegistryCache($mockPdo);
+        $cache->tablesExist('IBM');
+        $version = $cache->getVersion();
+
+        $cache->invalidate();
+
+        $this->assertGreaterThan($version, $cache->getVersion());
+        $this->assertTrue($cache->tablesExist('IBM'));
+    }
+
+    public function testUnavailableSharedBackendFallsBackToMemory()
+    {
+        $mockPdo = $this->createMock(PDO::class);
+        $cache = new SymbolRegistryCache($mockPdo, ['backend' => 'apcu']);
+
+        if (function_exists('apcu_enabled') && apcu_enabled()) {
+            $this->assertEquals('apcu', $cache->getBackend());
+        } else {
+            $this->assertEquals('memory', $cache->getBackend());
+        }
+    }
+}
@@ -0,0 +1,190 @@
+<?php
+use PHPUnit\Framework\TestCase;
+use Ksfraser\Analysis\UnifiedAnalyzer;
+use Ksfraser\Analysis\UnifiedScoreStore;
+
+require_once __DIR__ . '/../Stock-Analysis-Extension/Legacy/src/Ksfraser/Analysis/UnifiedScoreStore.php';
+require_once __DIR__ . '/../Stock-Analysis-Extension/Legacy/src/Ksfraser/Analysis/UnifiedAnalyzer.php';
+
+/**
+ * @covers \Ksfraser\Analysis\UnifiedScoreStore
+ * @covers \Ksfraser\Analysis\UnifiedAnalyzer
+ */
+class UnifiedScoreStoreTest extends TestCase
+{
+    /**
+     * unified_scores rows by stock id
+     */
+    private $rows = [];
+
+    /**
+     * PDO mock backed by $this->rows
+     */
+    private function createStorePdo()
+    {
+        $pdo = $this->createMock(PDO::class);
+
+        $existing = $this->createMock(PDOStatement::class);
+        $existing->method('fetchColumn')->willReturn(1);
+        $pdo->method('query')->willReturn($existing);
+
+        $bound = [];
+        $selectStale = $this->createMock(PDOStatement::class);
+        $selectStale->method('bindValue')->willReturnCallback(function ($name, $value) use (&$bound) {
+            $bound[$name] = $value;
+            return true;
+        });
+        $selectStale->method('fetchAll')->willReturnCallback(function () use (&$bound) {
+            ksort($this->rows);
+            $stale = [];
+            foreach ($this->rows as $id => $row) {
+                if ($row['is_stale'] && $id > $bound[':afterId']) {
+                    $stale[] = ['idstockinfo' => $id, 'version' => $row['version']];
+                }
+            }
+            return array_slice($stale, 0, $bound[':limit']);
+        });
+
+        $updated = 0;
+        $update = $this->createMock(PDOStatement::class);
+        $update->method('execute')->willReturnCallback(function ($params) use (&$updated) {
+            $id = $params[':stockId'];
+            $updated = 0;
+            if ($this->rows[$id]['version'] === $params[':version']) {
+                $this->rows[$id]['unified_score'] = $params[':score'];
+                $this->rows[$id]['is_stale'] = 0;
+                $updated = 1;
+            }
+            return true;
+        });
+        $update->method('rowCount')->willReturnCallback(function () use (&$updated) {
+            return $updated;
+        });
+
+        $top = $this->createMock(PDOStatement::class);
+        $top->method('fetchAll')->willReturnCallback(function () {
+            $ranked = [];
+            foreach ($this->rows as $id => $row) {
+                if ($row['unified_score'] > 0) {
+                    $ranked[] = [
+                        'idstockinfo' => $id, 'symbol' => "S{$id}", 'name' => "Stock {$id}", 'sector' => 'Tech',
+                        'unified_score' => $row['unified_score'], 'grade' => 'A',
+                        'confidence_level' => 'High', 'methodologies_count' => 4
+                    ];
+                }
+            }
+            usort($ranked, function ($a, $b) {
+                return $b['unified_score'] <=> $a['unified_score'];
+            });
+            return $ranked;
+        });
+
+        $pdo->method('prepare')->willReturnCallback(function ($sql) use ($selectStale, $update, $top) {
+            if (strpos($sql, 'WHERE is_stale = 1') !== false) {
+                return $selectStale;
+            }
+            return strpos($sql, 'UPDATE unified_scores') !== false ? $update : $top;
+        });
+
+        return $pdo;
+    }
+
+    private function createAnalyzer(array $freshScores)
+    {
+        $analyzer = $this->getMockBuilder(UnifiedAnalyzer::class)
+            ->disableOriginalConstructor()
+            ->onlyMethods(['calculateUnifiedScore'])
+            ->getMock();
+        $analyzer->method('calculateUnifiedScore')->willReturnCallback(function ($stockId) use ($freshScores) {
+            return [
+                'unified_score' => $freshScores[$stockId],
+                'individual_scores' => ['motley_fool' => $freshScores[$stockId]],
+                'grade' => 'A',
+                'confidence_level' => 'High'
+            ];
+        });
+
+        $store = new ReflectionProperty(UnifiedAnalyzer::class, 'scoreStore');
+        $store->setAccessible(true);
+        $store->setValue($analyzer, new UnifiedScoreStore($this->createStorePdo()));
+
+        return $analyzer;
+    }
+
+    public function testRankingRecomputesStaleRowsFirst()
+    {
+        // Stocks 3-6 changed since they were scored; within one refresh batch
+        $this->rows = [
+            1 => ['unified_score' => 80.0, 'is_stale' => 0, 'version' => 1],
+            2 => ['unified_score' => 70.0, 'is_stale' => 0, 'version' => 1],
+            3 => ['unified_score' => 95.0, 'is_stale' => 1, 'version' => 2],
+            4 => ['unified_score' => 10.0, 'is_stale' => 1, 'version' => 2],
+            5 => ['unified_score' => 20.0, 'is_stale' => 1, 'version' => 3],
+            6 => ['unified_score' => null, 'is_stale' => 1, 'version' => 1]
+        ];
+        $analyzer = $this->createAnalyzer([3 => 30.0, 4 => 90.0, 5 => 60.0, 6 => 85.0]);
+
+        $top = $analyzer->getTopUnifiedStocks(3);
+
+        $this->assertEquals([4, 6, 1], array_column(array_column($top, 'stock_info'), 'idstockinfo'));
+        $this->assertEquals([90.0, 85.0, 80.0], array_column($top, 'unified_score'));
+        $this->assertEmpty(array_filter(array_column($this->rows, 'is_stale')));
+    }
+
+    public function testRefreshOnlyClearsRowsWhoseVersionIsUnchanged()
+    {
+        $this->rows = [
+            1 => ['unified_score' => 50.0, 'is_stale' => 1, 'version' => 1]
+        ];
+        $store = new UnifiedScoreStore($this->createStorePdo());
+
+        // A methodology table changes while stock 1 is being scored
+        $refreshed = $store->refreshStale(function ($stockId) {
+            $this->rows[$stockId]['version']++;
+            return ['unified_score' => 65.0, 'individual_scores' => [], 'grade' => 'B', 'confidence_level' => 'Low'];
+        });
+
+        $this->assertEquals(0, $refreshed);
+        $this->assertEquals(1, $this->rows[1]['is_stale']);
+        $this->assertEquals(50.0, $this->rows[1]['unified_score']);
+    }
+
+    public function testRefreshAllRetriesABatchThatLostTheVersionRace()
+    {
+        $this->rows = [];
+        foreach ([1, 2, 3, 4] as $id) {
+            $this->rows[$id] = ['unified_score' => null, 'is_stale' => 1, 'version' => 1];
+        }
+        $store = new UnifiedScoreStore($this->createStorePdo());
+
+        // Stocks 1 and 2, the whole first batch, change while being scored
+        $raced = [];
+        $refreshed = $store->refreshAll(function ($stockId) use (&$raced) {
+            if ($stockId <= 2 && !isset($raced[$stockId])) {
+                $raced[$stockId] = true;
+                $this->rows[$stockId]['version']++;
+            }
+            return ['unified_score' => 10.0 * $stockId, 'individual_scores' => [], 'grade' => 'C', 'confidence_level' => 'Low'];
+        }, 2);
+
+        $this->assertEquals(4, $refreshed);
+        $this->assertEmpty(array_filter(array_column($this->rows, 'is_stale')));
+    }
+
+    public function testRefreshAllGivesUpOnRowsThatKeepChanging()
+    {
+        $this->rows = [7 => ['unified_score' => 40.0, 'is_stale' => 1, 'version' => 1]];
+        $store = new UnifiedScoreStore($this->createStorePdo());
+
+        $calls = 0;
+        $refreshed = $store->refreshAll(function ($stockId) use (&$calls) {
+            $calls++;
+            $this->rows[$stockId]['version']++;
+            return ['unified_score' => 50.0, 'individual_scores' => [], 'grade' => 'B', 'confidence_level' => 'Low'];
+        }, 2, 3);
+
+        $this->assertEquals(0, $refreshed);
+        $this->assertEquals(3, $calls);
+        $this->assertEquals(1, $this->rows[7]['is_stale']);
+    }
+}
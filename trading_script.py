@@ -29,6 +29,12 @@ import yfinance as yf
 import json
 import logging
 
+from portfolio_kernel import (
+    RollingRiskState, daily_risk_free, revalue, risk_metrics, max_drawdown as kernel_max_drawdown
+)
+from portfolio_store import get_history_store
+import runtime_metrics as metrics
+
 # Optional pandas-datareader import for Stooq access
 try:
     import pandas_datareader.data as pdr
@@ -320,6 +326,85 @@ def _weekend_safe_range(period: str | None, start: Any, end: Any) -> tuple[pd.Ti
     end_ts = (end_trading + pd.Timedelta(days=1)).normalize()
     return start_ts, end_ts
 
+# ------------------------------
+# Price cache (memory LRU -> per-ticker columnar files -> network)
+# ------------------------------
+
+# PRICE_CACHE=0 disables; PRICE_CACHE_DIR relocates the on-disk store
+PRICE_CACHE_ENABLED = os.environ.get("PRICE_CACHE", "1") not in ("0", "false", "no")
+PRICE_CACHE_DIR = Path(os.environ.get("PRICE_CACHE_DIR", str(SCRIPT_DIR / ".price_cache")))
+_PRICE_CACHE = None
+
+
+def get_price_cache():
+    """Lazily create the shared PriceCache (None when disabled or unavailable)."""
+    global _PRICE_CACHE
+    if not PRICE_CACHE_ENABLED:
+        return None
+    if _PRICE_CACHE is None:
+        try:
+            from price_cache import PriceCache
+            _PRICE_CACHE = PriceCache(PRICE_CACHE_DIR)
+        except Exception as exc:
+            logger.warning("Price cache unavailable, fetching directly: %s", exc)
+            return None
+    return _PRICE_CACHE
+
+
+PROXY_MAP = {"^GSPC": "SPY", "^RUT": "IWM"}
+PROVIDER_ORDER = ["yahoo", "stooq-pdr", "stooq-csv", "proxy"]
+
+
+def _fetch_from_provider(
+    provider: str, ticker: str, s: pd.Timestamp, e: pd.Timestamp, kwargs: Dict[str, Any]
+) -> tuple[pd.DataFrame, str]:
+    """Run one fallback stage; returns (frame, source) with an empty frame on failure."""
+    if provider == "proxy" and ticker not in PROXY_MAP:
+        return pd.DataFrame(), "empty"
+
+    with metrics.span("price_provider_fetch", provider=provider) as span:
+        if provider == "yahoo":
+            df, source = _yahoo_download(ticker, start=s, end=e, **kwargs), "yahoo"
+        elif provider == "stooq-pdr":
+            df, source = _stooq_download(ticker, start=s, end=e), "stooq-pdr"
+        elif provider == "stooq-csv":
+            df, source = _stooq_csv_download(ticker, s, e), "stooq-csv"
+        else:
+            proxy = PROXY_MAP[ticker]
+            df, source = _yahoo_download(proxy, start=s, end=e, **kwargs), f"yahoo:{proxy}-proxy"
+
+        if not isinstance(df, pd.DataFrame) or df.empty:
+            span.label(outcome="empty")
+            return pd.DataFrame(), "empty"
+
+    if isinstance(df.columns, pd.MultiIndex):
+        df.columns = df.columns.get_level_values(0)
+    return _normalize_ohlcv(_to_datetime_index(df)), source
+
+
+def _fetch_uncached(
+    ticker: str,
+    s: pd.Timestamp,
+    e: pd.Timestamp,
+    preferred: Optional[str],
+    kwargs: Dict[str, Any],
+    skip: tuple[str, ...] = (),
+) -> tuple[pd.DataFrame, str]:
+    """Walk the provider chain, starting with the provider that last worked for this ticker."""
+    order = [p for p in PROVIDER_ORDER if p not in skip]
+    if preferred:
+        stage = "proxy" if preferred.endswith("-proxy") else preferred
+        if stage in order:
+            order.remove(stage)
+            order.insert(0, stage)
+
+    for provider in order:
+        df, source = _fetch_from_provider(provider, ticker, s, e, kwargs)
+        if not df.empty:
+            return df, source
+    return pd.DataFrame(columns=["Open", "High", "Low", "Close", "Adj Close", "Volume"]), "empty"
+
+
 def download_price_data(ticker: str, **kwargs: Any) -> FetchResult:
     """
     Robust OHLCV fetch with multi-stage fallbacks:
@@ -329,43 +414,151 @@ def download_price_data(ticker: str, **kwargs: Any) -> FetchResult:
       2) Stooq via pandas-datareader
       3) Stooq direct CSV
       4) Index proxies (e.g., ^GSPC->SPY, ^RUT->IWM) via Yahoo
+    The provider that last succeeded for a ticker is tried first.
+
+    Daily requests go through the local price cache, so only dates not
+    already stored are fetched. Pass use_cache=False to bypass it.
     Returns a DataFrame with columns [Open, High, Low, Close, Adj Close, Volume].
     """
     # Pull out range args, compute a weekend-safe window
     period = kwargs.pop("period", None)
     start = kwargs.pop("start", None)
     end = kwargs.pop("end", None)
+    use_cache = kwargs.pop("use_cache", True)
     kwargs.setdefault("progress", False)
     kwargs.setdefault("threads", False)
 
     s, e = _weekend_safe_range(period, start, end)
 
-    # ---------- 1) Yahoo (date-bounded) ----------
-    df_y = _yahoo_download(ticker, start=s, end=e, **kwargs)
-    if isinstance(df_y, pd.DataFrame) and not df_y.empty:
-        return FetchResult(_normalize_ohlcv(_to_datetime_index(df_y)), "yahoo")
+    cache = get_price_cache() if use_cache and kwargs.get("interval", "1d") == "1d" else None
+    with metrics.span("price_download", cache="on" if cache is not None else "off"):
+        if cache is not None:
+            df, source = cache.get(
+                ticker, s, e,
+                lambda t, ms, me, preferred: _fetch_uncached(t, ms, me, preferred, kwargs),
+                variant=_cache_variant(kwargs),
+            )
+        else:
+            df, source = _fetch_uncached(ticker, s, e, None, kwargs)
+    return FetchResult(df, source)
+
+
+def _cache_variant(kwargs: Dict[str, Any]) -> str:
+    """Cache key suffix; adjusted and raw prices are different series."""
+    return "" if kwargs.get("auto_adjust") is False else f"@adj={kwargs.get('auto_adjust')}"
+
+
+def _split_grouped(df: pd.DataFrame, tickers: List[str]) -> Dict[str, pd.DataFrame]:
+    """Split a grouped yfinance frame (ticker, field) into normalized per-ticker frames."""
+    out: Dict[str, pd.DataFrame] = {}
+    if not isinstance(df, pd.DataFrame) or df.empty:
+        return out
+
+    if isinstance(df.columns, pd.MultiIndex):
+        present = set(df.columns.get_level_values(0))
+        for t in tickers:
+            if t in present:
+                sub = df[t].dropna(how="all")
+                if not sub.empty:
+                    out[t] = _normalize_ohlcv(_to_datetime_index(sub.copy()))
+    elif len(tickers) == 1:
+        out[tickers[0]] = _normalize_ohlcv(_to_datetime_index(df.copy()))
+    return out
+
+
+def _fetch_batch_uncached(
+    requests_: List[tuple[str, pd.Timestamp, pd.Timestamp, Optional[str]]],
+    kwargs: Dict[str, Any],
+    max_workers: int,
+) -> Dict[tuple[str, pd.Timestamp, pd.Timestamp], tuple[pd.DataFrame, str]]:
+    """Fetch (ticker, start, end, preferred) requests.
+
+    Requests sharing a window go to Yahoo as one grouped download. Tickers
+    Yahoo doesn't return, or whose last good provider was Stooq, run through
+    the per-ticker fallback chain on a bounded thread pool.
+    """
+    from concurrent.futures import ThreadPoolExecutor
+
+    results: Dict[tuple[str, pd.Timestamp, pd.Timestamp], tuple[pd.DataFrame, str]] = {}
+    groups: Dict[tuple[pd.Timestamp, pd.Timestamp], List[str]] = {}
+    fallback: List[tuple[str, pd.Timestamp, pd.Timestamp, Optional[str]]] = []
+
+    for ticker, s, e, preferred in requests_:
+        if preferred and preferred.startswith("stooq"):
+            fallback.append((ticker, s, e, preferred))
+        else:
+            groups.setdefault((s, e), []).append(ticker)
+
+    yahoo_kwargs = dict(kwargs, threads=True, group_by="ticker")
+    for (s, e), tickers in groups.items():
+        with metrics.span("price_provider_fetch", provider="yahoo-batch"):
+            frame = _yahoo_download(sorted(set(tickers)), start=s, end=e, **yahoo_kwargs)
+        grouped = _split_grouped(frame, tickers)
+        for t in tickers:
+            if t in grouped:
+                results[(t, s, e)] = (grouped[t], "yahoo")
+            else:
+                fallback.append((t, s, e, None))
+
+    if fallback:
+        # Stooq stages only: _yahoo_download redirects stdout, which is not thread-safe
+        with ThreadPoolExecutor(max_workers=max(1, min(max_workers, len(fallback)))) as pool:
+            futures = {
+                (t, s, e): pool.submit(_fetch_uncached, t, s, e, preferred, kwargs, ("yahoo", "proxy"))
+                for t, s, e, preferred in fallback
+            }
+            for key, future in futures.items():
+                results[key] = future.result()
+
+        # Remaining Yahoo stages run serially
+        for t, s, e, preferred in fallback:
+            if results[(t, s, e)][0].empty:
+                tried_yahoo = not (preferred and preferred.startswith("stooq"))
+                skip = ("stooq-pdr", "stooq-csv") + (("yahoo",) if tried_yahoo else ())
+                results[(t, s, e)] = _fetch_uncached(t, s, e, None, kwargs, skip)
+
+    return results
+
 
-    # ---------- 2) Stooq via pandas-datareader ----------
-    df_s = _stooq_download(ticker, start=s, end=e)
-    if isinstance(df_s, pd.DataFrame) and not df_s.empty:
-        return FetchResult(_normalize_ohlcv(_to_datetime_index(df_s)), "stooq-pdr")
+def download_price_data_batch(tickers: List[str], **kwargs: Any) -> Dict[str, FetchResult]:
+    """
+    Fetch the same window for many tickers at once.
+
+    Accepts the same window arguments as download_price_data
+    (period/start/end, use_cache). Cached tickers only request their
+    missing dates; everything that has to hit the network is grouped into
+    one yfinance download per distinct window, and Stooq fallbacks run on a
+    pool of at most max_workers threads (default 8).
+    Returns {ticker: FetchResult}, keyed by the tickers as given.
+    """
+    period = kwargs.pop("period", None)
+    start = kwargs.pop("start", None)
+    end = kwargs.pop("end", None)
+    use_cache = kwargs.pop("use_cache", True)
+    max_workers = int(kwargs.pop("max_workers", 8))
+    kwargs.setdefault("progress", False)
+
+    s, e = _weekend_safe_range(period, start, end)
+    unique = list(dict.fromkeys(tickers))
 
-    # ---------- 3) Stooq direct CSV ----------
-    df_csv = _stooq_csv_download(ticker, s, e)
-    if isinstance(df_csv, pd.DataFrame) and not df_csv.empty:
-        return FetchResult(_normalize_ohlcv(_to_datetime_index(df_csv)), "stooq-csv")
+    cache = get_price_cache() if use_cache and kwargs.get("interval", "1d") == "1d" else None
+    if cache is None:
+        fetched = _fetch_batch_uncached([(t, s, e, None) for t in unique], kwargs, max_workers)
+        out = {t: FetchResult(*fetched[(t, s, e)]) for t in unique}
+        return {t: out[t] for t in tickers}
 
-    # ---------- 4) Proxy indices if applicable ----------
-    proxy_map = {"^GSPC": "SPY", "^RUT": "IWM"}
-    proxy = proxy_map.get(ticker)
-    if proxy:
-        df_proxy = _yahoo_download(proxy, start=s, end=e, **kwargs)
-        if isinstance(df_proxy, pd.DataFrame) and not df_proxy.empty:
-            return FetchResult(_normalize_ohlcv(_to_datetime_index(df_proxy)), f"yahoo:{proxy}-proxy")
+    variant = _cache_variant(kwargs)
+    plans = {t: cache.plan(t, s, e, variant) for t in unique}
+    wanted = [(t, ms, me, preferred) for t, (missing, preferred) in plans.items() for ms, me in missing]
+    fetched = _fetch_batch_uncached(wanted, kwargs, max_workers) if wanted else {}
 
-    # ---------- Nothing worked ----------
-    empty = pd.DataFrame(columns=["Open", "High", "Low", "Close", "Adj Close", "Volume"])
-    return FetchResult(empty, "empty")
+    out = {}
+    for t in unique:
+        missing, _ = plans[t]
+        deltas = [(ms, me) + fetched[(t, ms, me)] for ms, me in missing]
+        source = cache.update(t, deltas, variant) or "cache"
+        out[t] = FetchResult(*cache.read(t, s, e, variant, source))
+    return {t: out[t] for t in tickers}
 
 
 
@@ -458,15 +651,7 @@ Would you like to log a manual trade? Enter 'b' for buy, 's' for sell, or press
                         "Reason": "MANUAL BUY MOO - Filled",
                     }
                     # --- Manual BUY MOO logging ---
-                    if os.path.exists(TRADE_LOG_CSV):
-                        df_log = pd.read_csv(TRADE_LOG_CSV)
-                        if df_log.empty:
-                            df_log = pd.DataFrame([log])
-                        else:
-                            df_log = pd.concat([df_log, pd.DataFrame([log])], ignore_index=True)
-                    else:
-                        df_log = pd.DataFrame([log])
-                    df_log.to_csv(TRADE_LOG_CSV, index=False)
+                    append_trade_log(log)
 
                     rows = portfolio_df.loc[portfolio_df["ticker"].astype(str).str.upper() == ticker.upper()]
                     if rows.empty:
@@ -535,6 +720,9 @@ Would you like to log a manual trade? Enter 'b' for buy, 's' for sell, or press
 
     # ------- Daily pricing + stop-loss execution -------
     s, e = trading_day_window()
+    fetches = download_price_data_batch(
+        [str(t).upper() for t in portfolio_df["ticker"]], start=s, end=e, auto_adjust=False, progress=False
+    ) if not portfolio_df.empty else {}
     for _, stock in portfolio_df.iterrows():
         ticker = str(stock["ticker"]).upper()
         shares = int(stock["shares"]) if not pd.isna(stock["shares"]) else 0
@@ -542,7 +730,7 @@ Would you like to log a manual trade? Enter 'b' for buy, 's' for sell, or press
         cost_basis = float(stock["cost_basis"]) if not pd.isna(stock["cost_basis"]) else cost * shares
         stop = float(stock["stop_loss"]) if not pd.isna(stock["stop_loss"]) else 0.0
 
-        fetch = download_price_data(ticker, start=s, end=e, auto_adjust=False, progress=False)
+        fetch = fetches[ticker]
         data = fetch.df
 
         if data.empty:
@@ -601,13 +789,9 @@ Would you like to log a manual trade? Enter 'b' for buy, 's' for sell, or press
     }
     results.append(total_row)
 
-    df_out = pd.DataFrame(results)
-    if PORTFOLIO_CSV.exists():
-        existing = pd.read_csv(PORTFOLIO_CSV)
-        existing = existing[existing["Date"] != str(today_iso)]
-        print("Saving results to CSV...")
-        df_out = pd.concat([existing, df_out], ignore_index=True)
-    df_out.to_csv(PORTFOLIO_CSV, index=False)
+    # Re-running on the same day replaces that day's rows
+    print("Saving results to CSV...")
+    get_history_store(PORTFOLIO_CSV).append(results, replace_date=today_iso)
 
     return portfolio_df, cash
 
@@ -617,6 +801,11 @@ Would you like to log a manual trade? Enter 'b' for buy, 's' for sell, or press
 # Trade logging
 # ------------------------------
 
+def append_trade_log(log: dict[str, object]) -> None:
+    """Append one trade to the trade log history (and its CSV)."""
+    get_history_store(TRADE_LOG_CSV).append([log])
+
+
 def log_sell(
     ticker: str,
     shares: float,
@@ -638,15 +827,7 @@ def log_sell(
     print(f"{ticker} stop loss was met. Selling all shares.")
     portfolio = portfolio[portfolio["ticker"] != ticker]
 
-    if TRADE_LOG_CSV.exists():
-        df = pd.read_csv(TRADE_LOG_CSV)
-        if df.empty:
-            df = pd.DataFrame([log])
-        else:
-            df = pd.concat([df, pd.DataFrame([log])], ignore_index=True)
-    else:
-        df = pd.DataFrame([log])
-    df.to_csv(TRADE_LOG_CSV, index=False)
+    append_trade_log(log)
     return portfolio
 
 def log_manual_buy(
@@ -709,15 +890,7 @@ def log_manual_buy(
         "PnL": 0.0,
         "Reason": "MANUAL BUY LIMIT - Filled",
     }
-    if os.path.exists(TRADE_LOG_CSV):
-        df = pd.read_csv(TRADE_LOG_CSV)
-        if df.empty:
-            df = pd.DataFrame([log])
-        else:
-            df = pd.concat([df, pd.DataFrame([log])], ignore_index=True)
-    else:
-        df = pd.DataFrame([log])
-    df.to_csv(TRADE_LOG_CSV, index=False)
+    append_trade_log(log)
 
     rows = chatgpt_portfolio.loc[chatgpt_portfolio["ticker"].str.upper() == ticker.upper()]
     if rows.empty:
@@ -818,15 +991,7 @@ If this is a mistake, enter 1. """
         "Reason": f"MANUAL SELL LIMIT - {reason}", "Shares Sold": shares_sold,
         "Sell Price": exec_price,
     }
-    if os.path.exists(TRADE_LOG_CSV):
-        df = pd.read_csv(TRADE_LOG_CSV)
-        if df.empty:
-            df = pd.DataFrame([log])
-        else:
-            df = pd.concat([df, pd.DataFrame([log])], ignore_index=True)
-    else:
-        df = pd.DataFrame([log])
-    df.to_csv(TRADE_LOG_CSV, index=False)
+    append_trade_log(log)
 
 
     if total_shares == shares_sold:
@@ -848,6 +1013,29 @@ If this is a mistake, enter 1. """
 # Reporting / Metrics
 # ------------------------------
 
+# Trailing window (trading days) for the recent Sharpe/Sortino figures
+RECENT_RISK_WINDOW = 20
+
+
+def holdings_revaluation(portfolio_dict: list[dict[Any, Any]],
+                         closes: dict[str, tuple[float, float]],
+                         cash: float):
+    """Revalue the holdings at the previous and latest close in one pass.
+
+    Returns the tickers (columns of the result) and the portfolio_kernel
+    Revaluation for one portfolio over those two dates.
+    """
+    tickers = [str(stock["ticker"]).upper() for stock in portfolio_dict]
+    prices = np.array(
+        [[closes.get(t, (np.nan, np.nan))[day] for t in tickers] for day in (0, 1)], dtype=float
+    )
+    def column(name: str) -> np.ndarray:
+        return np.array([[0.0 if pd.isna(stock.get(name)) else float(stock[name]) for stock in portfolio_dict]])
+
+    shares, cost_basis = column("shares"), column("cost_basis")
+    return tickers, revalue(prices, shares, np.array([cash]), cost_basis=cost_basis)
+
+
 def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
     """Print daily price updates and performance metrics (incl. CAPM)."""
     portfolio_dict: list[dict[Any, Any]] = chatgpt_portfolio.to_dict(orient="records")
@@ -862,10 +1050,16 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
     benchmarks = load_benchmarks()  # reads tickers.json or returns defaults
     benchmark_entries = [{"ticker": t} for t in benchmarks]
 
-    for stock in portfolio_dict + benchmark_entries:
-        ticker = str(stock["ticker"]).upper()
+    all_tickers = [str(stock["ticker"]).upper() for stock in portfolio_dict + benchmark_entries]
+    closes: dict[str, tuple[float, float]] = {}
+    try:
+        fetches = download_price_data_batch(all_tickers, start=start_d, end=(end_d + pd.Timedelta(days=1)), progress=False)
+    except Exception as e:
+        raise Exception(f"Batch download failed. {e} Try checking internet connection.")
+
+    for ticker in all_tickers:
         try:
-            fetch = download_price_data(ticker, start=start_d, end=(end_d + pd.Timedelta(days=1)), progress=False)
+            fetch = fetches[ticker]
             data = fetch.df
             if data.empty or len(data) < 2:
                 rows.append([ticker, "—", "—", "—"])
@@ -875,16 +1069,14 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
             last_price = float(data["Close"].iloc[-2])
             volume = float(data["Volume"].iloc[-1])
 
+            closes[ticker] = (last_price, price)
             percent_change = ((price - last_price) / last_price) * 100
             rows.append([ticker, f"{price:,.2f}", f"{percent_change:+.2f}%", f"{int(volume):,}"])
         except Exception as e:
             raise Exception(f"Download for {ticker} failed. {e} Try checking internet connection.")
 
-    # Read portfolio history
-    chatgpt_df = pd.read_csv(PORTFOLIO_CSV)
-
-    # Use only TOTAL rows, sorted by date
-    totals = chatgpt_df[chatgpt_df["Ticker"] == "TOTAL"].copy()
+    # TOTAL rows only, sorted by date (indexed in the history store)
+    totals = get_history_store(PORTFOLIO_CSV).totals()
     if totals.empty:
         print("\n" + "=" * 64)
         print(f"Daily Results — {today}")
@@ -907,10 +1099,10 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
     equity_series = totals.set_index("Date")["Total Equity"].astype(float).sort_index()
 
     # --- Max Drawdown ---
-    running_max = equity_series.cummax()
-    drawdowns = (equity_series / running_max) - 1.0
-    max_drawdown = float(drawdowns.min())  # most negative value
-    mdd_date = drawdowns.idxmin()
+    equity_values = equity_series.to_numpy(dtype=float)
+    mdd, mdd_index = kernel_max_drawdown(equity_values)
+    max_drawdown = float(mdd)  # most negative value
+    mdd_date = equity_series.index[int(mdd_index)]
 
     # Daily simple returns (portfolio)
     r = equity_series.pct_change().dropna()
@@ -939,69 +1131,40 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
         return
 
     # Risk-free config
-    rf_annual = 0.045
-    rf_daily = (1 + rf_annual) ** (1 / 252) - 1
-    rf_period = (1 + rf_daily) ** n_days - 1
-
-    # Stats
-    mean_daily = float(r.mean())
-    std_daily = float(r.std(ddof=1))
-
-    # Downside deviation (MAR = rf_daily)
-    downside = (r - rf_daily).clip(upper=0)
-    downside_std = float((downside.pow(2).mean()) ** 0.5) if not downside.empty else np.nan
-
-    # Total return over the window
-    r_numeric = pd.to_numeric(r, errors="coerce")
-    r_numeric = r_numeric[~r_numeric.isna()].astype(float)
-    # Filter out any non-finite values to ensure only valid floats are used
-    r_numeric = r_numeric[np.isfinite(r_numeric)]
-    # Only use numeric values for the calculation
-    if len(r_numeric) > 0:
-        arr = np.asarray(r_numeric.values, dtype=float)
-        period_return = float(np.prod(1 + arr) - 1) if arr.size > 0 else float('nan')
-    else:
-        period_return = float('nan')
+    rf_daily = daily_risk_free(0.045)
 
-    # Sharpe / Sortino
-    sharpe_period = (period_return - rf_period) / (std_daily * np.sqrt(n_days)) if std_daily > 0 else np.nan
-    sharpe_annual = ((mean_daily - rf_daily) / std_daily) * np.sqrt(252) if std_daily > 0 else np.nan
-    sortino_period = (period_return - rf_period) / (downside_std * np.sqrt(n_days)) if downside_std and downside_std > 0 else np.nan
-    sortino_annual = ((mean_daily - rf_daily) / downside_std) * np.sqrt(252) if downside_std and downside_std > 0 else np.nan
-
-    # -------- CAPM: Beta & Alpha (vs ^GSPC) --------
+    # -------- Stats + CAPM: Beta & Alpha (vs ^GSPC) --------
     start_date = equity_series.index.min() - pd.Timedelta(days=1)
     end_date = equity_series.index.max() + pd.Timedelta(days=1)
 
     spx_fetch = download_price_data("^GSPC", start=start_date, end=end_date, progress=False)
     spx = spx_fetch.df
 
-    beta = np.nan
-    alpha_annual = np.nan
-    r2 = np.nan
-    n_obs = 0
-
+    # Market returns aligned to the portfolio's return dates (NaN where missing)
+    market_returns = None
     if not spx.empty and len(spx) >= 2:
         spx = spx.reset_index().set_index("Date").sort_index()
         mkt_ret = spx["Close"].astype(float).pct_change().dropna()
-
-        # Align portfolio & market returns
-        common_idx = r.index.intersection(list(mkt_ret.index))
-        if len(common_idx) >= 2:
-            rp = (r.reindex(common_idx).astype(float) - rf_daily)   # portfolio excess
-            rm = (mkt_ret.reindex(common_idx).astype(float) - rf_daily)  # market excess
-
-            x = np.asarray(rm.values, dtype=float).ravel()
-            y = np.asarray(rp.values, dtype=float).ravel()
-
-            n_obs = x.size
-            rm_std = float(np.std(x, ddof=1)) if n_obs > 1 else 0.0
-            if rm_std > 0:
-                beta, alpha_daily = np.polyfit(x, y, 1)
-                alpha_annual = (1 + float(alpha_daily)) ** 252 - 1
-
-                corr = np.corrcoef(x, y)[0, 1]
-                r2 = float(corr ** 2)
+        market_returns = mkt_ret.reindex(r.index).to_numpy(dtype=float)
+
+    risk = risk_metrics(equity_values, market_returns, rf_daily)
+    sharpe_period = float(risk["sharpe_period"])
+    sharpe_annual = float(risk["sharpe_annual"])
+    sortino_period = float(risk["sortino_period"])
+    sortino_annual = float(risk["sortino_annual"])
+    beta = float(risk["beta"])
+    alpha_annual = float(risk["alpha_annual"])
+    r2 = float(risk["r2"])
+    n_obs = int(risk["n_obs"])
+
+    # Same statistics over the trailing window only
+    recent = RollingRiskState.from_history(
+        equity_values, market_returns, window=RECENT_RISK_WINDOW, rf_daily=rf_daily
+    ).metrics()
+    recent_sharpe = float(recent["sharpe_annual"][0])
+    recent_sortino = float(recent["sortino_annual"][0])
+
+    holding_tickers, holdings = holdings_revaluation(portfolio_dict, closes, cash)
 
     # $X normalized S&P 500 over same window (asks user for initial equity)
     spx_norm_fetch = download_price_data(
@@ -1051,6 +1214,9 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
     print(f"{'Sharpe Ratio (annualized):':32} {fmt_or_na(sharpe_annual, '{:.4f}'):>15}")
     print(f"{'Sortino Ratio (period):':32} {fmt_or_na(sortino_period, '{:.4f}'):>15}")
     print(f"{'Sortino Ratio (annualized):':32} {fmt_or_na(sortino_annual, '{:.4f}'):>15}")
+    if n_days > RECENT_RISK_WINDOW:
+        print(f"{f'Sharpe Ratio ({RECENT_RISK_WINDOW}d, annualized):':32} {fmt_or_na(recent_sharpe, '{:.4f}'):>15}")
+        print(f"{f'Sortino Ratio ({RECENT_RISK_WINDOW}d, annualized):':32} {fmt_or_na(recent_sortino, '{:.4f}'):>15}")
 
     print("\n[ CAPM vs Benchmarks ]")
     if not np.isnan(beta):
@@ -1074,6 +1240,16 @@ def daily_results(chatgpt_portfolio: pd.DataFrame, cash: float) -> None:
     print("\n[ Holdings ]")
     print(chatgpt_portfolio)
 
+    if holding_tickers:
+        print("\n[ Holdings Revaluation ]")
+        print(f"{'Ticker':<10} {'Value':>14} {'Exposure':>10} {'Day P&L':>12}")
+        for i, ticker in enumerate(holding_tickers):
+            value = holdings.values[0, 1, i]
+            day_pnl = value - holdings.values[0, 0, i]
+            print(f"{ticker:<10} {fmt_or_na(value, '${:,.2f}'):>14} "
+                  f"{fmt_or_na(holdings.exposures[0, 1, i], '{:.1%}'):>10} {fmt_or_na(day_pnl, '${:+,.2f}'):>12}")
+        print(f"{'Unrealized P&L:':32} {fmt_or_na(holdings.pnl[0, 1], '${:+,.2f}'):>15}")
+
     print("\n[ Your Instructions ]")
     print(
         "Use this info to make decisions regarding your portfolio. You have complete control over every decision. Make any changes you believe are beneficial—no approval required.\n"
@@ -1093,8 +1269,8 @@ def load_latest_portfolio_state(
     file: str,
 ) -> tuple[pd.DataFrame | list[dict[str, Any]], float]:
     """Load the most recent portfolio snapshot and cash balance."""
-    df = pd.read_csv(file)
-    if df.empty:
+    state = get_history_store(file).latest_state()
+    if state is None:
         portfolio = pd.DataFrame(columns=["ticker", "shares", "stop_loss", "buy_price", "cost_basis"])
         print("Portfolio CSV is empty. Returning set amount of cash for creating portfolio.")
         try:
@@ -1105,11 +1281,9 @@ def load_latest_portfolio_state(
             )
         return portfolio, cash
 
-    non_total = df[df["Ticker"] != "TOTAL"].copy()
-    non_total["Date"] = pd.to_datetime(non_total["Date"], format="mixed", errors="coerce")
-
-    latest_date = non_total["Date"].max()
-    latest_tickers = non_total[non_total["Date"] == latest_date].copy()
+    latest_tickers = pd.DataFrame(state["positions"]).replace("", np.nan).infer_objects()
+    if latest_tickers.empty:
+        latest_tickers = pd.DataFrame(columns=["Ticker", "Action"])
     sold_mask = latest_tickers["Action"].astype(str).str.startswith("SELL")
     latest_tickers = latest_tickers[~sold_mask].copy()
     latest_tickers.drop(
@@ -1137,10 +1311,7 @@ def load_latest_portfolio_state(
     )
     latest_tickers = latest_tickers.reset_index(drop=True).to_dict(orient="records")
 
-    df_total = df[df["Ticker"] == "TOTAL"].copy()
-    df_total["Date"] = pd.to_datetime(df_total["Date"], format="mixed", errors="coerce")
-    latest = df_total.sort_values("Date").iloc[-1]
-    cash = float(latest["Cash Balance"])
+    cash = float(state["total"]["Cash Balance"])
     return latest_tickers, cash
 
 
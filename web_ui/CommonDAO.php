@@ -2,10 +2,13 @@
 /**
  * CommonDAO: Base class for all DAOs, handles DB connection, error logging, and config.
  */
+require_once __DIR__ . '/../src/Ksfraser/Database/StatementCache.php';
+
 abstract class CommonDAO {
     protected $pdo;
     protected $errors = [];
     protected $dbConfigClass;
+    protected $statementCache;
 
     public function __construct($dbConfigClass) {
         $this->dbConfigClass = $dbConfigClass;
@@ -74,6 +77,22 @@ abstract class CommonDAO {
         return $this->pdo;
     }
 
+    // Prepare once per SQL text (table + query shape) and reuse the statement;
+    // finish reading its results before preparing the same SQL again
+    protected function prepareCached($sql) {
+        if ($this->statementCache === null) {
+            $this->statementCache = new \Ksfraser\Database\StatementCache();
+        }
+        return $this->statementCache->get($sql, function ($sql) {
+            return $this->pdo->prepare($sql);
+        });
+    }
+
+    // Hit/miss counters of this DAO's statement cache
+    public function getStatementCacheStats() {
+        return $this->statementCache ? $this->statementCache->getStats() : null;
+    }
+
     protected function logError($msg) {
         $this->errors[] = $msg;
     }
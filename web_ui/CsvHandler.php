@@ -10,33 +10,46 @@ class CsvHandler {
      * Read CSV file and return associative array
      */
     public function read($csvPath) {
+        try {
+            return iterator_to_array($this->stream($csvPath), false);
+        } catch (Exception $e) {
+            $this->logError('CSV read failed: ' . $e->getMessage());
+            return [];
+        }
+    }
+    
+    /**
+     * Read CSV file one row at a time
+     *
+     * Generator yielding header-keyed rows keyed by line number, so memory
+     * stays flat regardless of file size. Errors are collected as in read().
+     */
+    public function stream($csvPath) {
         $this->errors = [];
         
         if (!file_exists($csvPath)) {
             $this->logError("CSV file not found: $csvPath");
-            return [];
+            return;
         }
         
         if (!is_readable($csvPath)) {
             $this->logError("CSV file not readable: $csvPath");
-            return [];
+            return;
+        }
+        
+        $handle = fopen($csvPath, 'r');
+        if (!$handle) {
+            $this->logError("Cannot open CSV file: $csvPath");
+            return;
         }
         
         try {
-            $handle = fopen($csvPath, 'r');
-            if (!$handle) {
-                $this->logError("Cannot open CSV file: $csvPath");
-                return [];
-            }
-            
             $header = fgetcsv($handle);
             if (!$header) {
                 $this->logError("CSV file has no header: $csvPath");
-                fclose($handle);
-                return [];
+                return;
             }
             
-            $data = [];
             $lineNumber = 2; // Start from line 2 (after header)
             
             while (($row = fgetcsv($handle)) !== false) {
@@ -46,16 +59,11 @@ class CsvHandler {
                     continue;
                 }
                 
-                $data[] = array_combine($header, $row);
+                yield $lineNumber => array_combine($header, $row);
                 $lineNumber++;
             }
-            
+        } finally {
             fclose($handle);
-            return $data;
-            
-        } catch (Exception $e) {
-            $this->logError('CSV read failed: ' . $e->getMessage());
-            return [];
         }
     }
     
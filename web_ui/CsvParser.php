@@ -15,66 +15,83 @@ class CsvParser implements CsvParserInterface
     }
 
     public function parse($filePath)
+    {
+        $rows = [];
+
+        try {
+            foreach ($this->stream($filePath) as $row) {
+                $rows[] = $row;
+            }
+
+            $this->logger->info('CSV parsed successfully', [
+                'file' => $filePath,
+                'rows' => count($rows)
+            ]);
+
+        } catch (Exception $e) {
+            $this->logger->error('Error parsing CSV', [
+                'file' => $filePath,
+                'error' => $e->getMessage()
+            ]);
+            $rows = [];
+        }
+
+        return $rows;
+    }
+
+    /**
+     * Lazily yield rows as header-keyed arrays, keyed by file line number
+     *
+     * Only one row is held in memory at a time, so this is the entry point
+     * for large files. Lines whose column count does not match the header
+     * are logged and skipped.
+     */
+    public function stream($filePath)
     {
         if (!file_exists($filePath)) {
             $this->logger->error('CSV file not found', ['file' => $filePath]);
-            return [];
+            return;
         }
 
         if (!is_readable($filePath)) {
             $this->logger->error('CSV file not readable', ['file' => $filePath]);
-            return [];
+            return;
         }
 
-        $rows = [];
         $handle = fopen($filePath, 'r');
-        
+
         if (!$handle) {
             $this->logger->error('Failed to open CSV file', ['file' => $filePath]);
-            return [];
+            return;
         }
 
         try {
             $header = fgetcsv($handle);
             if (!$header || empty($header)) {
                 $this->logger->warning('CSV file has no header or empty header', ['file' => $filePath]);
-                fclose($handle);
-                return [];
+                return;
             }
 
+            $columnCount = count($header);
             $lineNumber = 1;
             while (($data = fgetcsv($handle)) !== false) {
                 $lineNumber++;
-                
-                if (count($data) !== count($header)) {
+
+                if (count($data) !== $columnCount) {
                     $this->logger->warning('CSV line has different column count than header', [
                         'file' => $filePath,
                         'line' => $lineNumber,
-                        'expected' => count($header),
+                        'expected' => $columnCount,
                         'actual' => count($data)
                     ]);
                     continue;
                 }
 
-                $rows[] = array_combine($header, $data);
+                yield $lineNumber => array_combine($header, $data);
             }
-
-            $this->logger->info('CSV parsed successfully', [
-                'file' => $filePath,
-                'rows' => count($rows)
-            ]);
-
-        } catch (Exception $e) {
-            $this->logger->error('Error parsing CSV', [
-                'file' => $filePath,
-                'error' => $e->getMessage()
-            ]);
-            $rows = [];
         } finally {
             fclose($handle);
         }
-
-        return $rows;
     }
 
     public function write($filePath, array $data)
@@ -33,7 +33,6 @@ class UserAuthDAO
     {
         try {
             $this->enhancedDAO = new EnhancedUserAuthDAO();
-            $this->dbInfo = $this->enhancedDAO->getDatabaseInfo();
         } catch (Exception $e) {
             // Log the error but don't throw - maintain compatibility
             error_log("Enhanced database initialization failed: " . $e->getMessage());
@@ -186,6 +185,9 @@ class UserAuthDAO
      */
     public function getDatabaseInfo()
     {
+        if ($this->dbInfo === null) {
+            $this->dbInfo = $this->enhancedDAO->getDatabaseInfo();
+        }
         return $this->dbInfo;
     }
 }
@@ -11,6 +11,16 @@ require_once __DIR__ . '/SecureFileUploadHandler.php';
  */
 class ImportService
 {
+    /**
+     * Rows normalized and written per batch
+     */
+    const DEFAULT_CHUNK_SIZE = 500;
+
+    /**
+     * Cap on errors/warnings returned, so a bad file cannot grow them unbounded
+     */
+    const MAX_MESSAGES = 100;
+
     private $csvParser;
     private $fileUploadHandler;
     private $transactionDAO;
@@ -18,6 +28,7 @@ class ImportService
     private $csvValidator;
     private $transactionValidator;
     private $logger;
+    private $chunkSize = self::DEFAULT_CHUNK_SIZE;
 
     public function __construct(
         CsvParser $csvParser,
@@ -66,26 +77,39 @@ class ImportService
 
     /**
      * Import transactions from existing CSV file
+     *
+     * The file is streamed: rows are normalized and validated in chunks of
+     * $chunkSize, each chunk is written with one batched INSERT in its own
+     * database transaction, and portfolio positions are written once per
+     * ticker, in the final chunk's transaction. Memory use is bounded by the
+     * chunk size and the number of distinct tickers, not by the file size.
      */
     public function importTransactionsFromFile($filePath)
     {
         $this->logger->info('Starting transaction import from file', ['file' => $filePath]);
 
         try {
-            // Parse CSV file
-            $csvData = $this->csvParser->parseFile($filePath);
-            
-            if (empty($csvData)) {
+            $rows = $this->csvParser->stream($filePath);
+
+            // Validate CSV structure against the first chunk only
+            $firstChunk = [];
+            foreach ($rows as $lineNumber => $row) {
+                $firstChunk[$lineNumber] = $row;
+                if (count($firstChunk) >= $this->chunkSize) {
+                    break;
+                }
+            }
+
+            if (empty($firstChunk)) {
                 return new ImportResult(false, 0, ['No data found in CSV file']);
             }
 
-            // Validate CSV structure
-            $csvValidation = $this->csvValidator->validate($csvData);
+            $csvValidation = $this->csvValidator->validate(array_values($firstChunk));
             if (!$csvValidation->isValid()) {
                 return new ImportResult(false, 0, $csvValidation->getErrors());
             }
 
-            return $this->processTransactionData($csvData);
+            return $this->processTransactionData($this->resume($firstChunk, $rows));
 
         } catch (Exception $e) {
             $this->logger->error('Import from file failed', [
@@ -97,94 +121,172 @@ class ImportService
     }
 
     /**
-     * Process CSV data and import transactions
+     * Set the number of rows normalized and written per batch
+     */
+    public function setChunkSize($chunkSize)
+    {
+        $this->chunkSize = max(1, (int)$chunkSize);
+    }
+
+    /**
+     * Yield the rows already read for validation, then the rest of the stream
+     */
+    private function resume(array $firstChunk, Generator $rows)
+    {
+        foreach ($firstChunk as $lineNumber => $row) {
+            yield $lineNumber => $row;
+        }
+
+        // break left the generator on the last buffered row
+        $rows->next();
+        while ($rows->valid()) {
+            yield $rows->key() => $rows->current();
+            $rows->next();
+        }
+    }
+
+    /**
+     * Process CSV rows and import transactions
+     *
+     * Accepts any iterable of header-keyed rows (keys are used as row
+     * numbers in error messages).
      */
-    private function processTransactionData(array $csvData)
+    private function processTransactionData($rows)
     {
-        $imported = 0;
-        $failed = 0;
-        $errors = [];
-        $warnings = [];
+        $result = [
+            'imported' => 0,
+            'failed' => 0,
+            'errors' => [],
+            'warnings' => []
+        ];
+        $positions = [];
 
-        $this->logger->info('Processing transaction data', ['total_rows' => count($csvData)]);
+        // Hold one chunk back so the last one is known when it is written
+        $pending = null;
+        foreach ($this->normalizedChunks($rows, $result) as $chunk) {
+            if ($pending !== null) {
+                $this->importChunk($pending, $positions, $result, false);
+            }
+            $pending = $chunk;
+        }
+        if ($pending !== null) {
+            $this->importChunk($pending, $positions, $result, true);
+        }
 
-        // Process each transaction in a database transaction
-        $this->transactionDAO->beginTransaction();
+        if ($result['imported'] > 0) {
+            $this->logger->info('Transaction import completed successfully', [
+                'imported' => $result['imported'],
+                'failed' => $result['failed'],
+                'positions' => count($positions)
+            ]);
+        } else {
+            $this->logger->warning('No transactions imported');
+        }
+
+        return new ImportResult(
+            $result['imported'] > 0,
+            $result['imported'],
+            $result['errors'],
+            $result['warnings']
+        );
+    }
+
+    /**
+     * Write one chunk of transactions and fold it into $positions
+     *
+     * The last chunk writes the positions in its own transaction, so the
+     * final rows and the positions derived from them commit together. If
+     * it fails, the positions from the earlier chunks are written alone.
+     */
+    private function importChunk(array $chunk, array &$positions, array &$result, $isLast)
+    {
+        $updated = $positions;
+        foreach ($chunk as $transactionData) {
+            $this->applyToPosition($updated, $transactionData);
+        }
 
         try {
-            foreach ($csvData as $index => $row) {
-                $rowNumber = $index + 1;
+            $this->transactionDAO->insertTransactions(array_values($chunk), $isLast ? function () use ($updated) {
+                $this->writePositions($updated);
+            } : null);
+        } catch (Exception $e) {
+            $result['failed'] += count($chunk);
+            $this->addMessage($result['errors'], 'Rows ' . array_key_first($chunk) . '-' . array_key_last($chunk)
+                . ': Failed to import transactions - ' . $e->getMessage());
 
-                // Skip empty rows
-                if (empty(array_filter($row))) {
-                    continue;
-                }
+            $this->logger->warning('Transaction import failed for chunk', [
+                'first_row' => array_key_first($chunk),
+                'rows' => count($chunk),
+                'error' => $e->getMessage()
+            ]);
 
-                // Normalize transaction data
-                $transactionData = $this->normalizeTransactionData($row);
+            if ($isLast) {
+                $this->writePositions($positions);
+            }
+            return;
+        }
 
-                // Validate individual transaction
-                $validation = $this->transactionValidator->validate($transactionData);
-                
-                if (!$validation->isValid()) {
-                    $failed++;
-                    $errors[] = "Row $rowNumber: " . implode(', ', $validation->getErrors());
-                    continue;
-                }
+        $result['imported'] += count($chunk);
+        $positions = $updated;
+    }
 
-                // Add any warnings
-                if ($validation->hasWarnings()) {
-                    foreach ($validation->getWarnings() as $warning) {
-                        $warnings[] = "Row $rowNumber: $warning";
-                    }
-                }
+    /**
+     * Normalize and validate rows, yielding chunks of valid transactions
+     *
+     * Chunks are keyed by row number. Invalid rows are counted and reported
+     * in $result instead of being yielded.
+     */
+    private function normalizedChunks($rows, array &$result)
+    {
+        $chunk = [];
 
-                try {
-                    // Insert transaction
-                    $transactionId = $this->transactionDAO->insertTransaction($transactionData);
-                    
-                    // Update portfolio position
-                    $this->updatePortfolioPosition($transactionData);
-                    
-                    $imported++;
-                    
-                } catch (Exception $e) {
-                    $failed++;
-                    $errors[] = "Row $rowNumber: Failed to import transaction - " . $e->getMessage();
-                    
-                    $this->logger->warning('Transaction import failed for row', [
-                        'row' => $rowNumber,
-                        'data' => $transactionData,
-                        'error' => $e->getMessage()
-                    ]);
+        foreach ($rows as $rowNumber => $row) {
+            // Skip empty rows
+            if (empty(array_filter($row))) {
+                continue;
+            }
+
+            // Normalize transaction data
+            $transactionData = $this->normalizeTransactionData($row);
+
+            // Validate individual transaction
+            $validation = $this->transactionValidator->validate($transactionData);
+
+            if (!$validation->isValid()) {
+                $result['failed']++;
+                $this->addMessage($result['errors'], "Row $rowNumber: " . implode(', ', $validation->getErrors()));
+                continue;
+            }
+
+            // Add any warnings
+            if ($validation->hasWarnings()) {
+                foreach ($validation->getWarnings() as $warning) {
+                    $this->addMessage($result['warnings'], "Row $rowNumber: $warning");
                 }
             }
 
-            // Commit transaction if we imported anything
-            if ($imported > 0) {
-                $this->transactionDAO->commit();
-                $this->logger->info('Transaction import completed successfully', [
-                    'imported' => $imported,
-                    'failed' => $failed
-                ]);
-            } else {
-                $this->transactionDAO->rollback();
-                $this->logger->warning('No transactions imported, rolling back');
+            $chunk[$rowNumber] = $transactionData;
+            if (count($chunk) >= $this->chunkSize) {
+                yield $chunk;
+                $chunk = [];
             }
+        }
 
-            return new ImportResult(
-                $imported > 0,
-                $imported,
-                $errors,
-                $warnings
-            );
+        if (!empty($chunk)) {
+            yield $chunk;
+        }
+    }
 
-        } catch (Exception $e) {
-            $this->transactionDAO->rollback();
-            $this->logger->error('Transaction import failed, rolled back', [
-                'error' => $e->getMessage()
-            ]);
-            throw $e;
+    /**
+     * Append an error/warning, keeping at most MAX_MESSAGES per list
+     */
+    private function addMessage(array &$messages, $message)
+    {
+        $count = count($messages);
+        if ($count < self::MAX_MESSAGES) {
+            $messages[] = $message;
+        } elseif ($count === self::MAX_MESSAGES) {
+            $messages[] = 'Further messages suppressed';
         }
     }
 
@@ -273,39 +375,73 @@ class ImportService
     }
 
     /**
-     * Update portfolio position based on transaction
+     * Fold a transaction into the in-memory position for its symbol
+     *
+     * The position is loaded from the database the first time a symbol is
+     * seen; after that, BUYs re-average the cost and SELLs reduce shares at
+     * the same average cost, as they would if applied row by row.
      */
-    private function updatePortfolioPosition(array $transactionData)
+    private function applyToPosition(array &$positions, array $transactionData)
     {
         $symbol = $transactionData['symbol'];
         $shares = $transactionData['shares'];
         $price = $transactionData['price'];
         $type = $transactionData['txn_type'];
 
-        // Get current portfolio position
-        $currentPosition = $this->portfolioDAO->getPortfolioBySymbol($symbol);
+        if (!isset($positions[$symbol])) {
+            // Get current portfolio position
+            $currentPosition = $this->portfolioDAO->getPortfolioBySymbol($symbol);
+            $positions[$symbol] = $currentPosition ? [
+                'shares' => $currentPosition['current_shares'],
+                'avg_cost' => $currentPosition['avg_cost'],
+                'price' => null,
+                'exists' => true
+            ] : ['shares' => 0, 'avg_cost' => 0, 'price' => null, 'exists' => false];
+        }
 
-        if ($currentPosition) {
-            // Update existing position
-            $currentShares = $currentPosition['current_shares'];
-            $currentAvgCost = $currentPosition['avg_cost'];
+        $position = &$positions[$symbol];
 
+        if ($position['exists']) {
             if ($type === 'BUY') {
-                $newShares = $currentShares + $shares;
-                $newAvgCost = (($currentShares * $currentAvgCost) + ($shares * $price)) / $newShares;
+                $newShares = $position['shares'] + $shares;
+                if ($newShares != 0) {
+                    $position['avg_cost'] = (($position['shares'] * $position['avg_cost']) + ($shares * $price)) / $newShares;
+                }
+                $position['shares'] = $newShares;
             } else { // SELL
-                $newShares = $currentShares - $shares;
-                $newAvgCost = $currentAvgCost; // Keep same average cost for sells
+                $position['shares'] -= $shares; // Keep same average cost for sells
             }
-
-            $this->portfolioDAO->updatePortfolioPosition($symbol, $newShares, $newAvgCost, $price);
-            
-        } else {
+            $position['price'] = $price;
+        } elseif ($type === 'BUY') {
             // New position
-            if ($type === 'BUY') {
-                $this->portfolioDAO->updatePortfolioPosition($symbol, $shares, $price, $price);
+            $position = ['shares' => $shares, 'avg_cost' => $price, 'price' => $price, 'exists' => true];
+        }
+        // For sells of non-existent positions, we might want to log a warning
+    }
+
+    /**
+     * Write each touched position once
+     */
+    private function writePositions(array $positions)
+    {
+        foreach ($positions as $symbol => $position) {
+            if ($position['price'] === null) {
+                continue;
+            }
+
+            try {
+                $this->portfolioDAO->updatePortfolioPosition(
+                    $symbol,
+                    $position['shares'],
+                    $position['avg_cost'],
+                    $position['price']
+                );
+            } catch (Exception $e) {
+                $this->logger->error('Portfolio position update failed', [
+                    'symbol' => $symbol,
+                    'error' => $e->getMessage()
+                ]);
             }
-            // For sells of non-existent positions, we might want to log a warning
         }
     }
 
@@ -147,6 +147,8 @@ abstract class BaseDAO
  */
 class TransactionDAO extends BaseDAO
 {
+    private $batchStatements = [];
+
     public function __construct(
         DatabaseConnectionInterface $db,
         LoggerInterface $logger,
@@ -186,6 +188,71 @@ class TransactionDAO extends BaseDAO
         return $insertId;
     }
 
+    /**
+     * Insert a chunk of transactions in one transaction
+     *
+     * Every row is validated before any is written. Uses a single multi-row
+     * INSERT; the prepared statement is reused for every chunk of the same
+     * size. $inTransaction, if given, runs after the INSERT and before the
+     * commit, so writes derived from the chunk land with it. Either the whole
+     * chunk is committed or none of it is. Returns the number of rows written.
+     */
+    public function insertTransactions(array $transactions, callable $inTransaction = null)
+    {
+        if (empty($transactions)) {
+            return 0;
+        }
+
+        $rowCount = count($transactions);
+        $params = [];
+        foreach (array_values($transactions) as $index => $transactionData) {
+            $validation = $this->validateData($transactionData);
+            if (!$validation->isValid()) {
+                throw new InvalidArgumentException("Invalid transaction data in row {$index}: " . implode(', ', $validation->getErrors()));
+            }
+
+            $params[] = $transactionData['symbol'];
+            $params[] = $transactionData['shares'];
+            $params[] = $transactionData['price'];
+            $params[] = $transactionData['txn_date'];
+            $params[] = $transactionData['txn_type'] ?? 'BUY';
+        }
+
+        return $this->executeTransaction(function () use ($rowCount, $params, $inTransaction) {
+            try {
+                $this->prepareBatchInsert($rowCount)->execute($params);
+            } catch (PDOException $e) {
+                $this->logger->error('Batch transaction insert failed', [
+                    'rows' => $rowCount,
+                    'error' => $e->getMessage()
+                ]);
+                throw new RuntimeException('Database operation failed: ' . $e->getMessage(), 0, $e);
+            }
+
+            if ($inTransaction !== null) {
+                $inTransaction();
+            }
+
+            $this->logger->info('Transactions inserted', ['rows' => $rowCount]);
+            return $rowCount;
+        });
+    }
+
+    /**
+     * Prepared multi-row INSERT for $rowCount rows, cached by row count
+     */
+    private function prepareBatchInsert($rowCount)
+    {
+        if (!isset($this->batchStatements[$rowCount])) {
+            $values = implode(', ', array_fill(0, $rowCount, '(?, ?, ?, ?, ?)'));
+            $this->batchStatements[$rowCount] = $this->db->getConnection()->prepare(
+                "INSERT INTO transactions (symbol, shares, price, txn_date, txn_type) VALUES $values"
+            );
+        }
+
+        return $this->batchStatements[$rowCount];
+    }
+
     public function getTransactionsBySymbol($symbol)
     {
         $sql = "SELECT * FROM transactions WHERE symbol = :symbol ORDER BY txn_date DESC";
@@ -27,9 +27,14 @@ class PortfolioDAO extends CommonDAO {
         // Try DB first
         if ($this->pdo) {
             try {
-                $stmt = $this->pdo->query("SELECT * FROM {$this->tableName} WHERE date = (SELECT MAX(date) FROM {$this->tableName})");
-                $rows = $stmt->fetchAll(PDO::FETCH_ASSOC);
-                if ($rows) return $rows;
+                // Resolve the latest date first (an index lookup), then read that date only
+                $latest = $this->pdo->query("SELECT MAX(date) FROM {$this->tableName}")->fetchColumn();
+                if ($latest) {
+                    $stmt = $this->prepareCached("SELECT * FROM {$this->tableName} WHERE date = ?");
+                    $stmt->execute([$latest]);
+                    $rows = $stmt->fetchAll(PDO::FETCH_ASSOC);
+                    if ($rows) return $rows;
+                }
             } catch (Exception $e) {
                 $this->logError('DB read failed: ' . $e->getMessage());
             }
@@ -50,13 +55,31 @@ class PortfolioDAO extends CommonDAO {
     }
 
 
+    /**
+     * Rows of the latest Date in the CSV, streamed so only that date is kept in memory
+     */
     private function readPortfolioCsv() {
-        $data = $this->readCsv($this->csvPath);
-        if (empty($data)) return [];
-        // Get latest date
-        $dates = array_column($data, 'Date');
-        $latest = max($dates);
-        return array_values(array_filter($data, function($r) use ($latest) { return $r['Date'] === $latest; }));
+        if (!file_exists($this->csvPath)) return [];
+        $handle = fopen($this->csvPath, 'r');
+        if ($handle === false) return [];
+        
+        $header = fgetcsv($handle);
+        $latest = null;
+        $rows = [];
+        while ($header && ($line = fgetcsv($handle)) !== false) {
+            if (count($line) !== count($header)) continue;
+            $row = array_combine($header, $line);
+            $date = $row['Date'] ?? null;
+            if ($latest === null || $date > $latest) {
+                $latest = $date;
+                $rows = [];
+            }
+            if ($date === $latest) {
+                $rows[] = $row;
+            }
+        }
+        fclose($handle);
+        return $rows;
     }
 
     private function writePortfolioCsv($rows) {
@@ -66,8 +89,8 @@ class PortfolioDAO extends CommonDAO {
     private function writePortfolioDb($rows) {
         if (!$this->pdo) return false;
         try {
+            $stmt = $this->prepareCached("REPLACE INTO {$this->tableName} (symbol, date, position_size, avg_cost, current_price, market_value, unrealized_pnl) VALUES (?, ?, ?, ?, ?, ?, ?)");
             foreach ($rows as $row) {
-                $stmt = $this->pdo->prepare("REPLACE INTO {$this->tableName} (symbol, date, position_size, avg_cost, current_price, market_value, unrealized_pnl) VALUES (?, ?, ?, ?, ?, ?, ?)");
                 $stmt->execute([
                     $row['Ticker'] ?? $row['symbol'] ?? '',
                     $row['Date'],
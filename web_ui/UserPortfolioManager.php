@@ -2,6 +2,12 @@
 /**
  * User-Aware Portfolio Manager
  * Manages portfolios with user authentication and per-user data separation
+ *
+ * All users share one history table keyed by (user_id, date, symbol) and a
+ * "current holdings" projection (user_id, symbol) rewritten on each write of
+ * a user's latest date, so reads and admin summaries are single indexed
+ * queries. Legacy portfolios_user_<id> tables are copied in once, when the
+ * tables are first ensured, before any read or write touches them.
  */
 
 require_once __DIR__ . '/UserAuthDAO.php';
@@ -9,6 +15,13 @@ require_once __DIR__ . '/CommonDAO.php';
 
 class UserPortfolioManager extends CommonDAO {
     
+    /** Stored columns besides user_id/date/symbol */
+    const VALUE_COLUMNS = ['shares', 'market_value', 'book_cost', 'gain_loss', 'gain_loss_percent', 'current_price'];
+    
+    /** Per-process memo of tables known to exist (and legacy tables found) */
+    private static $ensuredTables = [];
+    private static $legacyTables = null;
+    
     private $userAuth;
     private $baseTableName;
     private $baseCsvPath;
@@ -36,48 +49,196 @@ class UserPortfolioManager extends CommonDAO {
     }
     
     /**
-     * Ensure user portfolio table exists
+     * Ensure the consolidated portfolio tables exist (checked once per process)
+     *
+     * $userId is accepted for compatibility; the tables are shared by all users.
      */
     public function ensureUserPortfolioTable($userId = null) {
-        $userId = $userId ?: $this->getCurrentUserId();
-        
         if (!$this->pdo) return false;
         
+        $historyTable = $this->getHistoryTableName();
+        if (isset(self::$ensuredTables[$historyTable])) {
+            return true;
+        }
+        
         try {
-            $tableName = $this->getUserTableName($userId);
-            
-            // Create user-specific portfolio table
-            $sql = "CREATE TABLE IF NOT EXISTS `{$tableName}` (
-                id INT AUTO_INCREMENT PRIMARY KEY,
-                user_id INT NOT NULL,
-                symbol VARCHAR(10) NOT NULL,
+            $valueColumns = "
                 shares DECIMAL(15,4) DEFAULT 0,
                 market_value DECIMAL(15,2) DEFAULT 0,
                 book_cost DECIMAL(15,2) DEFAULT 0,
                 gain_loss DECIMAL(15,2) DEFAULT 0,
                 gain_loss_percent DECIMAL(8,4) DEFAULT 0,
                 current_price DECIMAL(10,4) DEFAULT 0,
+                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,";
+            
+            $this->pdo->exec("CREATE TABLE IF NOT EXISTS `{$historyTable}` (
+                user_id INT NOT NULL,
                 date DATE NOT NULL,
-                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
-                INDEX idx_user_date (user_id, date),
+                symbol VARCHAR(10) NOT NULL,{$valueColumns}
+                PRIMARY KEY (user_id, date, symbol),
                 INDEX idx_symbol (symbol),
                 FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
-            )";
+            )");
             
-            $this->pdo->exec($sql);
-            return true;
+            $this->pdo->exec("CREATE TABLE IF NOT EXISTS `{$this->getCurrentTableName()}` (
+                user_id INT NOT NULL,
+                symbol VARCHAR(10) NOT NULL,
+                date DATE NOT NULL,{$valueColumns}
+                PRIMARY KEY (user_id, symbol),
+                FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
+            )");
+            
+            $this->pdo->exec("CREATE TABLE IF NOT EXISTS `{$this->getLegacyImportsTableName()}` (
+                table_name VARCHAR(64) NOT NULL PRIMARY KEY,
+                imported_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+            )");
+            
+            self::$ensuredTables[$historyTable] = true;
             
         } catch (Exception $e) {
             $this->logError("Failed to create user portfolio table: " . $e->getMessage());
             return false;
         }
+        
+        $this->importLegacyTables();
+        return true;
     }
     
     /**
-     * Get user-specific table name
+     * Shared history table (all users, all dates)
+     */
+    private function getHistoryTableName() {
+        return $this->baseTableName . '_user_history';
+    }
+    
+    /**
+     * Latest holdings per user
+     */
+    private function getCurrentTableName() {
+        return $this->baseTableName . '_user_current';
+    }
+    
+    /**
+     * Legacy per-user tables already copied into the history table
+     */
+    private function getLegacyImportsTableName() {
+        return $this->baseTableName . '_legacy_imports';
+    }
+    
+    /**
+     * Legacy per-user table name
      */
     private function getUserTableName($userId) {
-        return $this->baseTableName . '_user_' . $userId;
+        return $this->baseTableName . '_user_' . (int)$userId;
+    }
+    
+    /**
+     * Legacy per-user tables still present (one SHOW TABLES per process)
+     */
+    private function getLegacyTables() {
+        if (self::$legacyTables === null) {
+            self::$legacyTables = [];
+            try {
+                $like = str_replace('_', '\\_', $this->baseTableName . '_user_') . '%';
+                $stmt = $this->pdo->prepare("SHOW TABLES LIKE ?");
+                $stmt->execute([$like]);
+                foreach ($stmt->fetchAll(PDO::FETCH_COLUMN) as $table) {
+                    if (preg_match('/_user_\d+$/', $table)) {
+                        self::$legacyTables[$table] = true;
+                    }
+                }
+            } catch (Exception $e) {
+                $this->logError('Legacy table lookup failed: ' . $e->getMessage());
+            }
+        }
+        return self::$legacyTables;
+    }
+    
+    /**
+     * Copy every legacy table not yet recorded in the imports table
+     */
+    private function importLegacyTables() {
+        $legacyTables = $this->getLegacyTables();
+        if (!$legacyTables) {
+            return;
+        }
+        
+        try {
+            $imported = array_flip($this->pdo->query("SELECT table_name FROM `{$this->getLegacyImportsTableName()}`")
+                ->fetchAll(PDO::FETCH_COLUMN));
+        } catch (Exception $e) {
+            $this->logError('Legacy import lookup failed: ' . $e->getMessage());
+            return;
+        }
+        
+        foreach (array_keys($legacyTables) as $legacyTable) {
+            if (!isset($imported[$legacyTable]) && preg_match('/_user_(\d+)$/', $legacyTable, $matches)) {
+                $this->importLegacyUserTable((int)$matches[1]);
+            }
+        }
+    }
+    
+    /**
+     * Copy a user's legacy table into the consolidated store
+     *
+     * Idempotent: history rows already present (e.g. written since) win, and
+     * the projection is only rebuilt if the legacy data is the newest.
+     *
+     * @return bool True if the table was imported
+     */
+    private function importLegacyUserTable($userId) {
+        $legacyTable = $this->getUserTableName($userId);
+        $legacyTables = $this->getLegacyTables();
+        if (!isset($legacyTables[$legacyTable])) {
+            return false;
+        }
+        
+        $columns = '`' . implode('`, `', self::VALUE_COLUMNS) . '`';
+        $this->pdo->beginTransaction();
+        try {
+            $stmt = $this->pdo->prepare("
+                INSERT IGNORE INTO `{$this->getHistoryTableName()}` (user_id, date, symbol, {$columns})
+                SELECT ?, date, symbol, {$columns} FROM `{$legacyTable}`
+            ");
+            $stmt->execute([$userId]);
+            $latest = $this->pdo->query("SELECT MAX(date) FROM `{$legacyTable}`")->fetchColumn();
+            $stmt = $this->pdo->prepare("SELECT MAX(date) FROM `{$this->getCurrentTableName()}` WHERE user_id = ?");
+            $stmt->execute([$userId]);
+            $currentDate = $stmt->fetchColumn();
+            if ($latest && (!$currentDate || $latest > $currentDate)) {
+                $this->refreshCurrentHoldings($userId, $latest);
+            }
+            $stmt = $this->pdo->prepare("INSERT IGNORE INTO `{$this->getLegacyImportsTableName()}` (table_name) VALUES (?)");
+            $stmt->execute([$legacyTable]);
+            $this->pdo->commit();
+        } catch (Exception $e) {
+            if ($this->pdo->inTransaction()) {
+                $this->pdo->rollBack();
+            }
+            $this->logError('Legacy portfolio import failed: ' . $e->getMessage());
+            return false;
+        }
+        
+        // The legacy table is left in place; deleteUserPortfolio drops it
+        return true;
+    }
+    
+    /**
+     * Rebuild a user's current-holdings projection from one history date
+     */
+    private function refreshCurrentHoldings($userId, $date) {
+        $columns = '`' . implode('`, `', self::VALUE_COLUMNS) . '`';
+        $currentTable = $this->getCurrentTableName();
+        
+        $stmt = $this->pdo->prepare("DELETE FROM `{$currentTable}` WHERE user_id = ?");
+        $stmt->execute([$userId]);
+        
+        $stmt = $this->pdo->prepare("
+            INSERT INTO `{$currentTable}` (user_id, symbol, date, {$columns})
+            SELECT user_id, symbol, date, {$columns} FROM `{$this->getHistoryTableName()}`
+            WHERE user_id = ? AND date = ?
+        ");
+        $stmt->execute([$userId, $date]);
     }
     
     /**
@@ -96,19 +257,18 @@ class UserPortfolioManager extends CommonDAO {
      */
     public function readUserPortfolio($userId = null) {
         $userId = $userId ?: $this->getCurrentUserId();
-        $tableName = $this->getUserTableName($userId);
         
         // Try database first
         if ($this->pdo) {
             try {
-                $this->ensureUserPortfolioTable($userId);
+                $this->ensureUserPortfolioTable();
                 
                 $stmt = $this->pdo->prepare("
-                    SELECT * FROM `{$tableName}` 
-                    WHERE date = (SELECT MAX(date) FROM `{$tableName}`)
+                    SELECT * FROM `{$this->getCurrentTableName()}`
+                    WHERE user_id = ?
                     ORDER BY symbol
                 ");
-                $stmt->execute();
+                $stmt->execute([$userId]);
                 $rows = $stmt->fetchAll(PDO::FETCH_ASSOC);
                 
                 if ($rows) return $rows;
@@ -198,24 +358,32 @@ class UserPortfolioManager extends CommonDAO {
     
     /**
      * Write user portfolio to database
+     *
+     * Replaces the rows for the written date and, when that date is the
+     * user's latest, the current-holdings projection.
      */
     private function writeUserPortfolioDb($rows, $userId) {
         if (!$this->pdo || empty($rows)) return false;
         
         try {
-            $this->ensureUserPortfolioTable($userId);
-            $tableName = $this->getUserTableName($userId);
+            $this->ensureUserPortfolioTable();
+            $historyTable = $this->getHistoryTableName();
             
             $this->pdo->beginTransaction();
             
             // Clear existing data for today
             $date = $rows[0]['date'] ?? date('Y-m-d');
-            $stmt = $this->pdo->prepare("DELETE FROM `{$tableName}` WHERE user_id = ? AND date = ?");
+            $stmt = $this->pdo->prepare("DELETE FROM `{$historyTable}` WHERE user_id = ? AND date = ?");
             $stmt->execute([$userId, $date]);
             
-            // Insert new data
-            foreach ($rows as $row) {
-                $this->insertPortfolioRow($tableName, $row);
+            // Insert new data in one statement
+            $this->insertPortfolioRows($historyTable, $rows, $userId, $date);
+            
+            $stmt = $this->prepareCached("SELECT MAX(date) FROM `{$this->getCurrentTableName()}` WHERE user_id = ?");
+            $stmt->execute([$userId]);
+            $currentDate = $stmt->fetchColumn();
+            if (!$currentDate || $date >= $currentDate) {
+                $this->refreshCurrentHoldings($userId, $date);
             }
             
             $this->pdo->commit();
@@ -231,15 +399,26 @@ class UserPortfolioManager extends CommonDAO {
     }
     
     /**
-     * Insert a single portfolio row
+     * Insert portfolio rows for one user and date (unknown keys are ignored)
      */
-    private function insertPortfolioRow($tableName, $row) {
-        $columns = array_keys($row);
-        $placeholders = str_repeat('?,', count($columns) - 1) . '?';
+    private function insertPortfolioRows($tableName, $rows, $userId, $date) {
+        $columns = array_merge(['user_id', 'date', 'symbol'], self::VALUE_COLUMNS);
+        $placeholders = '(' . rtrim(str_repeat('?,', count($columns)), ',') . ')';
         
-        $sql = "INSERT INTO `{$tableName}` (`" . implode('`, `', $columns) . "`) VALUES ({$placeholders})";
+        $params = [];
+        foreach ($rows as $row) {
+            $params[] = $userId;
+            $params[] = $date;
+            $params[] = $row['symbol'] ?? '';
+            foreach (self::VALUE_COLUMNS as $column) {
+                $params[] = $row[$column] ?? 0;
+            }
+        }
+        
+        $sql = "INSERT INTO `{$tableName}` (`" . implode('`, `', $columns) . "`) VALUES "
+            . implode(', ', array_fill(0, count($rows), $placeholders));
         $stmt = $this->pdo->prepare($sql);
-        $stmt->execute(array_values($row));
+        $stmt->execute($params);
     }
     
     /**
@@ -251,15 +430,14 @@ class UserPortfolioManager extends CommonDAO {
         if (!$this->pdo) return [];
         
         try {
-            $tableName = $this->getUserTableName($userId);
-            $this->ensureUserPortfolioTable($userId);
+            $this->ensureUserPortfolioTable();
             
             $stmt = $this->pdo->prepare("
                 SELECT date, 
                        COUNT(*) as holdings_count, 
                        SUM(market_value) as total_value,
                        SUM(gain_loss) as total_gain_loss
-                FROM `{$tableName}` 
+                FROM `{$this->getHistoryTableName()}` 
                 WHERE user_id = ? 
                 GROUP BY date 
                 ORDER BY date DESC 
@@ -282,12 +460,7 @@ class UserPortfolioManager extends CommonDAO {
         
         $portfolio = $this->readUserPortfolio($userId);
         if (empty($portfolio)) {
-            return [
-                'total_holdings' => 0,
-                'total_value' => 0,
-                'total_gain_loss' => 0,
-                'last_updated' => null
-            ];
+            return $this->emptySummary();
         }
         
         $totalValue = 0;
@@ -303,8 +476,21 @@ class UserPortfolioManager extends CommonDAO {
             }
         }
         
+        return $this->buildSummary(count($portfolio), $totalValue, $totalGainLoss, $lastUpdated);
+    }
+    
+    private function emptySummary() {
         return [
-            'total_holdings' => count($portfolio),
+            'total_holdings' => 0,
+            'total_value' => 0,
+            'total_gain_loss' => 0,
+            'last_updated' => null
+        ];
+    }
+    
+    private function buildSummary($holdings, $totalValue, $totalGainLoss, $lastUpdated) {
+        return [
+            'total_holdings' => $holdings,
             'total_value' => $totalValue,
             'total_gain_loss' => $totalGainLoss,
             'gain_loss_percent' => $totalValue > 0 ? ($totalGainLoss / ($totalValue - $totalGainLoss)) * 100 : 0,
@@ -323,23 +509,43 @@ class UserPortfolioManager extends CommonDAO {
         if (!$this->pdo) return [];
         
         try {
-            // Get all users and their portfolio summary
-            $users = $this->userAuth->getAllUsers();
+            $this->ensureUserPortfolioTable();
+            
+            // One grouped query over the projection covers every user
+            $stmt = $this->pdo->query("
+                SELECT user_id,
+                       COUNT(*) as total_holdings,
+                       SUM(market_value) as total_value,
+                       SUM(gain_loss) as total_gain_loss,
+                       MAX(date) as last_updated
+                FROM `{$this->getCurrentTableName()}`
+                GROUP BY user_id
+            ");
+            $summaries = [];
+            foreach ($stmt->fetchAll(PDO::FETCH_ASSOC) as $row) {
+                $summaries[$row['user_id']] = $this->buildSummary(
+                    (int)$row['total_holdings'],
+                    (float)$row['total_value'],
+                    (float)$row['total_gain_loss'],
+                    $row['last_updated']
+                );
+            }
+            
             $portfolioSummaries = [];
             
-            foreach ($users as $user) {
-                try {
-                    $summary = $this->getUserPortfolioSummary($user['id']);
-                    $portfolioSummaries[] = array_merge($user, $summary);
-                } catch (Exception $e) {
-                    // User might not have a portfolio yet
-                    $portfolioSummaries[] = array_merge($user, [
-                        'total_holdings' => 0,
-                        'total_value' => 0,
-                        'total_gain_loss' => 0,
-                        'last_updated' => null
-                    ]);
+            foreach ($this->userAuth->getAllUsers() as $user) {
+                $summary = $summaries[$user['id']] ?? null;
+                
+                // CSV only: fall back to the per-user path
+                if ($summary === null && file_exists($this->getUserCsvPath($user['id']))) {
+                    try {
+                        $summary = $this->getUserPortfolioSummary($user['id']);
+                    } catch (Exception $e) {
+                        $summary = null;
+                    }
                 }
+                
+                $portfolioSummaries[] = array_merge($user, $summary ?? $this->emptySummary());
             }
             
             return $portfolioSummaries;
@@ -391,13 +597,24 @@ class UserPortfolioManager extends CommonDAO {
             throw new Exception('Admin access required');
         }
         
-        // Delete database table
+        // Delete database rows (and any legacy per-user table)
         if ($this->pdo) {
             try {
+                $this->ensureUserPortfolioTable();
+                foreach ([$this->getCurrentTableName(), $this->getHistoryTableName()] as $table) {
+                    $stmt = $this->pdo->prepare("DELETE FROM `{$table}` WHERE user_id = ?");
+                    $stmt->execute([$userId]);
+                }
+                
                 $tableName = $this->getUserTableName($userId);
                 $this->pdo->exec("DROP TABLE IF EXISTS `{$tableName}`");
+                $stmt = $this->pdo->prepare("DELETE FROM `{$this->getLegacyImportsTableName()}` WHERE table_name = ?");
+                $stmt->execute([$tableName]);
+                if (self::$legacyTables !== null) {
+                    unset(self::$legacyTables[$tableName]);
+                }
             } catch (Exception $e) {
-                $this->logError('Failed to drop user portfolio table: ' . $e->getMessage());
+                $this->logError('Failed to delete user portfolio: ' . $e->getMessage());
             }
         }
         
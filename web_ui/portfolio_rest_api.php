@@ -3,6 +3,8 @@
 // OpenAPI/Swagger spec will be provided separately
 require_once __DIR__ . '/PortfolioDAO.php';
 require_once __DIR__ . '/DbConfigClasses.php';
+require_once __DIR__ . '/../src/ResponseCache.php';
+require_once __DIR__ . '/../src/HttpCache.php';
 header('Content-Type: application/json');
 
 function getPortfolioInfo($type) {
@@ -44,15 +46,24 @@ if (!$type) {
 $info = getPortfolioInfo($type);
 $dao = new PortfolioDAO($info['csv'], $info['table'], $info['dbclass']);
 
+// Pollers share one read per type for a few seconds; writes invalidate it
+$cache = new ResponseCache(['prefix' => 'portfolio_rest_api']);
+$cacheTtl = 5;
+$cacheNamespace = 'portfolio_' . $info['table'];
+
 switch ($method) {
     case 'GET':
-        $rows = $dao->readPortfolio();
-        echo json_encode(['data' => $rows, 'errors' => $dao->getErrors()]);
+        $body = $cache->remember($cacheNamespace, 'read', $cacheTtl, function () use ($dao) {
+            $rows = $dao->readPortfolio();
+            return json_encode(['data' => $rows, 'errors' => $dao->getErrors()]);
+        });
+        HttpCache::send($body, $cacheTtl);
         break;
     case 'POST':
         $input = json_decode(file_get_contents('php://input'), true);
         $rows = $input['rows'] ?? [];
         $ok = $dao->writePortfolio($rows);
+        $cache->invalidate($cacheNamespace);
         echo json_encode(['success' => $ok, 'errors' => $dao->getErrors()]);
         break;
     default:
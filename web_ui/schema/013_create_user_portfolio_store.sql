@@ -0,0 +1,32 @@
+-- v1.1: Consolidated per-user portfolio store (replaces portfolios_user_<id> tables)
+CREATE TABLE IF NOT EXISTS portfolios_user_history (
+    user_id INT NOT NULL,
+    date DATE NOT NULL,
+    symbol VARCHAR(10) NOT NULL,
+    shares DECIMAL(15,4) DEFAULT 0,
+    market_value DECIMAL(15,2) DEFAULT 0,
+    book_cost DECIMAL(15,2) DEFAULT 0,
+    gain_loss DECIMAL(15,2) DEFAULT 0,
+    gain_loss_percent DECIMAL(8,4) DEFAULT 0,
+    current_price DECIMAL(10,4) DEFAULT 0,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+    PRIMARY KEY (user_id, date, symbol),
+    INDEX idx_symbol (symbol),
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
+);
+
+-- Latest holdings per user, maintained on write
+CREATE TABLE IF NOT EXISTS portfolios_user_current (
+    user_id INT NOT NULL,
+    symbol VARCHAR(10) NOT NULL,
+    date DATE NOT NULL,
+    shares DECIMAL(15,4) DEFAULT 0,
+    market_value DECIMAL(15,2) DEFAULT 0,
+    book_cost DECIMAL(15,2) DEFAULT 0,
+    gain_loss DECIMAL(15,2) DEFAULT 0,
+    gain_loss_percent DECIMAL(8,4) DEFAULT 0,
+    current_price DECIMAL(10,4) DEFAULT 0,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+    PRIMARY KEY (user_id, symbol),
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
+);
@@ -29,6 +29,8 @@ require_once __DIR__ . '/DatabaseJobBackend.php';
 require_once __DIR__ . '/RedisJobBackend.php';
 require_once __DIR__ . '/RabbitMQJobBackend.php';
 require_once __DIR__ . '/MQTTJobBackend.php';
+require_once __DIR__ . '/src/Ksfraser/Database/StatementCache.php';
+require_once __DIR__ . '/src/Metrics.php';
 
 /**
  * Worker class for processing jobs
@@ -38,12 +40,19 @@ class StandaloneWorker
     private $workerId;
     private $config;
     private $backend;
+    private $backendName;
     private $logger;
     private $running = false;
     private $processors = [];
     private $currentJobs = [];
     private $maxConcurrentJobs;
     private $pollInterval;
+    private $blockingAcquisition = false;
+    
+    /**
+     * In a forked child: the socket its exit code is reported on
+     */
+    private $resultSocket = null;
     
     public function __construct($configFile = null)
     {
@@ -52,10 +61,11 @@ class StandaloneWorker
         
         // Load configuration
         $this->loadConfig($configFile);
+        Metrics::configure($this->config['metrics'] ?? []);
         
         // Setup logger
         $logFile = $this->config['worker']['log_file'] ?? 'logs/worker_' . $this->workerId . '.log';
-        $this->logger = new JobLogger($logFile);
+        $this->logger = new JobLogger($logFile, $this->config['logging'] ?? []);
         
         // Initialize backend
         $this->initializeBackend();
@@ -67,6 +77,10 @@ class StandaloneWorker
         $this->maxConcurrentJobs = $this->config['worker']['max_concurrent_jobs'] ?? 3;
         $this->pollInterval = $this->config['worker']['poll_interval'] ?? 5;
         
+        // Block in the backend until a job arrives instead of sleeping between polls
+        $acquisitionMode = $this->config['worker']['acquisition_mode'] ?? 'blocking';
+        $this->blockingAcquisition = $acquisitionMode === 'blocking' && method_exists($this->backend, 'waitForJob');
+        
         // Setup signal handlers for graceful shutdown
         $this->setupSignalHandlers();
         
@@ -99,6 +113,7 @@ class StandaloneWorker
     private function initializeBackend()
     {
         $backendType = $this->config['queue']['backend'] ?? 'database';
+        $this->backendName = $backendType;
         
         switch ($backendType) {
             case 'database':
@@ -143,6 +158,16 @@ class StandaloneWorker
             'data_import' => new DataImportJobProcessor(),
             'portfolio_analysis' => new PortfolioAnalysisJobProcessor()
         ];
+        
+        // Let processors enqueue child jobs (e.g. fanned-out technical analysis)
+        // and publish throttled progress through the backend
+        $progressOptions = [
+            'min_interval_ms' => $this->config['worker']['progress_interval_ms'] ?? 1000,
+            'min_delta' => $this->config['worker']['progress_min_delta'] ?? 5
+        ];
+        foreach ($this->processors as $processor) {
+            $processor->setJobBackend($this->backend, $progressOptions);
+        }
     }
     
     /**
@@ -161,23 +186,28 @@ class StandaloneWorker
     }
     
     /**
-     * Start the worker
+     * Register this worker with the backend
      */
-    public function start()
+    private function register()
     {
-        $this->running = true;
-        
-        // Register worker with backend
-        $workerInfo = [
+        $this->backend->registerWorker($this->workerId, [
             'hostname' => gethostname(),
             'pid' => getmypid(),
             'job_types' => array_keys($this->processors),
             'max_concurrent_jobs' => $this->maxConcurrentJobs,
             'version' => '1.0.0',
             'started_at' => time()
-        ];
+        ]);
+    }
+    
+    /**
+     * Start the worker
+     */
+    public function start()
+    {
+        $this->running = true;
         
-        $this->backend->registerWorker($this->workerId, $workerInfo);
+        $this->register();
         
         $this->logger->info("Worker {$this->workerId} started");
         
@@ -194,18 +224,35 @@ class StandaloneWorker
                 
                 // Send heartbeat
                 if (time() - $lastHeartbeat >= $heartbeatInterval) {
-                    $this->backend->updateWorkerHeartbeat($this->workerId);
+                    if ($this->backend->updateWorkerHeartbeat($this->workerId) === false) {
+                        // Registration expired (e.g. Redis TTL after a stall); jobs are not claimed until it is back
+                        $this->logger->warning("Worker {$this->workerId} registration expired; registering again");
+                        $this->register();
+                    }
                     $lastHeartbeat = time();
                 }
                 
+                // Check completed jobs
+                $this->checkCompletedJobs();
+                
+                // Write buffered log entries before blocking or sleeping
+                $this->logger->flush();
+                
+                if ($this->blockingAcquisition) {
+                    if (count($this->currentJobs) < $this->maxConcurrentJobs) {
+                        // Returns as soon as a job arrives, or after the poll interval
+                        $this->waitForNewJob();
+                    } else {
+                        usleep(100000); // At capacity: wait for a child to finish
+                    }
+                    continue;
+                }
+                
                 // Check for new jobs if we have capacity
                 if (count($this->currentJobs) < $this->maxConcurrentJobs) {
                     $this->checkForNewJobs();
                 }
                 
-                // Check completed jobs
-                $this->checkCompletedJobs();
-                
                 // Sleep before next iteration
                 sleep($this->pollInterval);
                 
@@ -230,13 +277,41 @@ class StandaloneWorker
     private function checkForNewJobs()
     {
         $jobTypes = array_keys($this->processors);
+        $span = Metrics::startSpan('worker_get_next_job', ['backend' => $this->backendName, 'mode' => 'poll']);
         $job = $this->backend->getNextJob($this->workerId, $jobTypes);
+        Metrics::endSpan($span, ['result' => $job ? 'job' : 'empty']);
+        
+        if ($job) {
+            $this->processJob($job);
+        }
+    }
+    
+    /**
+     * Block until the backend delivers a job (bounded by the poll interval,
+     * so heartbeats and signals are still handled)
+     */
+    private function waitForNewJob()
+    {
+        $jobTypes = array_keys($this->processors);
+        $span = Metrics::startSpan('worker_get_next_job', ['backend' => $this->backendName, 'mode' => 'blocking']);
+        $job = $this->backend->waitForJob($this->workerId, $jobTypes, $this->pollInterval);
+        Metrics::endSpan($span, ['result' => $job ? 'job' : 'empty']);
         
         if ($job) {
             $this->processJob($job);
         }
     }
     
+    /**
+     * Release a job claimed with waitForJob() once its outcome is known
+     */
+    private function ackJob($jobId, $success)
+    {
+        if ($this->blockingAcquisition && method_exists($this->backend, 'ackJob')) {
+            $this->backend->ackJob($jobId, $this->workerId, $success);
+        }
+    }
+    
     /**
      * Process a job
      */
@@ -246,8 +321,10 @@ class StandaloneWorker
         $jobType = $job['job_type'];
         
         if (!isset($this->processors[$jobType])) {
+            Metrics::increment('worker_unroutable_jobs_total', ['job_type' => $jobType]);
             $this->logger->error("No processor found for job type: {$jobType}");
             $this->backend->failJob($jobId, $this->workerId, "No processor for job type: {$jobType}", false);
+            $this->ackJob($jobId, true);
             return;
         }
         
@@ -255,28 +332,36 @@ class StandaloneWorker
         
         // Fork process if PCNTL is available
         if (function_exists('pcntl_fork')) {
+            $this->logger->flush();
+            $sockets = stream_socket_pair(STREAM_PF_UNIX, STREAM_SOCK_STREAM, STREAM_IPPROTO_IP) ?: [null, null];
             $pid = pcntl_fork();
             
             if ($pid == -1) {
                 // Fork failed
+                $this->closeSockets($sockets);
                 $this->logger->error("Failed to fork process for job {$jobId}");
                 $this->backend->failJob($jobId, $this->workerId, "Failed to fork process", true);
+                $this->ackJob($jobId, false);
                 return;
             } elseif ($pid == 0) {
                 // Child process
+                $this->closeSockets([$sockets[0]]);
+                $this->resultSocket = $sockets[1];
                 $this->executeJobInChild($job);
-                exit(0);
+                $this->exitChild(0);
             } else {
                 // Parent process
+                $this->closeSockets([$sockets[1]]);
                 $this->currentJobs[$jobId] = [
                     'pid' => $pid,
                     'job' => $job,
-                    'started_at' => time()
+                    'started_at' => time(),
+                    'result' => $sockets[0]
                 ];
             }
         } else {
             // No forking available - execute in main process
-            $this->executeJob($job);
+            $this->ackJob($jobId, $this->executeJob($job));
         }
     }
     
@@ -286,11 +371,78 @@ class StandaloneWorker
     private function executeJobInChild($job)
     {
         try {
+            // Don't share the parent's broker/database socket (or its blocking
+            // reads): the backend and freshly built processors pick up this
+            // process's own connections
+            if (method_exists($this->backend, 'reconnect')) {
+                $this->backend->reconnect();
+            }
+            $this->setupProcessors();
+            
             $result = $this->executeJob($job);
-            exit($result ? 0 : 1);
+            $this->exitChild($result ? 0 : 1);
         } catch (Exception $e) {
             $this->logger->error("Job {$job['id']} failed in child process: " . $e->getMessage());
-            exit(1);
+            $this->exitChild(1);
+        }
+    }
+    
+    /**
+     * End a forked child without closing the parent's connections
+     *
+     * The child still holds the parent's database handles (parked by
+     * DatabaseConfig::getSharedConnection) and broker clients (parked by the
+     * backends' reconnect()). A normal exit destroys them, and their close
+     * handlers send QUIT / connection.close on the parent's sockets, ending
+     * the parent's sessions. So the child flushes its logs and metrics, drops
+     * its own connections, reports $code on the result socket and SIGKILLs
+     * itself, which runs no destructors; checkCompletedJobs() reads the code
+     * back. Without posix_kill() the child falls back to a plain exit.
+     */
+    private function exitChild($code)
+    {
+        $this->logger->flush();
+        Metrics::flush();
+        DatabaseConfig::resetConnections();
+        
+        if (is_resource($this->resultSocket)) {
+            fwrite($this->resultSocket, chr((int)$code));
+            fclose($this->resultSocket);
+        }
+        
+        if (function_exists('posix_kill')) {
+            posix_kill(getmypid(), SIGKILL);
+        }
+        exit($code);
+    }
+    
+    /**
+     * Exit code of a reaped child: its normal exit status, or the code it
+     * reported before killing itself (see exitChild())
+     */
+    private function childExitCode(array $jobInfo, $status)
+    {
+        $code = 1;
+        if (pcntl_wifexited($status)) {
+            $code = pcntl_wexitstatus($status);
+        } elseif (is_resource($jobInfo['result'] ?? null)) {
+            $reported = fread($jobInfo['result'], 1);
+            $code = ($reported === false || $reported === '') ? 1 : ord($reported);
+        }
+        
+        $this->closeSockets([$jobInfo['result'] ?? null]);
+        return $code;
+    }
+    
+    /**
+     * Close the result sockets that are still open
+     */
+    private function closeSockets(array $sockets)
+    {
+        foreach ($sockets as $socket) {
+            if (is_resource($socket)) {
+                fclose($socket);
+            }
         }
     }
     
@@ -302,23 +454,48 @@ class StandaloneWorker
         $jobId = $job['id'];
         $jobType = $job['job_type'];
         
+        $processor = $this->processors[$jobType];
+        $statementsBefore = \Ksfraser\Database\StatementCache::getGlobalStats();
+        $span = Metrics::startSpan('worker_execute_job', ['job_type' => $jobType]);
+        
         try {
-            $processor = $this->processors[$jobType];
+            $processor->trackStatus($job, 'running', $this->workerId);
             $result = $processor->execute($job);
+            $processor->flushProgress($job);
             
             $this->backend->completeJob($jobId, $this->workerId, $result);
-            $this->logger->info("Completed job {$jobId}");
+            $processor->trackStatus($job, 'completed');
+            Metrics::endSpan($span, ['outcome' => 'ok']);
+            $this->logger->info("Completed job {$jobId}" . $this->describeStatementCache($statementsBefore));
             
             return true;
             
         } catch (Exception $e) {
+            Metrics::endSpan($span, ['outcome' => 'error']);
             $this->logger->error("Job {$jobId} failed: " . $e->getMessage());
+            $processor->flushProgress($job);
             $this->backend->failJob($jobId, $this->workerId, $e->getMessage(), true);
+            $processor->trackStatus($job, 'failed');
             
             return false;
         }
     }
     
+    /**
+     * Prepared statement cache hits/misses since $before, for the job log
+     */
+    private function describeStatementCache(array $before)
+    {
+        $after = \Ksfraser\Database\StatementCache::getGlobalStats();
+        $hits = $after['hits'] - $before['hits'];
+        $misses = $after['misses'] - $before['misses'];
+        if ($hits + $misses === 0) {
+            return '';
+        }
+        return sprintf(' (statement cache: %d hits, %d misses, %.1f%% hit rate)',
+            $hits, $misses, 100 * $hits / ($hits + $misses));
+    }
+    
     /**
      * Check for completed jobs
      */
@@ -335,16 +512,22 @@ class StandaloneWorker
             if ($result > 0) {
                 // Child process completed
                 unset($this->currentJobs[$jobId]);
+                $exitCode = $this->childExitCode($jobInfo, $status);
                 
-                if (pcntl_wexitstatus($status) == 0) {
+                if ($exitCode == 0) {
                     $this->logger->info("Job {$jobId} completed successfully");
                 } else {
-                    $this->logger->error("Job {$jobId} failed with exit code: " . pcntl_wexitstatus($status));
+                    $this->logger->error("Job {$jobId} failed with exit code: {$exitCode}");
                 }
+                $this->ackJob($jobId, $exitCode == 0);
+                continue;
             } elseif ($result == -1) {
                 // Error occurred
+                $this->closeSockets([$jobInfo['result'] ?? null]);
                 unset($this->currentJobs[$jobId]);
                 $this->logger->error("Error waiting for job {$jobId}");
+                $this->ackJob($jobId, false);
+                continue;
             }
             
             // Check for job timeout
@@ -352,7 +535,9 @@ class StandaloneWorker
             if (time() - $jobInfo['started_at'] > $timeout) {
                 $this->logger->warning("Job {$jobId} timed out, killing process");
                 posix_kill($jobInfo['pid'], SIGTERM);
+                $this->closeSockets([$jobInfo['result'] ?? null]);
                 unset($this->currentJobs[$jobId]);
+                $this->ackJob($jobId, false);
             }
         }
     }
@@ -373,6 +558,7 @@ class StandaloneWorker
         foreach ($this->currentJobs as $jobId => $jobInfo) {
             $this->logger->warning("Force killing job {$jobId}");
             posix_kill($jobInfo['pid'], SIGKILL);
+            $this->closeSockets([$jobInfo['result'] ?? null]);
         }
         
         $this->currentJobs = [];